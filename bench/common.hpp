@@ -0,0 +1,63 @@
+/**
+ * @file
+ * @brief Общие функции тестов производительности.
+ */
+#ifndef TASP_BENCH_COMMON_HPP_
+#define TASP_BENCH_COMMON_HPP_
+
+#include <evhttp.h>
+
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "http/synthetic_request.hpp"
+
+namespace tasp::bench
+{
+
+/**
+ * @brief Умный указатель запроса библиотеки libevent.
+ */
+using EvRequest =
+    std::unique_ptr<evhttp_request, decltype(&evhttp_request_free)>;
+
+/**
+ * @brief Формирование запроса libevent без подключения, в том виде, в котором
+ * его получает обработчик HTTP-сервера.
+ *
+ * @param type Метод
+ * @param url URL запроса
+ * @param headers Заголовки
+ * @param body Данные запроса
+ *
+ * @return Запрос
+ */
+inline EvRequest MakeRequest(
+    evhttp_cmd_type type,
+    const char *url,
+    const std::vector<std::pair<const char *, const char *>> &headers = {},
+    std::string_view body = {})
+{
+    EvRequest req{evhttp_request_new(nullptr, nullptr), evhttp_request_free};
+
+    [[maybe_unused]] const bool parsed{
+        http::InitRequest(req.get(), type, url, 1, 1)};
+
+    for (const auto &[name, value] : headers)
+    {
+        evhttp_add_header(evhttp_request_get_input_headers(req.get()),
+                          name,
+                          value);
+    }
+
+    evbuffer_add(
+        evhttp_request_get_input_buffer(req.get()), body.data(), body.size());
+
+    return req;
+}
+
+}  // namespace tasp::bench
+
+#endif  // TASP_BENCH_COMMON_HPP_
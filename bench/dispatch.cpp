@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include <functional>
+
+#include "common.hpp"
+#include "http/request_impl.hpp"
+#include "http/response_impl.hpp"
+#include "tasp/microservice.hpp"
+
+using tasp::HandlerRef;
+using tasp::bench::MakeRequest;
+using tasp::http::Request;
+using tasp::http::RequestImpl;
+using tasp::http::Response;
+using tasp::http::ResponseImpl;
+
+namespace
+{
+/**
+ * @brief Сервис с тривиальным обработчиком.
+ */
+class Service final
+{
+public:
+    /**
+     * @brief Тривиальный обработчик запроса.
+     */
+    void Handle([[maybe_unused]] const Request &request,
+                [[maybe_unused]] Response &response) noexcept
+    {
+        calls_++;
+    }
+
+    /**
+     * @brief Распределение запроса по обработчику через std::function, как
+     * до привязки при компиляции.
+     */
+    void DispatchFunction(RequestImpl &request, ResponseImpl &response) noexcept
+    {
+        function_handler_(request, response);
+    }
+
+    /**
+     * @brief Распределение запроса по обработчику через ссылку.
+     */
+    void DispatchRef(RequestImpl &request, ResponseImpl &response) noexcept
+    {
+        ref_handler_(request, response);
+    }
+
+    /**
+     * @brief Обработчик, привязанный std::bind.
+     */
+    // NOLINTNEXTLINE(modernize-avoid-bind)
+    tasp::Handler function_handler_{std::bind(&Service::Handle,
+                                              this,
+                                              std::placeholders::_1,
+                                              std::placeholders::_2)};
+
+    /**
+     * @brief Обработчик, привязанный при компиляции.
+     */
+    HandlerRef ref_handler_{HandlerRef::Bind<&Service::Handle>(this)};
+
+    /**
+     * @brief Количество вызовов обработчика.
+     */
+    uint64_t calls_{0};
+};
+
+//------------------------------------------------------------------------------
+void BM_DispatchFunction(benchmark::State &state)
+{
+    auto req{MakeRequest(EVHTTP_REQ_GET, "/api/v1/items")};
+    RequestImpl request(req.get());
+    ResponseImpl response(req.get());
+
+    Service service;
+
+    // распределитель подключения и обработчик - std::function
+    const std::function<void(RequestImpl &, ResponseImpl &)> dispatcher{
+        [&service](auto &&request_impl, auto &&response_impl)
+        {
+            service.DispatchFunction(request_impl, response_impl);
+        }};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        dispatcher(request, response);
+    }
+
+    benchmark::DoNotOptimize(service.calls_);
+}
+
+//------------------------------------------------------------------------------
+void BM_DispatchRef(benchmark::State &state)
+{
+    auto req{MakeRequest(EVHTTP_REQ_GET, "/api/v1/items")};
+    RequestImpl request(req.get());
+    ResponseImpl response(req.get());
+
+    Service service;
+
+    const auto dispatcher{
+        tasp::FunctionRef<void(RequestImpl &, ResponseImpl &)>::Bind<
+            &Service::DispatchRef>(&service)};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        dispatcher(request, response);
+    }
+
+    benchmark::DoNotOptimize(service.calls_);
+}
+
+}  // namespace
+
+BENCHMARK(BM_DispatchFunction);
+BENCHMARK(BM_DispatchRef);
@@ -0,0 +1,790 @@
+/**
+ * @file
+ * @brief Генератор нагрузки на HTTP-сервис.
+ *
+ * Запускает сервис в том же процессе (или подключается к внешнему), выполняет
+ * сценарии запросов по loopback-интерфейсу через постоянные подключения и
+ * выводит количество запросов в секунду и задержки p50/p99/p999.
+ *
+ * Использование:
+ * @code
+ * tasp-microservice-load [-c подключения] [-n запросы] [-s сценарий]
+ *                        [-a адрес:порт] [-p префикс] [-t] [-r full|resume]
+ *                        [-- аргументы сервиса]
+ * @endcode
+ *
+ * Адрес вида unix:/путь/к/файлу.sock задаёт подключение через сокет Unix.
+ * Для сервиса в том же процессе адрес берётся из параметра service.address:
+ * запуск с адресом TCP и с адресом unix: позволяет сравнить пропускную
+ * способность loopback-интерфейса и сокета Unix.
+ *
+ * Параметр -t включает подключение по TLS (без проверки сертификата).
+ * Параметр -r открывает новое подключение на каждый запрос: full - с полным
+ * рукопожатием TLS, resume - с возобновлением сессии; количество запросов в
+ * секунду при этом равно количеству рукопожатий в секунду.
+ *
+ * При подключении к внешнему сервису доступны только сценарии health и
+ * not_found.
+ */
+#include <event2/bufferevent.h>
+#include <event2/bufferevent_ssl.h>
+#include <evhttp.h>
+#include <openssl/ssl.h>
+#include <signal.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <tasp/config.hpp>
+#include <tasp/microservice.hpp>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+/**
+ * @brief Открытие подключений.
+ */
+enum class Reconnect
+{
+    /**
+     * @brief Постоянные подключения.
+     */
+    None,
+
+    /**
+     * @brief Новое подключение на каждый запрос с полным рукопожатием TLS.
+     */
+    Full,
+
+    /**
+     * @brief Новое подключение на каждый запрос с возобновлением сессии TLS.
+     */
+    Resume
+};
+
+/**
+ * @brief Параметры запуска.
+ */
+struct Options
+{
+    /**
+     * @brief Количество одновременных подключений.
+     */
+    size_t connections{32};
+
+    /**
+     * @brief Количество запросов в каждом сценарии.
+     */
+    size_t requests{100000};
+
+    /**
+     * @brief Адрес сервиса.
+     */
+    string address{"127.0.0.1"};
+
+    /**
+     * @brief Порт сервиса. 0 - взять из конфигурации сервиса.
+     */
+    uint16_t port{0};
+
+    /**
+     * @brief Путь к сокету Unix. Если задан, адрес и порт не используются.
+     */
+    string unix_path;
+
+    /**
+     * @brief Префикс пути. Для сервиса в том же процессе берётся из
+     * конфигурации.
+     */
+    string prefix{"/api/v1"};
+
+    /**
+     * @brief Запуск сервиса в том же процессе.
+     */
+    bool in_process{true};
+
+    /**
+     * @brief Подключение по TLS.
+     */
+    bool tls{false};
+
+    /**
+     * @brief Открытие подключений.
+     */
+    Reconnect reconnect{Reconnect::None};
+
+    /**
+     * @brief Выполняемые сценарии. Пустой список - все сценарии.
+     */
+    vector<string> scenarios;
+
+    /**
+     * @brief Аргументы запускаемого сервиса.
+     */
+    vector<const char *> service_args{"tasp-microservice-load"};
+};
+
+/**
+ * @brief Сценарий нагрузки.
+ */
+struct Scenario
+{
+    /**
+     * @brief Название.
+     */
+    string name;
+
+    /**
+     * @brief Путь запроса относительно префикса.
+     */
+    string path;
+};
+
+/**
+ * @brief Состояние выполнения сценария.
+ */
+struct Run
+{
+    /**
+     * @brief Цикл обработки событий клиента.
+     */
+    event_base *base{nullptr};
+
+    /**
+     * @brief Текст запроса.
+     */
+    string request;
+
+    /**
+     * @brief Количество запросов, которые ещё нужно отправить.
+     */
+    size_t remaining{0};
+
+    /**
+     * @brief Количество активных подключений.
+     */
+    size_t active{0};
+
+    /**
+     * @brief Количество ошибок.
+     */
+    size_t errors{0};
+
+    /**
+     * @brief Объём полученных тел ответов в байтах.
+     */
+    size_t bytes{0};
+
+    /**
+     * @brief Задержки ответов в микросекундах.
+     */
+    vector<double> latencies;
+
+    /**
+     * @brief Адрес сервиса.
+     */
+    sockaddr_storage address{};
+
+    /**
+     * @brief Размер адреса сервиса.
+     */
+    int address_length{0};
+
+    /**
+     * @brief Контекст TLS. Пустой указатель - подключения без шифрования.
+     */
+    SSL_CTX *tls{nullptr};
+
+    /**
+     * @brief Сессия TLS для возобновления.
+     */
+    SSL_SESSION *session{nullptr};
+
+    /**
+     * @brief Открытие подключений.
+     */
+    Reconnect reconnect{Reconnect::None};
+};
+
+/**
+ * @brief Подключение клиента.
+ *
+ * Запросы HTTP/1.1 формируются и разбираются непосредственно в буферах
+ * bufferevent: клиент libevent не поддерживает сокеты Unix, а одинаковый
+ * клиент для TCP и сокета Unix делает результаты сравнимыми.
+ */
+struct Client
+{
+    /**
+     * @brief Этап разбора ответа.
+     */
+    enum class State
+    {
+        Status,
+        Headers,
+        Body
+    };
+
+    /**
+     * @brief Состояние выполнения сценария.
+     */
+    Run *run{nullptr};
+
+    /**
+     * @brief Буферизованное подключение.
+     */
+    bufferevent *bev{nullptr};
+
+    /**
+     * @brief Время отправки текущего запроса.
+     */
+    Clock::time_point start;
+
+    /**
+     * @brief Этап разбора ответа.
+     */
+    State state{State::Status};
+
+    /**
+     * @brief Код текущего ответа.
+     */
+    int code{0};
+
+    /**
+     * @brief Оставшийся размер тела текущего ответа.
+     */
+    size_t body_left{0};
+};
+
+void OnRead(bufferevent *bev, void *arg) noexcept;
+void OnEvent(bufferevent *bev, int16_t events, void *arg) noexcept;
+
+//------------------------------------------------------------------------------
+bool Connect(Client &client) noexcept
+{
+    auto &run{*client.run};
+
+    if (run.tls != nullptr)
+    {
+        SSL *ssl{SSL_new(run.tls)};
+        if (run.session != nullptr)
+        {
+            SSL_set_session(ssl, run.session);
+        }
+        client.bev = bufferevent_openssl_socket_new(run.base,
+                                                    -1,
+                                                    ssl,
+                                                    BUFFEREVENT_SSL_CONNECTING,
+                                                    BEV_OPT_CLOSE_ON_FREE);
+        bufferevent_openssl_set_allow_dirty_shutdown(client.bev, 1);
+    }
+    else
+    {
+        client.bev =
+            bufferevent_socket_new(run.base, -1, BEV_OPT_CLOSE_ON_FREE);
+    }
+
+    bufferevent_setcb(client.bev, &OnRead, nullptr, &OnEvent, &client);
+    bufferevent_enable(client.bev, EV_READ | EV_WRITE);
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (bufferevent_socket_connect(client.bev,
+                                   reinterpret_cast<sockaddr *>(&run.address),
+                                   run.address_length) == 0)
+    {
+        return true;
+    }
+
+    bufferevent_free(client.bev);
+    client.bev = nullptr;
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void Close(Client &client) noexcept
+{
+    auto &run{*client.run};
+
+    bufferevent_free(client.bev);
+    client.bev = nullptr;
+
+    if (--run.active == 0)
+    {
+        event_base_loopbreak(run.base);
+    }
+}
+
+//------------------------------------------------------------------------------
+void Issue(Client &client) noexcept
+{
+    auto &run{*client.run};
+    if (run.remaining == 0)
+    {
+        Close(client);
+        return;
+    }
+
+    run.remaining--;
+
+    client.state = Client::State::Status;
+    client.start = Clock::now();
+    bufferevent_write(client.bev, run.request.data(), run.request.size());
+}
+
+//------------------------------------------------------------------------------
+void Complete(Client &client) noexcept
+{
+    auto &run{*client.run};
+
+    const std::chrono::duration<double, std::micro> elapsed{Clock::now() -
+                                                            client.start};
+
+    if (client.code == 0 || client.code >= HTTP_INTERNAL)
+    {
+        run.errors++;
+    }
+    else
+    {
+        run.latencies.push_back(elapsed.count());
+    }
+
+    if (run.reconnect == Reconnect::None)
+    {
+        Issue(client);
+        return;
+    }
+
+    // билет сессии TLS 1.3 приходит после рукопожатия, поэтому сессия
+    // сохраняется после получения ответа
+    if (run.reconnect == Reconnect::Resume && run.session == nullptr)
+    {
+        run.session =
+            SSL_get1_session(bufferevent_openssl_get_ssl(client.bev));
+    }
+
+    // сессия подключения, закрытого без уведомления close_notify, не
+    // возобновляется
+    if (run.tls != nullptr)
+    {
+        SSL_shutdown(bufferevent_openssl_get_ssl(client.bev));
+    }
+
+    bufferevent_free(client.bev);
+    client.bev = nullptr;
+
+    if (run.remaining == 0 || !Connect(client))
+    {
+        if (--run.active == 0)
+        {
+            event_base_loopbreak(run.base);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void OnRead(bufferevent *bev, void *arg) noexcept
+{
+    auto &client{*static_cast<Client *>(arg)};
+    evbuffer *input{bufferevent_get_input(bev)};
+
+    while (client.bev != nullptr)
+    {
+        if (client.state == Client::State::Body)
+        {
+            const size_t length{
+                std::min(client.body_left, evbuffer_get_length(input))};
+            evbuffer_drain(input, length);
+            client.body_left -= length;
+            client.run->bytes += length;
+
+            if (client.body_left > 0)
+            {
+                return;
+            }
+
+            Complete(client);
+
+            // новое подключение читается собственной функцией обратного
+            // вызова
+            if (client.run->reconnect != Reconnect::None)
+            {
+                return;
+            }
+            continue;
+        }
+
+        size_t length{0};
+        const std::unique_ptr<char, decltype(&free)> line{
+            evbuffer_readln(input, &length, EVBUFFER_EOL_CRLF), free};
+        if (!line)
+        {
+            return;
+        }
+
+        const string_view text{line.get(), length};
+
+        if (client.state == Client::State::Status)
+        {
+            // HTTP/1.1 200 OK
+            const auto space{text.find(' ')};
+            client.code = space == string_view::npos
+                              ? 0
+                              : std::atoi(line.get() + space + 1);
+            client.body_left = 0;
+            client.state = Client::State::Headers;
+        }
+        else if (!text.empty())
+        {
+            const string_view name{"content-length:"};
+            if (text.size() > name.size() &&
+                strncasecmp(text.data(), name.data(), name.size()) == 0)
+            {
+                client.body_left =
+                    std::strtoul(line.get() + name.size(), nullptr, 10);
+            }
+        }
+        else
+        {
+            client.state = Client::State::Body;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void OnEvent([[maybe_unused]] bufferevent *bev,
+             int16_t events,
+             void *arg) noexcept
+{
+    auto &client{*static_cast<Client *>(arg)};
+
+    if ((events & BEV_EVENT_CONNECTED) != 0)
+    {
+        Issue(client);
+        return;
+    }
+
+    if ((events & (BEV_EVENT_ERROR | BEV_EVENT_EOF)) != 0)
+    {
+        client.run->errors++;
+        Close(client);
+    }
+}
+
+//------------------------------------------------------------------------------
+double Percentile(const vector<double> &sorted, double rank) noexcept
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+
+    const auto index{static_cast<size_t>(rank *
+                                         static_cast<double>(sorted.size()))};
+    return sorted.at(std::min(index, sorted.size() - 1));
+}
+
+//------------------------------------------------------------------------------
+void Execute(const Options &options,
+             const Scenario &scenario,
+             const string &prefix) noexcept
+{
+    Run run;
+    run.address_length = sizeof(run.address);
+
+    if (!options.unix_path.empty())
+    {
+        auto &addr{reinterpret_cast<sockaddr_un &>(run.address)};  // NOLINT
+        addr.sun_family = AF_UNIX;
+        options.unix_path.copy(&addr.sun_path[0], sizeof(addr.sun_path) - 1);
+        run.address_length = sizeof(addr);
+    }
+    else
+    {
+        const string host{options.address + ":" +
+                          std::to_string(options.port)};
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        evutil_parse_sockaddr_port(host.c_str(),
+                                   reinterpret_cast<sockaddr *>(&run.address),
+                                   &run.address_length);
+    }
+
+    event_base *base{event_base_new()};
+
+    if (options.tls)
+    {
+        run.tls = SSL_CTX_new(TLS_client_method());
+    }
+
+    run.base = base;
+    run.reconnect = options.reconnect;
+    run.request = "GET " + prefix + scenario.path +
+                  " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    run.remaining = options.requests;
+    run.latencies.reserve(options.requests);
+
+    vector<Client> clients(options.connections);
+    for (auto &client : clients)
+    {
+        client.run = &run;
+        if (Connect(client))
+        {
+            run.active++;
+        }
+        else
+        {
+            run.errors++;
+        }
+    }
+
+    const auto start{Clock::now()};
+
+    if (run.active > 0)
+    {
+        event_base_dispatch(base);
+    }
+
+    const std::chrono::duration<double> elapsed{Clock::now() - start};
+
+    event_base_free(base);
+
+    SSL_SESSION_free(run.session);
+    SSL_CTX_free(run.tls);
+
+    std::sort(run.latencies.begin(), run.latencies.end());
+
+    const double mib{1024 * 1024};
+
+    std::printf("%-12s %10zu %8zu %12.0f %10.1f %10.1f %10.1f %10.1f\n",
+                scenario.name.c_str(),
+                run.latencies.size(),
+                run.errors,
+                static_cast<double>(run.latencies.size()) / elapsed.count(),
+                static_cast<double>(run.bytes) / mib / elapsed.count(),
+                Percentile(run.latencies, 0.5),
+                Percentile(run.latencies, 0.99),
+                Percentile(run.latencies, 0.999));
+}
+
+//------------------------------------------------------------------------------
+void SetAddress(Options &options, string_view address) noexcept
+{
+    const string_view unix_prefix{"unix:"};
+    if (address.substr(0, unix_prefix.size()) == unix_prefix)
+    {
+        options.unix_path = address.substr(unix_prefix.size());
+        return;
+    }
+
+    const auto colon{address.rfind(':')};
+    options.address = address.substr(0, colon);
+    options.port = static_cast<uint16_t>(std::strtoul(
+        string{address.substr(colon + 1)}.c_str(), nullptr, 10));
+}
+
+//------------------------------------------------------------------------------
+Options ParseOptions(int argc, const char **argv) noexcept
+{
+    Options options;
+
+    const vector<const char *> args(argv + 1, argv + argc);
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        const string_view arg{args[i]};
+        const bool has_value{i + 1 < args.size()};
+
+        if (arg == "--")
+        {
+            options.service_args.insert(options.service_args.end(),
+                                        args.begin() +
+                                            static_cast<ptrdiff_t>(i + 1),
+                                        args.end());
+            break;
+        }
+
+        if (arg == "-c" && has_value)
+        {
+            options.connections = std::strtoul(args[++i], nullptr, 10);
+        }
+        else if (arg == "-n" && has_value)
+        {
+            options.requests = std::strtoul(args[++i], nullptr, 10);
+        }
+        else if (arg == "-s" && has_value)
+        {
+            options.scenarios.emplace_back(args[++i]);
+        }
+        else if (arg == "-a" && has_value)
+        {
+            SetAddress(options, args[++i]);
+            options.in_process = false;
+        }
+        else if (arg == "-p" && has_value)
+        {
+            options.prefix = args[++i];
+        }
+        else if (arg == "-t")
+        {
+            options.tls = true;
+        }
+        else if (arg == "-r" && has_value &&
+                 (string_view{args[i + 1]} == "full" ||
+                  string_view{args[i + 1]} == "resume"))
+        {
+            options.reconnect = string_view{args[++i]} == "full"
+                                    ? Reconnect::Full
+                                    : Reconnect::Resume;
+        }
+        else
+        {
+            std::fprintf(stderr,
+                         "Использование: %s [-c подключения] [-n запросы] "
+                         "[-s сценарий] [-a адрес:порт] [-p префикс] [-t] "
+                         "[-r full|resume] [-- аргументы сервиса]\n",
+                         argv[0]);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    return options;
+}
+
+//------------------------------------------------------------------------------
+void AddScenarioHandlers(const tasp::MicroService &service) noexcept
+{
+    using tasp::http::Request;
+    using tasp::http::Response;
+
+    service.AddHandler(Request::Method::Get,
+                       "/bench/empty",
+                       []([[maybe_unused]] const Request &request,
+                          [[maybe_unused]] Response &response) {});
+
+    service.AddHandler(
+        Request::Method::Get,
+        "/bench/small",
+        []([[maybe_unused]] const Request &request, Response &response)
+        {
+            Json::Value data;
+            data["id"] = 1;
+            data["name"] = "Элемент";
+            response.Data()->Set(data);
+        });
+
+    service.AddHandler(
+        Request::Method::Get,
+        "/bench/list",
+        []([[maybe_unused]] const Request &request, Response &response)
+        {
+            Json::Value data{Json::arrayValue};
+            for (int i = 0; i < 1000; i++)
+            {
+                Json::Value item;
+                item["id"] = i;
+                item["name"] = "Элемент списка";
+                item["value"] = i * 1.5;
+                data.append(item);
+            }
+            response.Data()->Set(data);
+        });
+
+    service.AddHandler(
+        Request::Method::Get,
+        "/bench/bulk",
+        []([[maybe_unused]] const Request &request, Response &response)
+        {
+            static const Json::Value data{string(1024 * 1024, 'x')};
+            response.Data()->Set(data);
+        });
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, const char **argv)
+{
+    auto options{ParseOptions(argc, argv)};
+
+    const vector<Scenario> scenarios{{"empty", "/bench/empty"},
+                                     {"small", "/bench/small"},
+                                     {"list", "/bench/list"},
+                                     {"bulk", "/bench/bulk"},
+                                     {"health", "/health"},
+                                     {"not_found", "/bench/missing"}};
+
+    std::unique_ptr<tasp::MicroService> service;
+    std::thread service_thread;
+
+    const auto &config{tasp::ConfigGlobal::Instance()};
+
+    if (options.in_process)
+    {
+        service = std::make_unique<tasp::MicroService>(
+            static_cast<int>(options.service_args.size()),
+            options.service_args.data());
+        AddScenarioHandlers(*service);
+
+        service_thread = std::thread(
+            [&service]
+            {
+                [[maybe_unused]] const int res{service->Exec()};
+            });
+
+        options.prefix = config.Get("service.prefix", options.prefix);
+        options.port = config.Get<uint16_t>("service.port", 5555);
+
+        const string address{config.Get("service.address", string{})};
+        if (address.substr(0, 5) == "unix:")
+        {
+            SetAddress(options, address);
+        }
+
+        // ожидание запуска потоков обработки событий
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    std::printf("%-12s %10s %8s %12s %10s %10s %10s %10s\n",
+                "scenario",
+                "requests",
+                "errors",
+                "rps",
+                "MiB/s",
+                "p50,us",
+                "p99,us",
+                "p999,us");
+
+    for (const auto &scenario : scenarios)
+    {
+        if (!options.scenarios.empty() &&
+            std::find(options.scenarios.begin(),
+                      options.scenarios.end(),
+                      scenario.name) == options.scenarios.end())
+        {
+            continue;
+        }
+
+        Execute(options, scenario, options.prefix);
+    }
+
+    if (service_thread.joinable())
+    {
+        kill(getpid(), SIGTERM);
+        service_thread.join();
+    }
+
+    return EXIT_SUCCESS;
+}
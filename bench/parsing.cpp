@@ -0,0 +1,202 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+
+#include "common.hpp"
+#include "http/binary_format.hpp"
+#include "http/header_impl.hpp"
+#include "http/json_reader.hpp"
+#include "http/sql_filter.hpp"
+#include "http/uri_impl.hpp"
+
+using std::string;
+
+using tasp::bench::MakeRequest;
+using tasp::http::BinaryFormat;
+using tasp::http::HeaderImpl;
+using tasp::http::JsonReader;
+using tasp::http::SqlFilter;
+using tasp::http::UriImpl;
+
+namespace
+{
+/**
+ * @brief Формирование данных запроса в формате JSON.
+ *
+ * @param count Количество элементов
+ *
+ * @return Данные
+ */
+string Body(size_t count)
+{
+    string body{"["};
+    for (size_t i = 0; i < count; i++)
+    {
+        body.append(i == 0 ? "" : ",")
+            .append(R"({"id":)")
+            .append(std::to_string(i))
+            .append(R"(,"name":"element","tags":["a","b"],"value":1.5})");
+    }
+    return body.append("]");
+}
+
+/**
+ * @brief Формирование данных запроса в двоичном формате.
+ *
+ * @param format Формат данных
+ * @param count Количество элементов
+ *
+ * @return Данные
+ */
+string BinaryBody(BinaryFormat::Format format, size_t count)
+{
+    Json::Value value;
+    string errors;
+    static_cast<void>(JsonReader::Read(Body(count), value, errors));
+
+    const std::unique_ptr<evbuffer, decltype(&evbuffer_free)> buffer{
+        evbuffer_new(), evbuffer_free};
+    BinaryFormat::Write(format, value, buffer.get());
+
+    string body(evbuffer_get_length(buffer.get()), '\0');
+    evbuffer_remove(buffer.get(), body.data(), body.size());
+    return body;
+}
+
+//------------------------------------------------------------------------------
+void BinaryReader(benchmark::State &state, BinaryFormat::Format format)
+{
+    const string body{BinaryBody(format, static_cast<size_t>(state.range(0)))};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        Json::Value value;
+        string errors;
+        benchmark::DoNotOptimize(
+            BinaryFormat::Read(format, body, value, errors));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(body.size()));
+}
+
+//------------------------------------------------------------------------------
+void BM_HeaderParse(benchmark::State &state)
+{
+    auto req{MakeRequest(EVHTTP_REQ_GET,
+                         "/api/v1/items",
+                         {{"Host", "localhost:5555"},
+                          {"User-Agent", "bench/1.0"},
+                          {"Accept", "application/json"},
+                          {"Accept-Encoding", "gzip, deflate"},
+                          {"Accept-Language", "ru-RU,ru;q=0.9"},
+                          {"Connection", "keep-alive"},
+                          {"Cache-Control", "no-cache"},
+                          {"Authorization", "Bearer 0123456789abcdef"}})};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        const HeaderImpl header(req.get());
+        benchmark::DoNotOptimize(header.Get("Accept"));
+    }
+}
+
+//------------------------------------------------------------------------------
+void BM_QueryParse(benchmark::State &state)
+{
+    auto req{MakeRequest(EVHTTP_REQ_GET,
+                         "/api/v1/items?filter=name:eq:first&filter=id:gt:10"
+                         "&sort=name&limit=100&offset=200")};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        const UriImpl uri(req.get());
+        benchmark::DoNotOptimize(uri.ParamValues("filter"));
+    }
+}
+
+//------------------------------------------------------------------------------
+void BM_SqlConditionLiteral(benchmark::State &state)
+{
+    auto req{MakeRequest(EVHTTP_REQ_GET,
+                         "/api/v1/items?filter=name:eq:first&filter=id:gt:10"
+                         "&filter=state:in:new,active")};
+    const UriImpl uri(req.get());
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        benchmark::DoNotOptimize(uri.ToSQLCondition());
+    }
+}
+
+//------------------------------------------------------------------------------
+void BM_SqlConditionCompiled(benchmark::State &state)
+{
+    auto req{MakeRequest(EVHTTP_REQ_GET,
+                         "/api/v1/items?filter=name:eq:first&filter=id:gt:10"
+                         "&filter=state:in:new,active")};
+    const UriImpl uri(req.get());
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        benchmark::DoNotOptimize(SqlFilter::Compile(
+            uri.Filters(), tasp::SqlCondition::Placeholder::Dollar));
+    }
+}
+
+//------------------------------------------------------------------------------
+void BM_JsonReaderReused(benchmark::State &state)
+{
+    const string body{Body(static_cast<size_t>(state.range(0)))};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        Json::Value value;
+        string errors;
+        benchmark::DoNotOptimize(JsonReader::Read(body, value, errors));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(body.size()));
+}
+
+//------------------------------------------------------------------------------
+void BM_JsonReaderPerCall(benchmark::State &state)
+{
+    const string body{Body(static_cast<size_t>(state.range(0)))};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        const std::unique_ptr<Json::CharReader> reader{
+            Json::CharReaderBuilder().newCharReader()};
+
+        Json::Value value;
+        string errors;
+        benchmark::DoNotOptimize(reader->parse(
+            body.data(), body.data() + body.size(), &value, &errors));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(body.size()));
+}
+
+//------------------------------------------------------------------------------
+void BM_CborReader(benchmark::State &state)
+{
+    BinaryReader(state, BinaryFormat::Format::Cbor);
+}
+
+//------------------------------------------------------------------------------
+void BM_MessagePackReader(benchmark::State &state)
+{
+    BinaryReader(state, BinaryFormat::Format::MessagePack);
+}
+
+}  // namespace
+
+BENCHMARK(BM_HeaderParse);
+BENCHMARK(BM_QueryParse);
+BENCHMARK(BM_SqlConditionLiteral);
+BENCHMARK(BM_SqlConditionCompiled);
+BENCHMARK(BM_JsonReaderReused)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK(BM_JsonReaderPerCall)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK(BM_CborReader)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK(BM_MessagePackReader)->Arg(1)->Arg(100)->Arg(10000);
@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+#include "http/uri_impl.hpp"
+
+using std::string;
+using std::vector;
+
+using tasp::bench::MakeRequest;
+using tasp::http::UriImpl;
+
+namespace
+{
+/**
+ * @brief Набор путей обработчиков в том виде, в котором их формирует
+ * MicroServiceImpl::AddHandler.
+ *
+ * @param count Количество путей
+ *
+ * @return Пути обработчиков
+ */
+vector<string> Routes(size_t count)
+{
+    vector<string> routes;
+    for (size_t i = 0; i < count; i++)
+    {
+        routes.push_back("/api/v1/resource" + std::to_string(i) +
+                         "/([0-9]+)/?");
+    }
+    return routes;
+}
+
+//------------------------------------------------------------------------------
+void BM_RouteMatch(benchmark::State &state)
+{
+    const auto routes{Routes(static_cast<size_t>(state.range(0)))};
+    const string url{"/api/v1/resource" + std::to_string(routes.size() - 1) +
+                     "/42?limit=10"};
+
+    auto req{MakeRequest(EVHTTP_REQ_GET, url.c_str())};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        UriImpl uri(req.get());
+        for (const auto &route : routes)
+        {
+            if (uri.Match(route))
+            {
+                break;
+            }
+        }
+        benchmark::DoNotOptimize(uri.SubMatch(1));
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_RouteMatch)->Arg(1)->Arg(10)->Arg(50);
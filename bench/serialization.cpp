@@ -0,0 +1,146 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "common.hpp"
+#include "http/binary_format.hpp"
+#include "http/compression.hpp"
+#include "http/json_writer.hpp"
+#include "http/response_impl.hpp"
+
+using std::string;
+
+using tasp::bench::MakeRequest;
+using tasp::http::BinaryFormat;
+using tasp::http::Compression;
+using tasp::http::EvBuffer;
+using tasp::http::JsonWriter;
+using tasp::http::ResponseImpl;
+
+namespace
+{
+/**
+ * @brief Формирование типичного ответа со списком элементов.
+ *
+ * @param count Количество элементов
+ *
+ * @return Данные ответа
+ */
+Json::Value List(int64_t count)
+{
+    Json::Value list{Json::arrayValue};
+    for (int64_t i = 0; i < count; i++)
+    {
+        Json::Value item;
+        item["id"] = static_cast<Json::Int64>(i);
+        item["name"] = "Элемент списка";
+        item["active"] = (i % 2) == 0;
+        item["value"] = static_cast<double>(i) * 1.5;
+        list.append(item);
+    }
+    return list;
+}
+
+//------------------------------------------------------------------------------
+void BM_JsonWriterEvBuffer(benchmark::State &state)
+{
+    const Json::Value list{List(state.range(0))};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        const EvBuffer buffer{evbuffer_new(), evbuffer_free};
+        JsonWriter::Write(list, buffer.get());
+        benchmark::DoNotOptimize(evbuffer_get_length(buffer.get()));
+    }
+}
+
+//------------------------------------------------------------------------------
+void BM_JsonWriterDefault(benchmark::State &state)
+{
+    const Json::Value list{List(state.range(0))};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        const EvBuffer buffer{evbuffer_new(), evbuffer_free};
+        const string data{Json::writeString(Json::StreamWriterBuilder(), list)};
+        evbuffer_add(buffer.get(), data.data(), data.size());
+        benchmark::DoNotOptimize(evbuffer_get_length(buffer.get()));
+    }
+}
+
+//------------------------------------------------------------------------------
+void BM_CborWriter(benchmark::State &state)
+{
+    const Json::Value list{List(state.range(0))};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        const EvBuffer buffer{evbuffer_new(), evbuffer_free};
+        BinaryFormat::Write(BinaryFormat::Format::Cbor, list, buffer.get());
+        benchmark::DoNotOptimize(evbuffer_get_length(buffer.get()));
+    }
+}
+
+//------------------------------------------------------------------------------
+void BM_MessagePackWriter(benchmark::State &state)
+{
+    const Json::Value list{List(state.range(0))};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        const EvBuffer buffer{evbuffer_new(), evbuffer_free};
+        BinaryFormat::Write(
+            BinaryFormat::Format::MessagePack, list, buffer.get());
+        benchmark::DoNotOptimize(evbuffer_get_length(buffer.get()));
+    }
+}
+
+//------------------------------------------------------------------------------
+void BM_ResponseBody(benchmark::State &state)
+{
+    const Json::Value list{List(state.range(0))};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        auto req{MakeRequest(EVHTTP_REQ_GET, "/api/v1/items")};
+
+        ResponseImpl response(req.get());
+        response.Data()->Set(list);
+        benchmark::DoNotOptimize(response.Body());
+    }
+}
+
+//------------------------------------------------------------------------------
+void BM_Compression(benchmark::State &state)
+{
+    Compression::Settings settings;
+    settings.enabled = true;
+    settings.level = static_cast<int>(state.range(0));
+    Compression::Configure(settings);
+
+    const EvBuffer body{evbuffer_new(), evbuffer_free};
+    JsonWriter::Write(List(10000), body.get());
+
+    const auto length{evbuffer_get_length(body.get())};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const std::string_view data{
+        reinterpret_cast<char *>(evbuffer_pullup(body.get(), -1)), length};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        const EvBuffer buffer{evbuffer_new(), evbuffer_free};
+        benchmark::DoNotOptimize(Compression::Compress(
+            Compression::Encoding::Gzip, data, buffer.get()));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(length));
+}
+
+}  // namespace
+
+BENCHMARK(BM_JsonWriterEvBuffer)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK(BM_JsonWriterDefault)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK(BM_CborWriter)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK(BM_MessagePackWriter)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK(BM_ResponseBody)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK(BM_Compression)->Arg(1)->Arg(6);
@@ -0,0 +1,121 @@
+/**
+ * @file
+ * @brief Отложенный ответ асинхронного обработчика.
+ */
+#ifndef TASP_ASYNC_REPLY_HPP_
+#define TASP_ASYNC_REPLY_HPP_
+
+#include <memory>
+#include <type_traits>
+
+#include <tasp/function_ref.hpp>
+#include <tasp/http/response.hpp>
+
+namespace tasp
+{
+
+namespace http
+{
+class Exchange;
+}  // namespace http
+
+/**
+ * @brief Отложенный ответ асинхронного обработчика.
+ *
+ * Создание объекта в обработчике откладывает отправку ответа: после возврата
+ * из обработчика поток цикла обработки событий освобождается для других
+ * запросов, а ответ формируется и отправляется вызовом Send, например из
+ * функции обратного вызова HttpClient. Если у запроса есть срок обработки,
+ * по его истечении клиенту отправляется ответ с кодом 504, если все копии
+ * объекта удалены без вызова Send - ответ с кодом 500.
+ *
+ * Пример:
+ * @code
+ * [&client](const http::Request &, http::Response &response)
+ * {
+ *     AsyncReply reply(response);
+ *     client.Send({http::Request::Method::Get, "/users"},
+ *                 [reply](HttpClient::Result &&result) mutable
+ *                 {
+ *                     reply.Send(
+ *                         [&result](http::Response &response)
+ *                         {
+ *                             response.SetCode(
+ *                                 static_cast<http::Response::Code>(
+ *                                     result.status));
+ *                         });
+ *                 });
+ * }
+ * @endcode
+ *
+ * Объект можно копировать, но использовать только в потоке цикла обработки
+ * событий, в котором выполнялся обработчик. Запрос в функции формирования
+ * ответа не используется: к этому моменту подключение может быть закрыто.
+ * Недоступно для HTTP-сервера io_uring (service.backend = io_uring), запросов
+ * HTTP/2 и запросов пакета: ответ обработчика получает код 501, а Send
+ * игнорируется.
+ */
+class [[gnu::visibility("default")]] AsyncReply final
+{
+public:
+    /**
+     * @brief Функция формирования ответа.
+     */
+    using Filler = FunctionRef<void(http::Response &)>;
+
+    /**
+     * @brief Конструктор. Откладывает отправку ответа.
+     *
+     * @param response Ответ обработчика
+     */
+    explicit AsyncReply(http::Response &response) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~AsyncReply() noexcept;
+
+    AsyncReply(const AsyncReply &) noexcept;
+    AsyncReply(AsyncReply &&) noexcept;
+    AsyncReply &operator=(const AsyncReply &) noexcept;
+    AsyncReply &operator=(AsyncReply &&) noexcept;
+
+    /**
+     * @brief Запрос признака возможности отправить ответ: ответ отложен, ещё
+     * не отправлен (в том числе с кодом 504 по истечении срока) и
+     * подключение не закрыто.
+     *
+     * @return Признак возможности отправить ответ
+     */
+    [[nodiscard]] bool Valid() const noexcept;
+
+    /**
+     * @brief Формирование и отправка ответа. Повторные вызовы игнорируются.
+     *
+     * @param fill Функция формирования ответа
+     */
+    void Send(Filler fill) noexcept;
+
+    /**
+     * @brief Формирование и отправка ответа функциональным объектом.
+     *
+     * @param fill Функция формирования ответа
+     */
+    template<typename Functor,
+             typename = std::enable_if_t<
+                 !std::is_same_v<std::decay_t<Functor>, Filler>>>
+    void Send(Functor &&fill) noexcept
+    {
+        Send(Filler::Bind(fill));
+    }
+
+private:
+    /**
+     * @brief Обмен, которому принадлежит ответ.
+     */
+    std::shared_ptr<http::Exchange> exchange_;
+};
+
+}  // namespace tasp
+
+#endif  // TASP_ASYNC_REPLY_HPP_
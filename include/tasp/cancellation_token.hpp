@@ -0,0 +1,118 @@
+/**
+ * @file
+ * @brief Признак отмены обработки запроса.
+ */
+#ifndef TASP_CANCELLATION_TOKEN_HPP_
+#define TASP_CANCELLATION_TOKEN_HPP_
+
+#include <chrono>
+#include <memory>
+
+#include <tasp/http/request.hpp>
+
+namespace tasp
+{
+
+namespace http
+{
+class Deadline;
+}  // namespace http
+
+/**
+ * @brief Признак отмены обработки запроса.
+ *
+ * Обработка отменяется по истечении срока (параметр timeout обработчика,
+ * заголовки X-Request-Timeout и grpc-timeout) или при закрытии подключения
+ * клиентом. Длительные обработчики периодически проверяют признак и
+ * прекращают работу, результат которой клиенту уже не нужен. Ответ
+ * обработчика, превысившего срок, заменяется ответом с кодом 504.
+ *
+ * Пример:
+ * @code
+ * const CancellationToken token(request);
+ * for (const auto &item : items)
+ * {
+ *     if (token.Cancelled())
+ *     {
+ *         return;
+ *     }
+ *     Process(item);
+ * }
+ * @endcode
+ *
+ * Объект можно копировать и передавать в другие потоки.
+ */
+class [[gnu::visibility("default")]] CancellationToken final
+{
+public:
+    /**
+     * @brief Часы для отсчёта срока.
+     */
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Причина отмены.
+     */
+    enum class Reason
+    {
+        None,
+        Deadline,
+        ClientClosed
+    };
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param request Запрос
+     */
+    explicit CancellationToken(const http::Request &request) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~CancellationToken() noexcept;
+
+    CancellationToken(const CancellationToken &) noexcept;
+    CancellationToken(CancellationToken &&) noexcept;
+    CancellationToken &operator=(const CancellationToken &) noexcept;
+    CancellationToken &operator=(CancellationToken &&) noexcept;
+
+    /**
+     * @brief Запрос признака отмены.
+     *
+     * @return Признак отмены
+     */
+    [[nodiscard]] bool Cancelled() const noexcept;
+
+    /**
+     * @brief Запрос причины отмены.
+     *
+     * @return Причина отмены
+     */
+    [[nodiscard]] Reason GetReason() const noexcept;
+
+    /**
+     * @brief Запрос момента истечения срока.
+     *
+     * @return Момент истечения срока, Clock::time_point::max() без срока
+     */
+    [[nodiscard]] Clock::time_point Deadline() const noexcept;
+
+    /**
+     * @brief Запрос времени до истечения срока, например для ограничения
+     * времени запросов к другим сервисам.
+     *
+     * @return Оставшееся время, milliseconds::max() без срока
+     */
+    [[nodiscard]] std::chrono::milliseconds Remaining() const noexcept;
+
+private:
+    /**
+     * @brief Срок обработки запроса.
+     */
+    std::shared_ptr<const http::Deadline> deadline_;
+};
+
+}  // namespace tasp
+
+#endif  // TASP_CANCELLATION_TOKEN_HPP_
@@ -0,0 +1,120 @@
+/**
+ * @file
+ * @brief Поток событий Server-Sent Events.
+ */
+#ifndef TASP_EVENT_STREAM_HPP_
+#define TASP_EVENT_STREAM_HPP_
+
+#include <chrono>
+#include <memory>
+#include <string_view>
+
+namespace tasp
+{
+
+class EventStreamImpl;
+
+/**
+ * @brief Параметры потока событий.
+ */
+struct EventStreamOptions
+{
+    /**
+     * @brief Максимальный объём неотправленных данных подписчика в байтах,
+     * включая события, отложенные при превышении верхней границы записи
+     * подключения (service.client.output_high_watermark). Подписчик, не
+     * успевающий принимать события, отключается.
+     */
+    size_t max_buffer{256 * 1024};
+
+    /**
+     * @brief Максимальное количество подписчиков. Запросы сверх лимита
+     * отклоняются с кодом 503.
+     */
+    size_t max_subscribers{10000};
+
+    /**
+     * @brief Максимальное количество событий, ожидающих отправки в цикле
+     * обработки событий. При переполнении отбрасываются самые старые.
+     */
+    size_t max_queue{1024};
+
+    /**
+     * @brief Период отправки комментария для поддержания подключения и
+     * обнаружения отключившихся подписчиков.
+     */
+    std::chrono::seconds keepalive{15};
+};
+
+/**
+ * @brief Поток событий Server-Sent Events (text/event-stream).
+ *
+ * Создаётся методом MicroService::AddEventStream. Подписчики подключаются
+ * запросом GET на путь потока, подключение остаётся открытым, и события
+ * передаются частями ответа (chunked) в цикле обработки событий подключения.
+ * Опубликованное событие форматируется один раз и рассылается всем
+ * подписчикам без копирования.
+ *
+ * Пример:
+ * @code
+ * auto items{service.AddEventStream("/items/events")};
+ * ...
+ * items.Publish("update", R"({"id":1})");
+ * @endcode
+ *
+ * Методы Publish можно вызывать из любого потока. Недоступно для
+ * HTTP-сервера io_uring (service.backend = io_uring).
+ */
+class [[gnu::visibility("default")]] EventStream final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param impl Реализация потока событий
+     */
+    explicit EventStream(std::shared_ptr<EventStreamImpl> impl) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~EventStream() noexcept;
+
+    EventStream(const EventStream &) noexcept;
+    EventStream(EventStream &&) noexcept;
+    EventStream &operator=(const EventStream &) noexcept;
+    EventStream &operator=(EventStream &&) noexcept;
+
+    /**
+     * @brief Публикация события без типа (обрабатывается onmessage).
+     *
+     * @param data Данные события
+     */
+    void Publish(std::string_view data) const noexcept;
+
+    /**
+     * @brief Публикация события.
+     *
+     * @param event Тип события
+     * @param data Данные события. Многострочные данные передаются
+     * несколькими полями data.
+     */
+    void Publish(std::string_view event, std::string_view data) const noexcept;
+
+    /**
+     * @brief Запрос количества подписчиков.
+     *
+     * @return Количество подписчиков
+     */
+    [[nodiscard]] size_t Subscribers() const noexcept;
+
+private:
+    /**
+     * @brief Реализация потока событий.
+     */
+    std::shared_ptr<EventStreamImpl> impl_;
+};
+
+}  // namespace tasp
+
+#endif  // TASP_EVENT_STREAM_HPP_
@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @brief Невладеющая ссылка на вызываемый объект.
+ */
+#ifndef TASP_FUNCTION_REF_HPP_
+#define TASP_FUNCTION_REF_HPP_
+
+#include <type_traits>
+#include <utility>
+
+namespace tasp
+{
+
+template<typename Signature>
+class FunctionRef;
+
+/**
+ * @brief Невладеющая ссылка на вызываемый объект.
+ *
+ * В отличие от std::function не выделяет память и не копирует объект: хранит
+ * указатель на объект и указатель на статическую функцию-переходник,
+ * сформированную при компиляции. Функция члена класса, переданная параметром
+ * шаблона, встраивается в переходник, поэтому вызов обходится одним косвенным
+ * переходом.
+ *
+ * Объект, на который ссылается FunctionRef, должен существовать всё время
+ * использования ссылки.
+ *
+ * Пример:
+ * @code
+ * auto ref{FunctionRef<void(int)>::Bind<&Service::Process>(this)};
+ * ref(42);
+ * @endcode
+ */
+template<typename Result, typename... Args>
+class FunctionRef<Result(Args...)> final
+{
+public:
+    /**
+     * @brief Конструктор пустой ссылки.
+     */
+    constexpr FunctionRef() noexcept = default;
+
+    /**
+     * @brief Привязка функции члена класса.
+     *
+     * @tparam Method Функция члена класса
+     * @param object Объект класса
+     *
+     * @return Ссылка
+     */
+    template<auto Method, typename Class>
+    [[nodiscard]] static FunctionRef Bind(Class *object) noexcept
+    {
+        return FunctionRef{
+            const_cast<void *>(static_cast<const void *>(object)),  // NOLINT
+            [](void *self, Args... args) -> Result
+            {
+                return (static_cast<Class *>(self)->*Method)(
+                    std::forward<Args>(args)...);
+            }};
+    }
+
+    /**
+     * @brief Привязка свободной или статической функции.
+     *
+     * @tparam Func Функция
+     *
+     * @return Ссылка
+     */
+    template<auto Func>
+    [[nodiscard]] static FunctionRef Bind() noexcept
+    {
+        return FunctionRef{nullptr,
+                           []([[maybe_unused]] void *self,
+                              Args... args) -> Result
+                           {
+                               return Func(std::forward<Args>(args)...);
+                           }};
+    }
+
+    /**
+     * @brief Привязка существующего вызываемого объекта (лямбды,
+     * std::function и т.п.) без копирования.
+     *
+     * @param functor Вызываемый объект
+     *
+     * @return Ссылка
+     */
+    template<typename Functor,
+             typename = std::enable_if_t<
+                 !std::is_same_v<std::decay_t<Functor>, FunctionRef>>>
+    [[nodiscard]] static FunctionRef Bind(Functor &functor) noexcept
+    {
+        return FunctionRef{
+            const_cast<void *>(static_cast<const void *>(&functor)),  // NOLINT
+            [](void *self, Args... args) -> Result
+            {
+                return (*static_cast<Functor *>(self))(
+                    std::forward<Args>(args)...);
+            }};
+    }
+
+    /**
+     * @brief Вызов функции.
+     *
+     * @param args Аргументы
+     *
+     * @return Результат вызова
+     */
+    Result operator()(Args... args) const
+    {
+        return thunk_(object_, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Проверка наличия привязанной функции.
+     */
+    explicit operator bool() const noexcept
+    {
+        return thunk_ != nullptr;
+    }
+
+private:
+    /**
+     * @brief Формат функции-переходника.
+     */
+    using Thunk = Result (*)(void *, Args...);
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param object Указатель на объект
+     * @param thunk Функция-переходник
+     */
+    constexpr FunctionRef(void *object, Thunk thunk) noexcept
+    : object_(object)
+    , thunk_(thunk)
+    {
+    }
+
+    /**
+     * @brief Указатель на объект.
+     */
+    void *object_{nullptr};
+
+    /**
+     * @brief Функция-переходник.
+     */
+    Thunk thunk_{nullptr};
+};
+
+}  // namespace tasp
+
+#endif  // TASP_FUNCTION_REF_HPP_
@@ -0,0 +1,252 @@
+/**
+ * @file
+ * @brief Асинхронный HTTP-клиент для запросов к другим сервисам.
+ */
+#ifndef TASP_HTTP_CLIENT_HPP_
+#define TASP_HTTP_CLIENT_HPP_
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <tasp/http/request.hpp>
+
+namespace tasp
+{
+
+class HttpClientImpl;
+
+/**
+ * @brief Асинхронный HTTP-клиент для запросов к другим сервисам.
+ *
+ * Запросы выполняются в цикле обработки событий подключения HTTP-сервера,
+ * в потоке которого вызван Send, и не блокируют его. Для каждого цикла
+ * поддерживается собственный пул постоянных подключений (keep-alive) к
+ * сервису. Функция обратного вызова выполняется в том же потоке, поэтому
+ * асинхронный обработчик может сформировать в ней отложенный ответ
+ * (AsyncReply).
+ *
+ * Пример:
+ * @code
+ * HttpClient users("http://users:8080/api/v1");
+ *
+ * service.AddHandler(
+ *     http::Request::Method::Get,
+ *     "/profile",
+ *     [&users](const http::Request &request, http::Response &response)
+ *     {
+ *         HttpClient::Call call{http::Request::Method::Get, "/users/1"};
+ *         call.deadline = CancellationToken(request).Deadline();
+ *
+ *         users.Send(std::move(call),
+ *                    [reply = AsyncReply(response)](
+ *                        HttpClient::Result &&result) mutable
+ *                    {
+ *                        reply.Send([&result](http::Response &response)
+ *                                   { ... });
+ *                    });
+ *     });
+ * @endcode
+ *
+ * Вызов Send вне потоков подключений HTTP-сервера (в том числе для
+ * HTTP-сервера io_uring) завершается ошибкой. Пулы подключений удаляются при
+ * завершении циклов обработки событий, незавершённые запросы при этом
+ * отменяются без вызова функций обратного вызова.
+ */
+class [[gnu::visibility("default")]] HttpClient final
+{
+public:
+    /**
+     * @brief Часы для отсчёта сроков.
+     */
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Заголовки запроса или ответа.
+     */
+    using Headers = std::vector<std::pair<std::string, std::string>>;
+
+    /**
+     * @brief Параметры клиента.
+     */
+    struct Options
+    {
+        /**
+         * @brief Максимальное количество подключений к сервису в одном цикле
+         * обработки событий.
+         */
+        size_t max_connections{8};
+
+        /**
+         * @brief Максимальное количество запросов, одновременно назначенных
+         * одному подключению. Запросы подключения передаются
+         * последовательно: следующий отправляется после получения ответа на
+         * предыдущий.
+         */
+        size_t max_requests_per_connection{1};
+
+        /**
+         * @brief Максимальное количество запросов, ожидающих свободного
+         * подключения. Запросы сверх лимита завершаются ошибкой.
+         */
+        size_t max_pending{1024};
+
+        /**
+         * @brief Время ожидания ответа на одну попытку.
+         */
+        std::chrono::milliseconds timeout{5000};
+
+        /**
+         * @brief Количество повторов идемпотентных запросов (GET, HEAD, PUT,
+         * DELETE, OPTIONS) при ошибке подключения, превышении времени
+         * ожидания и кодах ответа 502, 503, 504.
+         */
+        size_t retries{2};
+
+        /**
+         * @brief Начальная задержка перед повтором. Задержка удваивается с
+         * каждой попыткой и выбирается случайно из второй половины
+         * интервала.
+         */
+        std::chrono::milliseconds backoff{50};
+
+        /**
+         * @brief Максимальная задержка перед повтором.
+         */
+        std::chrono::milliseconds max_backoff{1000};
+    };
+
+    /**
+     * @brief Параметры запроса.
+     */
+    struct Call
+    {
+        /**
+         * @brief Метод.
+         */
+        http::Request::Method method{http::Request::Method::Get};
+
+        /**
+         * @brief Путь запроса относительно адреса сервиса, с параметрами.
+         */
+        std::string path;
+
+        /**
+         * @brief Тело запроса.
+         */
+        std::string body;
+
+        /**
+         * @brief Тип данных тела запроса.
+         */
+        std::string content_type{"application/json"};
+
+        /**
+         * @brief Дополнительные заголовки.
+         */
+        Headers headers;
+
+        /**
+         * @brief Время ожидания ответа на одну попытку. Нулевое значение -
+         * из параметров клиента.
+         */
+        std::chrono::milliseconds timeout{0};
+
+        /**
+         * @brief Срок выполнения запроса со всеми повторами, например срок
+         * обработки входящего запроса (CancellationToken::Deadline).
+         * Оставшееся время передаётся сервису в заголовке X-Request-Timeout.
+         */
+        Clock::time_point deadline{Clock::time_point::max()};
+    };
+
+    /**
+     * @brief Результат запроса.
+     */
+    struct Result
+    {
+        /**
+         * @brief Код ответа, 0 - ответ не получен.
+         */
+        int status{0};
+
+        /**
+         * @brief Тело ответа.
+         */
+        std::string body;
+
+        /**
+         * @brief Заголовки ответа.
+         */
+        Headers headers;
+
+        /**
+         * @brief Описание ошибки, если ответ не получен.
+         */
+        std::string error;
+
+        /**
+         * @brief Количество выполненных попыток.
+         */
+        size_t attempts{0};
+
+        /**
+         * @brief Запрос признака успешного ответа (код 2xx).
+         *
+         * @return Признак успешного ответа
+         */
+        [[nodiscard]] bool Ok() const noexcept;
+    };
+
+    /**
+     * @brief Функция обратного вызова с результатом запроса.
+     */
+    using Callback = std::function<void(Result &&)>;
+
+    /**
+     * @brief Конструктор с параметрами по умолчанию.
+     *
+     * @param url Адрес сервиса вида http://узел:порт/префикс
+     */
+    explicit HttpClient(std::string_view url) noexcept;
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param url Адрес сервиса вида http://узел:порт/префикс
+     * @param options Параметры клиента
+     */
+    HttpClient(std::string_view url, const Options &options) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~HttpClient() noexcept;
+
+    /**
+     * @brief Отправка запроса.
+     *
+     * @param call Параметры запроса
+     * @param callback Функция обратного вызова с результатом
+     */
+    void Send(Call call, Callback callback) const noexcept;
+
+    HttpClient(const HttpClient &) = delete;
+    HttpClient(HttpClient &&) = delete;
+    HttpClient &operator=(const HttpClient &) = delete;
+    HttpClient &operator=(HttpClient &&) = delete;
+
+private:
+    /**
+     * @brief Реализация клиента.
+     */
+    std::unique_ptr<HttpClientImpl> impl_;
+};
+
+}  // namespace tasp
+
+#endif  // TASP_HTTP_CLIENT_HPP_
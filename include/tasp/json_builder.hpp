@@ -0,0 +1,224 @@
+/**
+ * @file
+ * @brief Последовательное формирование ответа в формате JSON.
+ */
+#ifndef TASP_JSON_BUILDER_HPP_
+#define TASP_JSON_BUILDER_HPP_
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <jsoncpp/json/json.h>
+
+#include <tasp/http/response.hpp>
+
+struct evbuffer;
+
+namespace tasp
+{
+
+/**
+ * @brief Формирование тела ответа в формате JSON без построения дерева
+ * Json::Value.
+ *
+ * Данные записываются непосредственно в буфер ответа по мере вызова методов.
+ * После создания объекта данные ответа (Response::Data) не отправляются.
+ *
+ * Пример:
+ * @code
+ * JsonBuilder json(response);
+ * json.BeginObject().Key("items").BeginArray();
+ * for (const auto &item : items)
+ * {
+ *     json.BeginObject().Key("id").Value(item.id).EndObject();
+ * }
+ * json.EndArray().EndObject();
+ * @endcode
+ */
+class [[gnu::visibility("default")]] JsonBuilder final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param response Ответ, в тело которого выполняется запись
+     */
+    explicit JsonBuilder(http::Response &response) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~JsonBuilder() noexcept;
+
+    /**
+     * @brief Начало объекта.
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &BeginObject() noexcept;
+
+    /**
+     * @brief Завершение объекта.
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &EndObject() noexcept;
+
+    /**
+     * @brief Начало массива.
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &BeginArray() noexcept;
+
+    /**
+     * @brief Завершение массива.
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &EndArray() noexcept;
+
+    /**
+     * @brief Запись ключа объекта.
+     *
+     * @param key Ключ
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &Key(std::string_view key) noexcept;
+
+    /**
+     * @brief Запись строкового значения.
+     *
+     * @param value Значение
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &Value(std::string_view value) noexcept;
+
+    /**
+     * @brief Запись строкового значения.
+     *
+     * @param value Значение
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &Value(const char *value) noexcept;
+
+    /**
+     * @brief Запись логического значения.
+     *
+     * @param value Значение
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &Value(bool value) noexcept;
+
+    /**
+     * @brief Запись целочисленного значения.
+     *
+     * @param value Значение
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &Value(int64_t value) noexcept;
+
+    /**
+     * @brief Запись беззнакового целочисленного значения.
+     *
+     * @param value Значение
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &Value(uint64_t value) noexcept;
+
+    /**
+     * @brief Запись целочисленного значения.
+     *
+     * @param value Значение
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &Value(int value) noexcept;
+
+    /**
+     * @brief Запись вещественного значения. Бесконечность и NaN
+     * записываются как null.
+     *
+     * @param value Значение
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &Value(double value) noexcept;
+
+    /**
+     * @brief Запись готового значения Json::Value.
+     *
+     * @param value Значение
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &Value(const Json::Value &value) noexcept;
+
+    /**
+     * @brief Запись значения, уже сериализованного в формате JSON. Значение
+     * записывается без проверки.
+     *
+     * @param json Значение в формате JSON
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &Raw(std::string_view json) noexcept;
+
+    /**
+     * @brief Запись значения null.
+     *
+     * @return Ссылка на себя
+     */
+    JsonBuilder &Null() noexcept;
+
+    JsonBuilder(const JsonBuilder &) = delete;
+    JsonBuilder(JsonBuilder &&) = delete;
+    JsonBuilder &operator=(const JsonBuilder &) = delete;
+    JsonBuilder &operator=(JsonBuilder &&) = delete;
+
+private:
+    /**
+     * @brief Запись разделителя перед очередным значением.
+     */
+    void Separate() noexcept;
+
+    /**
+     * @brief Запись данных в буфер.
+     *
+     * @param data Данные
+     */
+    void Append(std::string_view data) noexcept;
+
+    /**
+     * @brief Запись строки в кавычках с экранированием.
+     *
+     * @param str Строка
+     */
+    void AppendString(std::string_view str) noexcept;
+
+    /**
+     * @brief Буфер тела ответа.
+     */
+    evbuffer *buffer_{nullptr};
+
+    /**
+     * @brief Признаки наличия значений в открытых объектах и массивах.
+     */
+    std::vector<bool> not_empty_;
+
+    /**
+     * @brief Признак того, что перед значением записан ключ.
+     */
+    bool after_key_{false};
+};
+
+}  // namespace tasp
+
+#endif  // TASP_JSON_BUILDER_HPP_
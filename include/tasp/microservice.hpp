@@ -5,11 +5,15 @@
 #ifndef TASP_MICROSERVICE_HPP_
 #define TASP_MICROSERVICE_HPP_
 
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <string>
 #include <string_view>
 #include <vector>
 
+#include <tasp/event_stream.hpp>
+#include <tasp/function_ref.hpp>
 #include <tasp/health.hpp>
 #include <tasp/http/request.hpp>
 #include <tasp/http/response.hpp>
@@ -24,11 +28,85 @@ class MicroServiceImpl;
  */
 using Handler = std::function<void(const http::Request &, http::Response &)>;
 
+/**
+ * @brief Невладеющая ссылка на обработчик запросов, привязанный при
+ * компиляции.
+ */
+using HandlerRef = FunctionRef<void(const http::Request &, http::Response &)>;
+
 /**
  * @brief Формат функции проверки состояния компонента микросервиса.
  */
 using CheckFunction = std::function<HealthReport()>;
 
+/**
+ * @brief Параметры обработчика запроса.
+ */
+struct HandlerOptions
+{
+    /**
+     * @brief Параметры кэширования ответов обработчика.
+     *
+     * Кэшируются только ответы с кодом 200. Ключ кэша формируется из метода,
+     * полного URL запроса и значений заголовков из списка vary.
+     */
+    struct Cache
+    {
+        /**
+         * @brief Время жизни записи. Нулевое значение отключает кэширование.
+         */
+        std::chrono::milliseconds ttl{0};
+
+        /**
+         * @brief Максимальное количество записей.
+         */
+        size_t max_entries{1024};
+
+        /**
+         * @brief Максимальный суммарный размер тел ответов в байтах.
+         */
+        size_t max_size{16 * 1024 * 1024};
+
+        /**
+         * @brief Заголовки запроса, входящие в ключ кэша.
+         */
+        std::vector<std::string> vary;
+
+        /**
+         * @brief Максимальное время ожидания ответа, который по тому же
+         * ключу формирует другой запрос. По истечении обработчик вызывается
+         * без ожидания.
+         */
+        std::chrono::milliseconds wait{100};
+    };
+
+    /**
+     * @brief Кэширование ответов.
+     */
+    Cache cache;
+
+    /**
+     * @brief Формирование заголовка ETag для ответов с кодом 200 и ответ
+     * кодом 304 без данных, если значение совпадает с If-None-Match.
+     */
+    bool etag{false};
+
+    /**
+     * @brief Отложенный разбор данных запроса. Данные передаются обработчику в
+     * текстовом виде и разбираются только при обращении к ним. Подходит для
+     * обработчиков, которым данные нужны не всегда.
+     */
+    bool lazy_body{false};
+
+    /**
+     * @brief Срок обработки запроса. Нулевое значение - срок задаётся только
+     * заголовками запроса X-Request-Timeout и grpc-timeout. При истечении
+     * срока признак отмены (CancellationToken) переключается, а ответ
+     * заменяется ответом с кодом 504.
+     */
+    std::chrono::milliseconds timeout{0};
+};
+
 /**
  * @brief Интерфейс основного класса микросервиса.
  *
@@ -70,6 +148,63 @@ public:
                     std::string_view path,
                     const Handler &func) const noexcept;
 
+    /**
+     * @brief Установка обработчика запроса с параметрами.
+     *
+     * @param method Метод
+     * @param path Путь запроса
+     * @param func Обработчик
+     * @param options Параметры обработчика
+     */
+    void AddHandler(http::Request::Method method,
+                    std::string_view path,
+                    const Handler &func,
+                    const HandlerOptions &options) const noexcept;
+
+    /**
+     * @brief Установка обработчика запроса в виде невладеющей ссылки.
+     *
+     * Объект, на который ссылается обработчик, должен существовать всё время
+     * работы микросервиса.
+     *
+     * @param method Метод
+     * @param path Путь запроса
+     * @param func Обработчик
+     * @param options Параметры обработчика
+     */
+    void AddHandler(http::Request::Method method,
+                    std::string_view path,
+                    HandlerRef func,
+                    const HandlerOptions &options = {}) const noexcept;
+
+    /**
+     * @brief Установка обработчика запроса в виде функции члена класса,
+     * привязанной при компиляции.
+     *
+     * В отличие от перегрузки с указателем на функцию члена класса не
+     * использует std::bind и std::function: вызов функции встраивается в
+     * переходник, и обработка запроса обходится одним косвенным вызовом.
+     *
+     * Пример:
+     * @code
+     * service.AddHandler<&Service::GetItems>(Method::Get, "/items", this);
+     * @endcode
+     *
+     * @tparam Func Обработчик
+     * @param method Метод
+     * @param path Путь запроса
+     * @param object Объект класса
+     * @param options Параметры обработчика
+     */
+    template<auto Func, typename Name>
+    void AddHandler(http::Request::Method method,
+                    std::string_view path,
+                    Name *const object,
+                    const HandlerOptions &options = {}) const noexcept
+    {
+        AddHandler(method, path, HandlerRef::Bind<Func>(object), options);
+    }
+
     /**
      * @brief Установка обработчика запроса в виде функции члена класса.
      *
@@ -93,6 +228,48 @@ public:
                 func, object, std::placeholders::_1, std::placeholders::_2));
     }
 
+    /**
+     * @brief Установка обработчика запроса в виде функции члена класса с
+     * параметрами.
+     *
+     * @param method Метод
+     * @param path Путь запроса
+     * @param object Объект класса
+     * @param func Обработчик
+     * @param options Параметры обработчика
+     */
+    template<typename Name>
+    void AddHandler(http::Request::Method method,
+                    std::string_view path,
+                    Name *const object,
+                    void (Name::*const func)(const http::Request &,
+                                             http::Response &),
+                    const HandlerOptions &options) const noexcept
+    {
+        AddHandler(
+            method,
+            path,
+            // NOLINTNEXTLINE(modernize-avoid-bind)
+            std::bind(
+                func, object, std::placeholders::_1, std::placeholders::_2),
+            options);
+    }
+
+    /**
+     * @brief Создание потока событий Server-Sent Events.
+     *
+     * Устанавливает обработчик запроса GET на путь потока, подписывающий
+     * клиента на события. Возвращаемый объект используется для публикации.
+     *
+     * @param path Путь запроса подписки
+     * @param options Параметры потока событий
+     *
+     * @return Поток событий
+     */
+    [[nodiscard]] EventStream AddEventStream(
+        std::string_view path,
+        const EventStreamOptions &options = {}) const noexcept;
+
     MicroService(const MicroService &) = delete;
     MicroService(MicroService &&) = delete;
     MicroService &operator=(const MicroService &) = delete;
@@ -0,0 +1,150 @@
+/**
+ * @file
+ * @brief Параметризованное SQL-условие по параметрам filter запроса.
+ */
+#ifndef TASP_SQL_CONDITION_HPP_
+#define TASP_SQL_CONDITION_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <tasp/http/request.hpp>
+
+namespace tasp
+{
+
+/**
+ * @brief Параметризованное SQL-условие по параметрам filter запроса.
+ *
+ * В отличие от Uri::ToSQLCondition значения не встраиваются в текст условия,
+ * а передаются отдельным списком параметров, поэтому текст одинаков для
+ * запросов с одинаковым набором полей и операций и база данных может
+ * повторно использовать план подготовленного запроса. Тексты условий
+ * кэшируются по набору полей и операций.
+ *
+ * Параметр filter имеет вид поле:операция:значение. Поддерживаемые операции:
+ * eq (=), ne (<>), gt (>), ge (>=), lt (<), le (<=), like, ilike и in
+ * (значения через запятую). Поле - имя столбца, возможно уточнённое именем
+ * таблицы (table.column); список допустимых полей ограничивает поля,
+ * доступные клиенту. Условия упорядочиваются по полю и операции и
+ * объединяются через AND.
+ *
+ * Пример:
+ * @code
+ * // ?filter=name:eq:first&filter=id:in:1,2,3
+ * const SqlCondition condition(request);
+ * if (!condition.Valid())
+ * {
+ *     response.SetError(http::Response::Code::BadRequest, condition.Error());
+ *     return;
+ * }
+ * // condition.Text(): "id IN ($1, $2, $3) AND name = $4"
+ * // condition.Params(): 1, 2, 3, "first"
+ *
+ * // ?filter=password:eq:x - некорректное условие
+ * const SqlCondition limited(request, {"id", "name"});
+ * @endcode
+ */
+class [[gnu::visibility("default")]] SqlCondition final
+{
+public:
+    /**
+     * @brief Значение параметра. Тип определяется по значению: целое число,
+     * вещественное число, true/false, иначе строка.
+     */
+    using Param = std::variant<std::string, int64_t, double, bool>;
+
+    /**
+     * @brief Вид обозначения параметров в тексте условия: $1, $2 (PostgreSQL)
+     * или ? (SQLite, MySQL, ODBC).
+     */
+    enum class Placeholder
+    {
+        Dollar,
+        Question
+    };
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param request Запрос
+     * @param placeholder Вид обозначения параметров
+     */
+    explicit SqlCondition(
+        const http::Request &request,
+        Placeholder placeholder = Placeholder::Dollar) noexcept;
+
+    /**
+     * @brief Конструктор с ограничением полей условия.
+     *
+     * @param request Запрос
+     * @param fields Допустимые поля. Условие по другому полю некорректно.
+     * @param placeholder Вид обозначения параметров
+     */
+    SqlCondition(const http::Request &request,
+                 const std::vector<std::string> &fields,
+                 Placeholder placeholder = Placeholder::Dollar) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~SqlCondition() noexcept;
+
+    SqlCondition(const SqlCondition &) noexcept;
+    SqlCondition(SqlCondition &&) noexcept;
+    SqlCondition &operator=(const SqlCondition &) noexcept;
+    SqlCondition &operator=(SqlCondition &&) noexcept;
+
+    /**
+     * @brief Запрос признака корректности параметров filter.
+     *
+     * @return Признак корректности
+     */
+    [[nodiscard]] bool Valid() const noexcept;
+
+    /**
+     * @brief Запрос описания ошибки разбора параметров filter.
+     *
+     * @return Описание ошибки
+     */
+    [[nodiscard]] const std::string &Error() const noexcept;
+
+    /**
+     * @brief Запрос текста условия (для конкатенации с WHERE). Пустая строка,
+     * если параметров filter нет или они некорректны.
+     *
+     * @return Текст условия, одинаковый для условий с одинаковым набором
+     * полей и операций
+     */
+    [[nodiscard]] const std::string &Text() const noexcept;
+
+    /**
+     * @brief Запрос значений параметров в порядке их обозначений в тексте.
+     *
+     * @return Значения параметров
+     */
+    [[nodiscard]] const std::vector<Param> &Params() const noexcept;
+
+private:
+    /**
+     * @brief Текст условия.
+     */
+    std::shared_ptr<const std::string> text_;
+
+    /**
+     * @brief Значения параметров.
+     */
+    std::vector<Param> params_;
+
+    /**
+     * @brief Описание ошибки.
+     */
+    std::string error_;
+};
+
+}  // namespace tasp
+
+#endif  // TASP_SQL_CONDITION_HPP_
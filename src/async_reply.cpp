@@ -0,0 +1,59 @@
+#include "tasp/async_reply.hpp"
+
+#include "http/exchange.hpp"
+#include "http/response_impl.hpp"
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    AsyncReply
+------------------------------------------------------------------------------*/
+AsyncReply::AsyncReply(http::Response &response) noexcept
+{
+    auto *impl{dynamic_cast<http::ResponseImpl *>(&response)};
+    if (impl == nullptr || impl->GetExchange() == nullptr)
+    {
+        // без обмена ответ обработчика отправляется сразу, поэтому он
+        // сообщает об ошибке, а не передаётся пустым с кодом 200
+        response.SetError(
+            static_cast<http::Response::Code>(HTTP_NOTIMPLEMENTED),
+            "Отложенный ответ недоступен для данного HTTP-сервера");
+        return;
+    }
+
+    exchange_ = impl->GetExchange()->Defer();
+}
+
+//------------------------------------------------------------------------------
+AsyncReply::~AsyncReply() noexcept = default;
+
+//------------------------------------------------------------------------------
+AsyncReply::AsyncReply(const AsyncReply &) noexcept = default;
+
+//------------------------------------------------------------------------------
+AsyncReply::AsyncReply(AsyncReply &&) noexcept = default;
+
+//------------------------------------------------------------------------------
+AsyncReply &AsyncReply::operator=(const AsyncReply &) noexcept = default;
+
+//------------------------------------------------------------------------------
+AsyncReply &AsyncReply::operator=(AsyncReply &&) noexcept = default;
+
+//------------------------------------------------------------------------------
+bool AsyncReply::Valid() const noexcept
+{
+    return exchange_ != nullptr && !exchange_->Done();
+}
+
+//------------------------------------------------------------------------------
+void AsyncReply::Send(Filler fill) noexcept
+{
+    if (exchange_ == nullptr)
+    {
+        return;
+    }
+
+    exchange_->Complete(fill);
+}
+
+}  // namespace tasp
@@ -0,0 +1,412 @@
+#include "batch.hpp"
+
+#include <strings.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include <tasp/json_builder.hpp>
+#include <tasp/logging.hpp>
+
+#include "http/json_writer.hpp"
+#include "http/request_impl.hpp"
+#include "http/response_impl.hpp"
+#include "http/synthetic_request.hpp"
+
+using std::make_shared;
+using std::string;
+using std::string_view;
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+
+namespace tasp::ev
+{
+
+namespace
+{
+/**
+ * @brief Методы запросов пакета.
+ */
+constexpr std::array<std::pair<string_view, evhttp_cmd_type>, 7> methods{
+    {{"GET", EVHTTP_REQ_GET},
+     {"POST", EVHTTP_REQ_POST},
+     {"PUT", EVHTTP_REQ_PUT},
+     {"PATCH", EVHTTP_REQ_PATCH},
+     {"DELETE", EVHTTP_REQ_DELETE},
+     {"HEAD", EVHTTP_REQ_HEAD},
+     {"OPTIONS", EVHTTP_REQ_OPTIONS}}};
+
+/**
+ * @brief Заголовки запроса пакета, которые не передаются запросам пакета:
+ * они описывают тело, формат или срок пакета, а не отдельного запроса.
+ */
+constexpr std::array<const char *, 8> skipped_headers{{"Content-Length",
+                                                       "Content-Type",
+                                                       "Content-Encoding",
+                                                       "Transfer-Encoding",
+                                                       "Accept",
+                                                       "Accept-Encoding",
+                                                       "X-Request-Timeout",
+                                                       "grpc-timeout"}};
+
+/**
+ * @brief Умный указатель запроса библиотеки libevent.
+ */
+using EvRequest =
+    std::unique_ptr<evhttp_request, decltype(&evhttp_request_free)>;
+
+//------------------------------------------------------------------------------
+bool Skipped(const char *name) noexcept
+{
+    return std::any_of(skipped_headers.begin(),
+                       skipped_headers.end(),
+                       [name](const char *skipped)
+                       { return strcasecmp(name, skipped) == 0; });
+}
+
+//------------------------------------------------------------------------------
+string Error(string_view message) noexcept
+{
+    Json::Value root;
+    root["message"] = string{message};
+
+    const http::EvBuffer buffer{evbuffer_new(), evbuffer_free};
+    http::JsonWriter::Write(root, buffer.get());
+
+    string body(evbuffer_get_length(buffer.get()), '\0');
+    evbuffer_remove(buffer.get(), body.data(), body.size());
+    return body;
+}
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    Batch
+------------------------------------------------------------------------------*/
+Batch::Batch(const Settings &settings, string path, Dispatcher func) noexcept
+: settings_(settings)
+, path_(std::move(path))
+, func_(func)
+{
+    // поток цикла обработки событий выполняет запросы своего пакета
+    for (size_t i = 1; i < settings_.parallel; i++)
+    {
+        workers_.emplace_back(&Batch::Work, this);
+    }
+}
+
+//------------------------------------------------------------------------------
+Batch::~Batch() noexcept
+{
+    {
+        const std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+
+    for (auto &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+//------------------------------------------------------------------------------
+void Batch::Exec(const http::Request &request,
+                 http::Response &response) noexcept
+{
+    const auto *outer{dynamic_cast<const http::RequestImpl *>(&request)};
+    if (outer == nullptr)
+    {
+        response.SetError(http::Response::Code::InternalServerError,
+                          "Пакетная обработка недоступна для данного запроса");
+        return;
+    }
+
+    const auto items{request.Data()->Get<Json::Value>()};
+    if (!items.isArray())
+    {
+        response.SetError(http::Response::Code::BadRequest,
+                          "Тело пакета должно быть массивом запросов");
+        return;
+    }
+
+    const size_t count{items.size()};
+    if (count > settings_.max_requests)
+    {
+        response.SetError(
+            static_cast<http::Response::Code>(HTTP_ENTITYTOOLARGE),
+            "Превышено количество запросов в пакете");
+        return;
+    }
+
+    Logging::Debug("Пакет запросов: {}", count);
+
+    std::vector<Result> results(count);
+
+    if (workers_.empty() || count <= 1)
+    {
+        for (Json::ArrayIndex i = 0; i < count; i++)
+        {
+            Dispatch(*outer, items[i], results[i]);
+        }
+    }
+    else
+    {
+        auto job{make_shared<Job>()};
+        job->outer = outer;
+        job->items = &items;
+        job->results = &results;
+        job->count = static_cast<Json::ArrayIndex>(count);
+
+        {
+            const std::lock_guard lock(mutex_);
+            jobs_.push_back(job);
+        }
+        cv_.notify_all();
+
+        // поток цикла обрабатывает запросы наравне с общими потоками, поэтому
+        // пакет выполняется, даже если все общие потоки заняты
+        Run(*job);
+
+        std::unique_lock lock(mutex_);
+        job->finished.wait(lock,
+                           [&job]
+                           {
+                               return job->done == job->count;
+                           });
+        jobs_.erase(std::remove(jobs_.begin(), jobs_.end(), job), jobs_.end());
+    }
+
+    JsonBuilder json(response);
+    json.BeginArray();
+    for (const auto &result : results)
+    {
+        json.BeginObject().Key("status").Value(result.status);
+
+        json.Key("headers").BeginObject();
+        for (const auto &[name, value] : result.headers)
+        {
+            json.Key(name).Value(string_view{value});
+        }
+        json.EndObject();
+
+        // тело в формате JSON встраивается без повторного разбора
+        if (!result.body.empty())
+        {
+            json.Key("body");
+            if (result.type == http::JsonWriter::type)
+            {
+                json.Raw(result.body);
+            }
+            else
+            {
+                json.Value(string_view{result.body});
+            }
+        }
+
+        json.EndObject();
+    }
+    json.EndArray();
+}
+
+//------------------------------------------------------------------------------
+void Batch::Work() noexcept
+{
+    std::unique_lock lock(mutex_);
+    while (true)
+    {
+        cv_.wait(lock,
+                 [this]
+                 {
+                     return stop_ || !jobs_.empty();
+                 });
+        if (stop_)
+        {
+            return;
+        }
+
+        const auto job{jobs_.front()};
+        lock.unlock();
+
+        Run(*job);
+
+        // все запросы пакета распределены между потоками
+        lock.lock();
+        jobs_.erase(std::remove(jobs_.begin(), jobs_.end(), job), jobs_.end());
+    }
+}
+
+//------------------------------------------------------------------------------
+void Batch::Run(Job &job) noexcept
+{
+    for (auto i = job.next++; i < job.count; i = job.next++)
+    {
+        Dispatch(*job.outer, (*job.items)[i], (*job.results)[i]);
+
+        const std::lock_guard lock(mutex_);
+        if (++job.done == job.count)
+        {
+            job.finished.notify_all();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void Batch::Dispatch(const http::RequestImpl &outer,
+                     const Json::Value &item,
+                     Result &result) const noexcept
+{
+    const auto fail{[&result](int status, string_view message)
+                    {
+                        result.status = status;
+                        result.type = http::JsonWriter::type;
+                        result.body = Error(message);
+                        result.headers.emplace_back(
+                            "Content-Type", "application/json; charset=UTF-8");
+                    }};
+
+    if (!item.isObject() || !item["path"].isString())
+    {
+        fail(HTTP_BADREQUEST, "Не указан путь запроса пакета");
+        return;
+    }
+
+    // данные клиента проверяются до преобразования: jsoncpp выбрасывает
+    // исключение при несовпадении типа
+    const auto &headers{item["headers"]};
+    const bool valid_headers{
+        headers.isNull() ||
+        (headers.isObject() &&
+         std::all_of(headers.begin(),
+                     headers.end(),
+                     [](const Json::Value &value)
+                     { return value.isString(); }))};
+
+    if (!item.get("method", "GET").isString() || !valid_headers)
+    {
+        fail(HTTP_BADREQUEST, "Некорректное описание запроса пакета");
+        return;
+    }
+
+    const string path{item["path"].asString()};
+    const string method{item.get("method", "GET").asString()};
+
+    const auto *known{std::find_if(methods.begin(),
+                                   methods.end(),
+                                   [&method](const auto &entry)
+                                   { return entry.first == method; })};
+    if (known == methods.end())
+    {
+        fail(HTTP_NOTIMPLEMENTED, "Метод запроса пакета не поддерживается");
+        return;
+    }
+
+    string_view target{path};
+    target = target.substr(0, target.find('?'));
+    if (target.size() > 1 && target.back() == '/')
+    {
+        target.remove_suffix(1);
+    }
+
+    if (target.empty() || target[0] != '/' || target == path_)
+    {
+        fail(HTTP_BADREQUEST, "Некорректный путь запроса пакета");
+        return;
+    }
+
+    const EvRequest req{evhttp_request_new(nullptr, nullptr),
+                        evhttp_request_free};
+    if (!http::InitRequest(req.get(), known->second, path, 1, 1))
+    {
+        fail(HTTP_BADREQUEST, "Некорректный путь запроса пакета");
+        return;
+    }
+
+    // запрос пакета выполняется от имени клиента пакета
+    auto *input{evhttp_request_get_input_headers(req.get())};
+    const auto *outer_headers{evhttp_request_get_input_headers(outer.Native())};
+    for (const auto *header = outer_headers->tqh_first; header != nullptr;
+         header = header->next.tqe_next)
+    {
+        if (!Skipped(header->key))
+        {
+            evhttp_add_header(input, header->key, header->value);
+        }
+    }
+
+    for (const auto &name : headers.getMemberNames())
+    {
+        evhttp_remove_header(input, name.c_str());
+        evhttp_add_header(
+            input, name.c_str(), headers[name].asString().c_str());
+    }
+
+    // запрос пакета не может выполняться дольше самого пакета
+    const auto &deadline{*outer.GetDeadline()};
+    if (deadline.HasDeadline() &&
+        evhttp_find_header(input, "X-Request-Timeout") == nullptr)
+    {
+        const auto remaining{duration_cast<milliseconds>(
+            deadline.At() - http::Deadline::Clock::now())};
+        evhttp_add_header(
+            input,
+            "X-Request-Timeout",
+            std::to_string(std::max<int64_t>(remaining.count(), 0)).c_str());
+    }
+
+    const auto &body{item["body"]};
+    if (!body.isNull())
+    {
+        auto *buffer{evhttp_request_get_input_buffer(req.get())};
+        const bool text{body.isString()};
+        if (text)
+        {
+            const auto str{body.asString()};
+            evbuffer_add(buffer, str.data(), str.size());
+        }
+        else
+        {
+            http::JsonWriter::Write(body, buffer);
+        }
+
+        if (evhttp_find_header(input, "Content-Type") == nullptr)
+        {
+            evhttp_add_header(input,
+                              "Content-Type",
+                              text ? "text/plain" : "application/json");
+        }
+    }
+
+    http::RequestImpl request(req.get());
+    http::ResponseImpl response(req.get());
+
+    func_(request, response);
+
+    result.status = static_cast<int>(response.GetCode());
+    result.type = response.Type();
+
+    if (known->second != EVHTTP_REQ_HEAD)
+    {
+        result.body = response.Body();
+    }
+
+    if (!result.type.empty())
+    {
+        result.headers.emplace_back("Content-Type",
+                                    result.type + "; charset=UTF-8");
+    }
+
+    const auto *output{evhttp_request_get_output_headers(req.get())};
+    for (const auto *header = output->tqh_first; header != nullptr;
+         header = header->next.tqe_next)
+    {
+        // заголовки CORS относятся к ответу на пакет
+        if (strncasecmp(header->key, "Access-Control-", 15) != 0)
+        {
+            result.headers.emplace_back(header->key, header->value);
+        }
+    }
+}
+
+}  // namespace tasp::ev
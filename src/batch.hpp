@@ -0,0 +1,232 @@
+/**
+ * @file
+ * @brief Пакетная обработка запросов.
+ */
+#ifndef TASP_BATCH_HPP_
+#define TASP_BATCH_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <jsoncpp/json/json.h>
+
+#include "connection.hpp"
+
+namespace tasp::ev
+{
+
+/**
+ * @brief Пакетная обработка запросов.
+ *
+ * Тело пакета - массив запросов в формате JSON:
+ * @code
+ * [{"method": "GET", "path": "/api/items/1", "headers": {"Accept": "*"}},
+ *  {"method": "POST", "path": "/api/items", "body": {"name": "item"}}]
+ * @endcode
+ *
+ * Каждый запрос пакета формируется внутри сервиса без разбора HTTP и
+ * передаётся главному обработчику запросов, результаты возвращаются одним
+ * ответом - массивом объектов с полями status, headers и body в порядке
+ * запросов пакета.
+ *
+ * При параллельной обработке запросы пакета выполняются потоком цикла
+ * обработки событий и общими для всех пакетов потоками, количество которых не
+ * зависит от количества одновременно обрабатываемых пакетов.
+ */
+class Batch final
+{
+public:
+    /**
+     * @brief Параметры пакетной обработки.
+     */
+    struct Settings
+    {
+        /**
+         * @brief Признак включения пакетной обработки.
+         */
+        bool enabled{false};
+
+        /**
+         * @brief Максимальное количество запросов в пакете.
+         */
+        size_t max_requests{100};
+
+        /**
+         * @brief Количество потоков обработки запросов пакета: поток цикла
+         * обработки событий и parallel - 1 общих потоков. 1 -
+         * последовательная обработка в потоке цикла обработки событий.
+         */
+        size_t parallel{1};
+    };
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param settings Параметры пакетной обработки
+     * @param path Путь запроса пакета
+     * @param func Главный обработчик запросов
+     */
+    Batch(const Settings &settings,
+          std::string path,
+          Dispatcher func) noexcept;
+
+    /**
+     * @brief Деструктор. Останавливает общие потоки.
+     */
+    ~Batch() noexcept;
+
+    /**
+     * @brief Обработка пакета запросов.
+     *
+     * @param request Запрос пакета
+     * @param response Ответ
+     */
+    void Exec(const http::Request &request, http::Response &response) noexcept;
+
+    Batch(const Batch &) = delete;
+    Batch(Batch &&) = delete;
+    Batch &operator=(const Batch &) = delete;
+    Batch &operator=(Batch &&) = delete;
+
+private:
+    /**
+     * @brief Результат запроса пакета.
+     */
+    struct Result
+    {
+        /**
+         * @brief Код ответа.
+         */
+        int status{HTTP_OK};
+
+        /**
+         * @brief Тип данных ответа.
+         */
+        std::string type;
+
+        /**
+         * @brief Заголовки ответа.
+         */
+        std::vector<std::pair<std::string, std::string>> headers;
+
+        /**
+         * @brief Тело ответа.
+         */
+        std::string body;
+    };
+
+    /**
+     * @brief Пакет, запросы которого выполняются параллельно.
+     */
+    struct Job
+    {
+        /**
+         * @brief Запрос пакета.
+         */
+        const http::RequestImpl *outer;
+
+        /**
+         * @brief Описания запросов.
+         */
+        const Json::Value *items;
+
+        /**
+         * @brief Результаты запросов.
+         */
+        std::vector<Result> *results;
+
+        /**
+         * @brief Количество запросов.
+         */
+        Json::ArrayIndex count;
+
+        /**
+         * @brief Номер следующего невыполненного запроса.
+         */
+        std::atomic<Json::ArrayIndex> next{0};
+
+        /**
+         * @brief Количество выполненных запросов. Защищено mutex_.
+         */
+        Json::ArrayIndex done{0};
+
+        /**
+         * @brief Оповещение о выполнении всех запросов.
+         */
+        std::condition_variable finished;
+    };
+
+    /**
+     * @brief Функция общего потока.
+     */
+    void Work() noexcept;
+
+    /**
+     * @brief Выполнение запросов пакета, пока есть невыполненные.
+     *
+     * @param job Пакет
+     */
+    void Run(Job &job) noexcept;
+
+    /**
+     * @brief Выполнение запроса пакета.
+     *
+     * @param outer Запрос пакета
+     * @param item Описание запроса
+     * @param result Результат
+     */
+    void Dispatch(const http::RequestImpl &outer,
+                  const Json::Value &item,
+                  Result &result) const noexcept;
+
+    /**
+     * @brief Параметры пакетной обработки.
+     */
+    Settings settings_;
+
+    /**
+     * @brief Путь запроса пакета. Вложенные пакеты не допускаются.
+     */
+    std::string path_;
+
+    /**
+     * @brief Главный обработчик запросов.
+     */
+    Dispatcher func_;
+
+    /**
+     * @brief Синхронизация очереди пакетов.
+     */
+    std::mutex mutex_;
+
+    /**
+     * @brief Оповещение общих потоков о пакетах и остановке.
+     */
+    std::condition_variable cv_;
+
+    /**
+     * @brief Пакеты с невыполненными запросами.
+     */
+    std::deque<std::shared_ptr<Job>> jobs_;
+
+    /**
+     * @brief Признак остановки общих потоков.
+     */
+    bool stop_{false};
+
+    /**
+     * @brief Общие потоки обработки запросов пакетов.
+     */
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace tasp::ev
+
+#endif  // TASP_BATCH_HPP_
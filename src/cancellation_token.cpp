@@ -0,0 +1,93 @@
+#include "tasp/cancellation_token.hpp"
+
+#include <tasp/logging.hpp>
+
+#include "http/deadline.hpp"
+#include "http/request_impl.hpp"
+
+using std::chrono::milliseconds;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    CancellationToken
+------------------------------------------------------------------------------*/
+CancellationToken::CancellationToken(const http::Request &request) noexcept
+{
+    const auto *impl{dynamic_cast<const http::RequestImpl *>(&request)};
+    if (impl == nullptr)
+    {
+        Logging::Error("Признак отмены недоступен для данного запроса");
+        return;
+    }
+
+    deadline_ = impl->GetDeadline();
+}
+
+//------------------------------------------------------------------------------
+CancellationToken::~CancellationToken() noexcept = default;
+
+//------------------------------------------------------------------------------
+CancellationToken::CancellationToken(const CancellationToken &) noexcept =
+    default;
+
+//------------------------------------------------------------------------------
+CancellationToken::CancellationToken(CancellationToken &&) noexcept = default;
+
+//------------------------------------------------------------------------------
+CancellationToken &CancellationToken::operator=(
+    const CancellationToken &) noexcept = default;
+
+//------------------------------------------------------------------------------
+CancellationToken &CancellationToken::operator=(
+    CancellationToken &&) noexcept = default;
+
+//------------------------------------------------------------------------------
+bool CancellationToken::Cancelled() const noexcept
+{
+    return GetReason() != Reason::None;
+}
+
+//------------------------------------------------------------------------------
+CancellationToken::Reason CancellationToken::GetReason() const noexcept
+{
+    if (!deadline_)
+    {
+        return Reason::None;
+    }
+
+    if (deadline_->Expired())
+    {
+        return Reason::Deadline;
+    }
+
+    if (deadline_->ClientClosed())
+    {
+        return Reason::ClientClosed;
+    }
+
+    return Reason::None;
+}
+
+//------------------------------------------------------------------------------
+CancellationToken::Clock::time_point CancellationToken::Deadline()
+    const noexcept
+{
+    return deadline_ ? deadline_->At() : Clock::time_point::max();
+}
+
+//------------------------------------------------------------------------------
+milliseconds CancellationToken::Remaining() const noexcept
+{
+    if (!deadline_ || !deadline_->HasDeadline())
+    {
+        return milliseconds::max();
+    }
+
+    const auto remaining{
+        std::chrono::duration_cast<milliseconds>(deadline_->At() -
+                                                 Clock::now())};
+    return remaining.count() > 0 ? remaining : milliseconds(0);
+}
+
+}  // namespace tasp
@@ -1,28 +1,82 @@
 #include "connection.hpp"
 
+#include <event2/listener.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+
 #include <tasp/logging.hpp>
 
+#include "http/exchange.hpp"
+#include "http/memory_budget.hpp"
 #include "http/request_impl.hpp"
 #include "http/response_impl.hpp"
+#include "http/trace.hpp"
+#include "listen_socket.hpp"
+#include "response_cache.hpp"
 
+using std::make_shared;
 using std::make_unique;
+using std::shared_ptr;
 using std::string;
 using std::string_view;
 using std::thread;
 
+using tasp::http::MemoryBudget;
 using tasp::http::RequestImpl;
 using tasp::http::ResponseImpl;
+using tasp::http::Trace;
 
 namespace tasp::ev
 {
+
+namespace
+{
+/**
+ * @brief Код ответа при истечении срока обработки запроса (в libevent
+ * отсутствует).
+ */
+constexpr int gateway_timeout{504};
+
+/**
+ * @brief Цикл обработки событий текущего потока.
+ */
+thread_local event_base *current_base{nullptr};
+
+//------------------------------------------------------------------------------
+void SetNoDelay(evutil_socket_t socket) noexcept
+{
+    // буфер TLS передаёт заголовки и тело ответа отдельными записями TLS,
+    // вторая запись не должна ожидать подтверждения первой (алгоритм
+    // Нейгла); принятые подключения наследуют параметр прослушивающего
+    // сокета
+    const int enable{1};
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+}
+
+}  // namespace
+
 /*------------------------------------------------------------------------------
     Connection
 ------------------------------------------------------------------------------*/
 Connection::Connection(string_view address,
                        uint16_t port,
-                       const Handler &func) noexcept
-: Connection(func)
+                       const ConnectionOptions &options,
+                       Dispatcher func) noexcept
+: Connection(options, func)
 {
+    if (address.substr(0, unix_prefix.size()) == unix_prefix)
+    {
+        BindUnix(address.substr(unix_prefix.size()), options.unix_mode);
+        return;
+    }
+
     auto *info =
         evhttp_bind_socket_with_handle(server_.get(), address.data(), port);
     if (info == nullptr)
@@ -31,23 +85,44 @@ Connection::Connection(string_view address,
         return;
     }
 
+    accept_ = info;
     socket_ = evhttp_bound_socket_get_fd(info);
+
+    if (options.tls != nullptr)
+    {
+        SetNoDelay(socket_);
+    }
 }
 
 //------------------------------------------------------------------------------
-Connection::Connection(evutil_socket_t socket, const Handler &func) noexcept
-: Connection(func)
+Connection::Connection(evutil_socket_t socket,
+                       const ConnectionOptions &options,
+                       Dispatcher func) noexcept
+: Connection(options, func)
 {
-    const int res{evhttp_accept_socket(server_.get(), socket)};
-    if (res != 0)
+    // приёмник закрывает сокет при удалении, копия дескриптора позволяет
+    // удалить лишнее подключение, не закрывая общий сокет
+    socket_ = fcntl(socket, F_DUPFD_CLOEXEC, 0);
+    accept_ = socket_ < 0
+                  ? nullptr
+                  : evhttp_accept_socket_with_handle(server_.get(), socket_);
+    if (accept_ == nullptr)
     {
         Logging::Error("Ошибка привязки HTTP-сервера с сокетом");
     }
+
+    if (options.tls != nullptr)
+    {
+        SetNoDelay(socket_);
+    }
 }
 
 //------------------------------------------------------------------------------
-Connection::Connection(Handler func) noexcept
-: func_(std::move(func))
+Connection::Connection(const ConnectionOptions &options,
+                       Dispatcher func) noexcept
+: watchdog_(options.watchdog)
+, max_body_size_(options.max_body_size)
+, func_(func)
 {
     const int flags{EVENT_BASE_FLAG_EPOLL_USE_CHANGELIST |
                     EVENT_BASE_FLAG_NO_CACHE_TIME | EVENT_BASE_FLAG_IGNORE_ENV};
@@ -61,28 +136,151 @@ Connection::Connection(Handler func) noexcept
     const uint16_t all_methods{511};
     evhttp_set_allowed_methods(server_.get(), all_methods);
 
+    evhttp_set_max_body_size(server_.get(),
+                             static_cast<ev_ssize_t>(options.max_body_size));
+
     evhttp_set_gencb(server_.get(), &Connection::Request, this);
 
-    auto *event{event_new(
-        event_.get(), -1, EV_PERSIST, [](int, int16_t, void *) {}, nullptr)};
+    // буферы подключений создаются цепочкой: защита от медленных клиентов,
+    // приём HTTP/2, TLS
+    http::ClientLimits::BufferFactory factory{nullptr};
+    void *factory_arg{nullptr};
+    if (options.tls != nullptr)
+    {
+        factory = &http::Tls::CreateBuffer;
+        factory_arg = options.tls;
+    }
+
+    if (options.http2.enabled)
+    {
+        http2_ = make_unique<http2::Server>(
+            options.http2,
+            options.max_body_size,
+            Dispatcher::Bind<&Connection::Serve>(this));
+        http2_->SetFactory(factory, factory_arg);
+        factory = &http2::Server::CreateBuffer;
+        factory_arg = http2_.get();
+    }
+
+    if (options.client_limits.enabled)
+    {
+        limits_ = make_unique<http::ClientLimits>(options.client_limits,
+                                                  event_.get());
+        limits_->Install(server_.get(), factory, factory_arg);
+    }
+    else if (factory != nullptr)
+    {
+        evhttp_set_bevcb(server_.get(), factory, factory_arg);
+    }
+
+    monitor_ = make_unique<LoopMonitor>(options.id,
+                                        event_.get(),
+                                        options.probe_interval,
+                                        options.report_interval);
+
+    if (watchdog_ != nullptr)
+    {
+        slot_ = watchdog_->Register();
+    }
+
+    accepting_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    accepting_event_ = EvEvent(event_new(event_.get(),
+                                         accepting_fd_,
+                                         EV_READ | EV_PERSIST,
+                                         &Connection::OnAccepting,
+                                         this),
+                               event_free);
+    event_add(accepting_event_.get(), nullptr);
+
+    drain_event_ = EvEvent(event_new(event_.get(),
+                                     -1,
+                                     EV_PERSIST,
+                                     &Connection::OnDrain,
+                                     this),
+                           event_free);
+
+    const auto drain_usec{
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            options.probe_interval)
+            .count()};
+    drain_interval_ = {drain_usec / 1000000, drain_usec % 1000000};
+
+    // новые подключения получают ограничение по текущему остатку бюджета
+    if (MemoryBudget::Limit() > 0)
+    {
+        budget_event_ = EvEvent(event_new(event_.get(),
+                                          -1,
+                                          EV_PERSIST,
+                                          &Connection::OnBudget,
+                                          this),
+                                event_free);
+
+        const auto usec{std::chrono::duration_cast<std::chrono::microseconds>(
+                            options.probe_interval)
+                            .count()};
+        const timeval interval{usec / 1000000, usec % 1000000};
+        event_add(budget_event_.get(), &interval);
+    }
+
+    thread_ = make_unique<thread>(
+        [base = event_.get(),
+         slot = slot_,
+         limits = limits_.get(),
+         http2 = http2_.get()]
+        {
+            // запись в закрытое клиентом подключение (в том числе
+            // библиотекой OpenSSL) возвращает ошибку вместо завершения
+            // процесса сигналом SIGPIPE
+            sigset_t signals;
+            sigemptyset(&signals);
+            sigaddset(&signals, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &signals, nullptr);
 
-    event_exit_ = EvEvent(event, event_free);
-    const timeval sec = {0, 1};
-    event_add(event_exit_.get(), &sec);
+            current_base = base;
+            Watchdog::Bind(slot);
+            if (limits != nullptr)
+            {
+                limits->Bind();
+            }
+            if (http2 != nullptr)
+            {
+                http2->Bind();
+            }
+            event_base_dispatch(base);
 
-    thread_ = make_unique<thread>(&event_base_dispatch, event_.get());
+            // ответы запросов, ожидающих запись кэша, отправляются до
+            // освобождения данных потока
+            ResponseCache::Unbind();
+        });
 }
 
 //------------------------------------------------------------------------------
 Connection::~Connection() noexcept
 {
-    event_base_loopexit(event_.get(), nullptr);
+    Stop();
 
     thread_->join();
 
-    event_exit_.reset(nullptr);
+    if (watchdog_ != nullptr)
+    {
+        watchdog_->Unregister(slot_);
+    }
+
+    monitor_.reset(nullptr);
+    accepting_event_.reset(nullptr);
+    drain_event_.reset(nullptr);
+    budget_event_.reset(nullptr);
     server_.reset(nullptr);
+    http2_.reset(nullptr);
+    limits_.reset(nullptr);
     event_.reset(nullptr);
+
+    close(accepting_fd_);
+
+    if (!unix_path_.empty())
+    {
+        unlink(unix_path_.c_str());
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -90,12 +288,114 @@ void Connection::Request(evhttp_request *req, void *arg) noexcept
 {
     auto *server = static_cast<Connection *>(arg);
 
-    const RequestImpl request(req);
-    ResponseImpl response(req);
+    const auto start{LoopMonitor::Clock::now()};
+
+    auto trace{make_unique<Trace>(req)};
 
-    server->func_(request, response);
+    trace->Begin(Trace::Phase::Parse);
+    const auto exchange{make_shared<http::Exchange>(req)};
+    auto &request{exchange->Request()};
+    auto &response{exchange->Response()};
+    trace->End(Trace::Phase::Parse);
 
-    response.Send();
+    trace->SetRequest(http::MethodToString(request.GetMethod()),
+                      request.Uri()->Url());
+
+    // трассировка отложенного ответа завершается при его отправке
+    exchange->SetTrace(std::move(trace));
+
+    if (server->limits_ != nullptr)
+    {
+        server->limits_->Dispatched(evhttp_request_get_connection(req));
+    }
+
+    // следующий запрос подключения ограничивается остатком бюджета памяти
+    evhttp_connection_set_max_body_size(
+        evhttp_request_get_connection(req),
+        static_cast<ev_ssize_t>(
+            MemoryBudget::BodyLimit(server->max_body_size_)));
+
+    server->Serve(request, response);
+
+    // отложенный ответ отправляется при завершении асинхронной обработки
+    exchange->Dispatched();
+
+    // цикл с отложенными ответами не может быть удалён
+    if (exchange->Deferred())
+    {
+        auto &deferred{server->deferred_};
+        if (deferred.size() == deferred.capacity())
+        {
+            deferred.erase(std::remove_if(deferred.begin(),
+                                          deferred.end(),
+                                          [](const auto &item)
+                                          {
+                                              return item.expired();
+                                          }),
+                           deferred.end());
+        }
+        deferred.push_back(exchange);
+    }
+
+    server->monitor_->AddRequest(LoopMonitor::Clock::now() - start);
+}
+
+//------------------------------------------------------------------------------
+void Connection::Serve(RequestImpl &request, ResponseImpl &response) noexcept
+{
+    if (request.WithinBudget())
+    {
+        func_(request, response);
+        return;
+    }
+
+    Logging::Warning("Данные запроса не помещаются в бюджет памяти");
+    response.SetError(static_cast<http::Response::Code>(HTTP_SERVUNAVAIL),
+                      "Недостаточно памяти для обработки запроса");
+    response.Header()->Set("Retry-After", "1");
+}
+
+//------------------------------------------------------------------------------
+void Connection::OnBudget(evutil_socket_t, int16_t, void *arg) noexcept
+{
+    auto *connection{static_cast<Connection *>(arg)};
+
+    evhttp_set_max_body_size(
+        connection->server_.get(),
+        static_cast<ev_ssize_t>(
+            MemoryBudget::BodyLimit(connection->max_body_size_)));
+}
+
+//------------------------------------------------------------------------------
+void Connection::BindUnix(string_view path, mode_t mode) noexcept
+{
+    const evutil_socket_t fd{ListenUnix(path, mode)};
+    if (fd < 0)
+    {
+        return;
+    }
+
+    unix_path_ = path;
+
+    auto *listener{evconnlistener_new(
+        event_.get(), nullptr, nullptr, LEV_OPT_CLOSE_ON_FREE, -1, fd)};
+    if (listener == nullptr)
+    {
+        close(fd);
+    }
+
+    if (listener != nullptr)
+    {
+        accept_ = evhttp_bind_listener(server_.get(), listener);
+    }
+
+    if (accept_ == nullptr)
+    {
+        Logging::Error("Ошибка привязки HTTP-сервера с сокетом Unix");
+        return;
+    }
+
+    socket_ = fd;
 }
 
 //------------------------------------------------------------------------------
@@ -104,16 +404,168 @@ evutil_socket_t Connection::GetSocket() const noexcept
     return socket_;
 }
 
+//------------------------------------------------------------------------------
+void Connection::Stop() const noexcept
+{
+    event_base_loopexit(event_.get(), nullptr);
+}
+
+//------------------------------------------------------------------------------
+void Connection::SetAccepting(bool accepting) noexcept
+{
+    if (accepting_.exchange(accepting) != accepting)
+    {
+        drained_.store(false);
+
+        const uint64_t one{1};
+        static_cast<void>(write(accepting_fd_, &one, sizeof(one)));
+    }
+}
+
+//------------------------------------------------------------------------------
+bool Connection::Accepting() const noexcept
+{
+    return accepting_.load();
+}
+
+//------------------------------------------------------------------------------
+bool Connection::Drained() const noexcept
+{
+    return drained_.load();
+}
+
+//------------------------------------------------------------------------------
+void Connection::OnAccepting(evutil_socket_t fd, int16_t, void *arg) noexcept
+{
+    auto *connection{static_cast<Connection *>(arg)};
+
+    uint64_t value{0};
+    static_cast<void>(read(fd, &value, sizeof(value)));
+
+    if (connection->accept_ == nullptr)
+    {
+        return;
+    }
+
+    // приёмник отключается, а не удаляется, так как при удалении
+    // закрывается общий сокет
+    auto *listener{evhttp_bound_socket_get_listener(connection->accept_)};
+    if (connection->accepting_.load())
+    {
+        evconnlistener_enable(listener);
+        event_del(connection->drain_event_.get());
+    }
+    else
+    {
+        evconnlistener_disable(listener);
+        event_add(connection->drain_event_.get(),
+                  &connection->drain_interval_);
+    }
+}
+
+//------------------------------------------------------------------------------
+void Connection::OnDrain(evutil_socket_t, int16_t, void *arg) noexcept
+{
+    auto *connection{static_cast<Connection *>(arg)};
+
+    auto &deferred{connection->deferred_};
+    deferred.erase(std::remove_if(deferred.begin(),
+                                  deferred.end(),
+                                  [](const auto &item)
+                                  {
+                                      return item.expired();
+                                  }),
+                   deferred.end());
+
+    // подключения клиентов, HTTP/2, потоки событий и подключения HttpClient
+    // используют события дескрипторов; таймеры и отключённый приёмник не
+    // учитываются
+    if (!deferred.empty() ||
+        event_base_foreach_event(
+            connection->event_.get(), &Connection::FindBusy, connection) != 0)
+    {
+        return;
+    }
+
+    event_del(connection->drain_event_.get());
+    if (!connection->accepting_.load())
+    {
+        connection->drained_.store(true);
+    }
+}
+
+//------------------------------------------------------------------------------
+int Connection::FindBusy(const event_base *,
+                         const event *ev,
+                         void *arg) noexcept
+{
+    const auto *connection{static_cast<const Connection *>(arg)};
+
+    const evutil_socket_t fd{event_get_fd(ev)};
+    return fd >= 0 && fd != connection->accepting_fd_ &&
+                   fd != connection->socket_
+               ? 1
+               : 0;
+}
+
+//------------------------------------------------------------------------------
+event_base *Connection::CurrentBase() noexcept
+{
+    return current_base;
+}
+
+//------------------------------------------------------------------------------
+LoopMonitor::Snapshot Connection::GetLoopSnapshot() const noexcept
+{
+    auto snapshot{monitor_->GetSnapshot()};
+    if (slot_ != nullptr)
+    {
+        snapshot.stalls = slot_->stalls.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+//------------------------------------------------------------------------------
+uint64_t Connection::SlowClients() const noexcept
+{
+    return limits_ != nullptr ? limits_->Closed() : 0;
+}
+
+//------------------------------------------------------------------------------
+uint64_t Connection::Http2Streams() const noexcept
+{
+    return http2_ != nullptr ? http2_->Streams() : 0;
+}
+
 /*------------------------------------------------------------------------------
     HandlerImpl
 ------------------------------------------------------------------------------*/
 HandlerImpl::HandlerImpl(http::Request::Method method,
                          std::string_view path,
-                         Handler func) noexcept
+                         Handler func,
+                         const HandlerOptions &options) noexcept
+: HandlerImpl(method, path, HandlerRef{}, options)
+{
+    owned_func_ = make_unique<Handler>(std::move(func));
+    func_ = HandlerRef::Bind(*owned_func_);
+}
+
+//------------------------------------------------------------------------------
+HandlerImpl::HandlerImpl(http::Request::Method method,
+                         std::string_view path,
+                         HandlerRef func,
+                         const HandlerOptions &options) noexcept
 : method_(method)
 , path_(path)
-, func_(std::move(func))
+, func_(func)
+, etag_(options.etag)
+, lazy_body_(options.lazy_body)
+, timeout_(options.timeout)
 {
+    if (options.cache.ttl.count() > 0)
+    {
+        cache_ = make_shared<ResponseCache>(options.cache);
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -132,10 +584,128 @@ const string &HandlerImpl::Path() const noexcept
 }
 
 //------------------------------------------------------------------------------
-void HandlerImpl::Exec(const http::Request &request,
-                       http::Response &response) noexcept
+void HandlerImpl::Exec(RequestImpl &request, ResponseImpl &response) noexcept
 {
-    func_(request, response);
+    const Watchdog::Scope watchdog(path_);
+
+    auto &deadline{*request.GetDeadline()};
+    if (timeout_.count() > 0)
+    {
+        deadline.Limit(timeout_);
+    }
+
+    // срок мог истечь, пока запрос ожидал в очереди цикла обработки событий
+    if (deadline.Expired())
+    {
+        response.SetError(static_cast<http::Response::Code>(gateway_timeout),
+                          "Превышено время обработки запроса");
+        return;
+    }
+
+    auto read_result{http::JsonReader::Result::Ok};
+    {
+        const Trace::Scope parse(Trace::Phase::Parse);
+        read_result = request.ReadInputBuffer(lazy_body_);
+    }
+
+    switch (read_result)
+    {
+        case http::JsonReader::Result::TooLarge:
+            response.SetError(
+                static_cast<http::Response::Code>(HTTP_ENTITYTOOLARGE),
+                "Превышен допустимый размер данных запроса");
+            return;
+        case http::JsonReader::Result::Invalid:
+            response.SetError(
+                static_cast<http::Response::Code>(HTTP_BADREQUEST),
+                "Некорректные данные запроса в формате JSON");
+            return;
+        default:
+            break;
+    }
+
+    if (etag_)
+    {
+        response.EnableETag();
+    }
+
+    if (!cache_)
+    {
+        Invoke(request, response);
+        return;
+    }
+
+    const string key{cache_->Key(request)};
+
+    const auto lookup{cache_->Acquire(
+        key,
+        response.GetExchange(),
+        ResponseCache::Invoke::Bind<&HandlerImpl::Invoke>(this))};
+    if (lookup.parked)
+    {
+        // ответ отправляется после формирования записи другим запросом
+        return;
+    }
+
+    if (lookup.entry)
+    {
+        ResponseCache::Fill(*lookup.entry, response);
+        return;
+    }
+
+    if (!lookup.leader)
+    {
+        Invoke(request, response);
+        return;
+    }
+
+    // заголовки, установленные до вызова обработчика (traceparent, CORS),
+    // относятся к запросу, а не к ответу обработчика
+    const auto preset{response.Headers()};
+
+    Invoke(request, response);
+
+    shared_ptr<const ResponseCache::Entry> entry;
+    // ответ отложенного обработчика ещё не сформирован
+    if (response.GetCode() == http::Response::Code::Ok && !response.Deferred())
+    {
+        auto headers{response.Headers()};
+        headers.erase(std::remove_if(headers.begin(),
+                                     headers.end(),
+                                     [&preset](const auto &header)
+                                     {
+                                         return std::find(preset.begin(),
+                                                          preset.end(),
+                                                          header) !=
+                                                preset.end();
+                                     }),
+                      headers.end());
+
+        entry = make_shared<const ResponseCache::Entry>(
+            ResponseCache::Entry{response.Type(),
+                                 string{response.Body()},
+                                 etag_ ? response.ETag() : string{},
+                                 std::move(headers)});
+    }
+
+    cache_->Release(key, entry);
+}
+
+//------------------------------------------------------------------------------
+void HandlerImpl::Invoke(RequestImpl &request, ResponseImpl &response) noexcept
+{
+    {
+        const Trace::Scope handler(Trace::Phase::Handler);
+        func_(request, response);
+    }
+
+    // срок отложенного ответа контролируется обменом
+    if (!response.Deferred() && request.GetDeadline()->Expired())
+    {
+        Logging::Warning("Превышено время обработки запроса {}", path_);
+        response.SetError(static_cast<http::Response::Code>(gateway_timeout),
+                          "Превышено время обработки запроса");
+    }
 }
 
 }  // namespace tasp::ev
@@ -6,16 +6,39 @@
 #define TASP_CONNECTION_HPP_
 
 #include <evhttp.h>
+#include <sys/types.h>
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
+#include "http/client_limits.hpp"
+#include "http/tls.hpp"
+#include "http2/server.hpp"
+#include "loop_monitor.hpp"
 #include "tasp/microservice.hpp"
+#include "watchdog.hpp"
+
+namespace tasp::http
+{
+class Exchange;
+class RequestImpl;
+class ResponseImpl;
+}  // namespace tasp::http
 
 namespace tasp::ev
 {
 class Connection;
 class HandlerImpl;
+class ResponseCache;
+
+/**
+ * @brief Ссылка на функцию, распределяющую запросы подключения по
+ * обработчикам.
+ */
+using Dispatcher = FunctionRef<void(http::RequestImpl &, http::ResponseImpl &)>;
 
 /**
  * @brief Умный указатель конфигурации библиотеки libevent.
@@ -37,6 +60,59 @@ using EvHttp = std::unique_ptr<evhttp, decltype(&evhttp_free)>;
  */
 using EvEvent = std::unique_ptr<event, decltype(&event_free)>;
 
+/**
+ * @brief Параметры подключения к HTTP-серверу.
+ */
+struct ConnectionOptions
+{
+    /**
+     * @brief Максимальный размер данных запроса в байтах. Запросы большего
+     * размера отклоняются библиотекой libevent до чтения данных.
+     */
+    size_t max_body_size{16 * 1024 * 1024};
+
+    /**
+     * @brief Номер подключения в пуле.
+     */
+    size_t id{0};
+
+    /**
+     * @brief Период проверки задержки планирования цикла обработки событий.
+     */
+    std::chrono::milliseconds probe_interval{100};
+
+    /**
+     * @brief Интервал вывода показателей цикла обработки событий в журнал.
+     */
+    std::chrono::seconds report_interval{60};
+
+    /**
+     * @brief Контроль зависших обработчиков. Пустой указатель - контроль
+     * отключён.
+     */
+    Watchdog *watchdog{nullptr};
+
+    /**
+     * @brief Права доступа к файлу сокета Unix.
+     */
+    mode_t unix_mode{0660};
+
+    /**
+     * @brief Защита от медленных клиентов.
+     */
+    http::ClientLimits::Settings client_limits;
+
+    /**
+     * @brief Контекст TLS. Пустой указатель - подключения без шифрования.
+     */
+    http::Tls *tls{nullptr};
+
+    /**
+     * @brief Параметры HTTP/2.
+     */
+    http2::Server::Settings http2;
+};
+
 /**
  * @brief Класс подключения к HTTP-серверу.
  *
@@ -47,21 +123,30 @@ public:
     /**
      * @brief Конструктор главного подключения.
      *
+     * Адрес вида unix:/путь/к/файлу.sock задаёт сокет Unix, порт при этом не
+     * используется.
+     *
      * @param address Адрес для прослушивания
      * @param port Порт сервера
+     * @param options Параметры подключения
      * @param func Функция формирующая запрос
      */
     Connection(std::string_view address,
                uint16_t port,
-               const Handler &func) noexcept;
+               const ConnectionOptions &options,
+               Dispatcher func) noexcept;
 
     /**
-     * @brief Конструктор дополнительных подключения.
+     * @brief Конструктор дополнительных подключения. Подключение использует
+     * копию дескриптора сокета, поэтому может быть удалено раньше основного.
      *
      * @param socket Сокет основного подключения
+     * @param options Параметры подключения
      * @param func Функция формирующая запрос
      */
-    Connection(evutil_socket_t socket, const Handler &func) noexcept;
+    Connection(evutil_socket_t socket,
+               const ConnectionOptions &options,
+               Dispatcher func) noexcept;
 
     /**
      * @brief Деструктор.
@@ -76,12 +161,68 @@ public:
     evutil_socket_t GetSocket() const noexcept;
 
     /**
-     * @brief Конструктор копирования.
+     * @brief Запрос на завершение цикла обработки событий. Цикл завершается
+     * не позднее следующей проверки задержки планирования.
+     */
+    void Stop() const noexcept;
+
+    /**
+     * @brief Включение или приостановка приёма новых подключений. Принятые
+     * подключения продолжают обслуживаться. Может вызываться из любого
+     * потока, изменение выполняется в потоке цикла.
      *
-     * @param conn Подключение для копирования
+     * @param accepting Признак приёма подключений
      */
-    Connection(Connection &&conn) = default;
+    void SetAccepting(bool accepting) noexcept;
 
+    /**
+     * @brief Запрос признака приёма новых подключений.
+     *
+     * @return Признак приёма подключений
+     */
+    [[nodiscard]] bool Accepting() const noexcept;
+
+    /**
+     * @brief Запрос признака завершения обслуживания приостановленным
+     * циклом принятых подключений: у цикла нет подключений клиентов,
+     * отложенных ответов и потоков событий.
+     *
+     * @return Признак завершения обслуживания
+     */
+    [[nodiscard]] bool Drained() const noexcept;
+
+    /**
+     * @brief Запрос показателей цикла обработки событий подключения.
+     *
+     * @return Показатели
+     */
+    [[nodiscard]] LoopMonitor::Snapshot GetLoopSnapshot() const noexcept;
+
+    /**
+     * @brief Запрос количества подключений, закрытых защитой от медленных
+     * клиентов.
+     *
+     * @return Количество подключений
+     */
+    [[nodiscard]] uint64_t SlowClients() const noexcept;
+
+    /**
+     * @brief Запрос количества обработанных потоков HTTP/2.
+     *
+     * @return Количество потоков
+     */
+    [[nodiscard]] uint64_t Http2Streams() const noexcept;
+
+    /**
+     * @brief Запрос цикла обработки событий подключения, в потоке которого
+     * выполняется вызов.
+     *
+     * @return Цикл обработки событий или пустой указатель вне потоков
+     * подключений
+     */
+    [[nodiscard]] static event_base *CurrentBase() noexcept;
+
+    Connection(Connection &&) = delete;
     Connection(const Connection &) = delete;
     Connection &operator=(const Connection &) = delete;
     Connection &operator=(Connection &&) = delete;
@@ -91,9 +232,10 @@ private:
      * @brief Конструктор с общими действиями как для основного соединения, так
      * и для дополнительных соединений.
      *
+     * @param options Параметры подключения
      * @param func Функция формирующая запрос
      */
-    explicit Connection(Handler func) noexcept;
+    Connection(const ConnectionOptions &options, Dispatcher func) noexcept;
 
     /**
      * @brief Обработчик запроса передаваемый в библиотеку libevent.
@@ -103,6 +245,63 @@ private:
      */
     static void Request(evhttp_request *req, void *arg) noexcept;
 
+    /**
+     * @brief Передача запроса обработчикам, если данные запроса помещаются
+     * в бюджет памяти. Используется также сессиями HTTP/2.
+     *
+     * @param request Запрос
+     * @param response Ответ
+     */
+    void Serve(http::RequestImpl &request,
+               http::ResponseImpl &response) noexcept;
+
+    /**
+     * @brief Привязка HTTP-сервера к сокету Unix.
+     *
+     * @param path Путь к файлу сокета
+     * @param mode Права доступа к файлу сокета
+     */
+    void BindUnix(std::string_view path, mode_t mode) noexcept;
+
+    /**
+     * @brief Обработчик уведомления об изменении признака приёма
+     * подключений.
+     *
+     * @param fd Дескриптор eventfd
+     * @param arg Указатель на подключение
+     */
+    static void OnAccepting(evutil_socket_t fd, int16_t, void *arg) noexcept;
+
+    /**
+     * @brief Обработчик таймера проверки завершения обслуживания принятых
+     * подключений приостановленным циклом.
+     *
+     * @param arg Указатель на подключение
+     */
+    static void OnDrain(evutil_socket_t, int16_t, void *arg) noexcept;
+
+    /**
+     * @brief Функция перебора событий цикла (event_base_foreach_event):
+     * поиск событий дескрипторов, кроме собственных дескрипторов
+     * подключения.
+     *
+     * @param ev Событие
+     * @param arg Указатель на подключение
+     *
+     * @return 1 - найдено событие дескриптора, 0 - продолжение перебора
+     */
+    static int FindBusy(const event_base *,
+                        const event *ev,
+                        void *arg) noexcept;
+
+    /**
+     * @brief Обработчик таймера обновления максимального размера данных
+     * новых запросов по остатку бюджета памяти.
+     *
+     * @param arg Указатель на подключение
+     */
+    static void OnBudget(evutil_socket_t, int16_t, void *arg) noexcept;
+
     /**
      * @brief Поток для обработки событий подключения.
      */
@@ -119,19 +318,101 @@ private:
     EvHttp server_{nullptr, nullptr};
 
     /**
-     * @brief Событие для отслеживания выхода.
+     * @brief Защита от медленных клиентов. Пустой указатель - защита
+     * отключена.
+     */
+    std::unique_ptr<http::ClientLimits> limits_;
+
+    /**
+     * @brief Приём подключений HTTP/2. Пустой указатель - HTTP/2 отключён.
      */
-    EvEvent event_exit_{nullptr, nullptr};
+    std::unique_ptr<http2::Server> http2_;
+
+    /**
+     * @brief Контроль загрузки цикла. Периодический таймер контроля также
+     * обеспечивает своевременную обработку запроса на выход из цикла.
+     */
+    std::unique_ptr<LoopMonitor> monitor_;
+
+    /**
+     * @brief Контроль зависших обработчиков.
+     */
+    Watchdog *watchdog_{nullptr};
+
+    /**
+     * @brief Ячейка контроля зависших обработчиков потока подключения.
+     */
+    Watchdog::Slot *slot_{nullptr};
 
     /**
      * @brief Сокет подключения.
      */
     evutil_socket_t socket_{};
 
+    /**
+     * @brief Привязка HTTP-сервера к сокету.
+     */
+    evhttp_bound_socket *accept_{nullptr};
+
+    /**
+     * @brief Требуемый признак приёма подключений.
+     */
+    std::atomic<bool> accepting_{true};
+
+    /**
+     * @brief Дескриптор eventfd для уведомления цикла об изменении признака
+     * приёма подключений.
+     */
+    int accepting_fd_{-1};
+
+    /**
+     * @brief Событие уведомления об изменении признака приёма подключений.
+     */
+    EvEvent accepting_event_{nullptr, nullptr};
+
+    /**
+     * @brief Таймер проверки завершения обслуживания принятых подключений.
+     * Запущен, пока приём подключений приостановлен.
+     */
+    EvEvent drain_event_{nullptr, nullptr};
+
+    /**
+     * @brief Период проверки завершения обслуживания принятых подключений.
+     */
+    timeval drain_interval_{};
+
+    /**
+     * @brief Признак завершения обслуживания принятых подключений
+     * приостановленным циклом.
+     */
+    std::atomic<bool> drained_{false};
+
+    /**
+     * @brief Отложенные обмены цикла. Используется только в потоке цикла.
+     */
+    std::vector<std::weak_ptr<http::Exchange>> deferred_;
+
+    /**
+     * @brief Таймер обновления максимального размера данных запросов по
+     * остатку бюджета памяти. Пустой указатель - бюджет не ограничен.
+     */
+    EvEvent budget_event_{nullptr, nullptr};
+
+    /**
+     * @brief Максимальный размер данных запроса из параметров подключения.
+     */
+    size_t max_body_size_;
+
+    /**
+     * @brief Путь к файлу сокета Unix главного подключения. Файл удаляется
+     * при удалении подключения.
+     */
+    std::string unix_path_;
+
     /**
      * @brief Функция формирующая запрос.
      */
-    Handler func_;
+    Dispatcher func_;
 };
 
 /**
@@ -147,10 +428,25 @@ public:
      * @param method Метод запроса
      * @param path URL-путь запроса
      * @param func Обработчик запроса
+     * @param options Параметры обработчика
      */
     HandlerImpl(http::Request::Method method,
                 std::string_view path,
-                Handler func) noexcept;
+                Handler func,
+                const HandlerOptions &options = {}) noexcept;
+
+    /**
+     * @brief Конструктор с невладеющей ссылкой на обработчик.
+     *
+     * @param method Метод запроса
+     * @param path URL-путь запроса
+     * @param func Обработчик запроса
+     * @param options Параметры обработчика
+     */
+    HandlerImpl(http::Request::Method method,
+                std::string_view path,
+                HandlerRef func,
+                const HandlerOptions &options = {}) noexcept;
 
     /**
      * @brief Деструктор.
@@ -172,12 +468,14 @@ public:
     [[nodiscard]] const std::string &Path() const noexcept;
 
     /**
-     * @brief Вызов обработчика запроса.
+     * @brief Вызов обработчика запроса. Если для обработчика включено
+     * кэширование, ответ по возможности берётся из кэша.
      *
      * @param request Запрос
      * @param response Ответ
      */
-    void Exec(const http::Request &request, http::Response &response) noexcept;
+    void Exec(http::RequestImpl &request,
+              http::ResponseImpl &response) noexcept;
 
     /**
      * @brief Конструктор перемещения.
@@ -191,6 +489,16 @@ public:
     HandlerImpl &operator=(HandlerImpl &&) = delete;
 
 private:
+    /**
+     * @brief Вызов функции обработчика. Ответ обработчика, превысившего срок
+     * обработки запроса, заменяется ответом с кодом 504.
+     *
+     * @param request Запрос
+     * @param response Ответ
+     */
+    void Invoke(http::RequestImpl &request,
+                http::ResponseImpl &response) noexcept;
+
     /**
      * @brief Метод запроса.
      */
@@ -202,9 +510,35 @@ private:
     std::string path_;
 
     /**
-     * @brief Обработчик запроса.
+     * @brief Обработчик запроса, переданный в виде std::function. Хранится в
+     * динамической памяти, чтобы ссылка func_ не менялась при перемещении.
+     */
+    std::unique_ptr<Handler> owned_func_;
+
+    /**
+     * @brief Ссылка на обработчик запроса.
+     */
+    HandlerRef func_;
+
+    /**
+     * @brief Кэш ответов. Пустой указатель, если кэширование отключено.
+     */
+    std::shared_ptr<ResponseCache> cache_;
+
+    /**
+     * @brief Признак формирования заголовка ETag.
+     */
+    bool etag_{false};
+
+    /**
+     * @brief Признак отложенного разбора данных запроса.
+     */
+    bool lazy_body_{false};
+
+    /**
+     * @brief Срок обработки запроса, 0 - не задан.
      */
-    Handler func_;
+    std::chrono::milliseconds timeout_{0};
 };
 
 }  // namespace tasp::ev
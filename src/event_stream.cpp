@@ -0,0 +1,49 @@
+#include "tasp/event_stream.hpp"
+
+#include "event_stream_impl.hpp"
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    EventStream
+------------------------------------------------------------------------------*/
+EventStream::EventStream(std::shared_ptr<EventStreamImpl> impl) noexcept
+: impl_(std::move(impl))
+{
+}
+
+//------------------------------------------------------------------------------
+EventStream::~EventStream() noexcept = default;
+
+//------------------------------------------------------------------------------
+EventStream::EventStream(const EventStream &) noexcept = default;
+
+//------------------------------------------------------------------------------
+EventStream::EventStream(EventStream &&) noexcept = default;
+
+//------------------------------------------------------------------------------
+EventStream &EventStream::operator=(const EventStream &) noexcept = default;
+
+//------------------------------------------------------------------------------
+EventStream &EventStream::operator=(EventStream &&) noexcept = default;
+
+//------------------------------------------------------------------------------
+void EventStream::Publish(std::string_view data) const noexcept
+{
+    impl_->Publish({}, data);
+}
+
+//------------------------------------------------------------------------------
+void EventStream::Publish(std::string_view event,
+                          std::string_view data) const noexcept
+{
+    impl_->Publish(event, data);
+}
+
+//------------------------------------------------------------------------------
+size_t EventStream::Subscribers() const noexcept
+{
+    return impl_->Subscribers();
+}
+
+}  // namespace tasp
@@ -0,0 +1,888 @@
+#include "event_stream_impl.hpp"
+
+#include <event2/bufferevent.h>
+#include <evhttp.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include <tasp/logging.hpp>
+
+#include "connection.hpp"
+#include "http/client_limits.hpp"
+#include "http/exchange.hpp"
+#include "http/response_impl.hpp"
+
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::shared_ptr;
+using std::string;
+using std::string_view;
+
+using tasp::http::ClientLimits;
+
+namespace tasp
+{
+
+namespace
+{
+/**
+ * @brief Счётчик идентификаторов потоков событий.
+ */
+std::atomic<uint64_t> next_id{1};
+
+/**
+ * @brief Комментарий для поддержания подключения.
+ */
+constexpr string_view keepalive_comment{": keepalive\n\n"};
+
+/**
+ * @brief Объём событий, рассылаемых за одну итерацию цикла обработки событий.
+ * Соответствует объёму однократной записи в сокет в библиотеке libevent.
+ */
+constexpr size_t drain_budget{16 * 1024};
+
+/**
+ * @brief Умный указатель буфера данных библиотеки libevent.
+ */
+using EvBuffer = std::unique_ptr<evbuffer, decltype(&evbuffer_free)>;
+
+/**
+ * @brief Событие, общее для буферов всех подписчиков.
+ */
+using Frame = shared_ptr<const string>;
+
+//------------------------------------------------------------------------------
+void ReleaseFrame(const void * /*data*/, size_t /*length*/, void *arg) noexcept
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+    delete static_cast<Frame *>(arg);
+}
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    EventStreamImpl::Channel
+------------------------------------------------------------------------------*/
+/**
+ * @brief Подписчики потока событий в одном цикле обработки событий.
+ */
+class EventStreamImpl::Channel final
+{
+public:
+    /**
+     * @brief Конструктор. Вызывается в потоке цикла обработки событий.
+     *
+     * @param base Цикл обработки событий
+     * @param stream Поток событий
+     */
+    Channel(event_base *base, shared_ptr<EventStreamImpl> stream) noexcept
+    : stream_(std::move(stream))
+    , wake_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    {
+        wake_ = ev::EvEvent(event_new(base,
+                                      wake_fd_,
+                                      EV_READ | EV_PERSIST,
+                                      &Channel::OnWake,
+                                      this),
+                            event_free);
+        event_add(wake_.get(), nullptr);
+
+        drain_ = ev::EvEvent(evtimer_new(base, &Channel::OnDrain, this),
+                             event_free);
+
+        release_ = ev::EvEvent(evtimer_new(base, &Channel::OnRelease, this),
+                               event_free);
+
+        keepalive_ = ev::EvEvent(
+            event_new(base, -1, EV_PERSIST, &Channel::OnKeepalive, this),
+            event_free);
+
+        const auto interval{stream_->Options().keepalive};
+        if (interval.count() > 0)
+        {
+            const timeval tv{interval.count(), 0};
+            event_add(keepalive_.get(), &tv);
+        }
+    }
+
+    /**
+     * @brief Деструктор.
+     */
+    ~Channel() noexcept
+    {
+        Close();
+    }
+
+    /**
+     * @brief Добавление подписчика: отправка заголовков ответа и начало
+     * ответа частями. Вызывается в потоке цикла обработки событий.
+     *
+     * @param req Запрос подписки
+     */
+    void Add(evhttp_request *req) noexcept
+    {
+        auto *headers{evhttp_request_get_output_headers(req)};
+        evhttp_add_header(
+            headers, "Content-Type", "text/event-stream; charset=UTF-8");
+        evhttp_add_header(headers, "Cache-Control", "no-cache");
+        evhttp_add_header(headers, "X-Accel-Buffering", "no");
+
+        // подключение отключённого подписчика закрывается после отправки
+        // оставшихся данных
+        evhttp_add_header(headers, "Connection", "close");
+
+        evhttp_send_reply_start(req, HTTP_OK, "OK");
+
+        auto *connection{evhttp_request_get_connection(req)};
+        ClientLimits::SetCloseCallback(connection, &Channel::OnClose, this);
+
+        auto *bev{evhttp_connection_get_bufferevent(connection)};
+        auto &subscriber{subscribers_[connection]};
+        subscriber.channel = this;
+        subscriber.connection = connection;
+        subscriber.req = req;
+        subscriber.output = bufferevent_get_output(bev);
+        bufferevent_getwatermark(
+            bev, EV_WRITE, nullptr, &subscriber.high_watermark);
+        if (subscriber.high_watermark > 0)
+        {
+            subscriber.watch = evbuffer_add_cb(
+                subscriber.output, &Channel::OnOutput, &subscriber);
+        }
+        stream_->CountSubscribers(1);
+
+        Send(subscriber, make_shared<const string>(": connected\n\n"));
+    }
+
+    /**
+     * @brief Постановка события в очередь канала. Вызывается из любого
+     * потока.
+     *
+     * @param frame Событие
+     */
+    void Push(const Frame &frame) noexcept
+    {
+        const lock_guard lock(mutex_);
+        if (closed_)
+        {
+            return;
+        }
+
+        if (inbox_.size() >= stream_->Options().max_queue)
+        {
+            inbox_.pop_front();
+            dropped_++;
+        }
+
+        inbox_.push_back(frame);
+
+        // цикл пробуждается один раз на пачку событий
+        if (inbox_.size() == 1)
+        {
+            const uint64_t one{1};
+            static_cast<void>(write(wake_fd_, &one, sizeof(one)));
+        }
+    }
+
+    /**
+     * @brief Закрытие канала при завершении цикла обработки событий.
+     * Подключения подписчиков освобождаются HTTP-сервером.
+     */
+    void Close() noexcept
+    {
+        {
+            const lock_guard lock(mutex_);
+            if (closed_)
+            {
+                return;
+            }
+            closed_ = true;
+            inbox_.clear();
+        }
+
+        for (auto &[connection, subscriber] : subscribers_)
+        {
+            Unwatch(subscriber);
+            ClientLimits::SetCloseCallback(connection, nullptr, nullptr);
+        }
+        stream_->CountSubscribers(-static_cast<int64_t>(subscribers_.size()));
+        subscribers_.clear();
+
+        ready_.clear();
+        pending_.clear();
+        wake_.reset(nullptr);
+        drain_.reset(nullptr);
+        keepalive_.reset(nullptr);
+        release_.reset(nullptr);
+        close(wake_fd_);
+    }
+
+    /**
+     * @brief Запрос признака закрытия канала.
+     *
+     * @return Признак закрытия
+     */
+    [[nodiscard]] bool Closed() noexcept
+    {
+        const lock_guard lock(mutex_);
+        return closed_;
+    }
+
+    Channel(const Channel &) = delete;
+    Channel(Channel &&) = delete;
+    Channel &operator=(const Channel &) = delete;
+    Channel &operator=(Channel &&) = delete;
+
+private:
+    /**
+     * @brief Подписчик канала.
+     */
+    struct Subscriber
+    {
+        /**
+         * @brief Канал подписчика.
+         */
+        Channel *channel{nullptr};
+
+        /**
+         * @brief Подключение подписчика.
+         */
+        evhttp_connection *connection{nullptr};
+
+        /**
+         * @brief Запрос подписки.
+         */
+        evhttp_request *req{nullptr};
+
+        /**
+         * @brief Буфер вывода подключения.
+         */
+        evbuffer *output{nullptr};
+
+        /**
+         * @brief Объём неотправленных данных, при превышении которого
+         * рассылка подписчику приостанавливается, 0 - не приостанавливается.
+         */
+        size_t high_watermark{0};
+
+        /**
+         * @brief Функция обратного вызова буфера вывода.
+         */
+        evbuffer_cb_entry *watch{nullptr};
+
+        /**
+         * @brief События, ожидающие возобновления рассылки.
+         */
+        std::deque<Frame> backlog;
+
+        /**
+         * @brief Объём событий, ожидающих возобновления рассылки.
+         */
+        size_t backlog_size{0};
+
+        /**
+         * @brief Признак ожидания возобновления рассылки в цикле.
+         */
+        bool ready{false};
+    };
+
+    /**
+     * @brief Отправка события подписчику. Подписчик, объём неотправленных
+     * данных которого превышает max_buffer, отключается. Пока объём
+     * неотправленных данных выше верхней границы записи подключения,
+     * события откладываются до опустошения буфера вывода наполовину.
+     *
+     * @param subscriber Подписчик
+     * @param frame Событие
+     *
+     * @return Признак отправки
+     */
+    bool Send(Subscriber &subscriber, const Frame &frame) noexcept
+    {
+        const size_t pending{evbuffer_get_length(subscriber.output)};
+
+        if (pending + subscriber.backlog_size + frame->size() >
+            stream_->Options().max_buffer)
+        {
+            return false;
+        }
+
+        if (!subscriber.backlog.empty() ||
+            (subscriber.high_watermark > 0 &&
+             pending >= subscriber.high_watermark))
+        {
+            subscriber.backlog_size += frame->size();
+            subscriber.backlog.push_back(frame);
+            return true;
+        }
+
+        return Write(subscriber.req, frame);
+    }
+
+    /**
+     * @brief Запись события в ответ подписчику.
+     *
+     * @param req Запрос подписки
+     * @param frame Событие
+     *
+     * @return Признак записи
+     */
+    static bool Write(evhttp_request *req, const Frame &frame) noexcept
+    {
+        // буфер ссылается на общее событие без копирования данных
+        const EvBuffer buffer{evbuffer_new(), evbuffer_free};
+        // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+        auto *hold{new Frame(frame)};
+        if (evbuffer_add_reference(buffer.get(),
+                                   frame->data(),
+                                   frame->size(),
+                                   &ReleaseFrame,
+                                   hold) != 0)
+        {
+            ReleaseFrame(nullptr, 0, hold);
+            return false;
+        }
+
+        evhttp_send_reply_chunk(req, buffer.get());
+        return true;
+    }
+
+    /**
+     * @brief Рассылка события всем подписчикам канала.
+     *
+     * @param frame Событие
+     */
+    void Broadcast(const Frame &frame) noexcept
+    {
+        std::vector<evhttp_connection *> slow;
+        for (auto &[connection, subscriber] : subscribers_)
+        {
+            if (!Send(subscriber, frame))
+            {
+                slow.push_back(connection);
+            }
+        }
+
+        for (auto *connection : slow)
+        {
+            Logging::Warning(
+                "Подписчик потока событий отключён: превышен объём "
+                "неотправленных данных");
+            Evict(connection);
+        }
+    }
+
+    /**
+     * @brief Отключение подписчика, не успевающего принимать события.
+     *
+     * @param connection Подключение подписчика
+     */
+    void Evict(evhttp_connection *connection) noexcept
+    {
+        auto it{subscribers_.find(connection)};
+        if (it == subscribers_.end())
+        {
+            return;
+        }
+
+        auto *req{it->second.req};
+        Unwatch(it->second);
+        subscribers_.erase(it);
+        stream_->CountSubscribers(-1);
+
+        ClientLimits::SetCloseCallback(connection, nullptr, nullptr);
+        evhttp_send_reply_end(req);
+
+        ScheduleRelease();
+    }
+
+    /**
+     * @brief Запуск удаления канала без подписчиков в следующей итерации
+     * цикла, вне функций обратного вызова канала.
+     */
+    void ScheduleRelease() noexcept
+    {
+        if (subscribers_.empty())
+        {
+            const timeval now{0, 0};
+            event_add(release_.get(), &now);
+        }
+    }
+
+    /**
+     * @brief Отключение от буфера вывода подписчика.
+     *
+     * @param subscriber Подписчик
+     */
+    static void Unwatch(Subscriber &subscriber) noexcept
+    {
+        if (subscriber.watch != nullptr)
+        {
+            evbuffer_remove_cb_entry(subscriber.output, subscriber.watch);
+            subscriber.watch = nullptr;
+        }
+    }
+
+    /**
+     * @brief Отправка отложенных событий подписчику, пока объём
+     * неотправленных данных не превысит верхнюю границу записи.
+     *
+     * @param subscriber Подписчик
+     */
+    static void Flush(Subscriber &subscriber) noexcept
+    {
+        subscriber.ready = false;
+
+        while (!subscriber.backlog.empty() &&
+               evbuffer_get_length(subscriber.output) <
+                   subscriber.high_watermark)
+        {
+            const auto frame{std::move(subscriber.backlog.front())};
+            subscriber.backlog.pop_front();
+            subscriber.backlog_size -= frame->size();
+
+            Write(subscriber.req, frame);
+        }
+    }
+
+    /**
+     * @brief Функция обратного вызова изменения буфера вывода подписчика:
+     * возобновление рассылки при опустошении буфера наполовину. Отправка
+     * выполняется в следующей итерации цикла, вне записи в сокет.
+     *
+     * @param buffer Буфер вывода
+     * @param info Изменение буфера
+     * @param arg Указатель на подписчика
+     */
+    static void OnOutput(evbuffer *buffer,
+                         const evbuffer_cb_info *info,
+                         void *arg) noexcept
+    {
+        auto *subscriber{static_cast<Subscriber *>(arg)};
+        if (info->n_deleted == 0 || subscriber->backlog.empty() ||
+            subscriber->ready ||
+            evbuffer_get_length(buffer) > subscriber->high_watermark / 2)
+        {
+            return;
+        }
+
+        subscriber->ready = true;
+
+        auto *channel{subscriber->channel};
+        channel->ready_.push_back(subscriber->connection);
+
+        const timeval now{0, 0};
+        event_add(channel->drain_.get(), &now);
+    }
+
+    /**
+     * @brief Функция обратного вызова пробуждения цикла публикацией.
+     *
+     * @param fd Дескриптор eventfd
+     * @param events Не используется
+     * @param arg Указатель на канал
+     */
+    static void OnWake(evutil_socket_t fd,
+                       short /*events*/,
+                       void *arg) noexcept
+    {
+        auto *channel{static_cast<Channel *>(arg)};
+
+        uint64_t value{0};
+        static_cast<void>(read(fd, &value, sizeof(value)));
+
+        size_t dropped{0};
+        {
+            const lock_guard lock(channel->mutex_);
+            for (auto &frame : channel->inbox_)
+            {
+                channel->pending_.push_back(std::move(frame));
+            }
+            channel->inbox_.clear();
+            std::swap(dropped, channel->dropped_);
+        }
+
+        while (channel->pending_.size() > channel->stream_->Options().max_queue)
+        {
+            channel->pending_.pop_front();
+            dropped++;
+        }
+
+        if (dropped > 0)
+        {
+            Logging::Warning("Отброшено событий из-за переполнения очереди: {}",
+                             dropped);
+        }
+
+        channel->Drain();
+    }
+
+    /**
+     * @brief Функция обратного вызова продолжения рассылки.
+     *
+     * @param fd Не используется
+     * @param events Не используется
+     * @param arg Указатель на канал
+     */
+    static void OnDrain(evutil_socket_t /*fd*/,
+                        short /*events*/,
+                        void *arg) noexcept
+    {
+        static_cast<Channel *>(arg)->Drain();
+    }
+
+    /**
+     * @brief Рассылка ожидающих событий. За один проход рассылается не больше
+     * drain_budget байт, остальное - в следующей итерации цикла, чтобы
+     * успевающие подписчики получили данные до проверки объёма их буферов.
+     * Предварительно возобновляется рассылка подписчикам, принявшим
+     * отправленные данные.
+     */
+    void Drain() noexcept
+    {
+        for (auto *connection : std::exchange(ready_, {}))
+        {
+            auto it{subscribers_.find(connection)};
+            if (it != subscribers_.end())
+            {
+                Flush(it->second);
+            }
+        }
+
+        size_t sent{0};
+        while (!pending_.empty() && (sent == 0 || sent < drain_budget))
+        {
+            sent += pending_.front()->size();
+            Broadcast(pending_.front());
+            pending_.pop_front();
+        }
+
+        if (!pending_.empty())
+        {
+            const timeval now{0, 0};
+            event_add(drain_.get(), &now);
+        }
+    }
+
+    /**
+     * @brief Функция обратного вызова таймера поддержания подключений.
+     *
+     * @param fd Не используется
+     * @param events Не используется
+     * @param arg Указатель на канал
+     */
+    static void OnKeepalive(evutil_socket_t /*fd*/,
+                            short /*events*/,
+                            void *arg) noexcept
+    {
+        static const Frame frame{make_shared<const string>(keepalive_comment)};
+        static_cast<Channel *>(arg)->Broadcast(frame);
+    }
+
+    /**
+     * @brief Функция обратного вызова закрытия подключения подписчиком.
+     *
+     * @param connection Подключение
+     * @param arg Указатель на канал
+     */
+    static void OnClose(evhttp_connection *connection, void *arg) noexcept
+    {
+        auto *channel{static_cast<Channel *>(arg)};
+
+        auto it{channel->subscribers_.find(connection)};
+        if (it == channel->subscribers_.end())
+        {
+            return;
+        }
+
+        auto *req{it->second.req};
+        Unwatch(it->second);
+        channel->subscribers_.erase(it);
+        channel->stream_->CountSubscribers(-1);
+
+        // при обрыве подключения незавершённый ответ отсоединяется от него и
+        // должен быть освобождён завершением ответа
+        if (evhttp_request_get_connection(req) == nullptr)
+        {
+            evhttp_send_reply_end(req);
+        }
+
+        channel->ScheduleRelease();
+    }
+
+    /**
+     * @brief Функция обратного вызова удаления канала без подписчиков:
+     * канал закрывается и удаляется из каналов цикла, чтобы его события не
+     * удерживали цикл обработки событий.
+     *
+     * @param fd Не используется
+     * @param events Не используется
+     * @param arg Указатель на канал
+     */
+    static void OnRelease(evutil_socket_t /*fd*/,
+                          short /*events*/,
+                          void *arg) noexcept;
+
+    /**
+     * @brief Поток событий.
+     */
+    shared_ptr<EventStreamImpl> stream_;
+
+    /**
+     * @brief Дескриптор пробуждения цикла.
+     */
+    int wake_fd_;
+
+    /**
+     * @brief Событие пробуждения цикла.
+     */
+    ev::EvEvent wake_{nullptr, nullptr};
+
+    /**
+     * @brief Событие продолжения рассылки.
+     */
+    ev::EvEvent drain_{nullptr, nullptr};
+
+    /**
+     * @brief Таймер поддержания подключений.
+     */
+    ev::EvEvent keepalive_{nullptr, nullptr};
+
+    /**
+     * @brief Событие удаления канала без подписчиков.
+     */
+    ev::EvEvent release_{nullptr, nullptr};
+
+    /**
+     * @brief Синхронизация доступа к очереди событий.
+     */
+    mutex mutex_;
+
+    /**
+     * @brief Очередь событий для рассылки.
+     */
+    std::deque<Frame> inbox_;
+
+    /**
+     * @brief События, ожидающие рассылки. Используется только в потоке цикла
+     * обработки событий.
+     */
+    std::deque<Frame> pending_;
+
+    /**
+     * @brief Количество отброшенных событий.
+     */
+    size_t dropped_{0};
+
+    /**
+     * @brief Признак закрытия канала.
+     */
+    bool closed_{false};
+
+    /**
+     * @brief Подписчики по подключениям. Используется только в потоке
+     * цикла обработки событий.
+     */
+    std::unordered_map<evhttp_connection *, Subscriber> subscribers_;
+
+    /**
+     * @brief Подключения подписчиков, рассылка которым возобновляется в
+     * следующей итерации цикла.
+     */
+    std::vector<evhttp_connection *> ready_;
+};
+
+namespace
+{
+/**
+ * @brief Каналы потоков событий цикла обработки событий потока. Каналы
+ * закрываются при завершении потока, пока цикл ещё существует.
+ */
+struct Registry
+{
+    Registry() noexcept = default;
+
+    ~Registry() noexcept
+    {
+        for (auto &[id, channel] : channels)
+        {
+            channel->Close();
+        }
+    }
+
+    Registry(const Registry &) = delete;
+    Registry(Registry &&) = delete;
+    Registry &operator=(const Registry &) = delete;
+    Registry &operator=(Registry &&) = delete;
+
+    std::map<uint64_t, shared_ptr<EventStreamImpl::Channel>> channels;
+};
+
+thread_local Registry registry;  // NOLINT(cert-err58-cpp)
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+void EventStreamImpl::Channel::OnRelease(evutil_socket_t /*fd*/,
+                                         short /*events*/,
+                                         void *arg) noexcept
+{
+    auto *channel{static_cast<Channel *>(arg)};
+    if (!channel->subscribers_.empty())
+    {
+        return;
+    }
+
+    // канал закрывается в потоке цикла: последняя ссылка на него может
+    // освобождаться публикацией из другого потока
+    for (auto it = registry.channels.begin(); it != registry.channels.end();
+         ++it)
+    {
+        if (it->second.get() == channel)
+        {
+            channel->Close();
+            registry.channels.erase(it);
+            return;
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+    EventStreamImpl
+------------------------------------------------------------------------------*/
+EventStreamImpl::EventStreamImpl(const EventStreamOptions &options) noexcept
+: id_(next_id.fetch_add(1, std::memory_order_relaxed))
+, options_(options)
+{
+}
+
+//------------------------------------------------------------------------------
+EventStreamImpl::~EventStreamImpl() noexcept = default;
+
+//------------------------------------------------------------------------------
+void EventStreamImpl::Subscribe(const http::Request &request,
+                                http::Response &response) noexcept
+{
+    auto *impl{dynamic_cast<http::ResponseImpl *>(&response)};
+    auto *exchange{impl == nullptr ? nullptr : impl->GetExchange()};
+    auto *base{ev::Connection::CurrentBase()};
+    if (exchange == nullptr || base == nullptr)
+    {
+        response.SetError(
+            static_cast<http::Response::Code>(HTTP_NOTIMPLEMENTED),
+            "Поток событий недоступен для данного HTTP-сервера");
+        return;
+    }
+
+    // запрос HEAD обрабатывается обработчиком GET и не открывает поток
+    if (request.GetMethod() != http::Request::Method::Get)
+    {
+        impl->SetBody("text/event-stream; charset=UTF-8", "");
+        return;
+    }
+
+    if (subscribers_.load(std::memory_order_relaxed) >=
+        options_.max_subscribers)
+    {
+        response.SetError(static_cast<http::Response::Code>(HTTP_SERVUNAVAIL),
+                          "Превышено количество подписчиков потока событий");
+        return;
+    }
+
+    auto &channel{registry.channels[id_]};
+    if (!channel)
+    {
+        channel = make_shared<Channel>(base, shared_from_this());
+
+        const lock_guard lock(mutex_);
+        channels_.push_back(channel);
+    }
+
+    channel->Add(exchange->Stream());
+}
+
+//------------------------------------------------------------------------------
+void EventStreamImpl::Publish(string_view event, string_view data) noexcept
+{
+    const Frame frame{make_shared<const string>(Format(
+        next_event_.fetch_add(1, std::memory_order_relaxed), event, data))};
+
+    const lock_guard lock(mutex_);
+    for (auto it = channels_.begin(); it != channels_.end();)
+    {
+        auto channel{it->lock()};
+        if (!channel || channel->Closed())
+        {
+            it = channels_.erase(it);
+            continue;
+        }
+
+        channel->Push(frame);
+        ++it;
+    }
+}
+
+//------------------------------------------------------------------------------
+size_t EventStreamImpl::Subscribers() const noexcept
+{
+    return subscribers_.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+const EventStreamOptions &EventStreamImpl::Options() const noexcept
+{
+    return options_;
+}
+
+//------------------------------------------------------------------------------
+void EventStreamImpl::CountSubscribers(int64_t delta) noexcept
+{
+    subscribers_.fetch_add(static_cast<size_t>(delta),
+                           std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+string EventStreamImpl::Format(uint64_t id,
+                               string_view event,
+                               string_view data) noexcept
+{
+    string frame{"id: "};
+    frame.reserve(data.size() + event.size() + 32);
+    frame += std::to_string(id);
+    frame += '\n';
+
+    if (!event.empty())
+    {
+        frame.append("event: ").append(event).append("\n");
+    }
+
+    // каждая строка данных передаётся отдельным полем data
+    while (true)
+    {
+        const auto end{data.find('\n')};
+        auto line{data.substr(0, end)};
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+
+        frame.append("data: ").append(line).append("\n");
+
+        if (end == string_view::npos)
+        {
+            break;
+        }
+        data.remove_prefix(end + 1);
+    }
+
+    frame += '\n';
+    return frame;
+}
+
+}  // namespace tasp
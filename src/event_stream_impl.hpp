@@ -0,0 +1,139 @@
+/**
+ * @file
+ * @brief Реализация потока событий Server-Sent Events.
+ */
+#ifndef TASP_EVENT_STREAM_IMPL_HPP_
+#define TASP_EVENT_STREAM_IMPL_HPP_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <tasp/event_stream.hpp>
+#include <tasp/http/request.hpp>
+#include <tasp/http/response.hpp>
+
+namespace tasp
+{
+
+/**
+ * @brief Реализация потока событий Server-Sent Events.
+ *
+ * Подписчики хранятся в каналах - по одному на цикл обработки событий, в
+ * котором есть подписчики. Публикация помещает событие в очередь каждого
+ * канала и пробуждает цикл через eventfd, рассылка выполняется в потоке
+ * цикла. Каналы принадлежат потокам циклов и закрываются при отключении
+ * последнего подписчика или при завершении потока цикла.
+ */
+class EventStreamImpl final
+: public std::enable_shared_from_this<EventStreamImpl>
+{
+public:
+    class Channel;
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param options Параметры потока событий
+     */
+    explicit EventStreamImpl(const EventStreamOptions &options) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~EventStreamImpl() noexcept;
+
+    /**
+     * @brief Обработчик запроса подписки.
+     *
+     * @param request Запрос
+     * @param response Ответ
+     */
+    void Subscribe(const http::Request &request,
+                   http::Response &response) noexcept;
+
+    /**
+     * @brief Публикация события.
+     *
+     * @param event Тип события, пустой - без типа
+     * @param data Данные события
+     */
+    void Publish(std::string_view event, std::string_view data) noexcept;
+
+    /**
+     * @brief Запрос количества подписчиков.
+     *
+     * @return Количество подписчиков
+     */
+    [[nodiscard]] size_t Subscribers() const noexcept;
+
+    /**
+     * @brief Запрос параметров потока событий.
+     *
+     * @return Параметры
+     */
+    [[nodiscard]] const EventStreamOptions &Options() const noexcept;
+
+    /**
+     * @brief Изменение количества подписчиков.
+     *
+     * @param delta Изменение
+     */
+    void CountSubscribers(int64_t delta) noexcept;
+
+    /**
+     * @brief Форматирование события в формате text/event-stream.
+     *
+     * @param id Идентификатор события
+     * @param event Тип события, пустой - без типа
+     * @param data Данные события
+     *
+     * @return Событие
+     */
+    [[nodiscard]] static std::string Format(uint64_t id,
+                                            std::string_view event,
+                                            std::string_view data) noexcept;
+
+    EventStreamImpl(const EventStreamImpl &) = delete;
+    EventStreamImpl(EventStreamImpl &&) = delete;
+    EventStreamImpl &operator=(const EventStreamImpl &) = delete;
+    EventStreamImpl &operator=(EventStreamImpl &&) = delete;
+
+private:
+    /**
+     * @brief Идентификатор потока событий.
+     */
+    uint64_t id_;
+
+    /**
+     * @brief Параметры потока событий.
+     */
+    EventStreamOptions options_;
+
+    /**
+     * @brief Синхронизация доступа к списку каналов.
+     */
+    std::mutex mutex_;
+
+    /**
+     * @brief Каналы циклов обработки событий.
+     */
+    std::vector<std::weak_ptr<Channel>> channels_;
+
+    /**
+     * @brief Количество подписчиков.
+     */
+    std::atomic<size_t> subscribers_{0};
+
+    /**
+     * @brief Идентификатор следующего события.
+     */
+    std::atomic<uint64_t> next_event_{1};
+};
+
+}  // namespace tasp
+
+#endif  // TASP_EVENT_STREAM_IMPL_HPP_
@@ -0,0 +1,127 @@
+#include "hash.hpp"
+
+#include <cstring>
+
+using std::string_view;
+
+namespace tasp
+{
+
+namespace
+{
+constexpr uint64_t prime1{0x9E3779B185EBCA87ULL};
+constexpr uint64_t prime2{0xC2B2AE3D27D4EB4FULL};
+constexpr uint64_t prime3{0x165667B19E3779F9ULL};
+constexpr uint64_t prime4{0x85EBCA77C2B2AE63ULL};
+constexpr uint64_t prime5{0x27D4EB2F165667C5ULL};
+
+//------------------------------------------------------------------------------
+uint64_t Rotl(uint64_t value, int bits) noexcept
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+//------------------------------------------------------------------------------
+uint64_t Read64(const char *data) noexcept
+{
+    uint64_t value{};
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+//------------------------------------------------------------------------------
+uint64_t Read32(const char *data) noexcept
+{
+    uint32_t value{};
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+//------------------------------------------------------------------------------
+uint64_t Round(uint64_t acc, uint64_t input) noexcept
+{
+    acc += input * prime2;
+    acc = Rotl(acc, 31);
+    return acc * prime1;
+}
+
+//------------------------------------------------------------------------------
+uint64_t MergeRound(uint64_t acc, uint64_t value) noexcept
+{
+    acc ^= Round(0, value);
+    return acc * prime1 + prime4;
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+uint64_t Hash64(string_view data, uint64_t seed) noexcept
+{
+    const char *pos{data.data()};
+    const char *const end{pos + data.size()};
+
+    uint64_t hash{};
+
+    if (data.size() >= 32)
+    {
+        uint64_t acc1{seed + prime1 + prime2};
+        uint64_t acc2{seed + prime2};
+        uint64_t acc3{seed};
+        uint64_t acc4{seed - prime1};
+
+        const char *const limit{end - 32};
+        do
+        {
+            // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            acc1 = Round(acc1, Read64(pos));
+            acc2 = Round(acc2, Read64(pos + 8));
+            acc3 = Round(acc3, Read64(pos + 16));
+            acc4 = Round(acc4, Read64(pos + 24));
+            pos += 32;
+            // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        } while (pos <= limit);
+
+        hash = Rotl(acc1, 1) + Rotl(acc2, 7) + Rotl(acc3, 12) + Rotl(acc4, 18);
+        hash = MergeRound(hash, acc1);
+        hash = MergeRound(hash, acc2);
+        hash = MergeRound(hash, acc3);
+        hash = MergeRound(hash, acc4);
+    }
+    else
+    {
+        hash = seed + prime5;
+    }
+
+    hash += data.size();
+
+    // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    for (; end - pos >= 8; pos += 8)
+    {
+        hash ^= Round(0, Read64(pos));
+        hash = Rotl(hash, 27) * prime1 + prime4;
+    }
+
+    if (end - pos >= 4)
+    {
+        hash ^= Read32(pos) * prime1;
+        hash = Rotl(hash, 23) * prime2 + prime3;
+        pos += 4;
+    }
+
+    for (; pos < end; pos++)
+    {
+        hash ^= static_cast<uint8_t>(*pos) * prime5;
+        hash = Rotl(hash, 11) * prime1;
+    }
+    // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+}  // namespace tasp
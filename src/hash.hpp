@@ -0,0 +1,30 @@
+/**
+ * @file
+ * @brief Некриптографическое хеширование данных.
+ */
+#ifndef TASP_HASH_HPP_
+#define TASP_HASH_HPP_
+
+#include <cstdint>
+#include <string_view>
+
+namespace tasp
+{
+
+/**
+ * @brief Вычисление 64-битного хеша по алгоритму XXH64.
+ *
+ * Данные обрабатываются четырьмя независимыми потоками по 8 байт, что
+ * позволяет процессору выполнять их параллельно.
+ *
+ * @param data Данные
+ * @param seed Начальное значение
+ *
+ * @return Хеш
+ */
+[[nodiscard]] uint64_t Hash64(std::string_view data,
+                              uint64_t seed = 0) noexcept;
+
+}  // namespace tasp
+
+#endif  // TASP_HASH_HPP_
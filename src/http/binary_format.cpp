@@ -0,0 +1,1218 @@
+#include "binary_format.hpp"
+
+#include <strings.h>
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "json_writer.hpp"
+
+using std::string;
+using std::string_view;
+
+namespace tasp::http
+{
+
+namespace
+{
+/**
+ * @brief Формат данных.
+ */
+using Format = BinaryFormat::Format;
+
+/**
+ * @brief Типы данных MessagePack, принимаемые наравне с основным.
+ */
+constexpr std::array<string_view, 3> msgpack_types{{"application/msgpack",
+                                                    "application/x-msgpack",
+                                                    "application/vnd.msgpack"}};
+
+//------------------------------------------------------------------------------
+string_view Trim(string_view str) noexcept
+{
+    const auto first{str.find_first_not_of(" \t")};
+    if (first == string_view::npos)
+    {
+        return {};
+    }
+
+    return str.substr(first, str.find_last_not_of(" \t") - first + 1);
+}
+
+//------------------------------------------------------------------------------
+bool EqualsNoCase(string_view lhs, string_view rhs) noexcept
+{
+    return lhs.size() == rhs.size() &&
+           strncasecmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+//------------------------------------------------------------------------------
+Format FromMediaType(string_view media) noexcept
+{
+    if (EqualsNoCase(media, BinaryFormat::cbor_type))
+    {
+        return Format::Cbor;
+    }
+
+    for (const auto type : msgpack_types)
+    {
+        if (EqualsNoCase(media, type))
+        {
+            return Format::MessagePack;
+        }
+    }
+
+    return Format::Json;
+}
+
+//------------------------------------------------------------------------------
+bool IsFloat(double value) noexcept
+{
+    const auto max{static_cast<double>(std::numeric_limits<float>::max())};
+    if (!std::isfinite(value) || std::abs(value) > max)
+    {
+        return false;
+    }
+
+    // число без потерь представимо в float, если двоичное представление не
+    // изменяется после обратного преобразования
+    const auto widened{static_cast<double>(static_cast<float>(value))};
+
+    uint64_t original{0};
+    uint64_t restored{0};
+    std::memcpy(&original, &value, sizeof(original));
+    std::memcpy(&restored, &widened, sizeof(restored));
+    return original == restored;
+}
+
+/*------------------------------------------------------------------------------
+    Encoder
+------------------------------------------------------------------------------*/
+/**
+ * @brief Запись данных в двоичном формате непосредственно в буфер libevent.
+ */
+class Encoder final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param output Буфер
+     */
+    explicit Encoder(evbuffer *output) noexcept
+    : buffer_(output)
+    {
+    }
+
+    /**
+     * @brief Запись значения в формате CBOR.
+     *
+     * @param value Значение
+     */
+    void Cbor(const Json::Value &value) noexcept
+    {
+        switch (value.type())
+        {
+            case Json::nullValue:
+                Byte(0xf6);
+                break;
+            case Json::booleanValue:
+                Byte(value.asBool() ? 0xf5 : 0xf4);
+                break;
+            case Json::intValue:
+            {
+                const auto number{value.asInt64()};
+                if (number >= 0)
+                {
+                    CborHead(0, static_cast<uint64_t>(number));
+                }
+                else
+                {
+                    CborHead(1, static_cast<uint64_t>(-(number + 1)));
+                }
+                break;
+            }
+            case Json::uintValue:
+                CborHead(0, value.asUInt64());
+                break;
+            case Json::realValue:
+            {
+                const double number{value.asDouble()};
+                if (IsFloat(number))
+                {
+                    Byte(0xfa);
+                    Float(static_cast<float>(number));
+                }
+                else
+                {
+                    Byte(0xfb);
+                    Double(number);
+                }
+                break;
+            }
+            case Json::stringValue:
+            {
+                const char *begin{nullptr};
+                const char *end{nullptr};
+                value.getString(&begin, &end);
+                CborHead(3, static_cast<uint64_t>(end - begin));
+                Bytes(begin, end);
+                break;
+            }
+            case Json::arrayValue:
+                CborHead(4, value.size());
+                for (const auto &item : value)
+                {
+                    Cbor(item);
+                }
+                break;
+            case Json::objectValue:
+                CborHead(5, value.size());
+                for (auto it = value.begin(); it != value.end(); ++it)
+                {
+                    const char *end{nullptr};
+                    const char *begin{it.memberName(&end)};
+                    CborHead(3, static_cast<uint64_t>(end - begin));
+                    Bytes(begin, end);
+                    Cbor(*it);
+                }
+                break;
+        }
+    }
+
+    /**
+     * @brief Запись значения в формате MessagePack.
+     *
+     * @param value Значение
+     */
+    void MessagePack(const Json::Value &value) noexcept
+    {
+        switch (value.type())
+        {
+            case Json::nullValue:
+                Byte(0xc0);
+                break;
+            case Json::booleanValue:
+                Byte(value.asBool() ? 0xc3 : 0xc2);
+                break;
+            case Json::intValue:
+                MessagePackInt(value.asInt64());
+                break;
+            case Json::uintValue:
+                MessagePackUInt(value.asUInt64());
+                break;
+            case Json::realValue:
+            {
+                const double number{value.asDouble()};
+                if (IsFloat(number))
+                {
+                    Byte(0xca);
+                    Float(static_cast<float>(number));
+                }
+                else
+                {
+                    Byte(0xcb);
+                    Double(number);
+                }
+                break;
+            }
+            case Json::stringValue:
+            {
+                const char *begin{nullptr};
+                const char *end{nullptr};
+                value.getString(&begin, &end);
+                MessagePackString(begin, end);
+                break;
+            }
+            case Json::arrayValue:
+                MessagePackHead(0x90, 0xdc, value.size());
+                for (const auto &item : value)
+                {
+                    MessagePack(item);
+                }
+                break;
+            case Json::objectValue:
+                MessagePackHead(0x80, 0xde, value.size());
+                for (auto it = value.begin(); it != value.end(); ++it)
+                {
+                    const char *end{nullptr};
+                    const char *begin{it.memberName(&end)};
+                    MessagePackString(begin, end);
+                    MessagePack(*it);
+                }
+                break;
+        }
+    }
+
+private:
+    /**
+     * @brief Запись заголовка элемента CBOR: основного типа и аргумента.
+     *
+     * @param major Основной тип
+     * @param argument Аргумент (значение или длина)
+     */
+    void CborHead(uint8_t major, uint64_t argument) noexcept
+    {
+        const auto type{static_cast<uint8_t>(major << 5U)};
+        if (argument < 24)
+        {
+            Byte(static_cast<uint8_t>(type | argument));
+        }
+        else if (argument <= 0xff)
+        {
+            Byte(type | 24U);
+            BigEndian<uint8_t>(argument);
+        }
+        else if (argument <= 0xffff)
+        {
+            Byte(type | 25U);
+            BigEndian<uint16_t>(argument);
+        }
+        else if (argument <= 0xffffffff)
+        {
+            Byte(type | 26U);
+            BigEndian<uint32_t>(argument);
+        }
+        else
+        {
+            Byte(type | 27U);
+            BigEndian<uint64_t>(argument);
+        }
+    }
+
+    /**
+     * @brief Запись заголовка массива или объекта MessagePack.
+     *
+     * @param fix Код короткой формы (до 15 элементов)
+     * @param code Код формы с 16-разрядной длиной, следующий код - с
+     * 32-разрядной
+     * @param size Количество элементов
+     */
+    void MessagePackHead(uint8_t fix, uint8_t code, uint64_t size) noexcept
+    {
+        if (size < 16)
+        {
+            Byte(static_cast<uint8_t>(fix | size));
+        }
+        else if (size <= 0xffff)
+        {
+            Byte(code);
+            BigEndian<uint16_t>(size);
+        }
+        else
+        {
+            Byte(static_cast<uint8_t>(code + 1));
+            BigEndian<uint32_t>(size);
+        }
+    }
+
+    /**
+     * @brief Запись строки MessagePack.
+     *
+     * @param begin Начало строки
+     * @param end Конец строки
+     */
+    void MessagePackString(const char *begin, const char *end) noexcept
+    {
+        const auto size{static_cast<uint64_t>(end - begin)};
+        if (size < 32)
+        {
+            Byte(static_cast<uint8_t>(0xa0U | size));
+        }
+        else if (size <= 0xff)
+        {
+            Byte(0xd9);
+            BigEndian<uint8_t>(size);
+        }
+        else if (size <= 0xffff)
+        {
+            Byte(0xda);
+            BigEndian<uint16_t>(size);
+        }
+        else
+        {
+            Byte(0xdb);
+            BigEndian<uint32_t>(size);
+        }
+        Bytes(begin, end);
+    }
+
+    /**
+     * @brief Запись целого без знака MessagePack в наименьшей форме.
+     *
+     * @param number Число
+     */
+    void MessagePackUInt(uint64_t number) noexcept
+    {
+        if (number < 128)
+        {
+            Byte(static_cast<uint8_t>(number));
+        }
+        else if (number <= 0xff)
+        {
+            Byte(0xcc);
+            BigEndian<uint8_t>(number);
+        }
+        else if (number <= 0xffff)
+        {
+            Byte(0xcd);
+            BigEndian<uint16_t>(number);
+        }
+        else if (number <= 0xffffffff)
+        {
+            Byte(0xce);
+            BigEndian<uint32_t>(number);
+        }
+        else
+        {
+            Byte(0xcf);
+            BigEndian<uint64_t>(number);
+        }
+    }
+
+    /**
+     * @brief Запись целого со знаком MessagePack в наименьшей форме.
+     *
+     * @param number Число
+     */
+    void MessagePackInt(int64_t number) noexcept
+    {
+        if (number >= 0)
+        {
+            MessagePackUInt(static_cast<uint64_t>(number));
+            return;
+        }
+
+        const auto bits{static_cast<uint64_t>(number)};
+        if (number >= -32)
+        {
+            Byte(static_cast<uint8_t>(bits));
+        }
+        else if (number >= std::numeric_limits<int8_t>::min())
+        {
+            Byte(0xd0);
+            BigEndian<uint8_t>(bits);
+        }
+        else if (number >= std::numeric_limits<int16_t>::min())
+        {
+            Byte(0xd1);
+            BigEndian<uint16_t>(bits);
+        }
+        else if (number >= std::numeric_limits<int32_t>::min())
+        {
+            Byte(0xd2);
+            BigEndian<uint32_t>(bits);
+        }
+        else
+        {
+            Byte(0xd3);
+            BigEndian<uint64_t>(bits);
+        }
+    }
+
+    /**
+     * @brief Запись числа с плавающей точкой одинарной точности.
+     *
+     * @param number Число
+     */
+    void Float(float number) noexcept
+    {
+        uint32_t bits{0};
+        std::memcpy(&bits, &number, sizeof(bits));
+        BigEndian<uint32_t>(bits);
+    }
+
+    /**
+     * @brief Запись числа с плавающей точкой двойной точности.
+     *
+     * @param number Число
+     */
+    void Double(double number) noexcept
+    {
+        uint64_t bits{0};
+        std::memcpy(&bits, &number, sizeof(bits));
+        BigEndian<uint64_t>(bits);
+    }
+
+    /**
+     * @brief Запись младших разрядов числа в сетевом порядке байтов.
+     *
+     * @tparam Type Тип, определяющий количество записываемых байтов
+     * @param number Число
+     */
+    template<typename Type>
+    void BigEndian(uint64_t number) noexcept
+    {
+        std::array<char, sizeof(Type)> bytes{};
+        for (size_t i = sizeof(Type); i > 0; i--)
+        {
+            bytes[i - 1] = static_cast<char>(number & 0xffU);
+            number >>= 8U;
+        }
+        buffer_.sputn(bytes.data(), bytes.size());
+    }
+
+    /**
+     * @brief Запись байта.
+     *
+     * @param byte Байт
+     */
+    void Byte(unsigned int byte) noexcept
+    {
+        buffer_.sputc(static_cast<char>(byte));
+    }
+
+    /**
+     * @brief Запись последовательности байтов.
+     *
+     * @param begin Начало
+     * @param end Конец
+     */
+    void Bytes(const char *begin, const char *end) noexcept
+    {
+        buffer_.sputn(begin, end - begin);
+    }
+
+    /**
+     * @brief Поток записи в буфер libevent.
+     */
+    EvBufferStreamBuf buffer_;
+};
+
+/*------------------------------------------------------------------------------
+    Decoder
+------------------------------------------------------------------------------*/
+/**
+ * @brief Разбор данных в двоичном формате с проверкой границ и вложенности.
+ */
+class Decoder final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param data Данные
+     * @param max_depth Максимальная глубина вложенности
+     */
+    Decoder(string_view data, size_t max_depth) noexcept
+    : pos_(data.data())
+    , end_(data.data() + data.size())
+    , max_depth_(max_depth)
+    {
+    }
+
+    /**
+     * @brief Разбор данных CBOR.
+     *
+     * @param value Результат разбора
+     *
+     * @return Признак успешного разбора всех данных
+     */
+    bool ReadCbor(Json::Value &value) noexcept
+    {
+        return Cbor(value, 0) && pos_ == end_;
+    }
+
+    /**
+     * @brief Разбор данных MessagePack.
+     *
+     * @param value Результат разбора
+     *
+     * @return Признак успешного разбора всех данных
+     */
+    bool ReadMessagePack(Json::Value &value) noexcept
+    {
+        return MessagePack(value, 0) && pos_ == end_;
+    }
+
+private:
+    /**
+     * @brief Разбор элемента CBOR.
+     *
+     * Строки неопределённой длины не поддерживаются, байтовые строки
+     * разбираются как строки, теги пропускаются.
+     *
+     * @param value Результат разбора
+     * @param depth Глубина вложенности элемента
+     *
+     * @return Признак успешного разбора
+     */
+    bool Cbor(Json::Value &value, size_t depth) noexcept
+    {
+        uint8_t initial{0};
+        if (!Byte(initial))
+        {
+            return false;
+        }
+
+        const auto major{static_cast<uint8_t>(initial >> 5U)};
+        const auto info{static_cast<uint8_t>(initial & 0x1fU)};
+
+        if (major == 7)
+        {
+            return CborSimple(info, value);
+        }
+
+        uint64_t argument{0};
+        if (!CborArgument(info, argument))
+        {
+            return false;
+        }
+
+        switch (major)
+        {
+            case 0:
+                value = argument <= max_int64
+                            ? Json::Value(static_cast<Json::Int64>(argument))
+                            : Json::Value(static_cast<Json::UInt64>(argument));
+                return true;
+            case 1:
+                if (argument > max_int64)
+                {
+                    return false;
+                }
+                value = Json::Value(-1 - static_cast<Json::Int64>(argument));
+                return true;
+            case 2:
+            case 3:
+                return String(argument, value);
+            case 4:
+                return CborArray(argument, value, depth);
+            case 5:
+                return CborObject(argument, value, depth);
+            default:
+                // тег не влияет на значение
+                return depth < max_depth_ && Cbor(value, depth + 1);
+        }
+    }
+
+    /**
+     * @brief Разбор аргумента элемента CBOR.
+     *
+     * @param info Дополнительная информация начального байта
+     * @param argument Аргумент
+     *
+     * @return Признак успешного разбора
+     */
+    bool CborArgument(uint8_t info, uint64_t &argument) noexcept
+    {
+        if (info < 24)
+        {
+            argument = info;
+            return true;
+        }
+
+        switch (info)
+        {
+            case 24:
+                return BigEndian(1, argument);
+            case 25:
+                return BigEndian(2, argument);
+            case 26:
+                return BigEndian(4, argument);
+            case 27:
+                return BigEndian(8, argument);
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * @brief Разбор простого значения или числа с плавающей точкой CBOR.
+     *
+     * @param info Дополнительная информация начального байта
+     * @param value Результат разбора
+     *
+     * @return Признак успешного разбора
+     */
+    bool CborSimple(uint8_t info, Json::Value &value) noexcept
+    {
+        uint64_t bits{0};
+        switch (info)
+        {
+            case 20:
+            case 21:
+                value = Json::Value(info == 21);
+                return true;
+            case 22:
+            case 23:
+                value = Json::Value(Json::nullValue);
+                return true;
+            case 25:
+                if (!BigEndian(2, bits))
+                {
+                    return false;
+                }
+                value = Json::Value(Half(static_cast<uint16_t>(bits)));
+                return true;
+            case 26:
+                if (!BigEndian(4, bits))
+                {
+                    return false;
+                }
+                value = Json::Value(static_cast<double>(
+                    BitCast<float>(static_cast<uint32_t>(bits))));
+                return true;
+            case 27:
+                if (!BigEndian(8, bits))
+                {
+                    return false;
+                }
+                value = Json::Value(BitCast<double>(bits));
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * @brief Разбор массива CBOR.
+     *
+     * @param size Количество элементов
+     * @param value Результат разбора
+     * @param depth Глубина вложенности массива
+     *
+     * @return Признак успешного разбора
+     */
+    bool CborArray(uint64_t size, Json::Value &value, size_t depth) noexcept
+    {
+        if (!Container(size, depth))
+        {
+            return false;
+        }
+
+        value = Json::Value(Json::arrayValue);
+        value.resize(static_cast<Json::ArrayIndex>(size));
+        for (Json::ArrayIndex i = 0; i < size; i++)
+        {
+            if (!Cbor(value[i], depth + 1))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Разбор объекта CBOR. Ключи должны быть строками или целыми
+     * числами.
+     *
+     * @param size Количество элементов
+     * @param value Результат разбора
+     * @param depth Глубина вложенности объекта
+     *
+     * @return Признак успешного разбора
+     */
+    bool CborObject(uint64_t size, Json::Value &value, size_t depth) noexcept
+    {
+        if (!Container(size, depth))
+        {
+            return false;
+        }
+
+        value = Json::Value(Json::objectValue);
+        for (uint64_t i = 0; i < size; i++)
+        {
+            Json::Value key;
+            if (!Cbor(key, depth + 1) || !Key(key))
+            {
+                return false;
+            }
+
+            if (!Cbor(value[key.asString()], depth + 1))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Разбор элемента MessagePack.
+     *
+     * @param value Результат разбора
+     * @param depth Глубина вложенности элемента
+     *
+     * @return Признак успешного разбора
+     */
+    bool MessagePack(Json::Value &value, size_t depth) noexcept
+    {
+        uint8_t code{0};
+        if (!Byte(code))
+        {
+            return false;
+        }
+
+        if (code <= 0x7f)
+        {
+            value = Json::Value(static_cast<Json::Int64>(code));
+            return true;
+        }
+        if (code >= 0xe0)
+        {
+            value = Json::Value(static_cast<Json::Int64>(
+                static_cast<int8_t>(code)));
+            return true;
+        }
+        if (code >= 0xa0 && code <= 0xbf)
+        {
+            return String(code & 0x1fU, value);
+        }
+        if (code >= 0x90 && code <= 0x9f)
+        {
+            return MessagePackArray(code & 0x0fU, value, depth);
+        }
+        if (code >= 0x80 && code <= 0x8f)
+        {
+            return MessagePackObject(code & 0x0fU, value, depth);
+        }
+
+        uint64_t argument{0};
+        switch (code)
+        {
+            case 0xc0:
+                value = Json::Value(Json::nullValue);
+                return true;
+            case 0xc2:
+            case 0xc3:
+                value = Json::Value(code == 0xc3);
+                return true;
+            case 0xca:
+                if (!BigEndian(4, argument))
+                {
+                    return false;
+                }
+                value = Json::Value(static_cast<double>(
+                    BitCast<float>(static_cast<uint32_t>(argument))));
+                return true;
+            case 0xcb:
+                if (!BigEndian(8, argument))
+                {
+                    return false;
+                }
+                value = Json::Value(BitCast<double>(argument));
+                return true;
+            case 0xcc:
+            case 0xcd:
+            case 0xce:
+            case 0xcf:
+                if (!BigEndian(size_t{1} << (code - 0xccU), argument))
+                {
+                    return false;
+                }
+                value = argument <= max_int64
+                            ? Json::Value(static_cast<Json::Int64>(argument))
+                            : Json::Value(static_cast<Json::UInt64>(argument));
+                return true;
+            case 0xd0:
+            case 0xd1:
+            case 0xd2:
+            case 0xd3:
+                return MessagePackSigned(size_t{1} << (code - 0xd0U), value);
+            case 0xc4:
+            case 0xd9:
+                return BigEndian(1, argument) && String(argument, value);
+            case 0xc5:
+            case 0xda:
+                return BigEndian(2, argument) && String(argument, value);
+            case 0xc6:
+            case 0xdb:
+                return BigEndian(4, argument) && String(argument, value);
+            case 0xdc:
+                return BigEndian(2, argument) &&
+                       MessagePackArray(argument, value, depth);
+            case 0xdd:
+                return BigEndian(4, argument) &&
+                       MessagePackArray(argument, value, depth);
+            case 0xde:
+                return BigEndian(2, argument) &&
+                       MessagePackObject(argument, value, depth);
+            case 0xdf:
+                return BigEndian(4, argument) &&
+                       MessagePackObject(argument, value, depth);
+            default:
+                // расширения не имеют представления в JSON
+                return false;
+        }
+    }
+
+    /**
+     * @brief Разбор целого со знаком MessagePack.
+     *
+     * @param bytes Размер числа в байтах
+     * @param value Результат разбора
+     *
+     * @return Признак успешного разбора
+     */
+    bool MessagePackSigned(size_t bytes, Json::Value &value) noexcept
+    {
+        uint64_t bits{0};
+        if (!BigEndian(bytes, bits))
+        {
+            return false;
+        }
+
+        // расширение знака
+        const size_t shift{64 - bytes * 8};
+        const auto number{static_cast<int64_t>(bits << shift) >>
+                          static_cast<int64_t>(shift)};
+        value = Json::Value(static_cast<Json::Int64>(number));
+        return true;
+    }
+
+    /**
+     * @brief Разбор массива MessagePack.
+     *
+     * @param size Количество элементов
+     * @param value Результат разбора
+     * @param depth Глубина вложенности массива
+     *
+     * @return Признак успешного разбора
+     */
+    bool MessagePackArray(uint64_t size,
+                          Json::Value &value,
+                          size_t depth) noexcept
+    {
+        if (!Container(size, depth))
+        {
+            return false;
+        }
+
+        value = Json::Value(Json::arrayValue);
+        value.resize(static_cast<Json::ArrayIndex>(size));
+        for (Json::ArrayIndex i = 0; i < size; i++)
+        {
+            if (!MessagePack(value[i], depth + 1))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Разбор объекта MessagePack. Ключи должны быть строками или
+     * целыми числами.
+     *
+     * @param size Количество элементов
+     * @param value Результат разбора
+     * @param depth Глубина вложенности объекта
+     *
+     * @return Признак успешного разбора
+     */
+    bool MessagePackObject(uint64_t size,
+                           Json::Value &value,
+                           size_t depth) noexcept
+    {
+        if (!Container(size, depth))
+        {
+            return false;
+        }
+
+        value = Json::Value(Json::objectValue);
+        for (uint64_t i = 0; i < size; i++)
+        {
+            Json::Value key;
+            if (!MessagePack(key, depth + 1) || !Key(key))
+            {
+                return false;
+            }
+
+            if (!MessagePack(value[key.asString()], depth + 1))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Проверка массива или объекта: глубины вложенности и количества
+     * элементов, которое не может превышать количество оставшихся байтов.
+     *
+     * @param size Количество элементов
+     * @param depth Глубина вложенности
+     *
+     * @return Признак допустимости
+     */
+    [[nodiscard]] bool Container(uint64_t size, size_t depth) const noexcept
+    {
+        return depth < max_depth_ &&
+               size <= static_cast<uint64_t>(end_ - pos_);
+    }
+
+    /**
+     * @brief Проверка ключа объекта.
+     *
+     * @param key Ключ
+     *
+     * @return Признак допустимости
+     */
+    static bool Key(const Json::Value &key) noexcept
+    {
+        return key.isString() || key.isIntegral();
+    }
+
+    /**
+     * @brief Разбор строки.
+     *
+     * @param size Длина строки
+     * @param value Результат разбора
+     *
+     * @return Признак успешного разбора
+     */
+    bool String(uint64_t size, Json::Value &value) noexcept
+    {
+        if (size > static_cast<uint64_t>(end_ - pos_))
+        {
+            return false;
+        }
+
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        value = Json::Value(pos_, pos_ + size);
+        pos_ += size;
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return true;
+    }
+
+    /**
+     * @brief Чтение байта.
+     *
+     * @param byte Байт
+     *
+     * @return Признак наличия данных
+     */
+    bool Byte(uint8_t &byte) noexcept
+    {
+        if (pos_ == end_)
+        {
+            return false;
+        }
+
+        byte = static_cast<uint8_t>(*pos_);
+        pos_++;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return true;
+    }
+
+    /**
+     * @brief Чтение числа в сетевом порядке байтов.
+     *
+     * @param bytes Размер числа в байтах
+     * @param number Число
+     *
+     * @return Признак наличия данных
+     */
+    bool BigEndian(size_t bytes, uint64_t &number) noexcept
+    {
+        if (bytes > static_cast<size_t>(end_ - pos_))
+        {
+            return false;
+        }
+
+        number = 0;
+        for (size_t i = 0; i < bytes; i++)
+        {
+            number = (number << 8U) | static_cast<uint8_t>(*pos_);
+            pos_++;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+        return true;
+    }
+
+    /**
+     * @brief Преобразование числа с плавающей точкой половинной точности.
+     *
+     * @param bits Двоичное представление
+     *
+     * @return Число
+     */
+    static double Half(uint16_t bits) noexcept
+    {
+        const int exponent{(bits >> 10U) & 0x1f};
+        const double mantissa{static_cast<double>(bits & 0x3ffU)};
+
+        double number{0};
+        if (exponent == 0)
+        {
+            number = std::ldexp(mantissa, -24);
+        }
+        else if (exponent != 31)
+        {
+            number = std::ldexp(mantissa + 1024, exponent - 25);
+        }
+        else
+        {
+            number = (bits & 0x3ffU) == 0
+                         ? std::numeric_limits<double>::infinity()
+                         : std::numeric_limits<double>::quiet_NaN();
+        }
+
+        return (bits & 0x8000U) != 0 ? -number : number;
+    }
+
+    /**
+     * @brief Преобразование двоичного представления в число.
+     *
+     * @tparam Type Тип числа
+     * @tparam Bits Тип двоичного представления
+     * @param bits Двоичное представление
+     *
+     * @return Число
+     */
+    template<typename Type, typename Bits>
+    static Type BitCast(Bits bits) noexcept
+    {
+        static_assert(sizeof(Type) == sizeof(Bits));
+        Type number{};
+        std::memcpy(&number, &bits, sizeof(number));
+        return number;
+    }
+
+    /**
+     * @brief Наибольшее значение Json::Int64.
+     */
+    static constexpr auto max_int64{
+        static_cast<uint64_t>(std::numeric_limits<Json::Int64>::max())};
+
+    /**
+     * @brief Текущая позиция.
+     */
+    const char *pos_;
+
+    /**
+     * @brief Конец данных.
+     */
+    const char *end_;
+
+    /**
+     * @brief Максимальная глубина вложенности.
+     */
+    size_t max_depth_;
+};
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    BinaryFormat
+------------------------------------------------------------------------------*/
+BinaryFormat::Format BinaryFormat::FromContentType(
+    string_view content_type) noexcept
+{
+    return FromMediaType(Trim(content_type.substr(0, content_type.find(';'))));
+}
+
+//------------------------------------------------------------------------------
+BinaryFormat::Format BinaryFormat::Negotiate(string_view accept) noexcept
+{
+    if (accept.empty())
+    {
+        return Format::Json;
+    }
+
+    // JSON выбирается по умолчанию, двоичный формат - только с большим
+    // приоритетом
+    double json_quality{0};
+    double best_quality{0};
+    Format best{Format::Json};
+
+    while (!accept.empty())
+    {
+        const auto comma{accept.find(',')};
+        string_view item{accept.substr(0, comma)};
+        accept.remove_prefix(comma == string_view::npos ? accept.size()
+                                                        : comma + 1);
+
+        double quality{1};
+
+        const auto params{item.find(';')};
+        if (params != string_view::npos)
+        {
+            const string_view param{Trim(item.substr(params + 1))};
+            if (param.substr(0, 2) == "q=")
+            {
+                const string value{param.substr(2)};
+                quality = std::strtod(value.c_str(), nullptr);
+            }
+            item = item.substr(0, params);
+        }
+
+        const string_view media{Trim(item)};
+        const auto format{FromMediaType(media)};
+        if (format != Format::Json)
+        {
+            if (quality > best_quality)
+            {
+                best = format;
+                best_quality = quality;
+            }
+        }
+        else if (EqualsNoCase(media, JsonWriter::type) || media == "*/*" ||
+                 EqualsNoCase(media, "application/*"))
+        {
+            json_quality = std::max(json_quality, quality);
+        }
+    }
+
+    return best_quality > json_quality ? best : Format::Json;
+}
+
+//------------------------------------------------------------------------------
+string_view BinaryFormat::Type(Format format) noexcept
+{
+    switch (format)
+    {
+        case Format::Cbor:
+            return cbor_type;
+        case Format::MessagePack:
+            return msgpack_type;
+        default:
+            return JsonWriter::type;
+    }
+}
+
+//------------------------------------------------------------------------------
+void BinaryFormat::Write(Format format,
+                         const Json::Value &value,
+                         evbuffer *output) noexcept
+{
+    Encoder encoder(output);
+    if (format == Format::Cbor)
+    {
+        encoder.Cbor(value);
+    }
+    else
+    {
+        encoder.MessagePack(value);
+    }
+}
+
+//------------------------------------------------------------------------------
+JsonReader::Result BinaryFormat::Read(Format format,
+                                      string_view data,
+                                      Json::Value &value,
+                                      string &errors) noexcept
+{
+    const auto &settings{JsonReader::GetSettings()};
+    if (data.size() > settings.max_size)
+    {
+        errors = "Превышен допустимый размер данных";
+        return JsonReader::Result::TooLarge;
+    }
+
+    Decoder decoder(data, settings.max_depth);
+
+    const bool valid{format == Format::Cbor ? decoder.ReadCbor(value)
+                                            : decoder.ReadMessagePack(value)};
+    if (!valid)
+    {
+        errors = "Некорректные данные в формате ";
+        errors += format == Format::Cbor ? "CBOR" : "MessagePack";
+        return JsonReader::Result::Invalid;
+    }
+
+    return JsonReader::Result::Ok;
+}
+
+}  // namespace tasp::http
@@ -0,0 +1,110 @@
+/**
+ * @file
+ * @brief Двоичные форматы данных CBOR и MessagePack.
+ */
+#ifndef TASP_HTTP_BINARY_FORMAT_HPP_
+#define TASP_HTTP_BINARY_FORMAT_HPP_
+
+#include <event2/buffer.h>
+#include <jsoncpp/json/json.h>
+
+#include <string>
+#include <string_view>
+
+#include "json_reader.hpp"
+
+namespace tasp::http
+{
+
+/**
+ * @brief Преобразование данных Json::Value в двоичные форматы CBOR
+ * (RFC 8949) и MessagePack и обратно.
+ *
+ * Формат ответа выбирается по заголовку Accept запроса, формат данных
+ * запроса - по заголовку Content-Type. Двоичные форматы содержат те же
+ * значения, что и JSON: null, логические, целые, вещественные, строки,
+ * массивы и объекты со строковыми ключами. При разборе действуют ограничения
+ * JsonReader на размер и вложенность.
+ */
+class BinaryFormat final
+{
+public:
+    /**
+     * @brief Формат данных.
+     */
+    enum class Format
+    {
+        Json,
+        Cbor,
+        MessagePack
+    };
+
+    /**
+     * @brief Тип данных CBOR.
+     */
+    static constexpr std::string_view cbor_type{"application/cbor"};
+
+    /**
+     * @brief Тип данных MessagePack.
+     */
+    static constexpr std::string_view msgpack_type{"application/msgpack"};
+
+    /**
+     * @brief Определение формата данных по заголовку Content-Type.
+     *
+     * @param content_type Значение заголовка Content-Type
+     *
+     * @return Формат данных
+     */
+    [[nodiscard]] static Format FromContentType(
+        std::string_view content_type) noexcept;
+
+    /**
+     * @brief Выбор формата ответа по заголовку Accept. Двоичный формат
+     * выбирается, только если клиент предпочитает его формату JSON.
+     *
+     * @param accept Значение заголовка Accept
+     *
+     * @return Формат данных
+     */
+    [[nodiscard]] static Format Negotiate(std::string_view accept) noexcept;
+
+    /**
+     * @brief Запрос типа данных формата.
+     *
+     * @param format Формат данных
+     *
+     * @return Тип данных
+     */
+    [[nodiscard]] static std::string_view Type(Format format) noexcept;
+
+    /**
+     * @brief Запись данных в двоичном формате непосредственно в буфер.
+     *
+     * @param format Формат данных (Cbor или MessagePack)
+     * @param value Данные
+     * @param output Буфер
+     */
+    static void Write(Format format,
+                      const Json::Value &value,
+                      evbuffer *output) noexcept;
+
+    /**
+     * @brief Разбор данных в двоичном формате.
+     *
+     * @param format Формат данных (Cbor или MessagePack)
+     * @param data Данные
+     * @param value Результат разбора
+     * @param errors Описание ошибок разбора
+     *
+     * @return Результат разбора
+     */
+    [[nodiscard]] static JsonReader::Result Read(Format format,
+                                                 std::string_view data,
+                                                 Json::Value &value,
+                                                 std::string &errors) noexcept;
+};
+
+}  // namespace tasp::http
+
+#endif  // TASP_HTTP_BINARY_FORMAT_HPP_
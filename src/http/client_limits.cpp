@@ -0,0 +1,642 @@
+#include "client_limits.hpp"
+
+#include <event2/event.h>
+
+#include <algorithm>
+#include <array>
+
+#include <tasp/logging.hpp>
+
+using std::make_unique;
+using std::chrono::duration;
+
+namespace tasp::http
+{
+
+namespace
+{
+/**
+ * @brief Защита подключений цикла обработки событий текущего потока.
+ */
+thread_local ClientLimits *current{nullptr};
+
+/**
+ * @brief Период проверки подключений.
+ */
+constexpr timeval tick_interval{1, 0};
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    ClientLimits::Guard
+------------------------------------------------------------------------------*/
+/**
+ * @brief Защита одного подключения.
+ */
+class ClientLimits::Guard final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param limits Защита подключений
+     * @param bev Буфер подключения
+     */
+    Guard(ClientLimits &limits, bufferevent *bev) noexcept
+    : limits_(limits)
+    , bev_(bev)
+    , timer_(evtimer_new(limits.base_, &Guard::OnTick, this))
+    , input_(
+          evbuffer_add_cb(bufferevent_get_input(bev), &Guard::OnInput, this))
+    , output_(
+          evbuffer_add_cb(bufferevent_get_output(bev), &Guard::OnOutput, this))
+    {
+    }
+
+    /**
+     * @brief Деструктор.
+     */
+    ~Guard() noexcept
+    {
+        event_free(timer_);
+    }
+
+    /**
+     * @brief Отметка об установке функции обратного вызова закрытия
+     * подключения.
+     */
+    void Attach() noexcept
+    {
+        attached_ = true;
+    }
+
+    /**
+     * @brief Запрос признака установки функции обратного вызова закрытия
+     * подключения.
+     *
+     * @return Признак установки
+     */
+    [[nodiscard]] bool Attached() const noexcept
+    {
+        return attached_;
+    }
+
+    /**
+     * @brief Установка функции обратного вызова закрытия подключения.
+     *
+     * @param callback Функция обратного вызова
+     * @param arg Аргумент функции обратного вызова
+     */
+    void SetCloseCallback(CloseCallback callback, void *arg) noexcept
+    {
+        close_callback_ = callback;
+        close_arg_ = arg;
+    }
+
+    /**
+     * @brief Завершение чтения запроса.
+     */
+    void Dispatched() noexcept
+    {
+        phase_ = Phase::Idle;
+    }
+
+    /**
+     * @brief Прекращение контроля подключения.
+     */
+    void Release() noexcept
+    {
+        released_ = true;
+        phase_ = Phase::Idle;
+        writing_ = false;
+        evtimer_del(timer_);
+    }
+
+    /**
+     * @brief Закрытие подключения: отключение от буферов подключения и вызов
+     * функции обратного вызова закрытия.
+     *
+     * @param connection Подключение
+     */
+    void Close(evhttp_connection *connection) noexcept
+    {
+        evbuffer_remove_cb_entry(bufferevent_get_input(bev_), input_);
+        evbuffer_remove_cb_entry(bufferevent_get_output(bev_), output_);
+
+        if (close_callback_ != nullptr)
+        {
+            close_callback_(connection, close_arg_);
+        }
+    }
+
+    Guard(const Guard &) = delete;
+    Guard(Guard &&) = delete;
+    Guard &operator=(const Guard &) = delete;
+    Guard &operator=(Guard &&) = delete;
+
+private:
+    /**
+     * @brief Этап чтения запроса.
+     */
+    enum class Phase
+    {
+        Idle,
+        Header,
+        Body
+    };
+
+    /**
+     * @brief Передача данных за интервал оценки скорости.
+     */
+    struct Rate
+    {
+        /**
+         * @brief Начало интервала.
+         */
+        Clock::time_point since;
+
+        /**
+         * @brief Объём данных, переданных с начала интервала.
+         */
+        size_t bytes{0};
+    };
+
+    /**
+     * @brief Функция обратного вызова изменения буфера ввода.
+     *
+     * @param buffer Буфер ввода
+     * @param info Изменение буфера
+     * @param arg Указатель на защиту подключения
+     */
+    static void OnInput(evbuffer *buffer,
+                        const evbuffer_cb_info *info,
+                        void *arg) noexcept
+    {
+        auto *guard{static_cast<Guard *>(arg)};
+        if (info->n_added == 0 || guard->released_)
+        {
+            return;
+        }
+
+        if (guard->phase_ == Phase::Idle)
+        {
+            guard->Start(Phase::Header);
+            guard->blank_ = false;
+        }
+
+        if (guard->phase_ == Phase::Body)
+        {
+            guard->read_.bytes += info->n_added;
+            return;
+        }
+
+        size_t rest{0};
+        if (guard->ScanHeader(buffer, info->n_added, rest))
+        {
+            guard->Start(Phase::Body);
+            guard->read_.bytes = rest;
+        }
+    }
+
+    /**
+     * @brief Функция обратного вызова изменения буфера вывода.
+     *
+     * @param buffer Буфер вывода
+     * @param info Изменение буфера
+     * @param arg Указатель на защиту подключения
+     */
+    static void OnOutput(evbuffer *buffer,
+                         const evbuffer_cb_info *info,
+                         void *arg) noexcept
+    {
+        auto *guard{static_cast<Guard *>(arg)};
+        if (guard->released_)
+        {
+            return;
+        }
+
+        guard->write_.bytes += info->n_deleted;
+
+        if (evbuffer_get_length(buffer) == 0)
+        {
+            guard->writing_ = false;
+            return;
+        }
+
+        if (!guard->writing_)
+        {
+            guard->writing_ = true;
+            guard->write_ = Rate{Clock::now(), 0};
+            guard->Schedule();
+        }
+    }
+
+    /**
+     * @brief Функция обратного вызова таймера проверки подключения.
+     *
+     * @param arg Указатель на защиту подключения
+     */
+    static void OnTick(evutil_socket_t, short, void *arg) noexcept
+    {
+        auto *guard{static_cast<Guard *>(arg)};
+        const auto &settings{guard->limits_.settings_};
+        const auto now{Clock::now()};
+        const auto elapsed{now - guard->start_};
+
+        if (guard->phase_ == Phase::Header &&
+            elapsed > settings.header_timeout)
+        {
+            guard->Expire(BEV_EVENT_READING,
+                          "превышено время чтения заголовков запроса");
+            return;
+        }
+
+        if (guard->phase_ == Phase::Body && elapsed > settings.body_timeout)
+        {
+            guard->Expire(BEV_EVENT_READING,
+                          "превышено время чтения данных запроса");
+            return;
+        }
+
+        if (guard->phase_ == Phase::Body && guard->Slow(guard->read_, now))
+        {
+            guard->Expire(BEV_EVENT_READING,
+                          "низкая скорость передачи данных запроса");
+            return;
+        }
+
+        if (guard->writing_ && guard->Slow(guard->write_, now))
+        {
+            guard->Expire(BEV_EVENT_WRITING, "низкая скорость приёма ответа");
+            return;
+        }
+
+        if (guard->phase_ != Phase::Idle || guard->writing_)
+        {
+            guard->Schedule();
+        }
+    }
+
+    /**
+     * @brief Начало этапа чтения запроса.
+     *
+     * @param phase Этап
+     */
+    void Start(Phase phase) noexcept
+    {
+        phase_ = phase;
+        start_ = Clock::now();
+        read_ = Rate{start_, 0};
+        Schedule();
+    }
+
+    /**
+     * @brief Запуск таймера проверки подключения.
+     */
+    void Schedule() noexcept
+    {
+        if (evtimer_pending(timer_, nullptr) == 0)
+        {
+            evtimer_add(timer_, limits_.tick_);
+        }
+    }
+
+    /**
+     * @brief Поиск пустой строки, завершающей заголовки, в новых данных
+     * буфера ввода.
+     *
+     * @param buffer Буфер ввода
+     * @param added Объём новых данных в конце буфера
+     * @param rest Объём данных после заголовков
+     *
+     * @return Признак завершения заголовков
+     */
+    bool ScanHeader(evbuffer *buffer, size_t added, size_t &rest) noexcept
+    {
+        evbuffer_ptr start{};
+        evbuffer_ptr_set(buffer,
+                         &start,
+                         evbuffer_get_length(buffer) - added,
+                         EVBUFFER_PTR_SET);
+
+        // данные одного чтения из сокета занимают не больше нескольких
+        // блоков буфера
+        std::array<evbuffer_iovec, 4> vec{};
+        const int count{evbuffer_peek(buffer,
+                                      static_cast<ev_ssize_t>(added),
+                                      &start,
+                                      vec.data(),
+                                      static_cast<int>(vec.size()))};
+
+        const size_t extents{
+            std::min(static_cast<size_t>(std::max(count, 0)), vec.size())};
+
+        size_t seen{0};
+        for (size_t i = 0; i < extents; i++)
+        {
+            const auto *data{static_cast<const char *>(vec[i].iov_base)};
+            const size_t size{std::min(vec[i].iov_len, added - seen)};
+
+            for (size_t j = 0; j < size; j++)
+            {
+                if (data[j] == '\n')
+                {
+                    if (blank_)
+                    {
+                        rest = added - seen - j - 1;
+                        return true;
+                    }
+                    blank_ = true;
+                }
+                else if (data[j] != '\r')
+                {
+                    blank_ = false;
+                }
+            }
+
+            seen += size;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Проверка скорости передачи данных по истечении интервала
+     * оценки. Следующий интервал начинается с момента проверки, поэтому
+     * ранее переданные данные не засчитываются.
+     *
+     * @param rate Передача данных
+     * @param now Текущее время
+     *
+     * @return Признак передачи медленнее минимальной скорости
+     */
+    [[nodiscard]] bool Slow(Rate &rate, Clock::time_point now) const noexcept
+    {
+        const auto &settings{limits_.settings_};
+        const auto elapsed{now - rate.since};
+        if (settings.min_rate == 0 || elapsed < settings.rate_interval)
+        {
+            return false;
+        }
+
+        const bool slow{static_cast<double>(rate.bytes) <
+                        static_cast<double>(settings.min_rate) *
+                            duration<double>(elapsed).count()};
+        rate = Rate{now, 0};
+        return slow;
+    }
+
+    /**
+     * @brief Закрытие подключения так же, как при истечении времени
+     * ожидания libevent. Защита удаляется при закрытии подключения.
+     *
+     * @param what Направление передачи
+     * @param reason Причина закрытия
+     */
+    void Expire(int16_t what, const char *reason) noexcept
+    {
+        limits_.closed_.fetch_add(1, std::memory_order_relaxed);
+        Logging::Debug("Подключение медленного клиента закрыто: {}", reason);
+
+        bufferevent_trigger_event(
+            bev_, static_cast<int16_t>(what | BEV_EVENT_TIMEOUT), 0);
+    }
+
+    /**
+     * @brief Защита подключений.
+     */
+    ClientLimits &limits_;
+
+    /**
+     * @brief Буфер подключения.
+     */
+    bufferevent *bev_;
+
+    /**
+     * @brief Таймер проверки подключения.
+     */
+    event *timer_;
+
+    /**
+     * @brief Функция обратного вызова буфера ввода.
+     */
+    evbuffer_cb_entry *input_;
+
+    /**
+     * @brief Функция обратного вызова буфера вывода.
+     */
+    evbuffer_cb_entry *output_;
+
+    /**
+     * @brief Признак установки функции обратного вызова закрытия
+     * подключения.
+     */
+    bool attached_{false};
+
+    /**
+     * @brief Признак прекращения контроля подключения.
+     */
+    bool released_{false};
+
+    /**
+     * @brief Функция обратного вызова закрытия подключения.
+     */
+    CloseCallback close_callback_{nullptr};
+
+    /**
+     * @brief Аргумент функции обратного вызова закрытия подключения.
+     */
+    void *close_arg_{nullptr};
+
+    /**
+     * @brief Этап чтения запроса.
+     */
+    Phase phase_{Phase::Idle};
+
+    /**
+     * @brief Начало этапа чтения запроса.
+     */
+    Clock::time_point start_;
+
+    /**
+     * @brief Чтение данных запроса.
+     */
+    Rate read_;
+
+    /**
+     * @brief Признак пустой текущей строки заголовков.
+     */
+    bool blank_{false};
+
+    /**
+     * @brief Признак наличия неотправленных данных.
+     */
+    bool writing_{false};
+
+    /**
+     * @brief Отправка данных ответа.
+     */
+    Rate write_;
+};
+
+/*------------------------------------------------------------------------------
+    ClientLimits
+------------------------------------------------------------------------------*/
+ClientLimits::ClientLimits(const Settings &settings, event_base *base) noexcept
+: settings_(settings)
+, base_(base)
+, tick_(event_base_init_common_timeout(base, &tick_interval))
+{
+}
+
+//------------------------------------------------------------------------------
+ClientLimits::~ClientLimits() noexcept = default;
+
+//------------------------------------------------------------------------------
+void ClientLimits::Install(evhttp *server,
+                           BufferFactory factory,
+                           void *arg) noexcept
+{
+    factory_ = factory;
+    factory_arg_ = arg;
+
+    evhttp_set_timeout(server,
+                       static_cast<int>(settings_.idle_timeout.count()));
+    evhttp_set_bevcb(server, &ClientLimits::CreateBuffer, this);
+}
+
+//------------------------------------------------------------------------------
+void ClientLimits::Bind() noexcept
+{
+    current = this;
+}
+
+//------------------------------------------------------------------------------
+void ClientLimits::Dispatched(evhttp_connection *connection) noexcept
+{
+    auto *guard{Find(connection)};
+    if (guard != nullptr)
+    {
+        guard->Dispatched();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ClientLimits::Release(evhttp_connection *connection) noexcept
+{
+    // функции обратного вызова буферов не удаляются: освобождение может
+    // выполняться из функции обратного вызова того же буфера
+    auto *guard{current != nullptr ? current->Find(connection) : nullptr};
+    if (guard != nullptr)
+    {
+        guard->Release();
+    }
+}
+
+//------------------------------------------------------------------------------
+uint64_t ClientLimits::Closed() const noexcept
+{
+    return closed_.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+void ClientLimits::SetCloseCallback(evhttp_connection *connection,
+                                    CloseCallback callback,
+                                    void *arg) noexcept
+{
+    auto *guard{current != nullptr ? current->Find(connection) : nullptr};
+    if (guard == nullptr || !guard->Attached())
+    {
+        evhttp_connection_set_closecb(connection, callback, arg);
+        return;
+    }
+
+    guard->SetCloseCallback(callback, arg);
+}
+
+//------------------------------------------------------------------------------
+bufferevent *ClientLimits::CreateBuffer(event_base *base, void *arg) noexcept
+{
+    auto *limits{static_cast<ClientLimits *>(arg)};
+
+    auto *bev{limits->factory_ != nullptr
+                  ? limits->factory_(base, limits->factory_arg_)
+                  : bufferevent_socket_new(base, -1, BEV_OPT_CLOSE_ON_FREE)};
+    if (bev == nullptr)
+    {
+        return nullptr;
+    }
+
+    // верхняя граница записи не используется буферами сокета и TLS и
+    // читается источниками ответов частями
+    bufferevent_setwatermark(
+        bev, EV_WRITE, 0, limits->settings_.output_high_watermark);
+
+    limits->guards_.emplace(bev, make_unique<Guard>(*limits, bev));
+
+    // подключение libevent создаётся после возврата буфера, функция
+    // закрытия устанавливается до обработки событий подключения
+    if (limits->accepted_.empty())
+    {
+        event_base_once(
+            base, -1, EV_TIMEOUT, &ClientLimits::OnAccepted, limits, nullptr);
+    }
+    limits->accepted_.push_back(bev);
+
+    return bev;
+}
+
+//------------------------------------------------------------------------------
+void ClientLimits::OnAccepted(evutil_socket_t, short, void *arg) noexcept
+{
+    auto *limits{static_cast<ClientLimits *>(arg)};
+
+    for (auto *bev : limits->accepted_)
+    {
+        // аргумент функций обратного вызова буфера - подключение libevent
+        void *connection{nullptr};
+        bufferevent_getcb(bev, nullptr, nullptr, nullptr, &connection);
+
+        auto it{limits->guards_.find(bev)};
+        if (connection == nullptr || it == limits->guards_.end())
+        {
+            continue;
+        }
+
+        it->second->Attach();
+        evhttp_connection_set_closecb(
+            static_cast<evhttp_connection *>(connection),
+            &ClientLimits::OnClose,
+            limits);
+    }
+
+    limits->accepted_.clear();
+}
+
+//------------------------------------------------------------------------------
+void ClientLimits::OnClose(evhttp_connection *connection, void *arg) noexcept
+{
+    auto *limits{static_cast<ClientLimits *>(arg)};
+
+    auto *bev{evhttp_connection_get_bufferevent(connection)};
+    auto it{limits->guards_.find(bev)};
+    if (it == limits->guards_.end())
+    {
+        return;
+    }
+
+    const auto guard{std::move(it->second)};
+    limits->guards_.erase(it);
+
+    guard->Close(connection);
+}
+
+//------------------------------------------------------------------------------
+ClientLimits::Guard *ClientLimits::Find(
+    evhttp_connection *connection) const noexcept
+{
+    auto it{guards_.find(evhttp_connection_get_bufferevent(connection))};
+    return it != guards_.end() ? it->second.get() : nullptr;
+}
+
+}  // namespace tasp::http
@@ -0,0 +1,260 @@
+/**
+ * @file
+ * @brief Защита HTTP-сервера от медленных клиентов.
+ */
+#ifndef TASP_HTTP_CLIENT_LIMITS_HPP_
+#define TASP_HTTP_CLIENT_LIMITS_HPP_
+
+#include <event2/bufferevent.h>
+#include <evhttp.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace tasp::http
+{
+
+/**
+ * @brief Защита подключений HTTP-сервера libevent от медленных клиентов.
+ *
+ * Буфер каждого подключения создаётся через evhttp_set_bevcb (функцией
+ * создания буферов HTTP/2 или TLS, если они включены), данные подключения
+ * отслеживаются функциями обратного вызова его буферов ввода и вывода.
+ * Чтение запроса делится на этапы: заголовки - от первого байта запроса до
+ * пустой строки, данные - до передачи запроса обработчику.
+ * Подключение закрывается, если этап длится дольше header_timeout или
+ * body_timeout либо данные запроса или ответа передаются медленнее min_rate
+ * в среднем за интервал rate_interval. Простой подключения ограничивается
+ * idle_timeout библиотеки libevent.
+ *
+ * Буферу подключения задаётся верхняя граница записи
+ * (bufferevent_setwatermark), по которой источники ответов частями (потоки
+ * событий) приостанавливают передачу данных.
+ *
+ * Закрытие подключения отслеживается через evhttp_connection_set_closecb,
+ * поэтому остальные функции обратного вызова закрытия подключения
+ * устанавливаются через SetCloseCallback.
+ */
+class ClientLimits final
+{
+public:
+    /**
+     * @brief Часы для отсчёта сроков.
+     */
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Функция обратного вызова закрытия подключения.
+     */
+    using CloseCallback = void (*)(evhttp_connection *, void *);
+
+    /**
+     * @brief Функция создания буфера подключения (evhttp_set_bevcb).
+     */
+    using BufferFactory = bufferevent *(*)(event_base *, void *);
+
+    /**
+     * @brief Параметры защиты от медленных клиентов.
+     */
+    struct Settings
+    {
+        /**
+         * @brief Признак включения защиты.
+         */
+        bool enabled{true};
+
+        /**
+         * @brief Время простоя подключения без чтения и записи данных.
+         */
+        std::chrono::seconds idle_timeout{60};
+
+        /**
+         * @brief Время чтения заголовков запроса.
+         */
+        std::chrono::seconds header_timeout{20};
+
+        /**
+         * @brief Время чтения данных запроса.
+         */
+        std::chrono::seconds body_timeout{300};
+
+        /**
+         * @brief Минимальная скорость передачи данных запроса и ответа в
+         * байтах в секунду, 0 - не ограничена.
+         */
+        size_t min_rate{1024};
+
+        /**
+         * @brief Интервал оценки скорости передачи данных.
+         */
+        std::chrono::seconds rate_interval{10};
+
+        /**
+         * @brief Объём неотправленных данных подключения, при превышении
+         * которого источники ответов частями приостанавливают передачу, 0 -
+         * не ограничен.
+         */
+        size_t output_high_watermark{64 * 1024};
+    };
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param settings Параметры защиты
+     * @param base Цикл обработки событий HTTP-сервера
+     */
+    ClientLimits(const Settings &settings, event_base *base) noexcept;
+
+    /**
+     * @brief Деструктор. Вызывается после освобождения HTTP-сервера.
+     */
+    ~ClientLimits() noexcept;
+
+    /**
+     * @brief Подключение защиты к HTTP-серверу.
+     *
+     * @param server HTTP-сервер
+     * @param factory Функция создания буферов подключений, пустая - буферы
+     * сокетов
+     * @param arg Аргумент функции создания буферов
+     */
+    void Install(evhttp *server,
+                 BufferFactory factory = nullptr,
+                 void *arg = nullptr) noexcept;
+
+    /**
+     * @brief Привязка защиты к потоку цикла обработки событий. Вызывается в
+     * потоке цикла.
+     */
+    void Bind() noexcept;
+
+    /**
+     * @brief Уведомление о передаче запроса подключения обработчику:
+     * чтение запроса завершено.
+     *
+     * @param connection Подключение
+     */
+    void Dispatched(evhttp_connection *connection) noexcept;
+
+    /**
+     * @brief Прекращение контроля подключения, переданного другому
+     * протоколу (HTTP/2). Функции обратного вызова закрытия подключения
+     * продолжают вызываться защитой.
+     *
+     * @param connection Подключение
+     */
+    static void Release(evhttp_connection *connection) noexcept;
+
+    /**
+     * @brief Запрос количества подключений, закрытых из-за медленной
+     * передачи данных.
+     *
+     * @return Количество подключений
+     */
+    [[nodiscard]] uint64_t Closed() const noexcept;
+
+    /**
+     * @brief Установка функции обратного вызова закрытия подключения вместо
+     * evhttp_connection_set_closecb. Для подключений под защитой функция
+     * вызывается защитой, для остальных - устанавливается в libevent.
+     *
+     * @param connection Подключение
+     * @param callback Функция обратного вызова, пустая - удаление
+     * @param arg Аргумент функции обратного вызова
+     */
+    static void SetCloseCallback(evhttp_connection *connection,
+                                 CloseCallback callback,
+                                 void *arg) noexcept;
+
+    ClientLimits(const ClientLimits &) = delete;
+    ClientLimits(ClientLimits &&) = delete;
+    ClientLimits &operator=(const ClientLimits &) = delete;
+    ClientLimits &operator=(ClientLimits &&) = delete;
+
+private:
+    class Guard;
+
+    /**
+     * @brief Функция создания буфера подключения (evhttp_set_bevcb).
+     *
+     * @param base Цикл обработки событий
+     * @param arg Указатель на защиту
+     *
+     * @return Буфер подключения
+     */
+    static bufferevent *CreateBuffer(event_base *base, void *arg) noexcept;
+
+    /**
+     * @brief Функция обратного вызова, выполняемая после создания
+     * подключений библиотекой libevent: установка функции обратного вызова
+     * закрытия подключений.
+     *
+     * @param arg Указатель на защиту
+     */
+    static void OnAccepted(evutil_socket_t, short, void *arg) noexcept;
+
+    /**
+     * @brief Функция обратного вызова закрытия подключения.
+     *
+     * @param connection Подключение
+     * @param arg Указатель на защиту
+     */
+    static void OnClose(evhttp_connection *connection, void *arg) noexcept;
+
+    /**
+     * @brief Поиск защиты подключения.
+     *
+     * @param connection Подключение
+     *
+     * @return Защита подключения или пустой указатель
+     */
+    [[nodiscard]] Guard *Find(evhttp_connection *connection) const noexcept;
+
+    /**
+     * @brief Параметры защиты.
+     */
+    Settings settings_;
+
+    /**
+     * @brief Цикл обработки событий HTTP-сервера.
+     */
+    event_base *base_;
+
+    /**
+     * @brief Функция создания буферов подключений.
+     */
+    BufferFactory factory_{nullptr};
+
+    /**
+     * @brief Аргумент функции создания буферов подключений.
+     */
+    void *factory_arg_{nullptr};
+
+    /**
+     * @brief Период проверки подключений (общий таймаут libevent).
+     */
+    const timeval *tick_;
+
+    /**
+     * @brief Защиты подключений по буферам подключений.
+     */
+    std::unordered_map<bufferevent *, std::unique_ptr<Guard>> guards_;
+
+    /**
+     * @brief Буферы подключений, созданных в текущей итерации цикла.
+     */
+    std::vector<bufferevent *> accepted_;
+
+    /**
+     * @brief Количество подключений, закрытых из-за медленной передачи
+     * данных.
+     */
+    std::atomic<uint64_t> closed_{0};
+};
+
+}  // namespace tasp::http
+
+#endif  // TASP_HTTP_CLIENT_LIMITS_HPP_
@@ -0,0 +1,265 @@
+#include "compression.hpp"
+
+#include <zlib.h>
+
+#include <array>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+using std::string_view;
+
+namespace tasp::http
+{
+
+/**
+ * @brief Умный указатель буфера данных библиотеки libevent.
+ */
+using EvBuffer = std::unique_ptr<evbuffer, decltype(&evbuffer_free)>;
+
+namespace
+{
+/**
+ * @brief Параметры сжатия.
+ */
+Compression::Settings settings;  // NOLINT(cert-err58-cpp)
+
+/**
+ * @brief Размер порции сжатых данных, резервируемой в буфере.
+ */
+constexpr size_t chunk_size{64 * 1024};
+
+/**
+ * @brief Переиспользуемый поток сжатия zlib.
+ */
+struct Stream
+{
+    Stream() noexcept = default;
+
+    ~Stream() noexcept
+    {
+        if (initialized)
+        {
+            deflateEnd(&stream);
+        }
+    }
+
+    Stream(const Stream &) = delete;
+    Stream(Stream &&) = delete;
+    Stream &operator=(const Stream &) = delete;
+    Stream &operator=(Stream &&) = delete;
+
+    z_stream stream{};
+    bool initialized{false};
+    int level{};
+};
+
+//------------------------------------------------------------------------------
+z_stream *AcquireStream(Compression::Encoding encoding) noexcept
+{
+    thread_local std::array<Stream, 2> streams;
+
+    const bool gzip{encoding == Compression::Encoding::Gzip};
+    auto &stream{streams.at(gzip ? 0 : 1)};
+
+    if (stream.initialized && stream.level == settings.level)
+    {
+        deflateReset(&stream.stream);
+        return &stream.stream;
+    }
+
+    if (stream.initialized)
+    {
+        deflateEnd(&stream.stream);
+        stream.initialized = false;
+    }
+
+    // 15 - размер окна, +16 - формат gzip вместо zlib
+    const int window_bits{gzip ? 15 + 16 : 15};
+    const int memory_level{8};
+
+    stream.stream = z_stream{};
+    if (deflateInit2(&stream.stream,
+                     settings.level,
+                     Z_DEFLATED,
+                     window_bits,
+                     memory_level,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return nullptr;
+    }
+
+    stream.initialized = true;
+    stream.level = settings.level;
+    return &stream.stream;
+}
+
+//------------------------------------------------------------------------------
+string_view Trim(string_view str) noexcept
+{
+    const auto first{str.find_first_not_of(" \t")};
+    if (first == string_view::npos)
+    {
+        return {};
+    }
+
+    return str.substr(first, str.find_last_not_of(" \t") - first + 1);
+}
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    Compression
+------------------------------------------------------------------------------*/
+void Compression::Configure(const Settings &new_settings) noexcept
+{
+    settings = new_settings;
+
+    if (settings.level < Z_BEST_SPEED || settings.level > Z_BEST_COMPRESSION)
+    {
+        settings.level = Z_DEFAULT_COMPRESSION;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool Compression::Enabled() noexcept
+{
+    return settings.enabled;
+}
+
+//------------------------------------------------------------------------------
+Compression::Encoding Compression::Negotiate(string_view accept_encoding,
+                                             size_t size) noexcept
+{
+    if (!settings.enabled || size < settings.min_size ||
+        accept_encoding.empty())
+    {
+        return Encoding::Identity;
+    }
+
+    double gzip_quality{-1};
+    double deflate_quality{-1};
+    double any_quality{-1};
+
+    while (!accept_encoding.empty())
+    {
+        const auto comma{accept_encoding.find(',')};
+        string_view item{accept_encoding.substr(0, comma)};
+        accept_encoding.remove_prefix(
+            comma == string_view::npos ? accept_encoding.size() : comma + 1);
+
+        double quality{1};
+
+        const auto params{item.find(';')};
+        if (params != string_view::npos)
+        {
+            const string_view param{Trim(item.substr(params + 1))};
+            if (param.substr(0, 2) == "q=")
+            {
+                const std::string value{param.substr(2)};
+                quality = std::strtod(value.c_str(), nullptr);
+            }
+            item = item.substr(0, params);
+        }
+
+        const string_view name{Trim(item)};
+        if (name == "gzip" || name == "x-gzip")
+        {
+            gzip_quality = quality;
+        }
+        else if (name == "deflate")
+        {
+            deflate_quality = quality;
+        }
+        else if (name == "*")
+        {
+            any_quality = quality;
+        }
+    }
+
+    gzip_quality = gzip_quality < 0 ? any_quality : gzip_quality;
+    deflate_quality = deflate_quality < 0 ? any_quality : deflate_quality;
+
+    if (gzip_quality > 0 && gzip_quality >= deflate_quality)
+    {
+        return Encoding::Gzip;
+    }
+
+    if (deflate_quality > 0)
+    {
+        return Encoding::Deflate;
+    }
+
+    return Encoding::Identity;
+}
+
+//------------------------------------------------------------------------------
+string_view Compression::Name(Encoding encoding) noexcept
+{
+    switch (encoding)
+    {
+        case Encoding::Gzip:
+            return "gzip";
+        case Encoding::Deflate:
+            return "deflate";
+        default:
+            return "identity";
+    }
+}
+
+//------------------------------------------------------------------------------
+bool Compression::Compress(Encoding encoding,
+                           string_view data,
+                           evbuffer *output) noexcept
+{
+    if (encoding == Encoding::Identity)
+    {
+        return false;
+    }
+
+    z_stream *stream{AcquireStream(encoding)};
+    if (stream == nullptr)
+    {
+        return false;
+    }
+
+    const EvBuffer compressed{evbuffer_new(), evbuffer_free};
+
+    // zlib не изменяет входные данные, но объявляет их неконстантными
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    auto *input{const_cast<char *>(data.data())};
+
+    stream->next_in = reinterpret_cast<Bytef *>(input);
+    stream->avail_in = static_cast<uInt>(data.size());
+
+    int res{Z_OK};
+    while (res == Z_OK)
+    {
+        evbuffer_iovec vec{};
+        if (evbuffer_reserve_space(compressed.get(),
+                                   static_cast<ev_ssize_t>(chunk_size),
+                                   &vec,
+                                   1) < 1)
+        {
+            return false;
+        }
+
+        stream->next_out = static_cast<Bytef *>(vec.iov_base);
+        stream->avail_out = static_cast<uInt>(vec.iov_len);
+
+        res = deflate(stream, Z_FINISH);
+
+        vec.iov_len -= stream->avail_out;
+        evbuffer_commit_space(compressed.get(), &vec, 1);
+    }
+
+    if (res != Z_STREAM_END)
+    {
+        return false;
+    }
+
+    evbuffer_add_buffer(output, compressed.get());
+    return true;
+}
+
+}  // namespace tasp::http
@@ -0,0 +1,109 @@
+/**
+ * @file
+ * @brief Сжатие тела ответа HTTP.
+ */
+#ifndef TASP_HTTP_COMPRESSION_HPP_
+#define TASP_HTTP_COMPRESSION_HPP_
+
+#include <event2/buffer.h>
+
+#include <string_view>
+
+namespace tasp::http
+{
+
+/**
+ * @brief Сжатие тела ответа в соответствии с заголовком Accept-Encoding.
+ *
+ * Сжатые данные записываются непосредственно в буфер libevent порциями, без
+ * промежуточной копии. Потоки сжатия zlib переиспользуются в пределах потока
+ * обработки событий.
+ */
+class Compression final
+{
+public:
+    /**
+     * @brief Способ кодирования тела ответа.
+     */
+    enum class Encoding
+    {
+        Identity,
+        Gzip,
+        Deflate
+    };
+
+    /**
+     * @brief Параметры сжатия.
+     */
+    struct Settings
+    {
+        /**
+         * @brief Признак включения сжатия.
+         */
+        bool enabled{false};
+
+        /**
+         * @brief Минимальный размер тела ответа для сжатия в байтах.
+         */
+        size_t min_size{1024};
+
+        /**
+         * @brief Уровень сжатия от 1 до 9.
+         */
+        int level{6};
+    };
+
+    /**
+     * @brief Установка параметров сжатия.
+     *
+     * Вызывается при отсутствии потоков обработки событий.
+     *
+     * @param settings Параметры сжатия
+     */
+    static void Configure(const Settings &settings) noexcept;
+
+    /**
+     * @brief Запрос признака включения сжатия.
+     *
+     * @return Признак включения сжатия
+     */
+    [[nodiscard]] static bool Enabled() noexcept;
+
+    /**
+     * @brief Выбор способа кодирования по заголовку Accept-Encoding.
+     *
+     * @param accept_encoding Значение заголовка Accept-Encoding
+     * @param size Размер тела ответа
+     *
+     * @return Способ кодирования
+     */
+    [[nodiscard]] static Encoding Negotiate(std::string_view accept_encoding,
+                                            size_t size) noexcept;
+
+    /**
+     * @brief Запрос названия способа кодирования для заголовка
+     * Content-Encoding.
+     *
+     * @param encoding Способ кодирования
+     *
+     * @return Название
+     */
+    [[nodiscard]] static std::string_view Name(Encoding encoding) noexcept;
+
+    /**
+     * @brief Сжатие данных в буфер.
+     *
+     * @param encoding Способ кодирования
+     * @param data Данные
+     * @param output Буфер для записи сжатых данных
+     *
+     * @return Признак успешного сжатия. При ошибке буфер не изменяется.
+     */
+    [[nodiscard]] static bool Compress(Encoding encoding,
+                                       std::string_view data,
+                                       evbuffer *output) noexcept;
+};
+
+}  // namespace tasp::http
+
+#endif  // TASP_HTTP_COMPRESSION_HPP_
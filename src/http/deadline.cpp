@@ -0,0 +1,202 @@
+#include "deadline.hpp"
+
+#include <charconv>
+#include <string>
+
+#include "client_limits.hpp"
+
+using std::string_view;
+using std::chrono::hours;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using std::chrono::minutes;
+using std::chrono::nanoseconds;
+using std::chrono::seconds;
+
+namespace tasp::http
+{
+
+namespace
+{
+//------------------------------------------------------------------------------
+template <typename Duration>
+nanoseconds Cap(Duration duration) noexcept
+{
+    // значения, не представимые в наносекундах, не ограничивают обработку
+    if (duration > std::chrono::duration_cast<Duration>(nanoseconds::max()))
+    {
+        return nanoseconds::max();
+    }
+
+    return duration;
+}
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    Deadline
+------------------------------------------------------------------------------*/
+Deadline::Deadline(evhttp_request *req) noexcept
+: start_(Clock::now())
+, connection_(evhttp_request_get_connection(req))
+{
+    auto *headers{evhttp_request_get_input_headers(req)};
+
+    const char *timeout{evhttp_find_header(headers, "X-Request-Timeout")};
+    if (timeout != nullptr)
+    {
+        const string_view value{timeout};
+        int64_t ms{0};
+        const auto [end, ec]{
+            std::from_chars(value.data(), value.data() + value.size(), ms)};
+        if (ec == std::errc{} && end == value.data() + value.size() && ms >= 0)
+        {
+            Limit(Cap(milliseconds(ms)));
+        }
+    }
+
+    const char *grpc_timeout{evhttp_find_header(headers, "grpc-timeout")};
+    if (grpc_timeout != nullptr)
+    {
+        const auto value{ParseGrpcTimeout(grpc_timeout)};
+        if (value)
+        {
+            Limit(*value);
+        }
+    }
+
+    // запросы, сформированные внутри сервиса, не имеют подключения
+    if (connection_ == nullptr)
+    {
+        return;
+    }
+
+    ClientLimits::SetCloseCallback(connection_, &Deadline::OnClose, this);
+}
+
+//------------------------------------------------------------------------------
+Deadline::~Deadline() noexcept
+{
+    Detach();
+}
+
+//------------------------------------------------------------------------------
+void Deadline::Limit(nanoseconds timeout) noexcept
+{
+    // срок, превышающий диапазон часов, не ограничивает обработку
+    if (timeout > Clock::time_point::max() - start_)
+    {
+        return;
+    }
+
+    const auto deadline{start_ +
+                        std::chrono::duration_cast<Clock::duration>(timeout)};
+    if (deadline < deadline_)
+    {
+        deadline_ = deadline;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool Deadline::HasDeadline() const noexcept
+{
+    return deadline_ != Clock::time_point::max();
+}
+
+//------------------------------------------------------------------------------
+Deadline::Clock::time_point Deadline::At() const noexcept
+{
+    return deadline_;
+}
+
+//------------------------------------------------------------------------------
+bool Deadline::Expired() const noexcept
+{
+    return HasDeadline() && Clock::now() >= deadline_;
+}
+
+//------------------------------------------------------------------------------
+bool Deadline::ClientClosed() const noexcept
+{
+    return released_.load(std::memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------
+bool Deadline::Released() const noexcept
+{
+    return released_.load(std::memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------
+void Deadline::OnRelease(FunctionRef<void()> callback) noexcept
+{
+    on_release_ = callback;
+}
+
+//------------------------------------------------------------------------------
+void Deadline::Detach() noexcept
+{
+    on_release_ = {};
+
+    if (connection_ != nullptr)
+    {
+        ClientLimits::SetCloseCallback(connection_, nullptr, nullptr);
+        connection_ = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+std::optional<nanoseconds> Deadline::ParseGrpcTimeout(
+    string_view value) noexcept
+{
+    // значение - не более 8 цифр и единица измерения
+    const size_t max_digits{8};
+    if (value.size() < 2 || value.size() > max_digits + 1)
+    {
+        return std::nullopt;
+    }
+
+    int64_t amount{0};
+    const auto [end, ec]{std::from_chars(
+        value.data(), value.data() + value.size() - 1, amount)};
+    if (ec != std::errc{} || end != value.data() + value.size() - 1 ||
+        amount < 0)
+    {
+        return std::nullopt;
+    }
+
+    switch (value.back())
+    {
+        case 'H':
+            return Cap(hours(amount));
+        case 'M':
+            return Cap(minutes(amount));
+        case 'S':
+            return Cap(seconds(amount));
+        case 'm':
+            return Cap(milliseconds(amount));
+        case 'u':
+            return Cap(microseconds(amount));
+        case 'n':
+            return nanoseconds(amount);
+        default:
+            return std::nullopt;
+    }
+}
+
+//------------------------------------------------------------------------------
+void Deadline::OnClose(evhttp_connection * /*connection*/, void *arg) noexcept
+{
+    auto *deadline{static_cast<Deadline *>(arg)};
+    deadline->released_.store(true, std::memory_order_release);
+
+    // подключение освобождается библиотекой после вызова
+    deadline->connection_ = nullptr;
+
+    if (deadline->on_release_)
+    {
+        deadline->on_release_();
+    }
+}
+
+}  // namespace tasp::http
@@ -0,0 +1,164 @@
+/**
+ * @file
+ * @brief Срок обработки запроса и признак закрытия подключения клиентом.
+ */
+#ifndef TASP_HTTP_DEADLINE_HPP_
+#define TASP_HTTP_DEADLINE_HPP_
+
+#include <evhttp.h>
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <string_view>
+
+#include <tasp/function_ref.hpp>
+
+namespace tasp::http
+{
+
+/**
+ * @brief Срок обработки запроса и признак закрытия подключения клиентом.
+ *
+ * Срок задаётся заголовками запроса X-Request-Timeout (в миллисекундах) и
+ * grpc-timeout (формат gRPC: число и единица H, M, S, m, u, n), а также
+ * параметром timeout обработчика. Действует наименьший из сроков.
+ *
+ * Закрытие подключения определяется функцией обратного вызова закрытия
+ * подключения (ClientLimits::SetCloseCallback), которая выполняется в потоке
+ * цикла обработки событий и устанавливает атомарный признак; другие потоки
+ * только читают признак и не обращаются к сокету подключения. Пока поток
+ * цикла занят обработчиком, закрытие не определяется.
+ */
+class Deadline final
+{
+public:
+    /**
+     * @brief Часы для отсчёта срока.
+     */
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Конструктор. Срок отсчитывается от момента создания.
+     *
+     * @param req Указатель на запрос в библиотеке libevent
+     */
+    explicit Deadline(evhttp_request *req) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~Deadline() noexcept;
+
+    /**
+     * @brief Ограничение срока обработки запроса.
+     *
+     * @param timeout Время обработки от момента создания
+     */
+    void Limit(std::chrono::nanoseconds timeout) noexcept;
+
+    /**
+     * @brief Запрос признака наличия срока.
+     *
+     * @return Признак наличия срока
+     */
+    [[nodiscard]] bool HasDeadline() const noexcept;
+
+    /**
+     * @brief Запрос момента истечения срока.
+     *
+     * @return Момент истечения срока, Clock::time_point::max() без срока
+     */
+    [[nodiscard]] Clock::time_point At() const noexcept;
+
+    /**
+     * @brief Запрос признака истечения срока.
+     *
+     * @return Признак истечения срока
+     */
+    [[nodiscard]] bool Expired() const noexcept;
+
+    /**
+     * @brief Запрос признака закрытия подключения клиентом. Может
+     * вызываться из любого потока.
+     *
+     * @return Признак закрытия подключения
+     */
+    [[nodiscard]] bool ClientClosed() const noexcept;
+
+    /**
+     * @brief Запрос признака освобождения подключения и запроса библиотекой
+     * libevent.
+     *
+     * @return Признак освобождения запроса
+     */
+    [[nodiscard]] bool Released() const noexcept;
+
+    /**
+     * @brief Установка функции, вызываемой при освобождении подключения
+     * библиотекой libevent.
+     *
+     * @param callback Функция обратного вызова
+     */
+    void OnRelease(FunctionRef<void()> callback) noexcept;
+
+    /**
+     * @brief Отключение от подключения libevent. Вызывается при завершении
+     * обработки запроса, после чего признак закрытия не изменяется.
+     */
+    void Detach() noexcept;
+
+    /**
+     * @brief Разбор значения заголовка grpc-timeout.
+     *
+     * @param value Значение заголовка
+     *
+     * @return Время или std::nullopt при ошибке формата
+     */
+    [[nodiscard]] static std::optional<std::chrono::nanoseconds>
+    ParseGrpcTimeout(std::string_view value) noexcept;
+
+    Deadline(const Deadline &) = delete;
+    Deadline(Deadline &&) = delete;
+    Deadline &operator=(const Deadline &) = delete;
+    Deadline &operator=(Deadline &&) = delete;
+
+private:
+    /**
+     * @brief Функция обратного вызова закрытия подключения.
+     *
+     * @param connection Подключение
+     * @param arg Указатель на объект
+     */
+    static void OnClose(evhttp_connection *connection, void *arg) noexcept;
+
+    /**
+     * @brief Момент создания.
+     */
+    Clock::time_point start_;
+
+    /**
+     * @brief Момент истечения срока.
+     */
+    Clock::time_point deadline_{Clock::time_point::max()};
+
+    /**
+     * @brief Подключение libevent.
+     */
+    evhttp_connection *connection_{nullptr};
+
+    /**
+     * @brief Признак закрытия и освобождения подключения библиотекой
+     * libevent.
+     */
+    std::atomic<bool> released_{false};
+
+    /**
+     * @brief Функция, вызываемая при освобождении подключения.
+     */
+    FunctionRef<void()> on_release_;
+};
+
+}  // namespace tasp::http
+
+#endif  // TASP_HTTP_DEADLINE_HPP_
@@ -0,0 +1,262 @@
+#include "exchange.hpp"
+
+#include <event2/event.h>
+
+#include <algorithm>
+
+#include <tasp/logging.hpp>
+
+using std::shared_ptr;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+
+namespace tasp::http
+{
+
+namespace
+{
+/**
+ * @brief Код ответа при истечении срока обработки запроса (в libevent
+ * отсутствует).
+ */
+constexpr int gateway_timeout{504};
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    Exchange
+------------------------------------------------------------------------------*/
+Exchange::Exchange(evhttp_request *req) noexcept
+: req_(req)
+, request_(req)
+, response_(req)
+{
+    response_.SetExchange(this);
+}
+
+//------------------------------------------------------------------------------
+Exchange::~Exchange() noexcept
+{
+    if (!deferred_ || done_)
+    {
+        return;
+    }
+
+    if (Finish())
+    {
+        Logging::Error("Отложенный ответ не сформирован");
+        response_.SetError(
+            static_cast<Response::Code>(HTTP_INTERNAL),
+            "Внутренняя ошибка сервера: ответ не сформирован");
+        Send();
+    }
+}
+
+//------------------------------------------------------------------------------
+RequestImpl &Exchange::Request() noexcept
+{
+    return request_;
+}
+
+//------------------------------------------------------------------------------
+ResponseImpl &Exchange::Response() noexcept
+{
+    return response_;
+}
+
+//------------------------------------------------------------------------------
+void Exchange::SetTrace(std::unique_ptr<Trace> trace) noexcept
+{
+    trace_ = std::move(trace);
+}
+
+//------------------------------------------------------------------------------
+void Exchange::Dispatched() noexcept
+{
+    if (!deferred_)
+    {
+        Send();
+        return;
+    }
+
+    // трассировка отложенного ответа не должна оставаться текущей для
+    // следующих запросов потока
+    if (trace_)
+    {
+        trace_->Suspend();
+    }
+}
+
+//------------------------------------------------------------------------------
+shared_ptr<Exchange> Exchange::Defer() noexcept
+{
+    if (deferred_)
+    {
+        return shared_from_this();
+    }
+
+    deferred_ = true;
+
+    auto &deadline{*request_.GetDeadline()};
+    deadline.OnRelease(FunctionRef<void()>::Bind<&Exchange::Release>(this));
+
+    auto *connection{evhttp_request_get_connection(req_)};
+    if (deadline.HasDeadline() && connection != nullptr)
+    {
+        const auto remaining{std::max(
+            Deadline::Clock::duration::zero(),
+            deadline.At() - Deadline::Clock::now())};
+        const auto usec{duration_cast<microseconds>(remaining).count()};
+
+        const timeval timeout{usec / 1000000, usec % 1000000};
+
+        timer_ = evtimer_new(evhttp_connection_get_base(connection),
+                             &Exchange::OnTimeout,
+                             this);
+        evtimer_add(timer_, &timeout);
+    }
+
+    return shared_from_this();
+}
+
+//------------------------------------------------------------------------------
+bool Exchange::Deferred() const noexcept
+{
+    return deferred_;
+}
+
+//------------------------------------------------------------------------------
+bool Exchange::Done() const noexcept
+{
+    return done_;
+}
+
+//------------------------------------------------------------------------------
+bool Exchange::Resume() noexcept
+{
+    auto &deadline{*request_.GetDeadline()};
+    if (!deferred_ || done_ || deadline.Released())
+    {
+        return false;
+    }
+
+    if (timer_ != nullptr)
+    {
+        event_free(timer_);
+        timer_ = nullptr;
+    }
+
+    deferred_ = false;
+    deadline.OnRelease({});
+
+    if (trace_)
+    {
+        trace_->Resume();
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void Exchange::Complete(FunctionRef<void(http::Response &)> fill) noexcept
+{
+    if (!deferred_ || done_)
+    {
+        return;
+    }
+
+    if (!Finish())
+    {
+        Logging::Debug("Подключение закрыто до отправки отложенного ответа");
+        return;
+    }
+
+    fill(response_);
+
+    if (request_.GetDeadline()->Expired())
+    {
+        Logging::Warning("Превышено время обработки запроса");
+        response_.SetError(static_cast<Response::Code>(gateway_timeout),
+                           "Превышено время обработки запроса");
+    }
+
+    Send();
+}
+
+//------------------------------------------------------------------------------
+evhttp_request *Exchange::Stream() noexcept
+{
+    deferred_ = true;
+    static_cast<void>(Finish());
+    return req_;
+}
+
+//------------------------------------------------------------------------------
+void Exchange::OnTimeout(evutil_socket_t /*fd*/,
+                         short /*events*/,
+                         void *arg) noexcept
+{
+    auto *exchange{static_cast<Exchange *>(arg)};
+    if (!exchange->Finish())
+    {
+        return;
+    }
+
+    Logging::Warning("Превышено время обработки запроса");
+    exchange->response_.SetError(static_cast<Response::Code>(gateway_timeout),
+                                 "Превышено время обработки запроса");
+    exchange->Send();
+}
+
+//------------------------------------------------------------------------------
+void Exchange::Send() noexcept
+{
+    if (trace_)
+    {
+        trace_->Resume();
+    }
+
+    response_.Send();
+
+    if (trace_)
+    {
+        trace_->SetCode(static_cast<int>(response_.GetCode()));
+        trace_.reset();
+    }
+}
+
+//------------------------------------------------------------------------------
+void Exchange::Release() noexcept
+{
+    // таймер принадлежит циклу обработки событий, который может быть удалён
+    // раньше обмена
+    if (timer_ != nullptr)
+    {
+        event_free(timer_);
+        timer_ = nullptr;
+    }
+    done_ = true;
+}
+
+//------------------------------------------------------------------------------
+bool Exchange::Finish() noexcept
+{
+    if (timer_ != nullptr)
+    {
+        event_free(timer_);
+        timer_ = nullptr;
+    }
+
+    auto &deadline{*request_.GetDeadline()};
+    const bool released{done_ || deadline.Released()};
+
+    done_ = true;
+
+    // после отправки подключение может принять следующий запрос со своей
+    // функцией обратного вызова закрытия
+    deadline.Detach();
+
+    return !released;
+}
+
+}  // namespace tasp::http
@@ -0,0 +1,199 @@
+/**
+ * @file
+ * @brief Обмен HTTP: запрос и ответ с возможностью отложенной отправки.
+ */
+#ifndef TASP_HTTP_EXCHANGE_HPP_
+#define TASP_HTTP_EXCHANGE_HPP_
+
+#include <evhttp.h>
+
+#include <memory>
+
+#include <tasp/function_ref.hpp>
+
+#include "request_impl.hpp"
+#include "response_impl.hpp"
+#include "trace.hpp"
+
+namespace tasp::http
+{
+
+/**
+ * @brief Обмен HTTP: запрос и ответ подключения libevent.
+ *
+ * Обычно ответ отправляется сразу после возврата из обработчика. Обработчик
+ * может отложить ответ (Defer), тогда обмен продолжает существовать, пока на
+ * него есть ссылки, и ответ отправляется вызовом Complete из потока цикла
+ * обработки событий подключения. При истечении срока обработки запроса ответ
+ * отправляется с кодом 504 по таймеру, при освобождении последней ссылки без
+ * вызова Complete - с кодом 500.
+ *
+ * Обмен владеет трассировкой запроса: трассировка отложенного ответа
+ * приостанавливается после возврата из обработчика и завершается с
+ * фактическим кодом при отправке ответа.
+ *
+ * Все методы вызываются только из потока цикла обработки событий
+ * подключения.
+ */
+class Exchange final : public std::enable_shared_from_this<Exchange>
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param req Указатель на запрос в библиотеке libevent
+     */
+    explicit Exchange(evhttp_request *req) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~Exchange() noexcept;
+
+    /**
+     * @brief Запрос HTTP.
+     *
+     * @return Запрос
+     */
+    [[nodiscard]] RequestImpl &Request() noexcept;
+
+    /**
+     * @brief Ответ HTTP.
+     *
+     * @return Ответ
+     */
+    [[nodiscard]] ResponseImpl &Response() noexcept;
+
+    /**
+     * @brief Передача обмену трассировки запроса.
+     *
+     * @param trace Трассировка, текущая в потоке
+     */
+    void SetTrace(std::unique_ptr<Trace> trace) noexcept;
+
+    /**
+     * @brief Завершение вызова обработчика: отправка ответа, если он не
+     * отложен, иначе приостановка трассировки до отправки ответа.
+     */
+    void Dispatched() noexcept;
+
+    /**
+     * @brief Откладывание отправки ответа до вызова Complete. Если у запроса
+     * есть срок обработки, запускается таймер ответа с кодом 504.
+     *
+     * @return Ссылка на обмен
+     */
+    [[nodiscard]] std::shared_ptr<Exchange> Defer() noexcept;
+
+    /**
+     * @brief Запрос признака отложенного ответа.
+     *
+     * @return Признак отложенного ответа
+     */
+    [[nodiscard]] bool Deferred() const noexcept;
+
+    /**
+     * @brief Запрос признака невозможности отправить отложенный ответ: ответ
+     * уже отправлен или подключение освобождено.
+     *
+     * @return Признак завершения обмена
+     */
+    [[nodiscard]] bool Done() const noexcept;
+
+    /**
+     * @brief Возобновление обработки отложенного ответа, например для
+     * повторного вызова обработчика: ответ снова отправляется вызовом
+     * Dispatched, если обработчик его не отложит.
+     *
+     * @return Признак возможности отправить ответ
+     */
+    [[nodiscard]] bool Resume() noexcept;
+
+    /**
+     * @brief Формирование и отправка отложенного ответа. Повторные вызовы и
+     * вызовы после освобождения подключения игнорируются.
+     *
+     * @param fill Функция формирования ответа
+     */
+    void Complete(FunctionRef<void(http::Response &)> fill) noexcept;
+
+    /**
+     * @brief Передача запроса для ответа частями (chunked) в обход обмена:
+     * ответ обмена не отправляется, срок обработки не контролируется.
+     *
+     * @return Указатель на запрос в библиотеке libevent
+     */
+    [[nodiscard]] evhttp_request *Stream() noexcept;
+
+    Exchange(const Exchange &) = delete;
+    Exchange(Exchange &&) = delete;
+    Exchange &operator=(const Exchange &) = delete;
+    Exchange &operator=(Exchange &&) = delete;
+
+private:
+    /**
+     * @brief Функция обратного вызова таймера срока обработки запроса.
+     *
+     * @param fd Не используется
+     * @param events Не используется
+     * @param arg Указатель на обмен
+     */
+    static void OnTimeout(evutil_socket_t fd, short events, void *arg) noexcept;
+
+    /**
+     * @brief Отправка ответа и завершение трассировки запроса.
+     */
+    void Send() noexcept;
+
+    /**
+     * @brief Обработка освобождения подключения библиотекой libevent.
+     */
+    void Release() noexcept;
+
+    /**
+     * @brief Завершение отложенного обмена: остановка таймера и отключение
+     * от подключения.
+     *
+     * @return Признак возможности отправить ответ
+     */
+    [[nodiscard]] bool Finish() noexcept;
+
+    /**
+     * @brief Указатель на запрос в библиотеке libevent.
+     */
+    evhttp_request *req_;
+
+    /**
+     * @brief Запрос HTTP.
+     */
+    RequestImpl request_;
+
+    /**
+     * @brief Ответ HTTP.
+     */
+    ResponseImpl response_;
+
+    /**
+     * @brief Трассировка запроса. Пустой указатель - трассировка завершена.
+     */
+    std::unique_ptr<Trace> trace_;
+
+    /**
+     * @brief Таймер срока обработки запроса.
+     */
+    event *timer_{nullptr};
+
+    /**
+     * @brief Признак отложенного ответа.
+     */
+    bool deferred_{false};
+
+    /**
+     * @brief Признак завершения обмена.
+     */
+    bool done_{false};
+};
+
+}  // namespace tasp::http
+
+#endif  // TASP_HTTP_EXCHANGE_HPP_
@@ -1,5 +1,7 @@
 #include "header_impl.hpp"
 
+#include <sys/socket.h>
+
 #include <string>
 
 using std::string;
@@ -28,13 +30,54 @@ HeaderImpl::HeaderImpl(evhttp_request *req, Header::Type type) noexcept
         headers_.insert_or_assign(header->key, header->value);
     }
 
+    // у запросов, сформированных внутри сервиса, подключение отсутствует
+    auto *connection{evhttp_request_get_connection(req)};
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    // через сокет Unix подключается локальный обратный прокси-сервер, адрес
+    // клиента берётся из переданных им заголовков
+    const auto *addr{evhttp_connection_get_addr(connection)};
+    if (addr != nullptr && addr->sa_family == AF_UNIX)
+    {
+        headers_.insert_or_assign("client", UnixClient());
+        return;
+    }
+
     char *client_ip{};
     u_short client_port{};
 
-    evhttp_connection_get_peer(
-        evhttp_request_get_connection(req), &client_ip, &client_port);
+    evhttp_connection_get_peer(connection, &client_ip, &client_port);
+
+    if (client_ip != nullptr)
+    {
+        headers_.insert_or_assign("client", client_ip);
+    }
+}
+
+//------------------------------------------------------------------------------
+string HeaderImpl::UnixClient() const noexcept
+{
+    const string &real_ip{Get("X-Real-IP")};
+    if (!real_ip.empty())
+    {
+        return real_ip;
+    }
+
+    // первый адрес в списке - исходный клиент
+    string_view forwarded{Get("X-Forwarded-For")};
+    forwarded = forwarded.substr(0, forwarded.find(','));
+
+    const auto first{forwarded.find_first_not_of(' ')};
+    if (first != string_view::npos)
+    {
+        forwarded = forwarded.substr(first);
+        return string{forwarded.substr(0, forwarded.find(' '))};
+    }
 
-    headers_.insert_or_assign("client", client_ip);
+    return "unix";
 }
 
 //------------------------------------------------------------------------------
@@ -58,6 +58,14 @@ public:
     HeaderImpl &operator=(HeaderImpl &&) = delete;
 
 private:
+    /**
+     * @brief Определение адреса клиента, подключившегося через сокет Unix, по
+     * заголовкам X-Real-IP и X-Forwarded-For.
+     *
+     * @return Адрес клиента или "unix", если заголовки отсутствуют
+     */
+    [[nodiscard]] std::string UnixClient() const noexcept;
+
     /**
      * @brief Указатель на заголовки.
      */
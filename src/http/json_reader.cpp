@@ -0,0 +1,84 @@
+#include "json_reader.hpp"
+
+#include <memory>
+
+using std::string;
+using std::string_view;
+
+namespace tasp::http
+{
+
+namespace
+{
+/**
+ * @brief Параметры разбора.
+ */
+JsonReader::Settings settings;  // NOLINT(cert-err58-cpp)
+
+/**
+ * @brief Номер версии параметров разбора. Увеличивается при изменении
+ * параметров, чтобы потоки пересоздали объекты разбора.
+ */
+size_t generation{0};
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    JsonReader
+------------------------------------------------------------------------------*/
+void JsonReader::Configure(const Settings &new_settings) noexcept
+{
+    settings = new_settings;
+    generation++;
+}
+
+//------------------------------------------------------------------------------
+const JsonReader::Settings &JsonReader::GetSettings() noexcept
+{
+    return settings;
+}
+
+//------------------------------------------------------------------------------
+JsonReader::Result JsonReader::Read(string_view data,
+                                    Json::Value &value,
+                                    string &errors) noexcept
+{
+    if (data.size() > settings.max_size)
+    {
+        errors = "Превышен допустимый размер данных";
+        return Result::TooLarge;
+    }
+
+    thread_local std::unique_ptr<Json::CharReader> reader;
+    thread_local size_t reader_generation{0};
+
+    if (!reader || reader_generation != generation)
+    {
+        Json::CharReaderBuilder builder;
+        builder["collectComments"] = false;
+        builder["stackLimit"] = static_cast<Json::UInt64>(settings.max_depth);
+
+        reader.reset(builder.newCharReader());
+        reader_generation = generation;
+    }
+
+    try
+    {
+        const char *begin{data.data()};
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const char *end{begin + data.size()};
+
+        if (reader->parse(begin, end, &value, &errors))
+        {
+            return Result::Ok;
+        }
+    }
+    catch (const Json::Exception &exception)
+    {
+        errors = exception.what();
+    }
+
+    return Result::Invalid;
+}
+
+}  // namespace tasp::http
@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief Разбор данных запроса HTTP в формате JSON.
+ */
+#ifndef TASP_HTTP_JSON_READER_HPP_
+#define TASP_HTTP_JSON_READER_HPP_
+
+#include <jsoncpp/json/json.h>
+
+#include <string>
+#include <string_view>
+
+namespace tasp::http
+{
+
+/**
+ * @brief Разбор данных в формате JSON с ограничениями на размер и вложенность.
+ *
+ * Объект разбора создаётся один раз для каждого потока и переиспользуется до
+ * изменения параметров.
+ */
+class JsonReader final
+{
+public:
+    /**
+     * @brief Параметры разбора.
+     */
+    struct Settings
+    {
+        /**
+         * @brief Максимальный размер данных в байтах.
+         */
+        size_t max_size{16 * 1024 * 1024};
+
+        /**
+         * @brief Максимальная глубина вложенности.
+         */
+        size_t max_depth{64};
+    };
+
+    /**
+     * @brief Результат разбора.
+     */
+    enum class Result
+    {
+        Ok,
+        TooLarge,
+        Invalid
+    };
+
+    /**
+     * @brief Установка параметров разбора.
+     *
+     * Вызывается при отсутствии потоков обработки событий.
+     *
+     * @param settings Параметры разбора
+     */
+    static void Configure(const Settings &settings) noexcept;
+
+    /**
+     * @brief Запрос параметров разбора.
+     *
+     * @return Параметры разбора
+     */
+    [[nodiscard]] static const Settings &GetSettings() noexcept;
+
+    /**
+     * @brief Разбор данных.
+     *
+     * @param data Данные
+     * @param value Результат разбора
+     * @param errors Описание ошибок разбора
+     *
+     * @return Результат разбора
+     */
+    [[nodiscard]] static Result Read(std::string_view data,
+                                     Json::Value &value,
+                                     std::string &errors) noexcept;
+};
+
+}  // namespace tasp::http
+
+#endif  // TASP_HTTP_JSON_READER_HPP_
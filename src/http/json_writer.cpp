@@ -0,0 +1,99 @@
+#include "json_writer.hpp"
+
+#include <memory>
+#include <ostream>
+
+namespace tasp::http
+{
+
+namespace
+{
+/**
+ * @brief Размер области буфера, резервируемой за один раз.
+ */
+constexpr ev_ssize_t reserve_size{16 * 1024};
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    EvBufferStreamBuf
+------------------------------------------------------------------------------*/
+EvBufferStreamBuf::EvBufferStreamBuf(evbuffer *buffer) noexcept
+: buffer_(buffer)
+{
+}
+
+//------------------------------------------------------------------------------
+EvBufferStreamBuf::~EvBufferStreamBuf() noexcept
+{
+    Commit();
+}
+
+//------------------------------------------------------------------------------
+EvBufferStreamBuf::int_type EvBufferStreamBuf::overflow(int_type ch)
+{
+    Commit();
+
+    if (evbuffer_reserve_space(buffer_, reserve_size, &reserved_, 1) < 1)
+    {
+        reserved_ = {};
+        return traits_type::eof();
+    }
+
+    auto *begin{static_cast<char *>(reserved_.iov_base)};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    setp(begin, begin + reserved_.iov_len);
+
+    if (!traits_type::eq_int_type(ch, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(ch);
+}
+
+//------------------------------------------------------------------------------
+int EvBufferStreamBuf::sync()
+{
+    Commit();
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+void EvBufferStreamBuf::Commit() noexcept
+{
+    if (reserved_.iov_base == nullptr)
+    {
+        return;
+    }
+
+    reserved_.iov_len = static_cast<size_t>(pptr() - pbase());
+    evbuffer_commit_space(buffer_, &reserved_, 1);
+
+    reserved_ = {};
+    setp(nullptr, nullptr);
+}
+
+/*------------------------------------------------------------------------------
+    JsonWriter
+------------------------------------------------------------------------------*/
+void JsonWriter::Write(const Json::Value &value, evbuffer *output) noexcept
+{
+    thread_local const std::unique_ptr<Json::StreamWriter> writer{
+        []
+        {
+            Json::StreamWriterBuilder builder;
+            builder["indentation"] = "";
+            builder["emitUTF8"] = true;
+            return std::unique_ptr<Json::StreamWriter>(
+                builder.newStreamWriter());
+        }()};
+
+    EvBufferStreamBuf buffer(output);
+    std::ostream stream(&buffer);
+
+    writer->write(value, &stream);
+}
+
+}  // namespace tasp::http
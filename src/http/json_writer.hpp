@@ -0,0 +1,100 @@
+/**
+ * @file
+ * @brief Сериализация данных в формате JSON в буфер ответа HTTP.
+ */
+#ifndef TASP_HTTP_JSON_WRITER_HPP_
+#define TASP_HTTP_JSON_WRITER_HPP_
+
+#include <event2/buffer.h>
+#include <jsoncpp/json/json.h>
+
+#include <streambuf>
+#include <string_view>
+
+namespace tasp::http
+{
+
+/**
+ * @brief Поток вывода, записывающий данные непосредственно в зарезервированное
+ * место буфера libevent.
+ */
+class EvBufferStreamBuf final : public std::streambuf
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param buffer Буфер для записи
+     */
+    explicit EvBufferStreamBuf(evbuffer *buffer) noexcept;
+
+    /**
+     * @brief Деструктор. Фиксирует записанные данные в буфере.
+     */
+    ~EvBufferStreamBuf() noexcept override;
+
+    EvBufferStreamBuf(const EvBufferStreamBuf &) = delete;
+    EvBufferStreamBuf(EvBufferStreamBuf &&) = delete;
+    EvBufferStreamBuf &operator=(const EvBufferStreamBuf &) = delete;
+    EvBufferStreamBuf &operator=(EvBufferStreamBuf &&) = delete;
+
+protected:
+    /**
+     * @brief Фиксация заполненной области и резервирование новой.
+     *
+     * @param ch Символ, не поместившийся в заполненную область
+     *
+     * @return Записанный символ или признак ошибки
+     */
+    int_type overflow(int_type ch) override;
+
+    /**
+     * @brief Фиксация записанных данных в буфере.
+     *
+     * @return 0 - при успешной фиксации
+     */
+    int sync() override;
+
+private:
+    /**
+     * @brief Фиксация записанных данных в буфере.
+     */
+    void Commit() noexcept;
+
+    /**
+     * @brief Буфер для записи.
+     */
+    evbuffer *buffer_;
+
+    /**
+     * @brief Зарезервированная область буфера.
+     */
+    evbuffer_iovec reserved_{};
+};
+
+/**
+ * @brief Сериализация данных в компактном формате JSON.
+ *
+ * Объект сериализации создаётся один раз для каждого потока и
+ * переиспользуется.
+ */
+class JsonWriter final
+{
+public:
+    /**
+     * @brief Тип данных JSON.
+     */
+    static constexpr std::string_view type{"application/json"};
+
+    /**
+     * @brief Сериализация значения в буфер.
+     *
+     * @param value Значение
+     * @param output Буфер для записи
+     */
+    static void Write(const Json::Value &value, evbuffer *output) noexcept;
+};
+
+}  // namespace tasp::http
+
+#endif  // TASP_HTTP_JSON_WRITER_HPP_
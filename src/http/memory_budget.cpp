@@ -0,0 +1,219 @@
+#include "memory_budget.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace tasp::http
+{
+
+namespace
+{
+/**
+ * @brief Порядок доступа к счётчикам бюджета.
+ */
+constexpr auto relaxed{std::memory_order_relaxed};
+
+/**
+ * @brief Параметры бюджета.
+ */
+MemoryBudget::Settings settings;  // NOLINT(cert-err58-cpp)
+
+/**
+ * @brief Учтённый объём памяти в байтах.
+ */
+std::atomic<size_t> used{0};
+
+/**
+ * @brief Количество запросов, не поместившихся в бюджет.
+ */
+std::atomic<uint64_t> rejected{0};
+
+//------------------------------------------------------------------------------
+bool Acquire(size_t bytes, bool force) noexcept
+{
+    if (!settings.enabled || bytes == 0)
+    {
+        return true;
+    }
+
+    if (force || settings.limit == 0)
+    {
+        used.fetch_add(bytes, relaxed);
+        return true;
+    }
+
+    size_t current{used.load(relaxed)};
+    do
+    {
+        if (current + bytes > settings.limit)
+        {
+            rejected.fetch_add(1, relaxed);
+            return false;
+        }
+    } while (!used.compare_exchange_weak(current, current + bytes, relaxed));
+
+    return true;
+}
+
+/**
+ * @brief Тело ответа, на которое ссылается буфер отправки.
+ */
+struct Tracked
+{
+    /**
+     * @brief Данные тела ответа.
+     */
+    std::unique_ptr<evbuffer, decltype(&evbuffer_free)> data{evbuffer_new(),
+                                                              evbuffer_free};
+
+    /**
+     * @brief Учтённый объём.
+     */
+    MemoryBudget::Charge charge;
+
+    /**
+     * @brief Количество ссылок буфера отправки.
+     */
+    size_t refs{0};
+};
+
+//------------------------------------------------------------------------------
+void Unref(const void * /*data*/, size_t /*length*/, void *arg) noexcept
+{
+    auto *tracked{static_cast<Tracked *>(arg)};
+    if (--tracked->refs == 0)
+    {
+        delete tracked;  // NOLINT(cppcoreguidelines-owning-memory)
+    }
+}
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    MemoryBudget::Charge
+------------------------------------------------------------------------------*/
+MemoryBudget::Charge::Charge(size_t bytes, bool force) noexcept
+: granted_(Acquire(bytes, force))
+{
+    if (granted_ && settings.enabled)
+    {
+        bytes_ = bytes;
+    }
+}
+
+//------------------------------------------------------------------------------
+MemoryBudget::Charge::~Charge() noexcept
+{
+    if (bytes_ != 0)
+    {
+        used.fetch_sub(bytes_, relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+MemoryBudget::Charge::Charge(Charge &&other) noexcept
+: bytes_(std::exchange(other.bytes_, 0))
+, granted_(other.granted_)
+{
+}
+
+//------------------------------------------------------------------------------
+MemoryBudget::Charge &MemoryBudget::Charge::operator=(Charge &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (bytes_ != 0)
+        {
+            used.fetch_sub(bytes_, relaxed);
+        }
+        bytes_ = std::exchange(other.bytes_, 0);
+        granted_ = other.granted_;
+    }
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+bool MemoryBudget::Charge::Granted() const noexcept
+{
+    return granted_;
+}
+
+/*------------------------------------------------------------------------------
+    MemoryBudget
+------------------------------------------------------------------------------*/
+void MemoryBudget::Configure(const Settings &new_settings) noexcept
+{
+    settings = new_settings;
+}
+
+//------------------------------------------------------------------------------
+size_t MemoryBudget::Limit() noexcept
+{
+    return settings.enabled ? settings.limit : 0;
+}
+
+//------------------------------------------------------------------------------
+size_t MemoryBudget::Used() noexcept
+{
+    return used.load(relaxed);
+}
+
+//------------------------------------------------------------------------------
+uint64_t MemoryBudget::Rejected() noexcept
+{
+    return rejected.load(relaxed);
+}
+
+//------------------------------------------------------------------------------
+size_t MemoryBudget::BodyLimit(size_t max_body_size) noexcept
+{
+    const size_t limit{Limit()};
+    if (limit == 0)
+    {
+        return max_body_size;
+    }
+
+    const size_t current{used.load(relaxed)};
+    return std::min(max_body_size, current < limit ? limit - current : 0);
+}
+
+//------------------------------------------------------------------------------
+void MemoryBudget::Track(evbuffer *source, evbuffer *output) noexcept
+{
+    const size_t length{evbuffer_get_length(source)};
+    if (length == 0 || Limit() == 0)
+    {
+        evbuffer_add_buffer(output, source);
+        return;
+    }
+
+    auto tracked{std::make_unique<Tracked>()};
+    evbuffer_add_buffer(tracked->data.get(), source);
+
+    // тело ответа уже сформировано, поэтому учитывается сверх бюджета
+    tracked->charge = Charge(length, true);
+
+    const int count{
+        evbuffer_peek(tracked->data.get(), -1, nullptr, nullptr, 0)};
+    std::vector<evbuffer_iovec> chunks(static_cast<size_t>(count));
+    evbuffer_peek(tracked->data.get(), -1, nullptr, chunks.data(), count);
+
+    tracked->refs = chunks.size() + 1;
+    auto *holder{tracked.release()};
+    for (const auto &chunk : chunks)
+    {
+        if (evbuffer_add_reference(
+                output, chunk.iov_base, chunk.iov_len, &Unref, holder) != 0)
+        {
+            holder->refs--;
+        }
+    }
+
+    // собственная ссылка удерживает данные до добавления всех частей
+    Unref(nullptr, 0, holder);
+}
+
+}  // namespace tasp::http
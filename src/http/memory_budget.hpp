@@ -0,0 +1,160 @@
+/**
+ * @file
+ * @brief Учёт памяти, занятой данными запросов и ответов.
+ */
+#ifndef TASP_HTTP_MEMORY_BUDGET_HPP_
+#define TASP_HTTP_MEMORY_BUDGET_HPP_
+
+#include <event2/buffer.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tasp::http
+{
+
+/**
+ * @brief Общий для процесса бюджет памяти данных запросов, ответов и кэшей.
+ *
+ * Данные запроса учитываются на время существования запроса, крупные тела
+ * ответов - до их отправки клиенту, записи кэша ответов - до их вытеснения.
+ * Запросы, данные которых не помещаются в бюджет, отклоняются: до чтения
+ * данных - библиотекой libevent с кодом 413 (максимальный размер данных
+ * запроса уменьшается до остатка бюджета), после чтения - с кодом 503.
+ */
+class MemoryBudget final
+{
+public:
+    /**
+     * @brief Параметры бюджета памяти.
+     */
+    struct Settings
+    {
+        /**
+         * @brief Признак включения учёта.
+         */
+        bool enabled{true};
+
+        /**
+         * @brief Размер бюджета в байтах, 0 - без ограничения.
+         */
+        size_t limit{0};
+    };
+
+    /**
+     * @brief Учтённый в бюджете объём памяти. Освобождается при удалении
+     * объекта.
+     */
+    class Charge final
+    {
+    public:
+        /**
+         * @brief Конструктор пустого объёма.
+         */
+        Charge() noexcept = default;
+
+        /**
+         * @brief Конструктор. Объём учитывается, только если помещается в
+         * бюджет или учёт обязателен.
+         *
+         * @param bytes Объём в байтах
+         * @param force Признак учёта сверх бюджета
+         */
+        explicit Charge(size_t bytes, bool force = false) noexcept;
+
+        /**
+         * @brief Деструктор. Освобождает объём.
+         */
+        ~Charge() noexcept;
+
+        /**
+         * @brief Признак учёта объёма в бюджете.
+         *
+         * @return false, если объём не поместился в бюджет
+         */
+        [[nodiscard]] bool Granted() const noexcept;
+
+        /**
+         * @brief Конструктор перемещения.
+         *
+         * @param other Перемещаемый объём
+         */
+        Charge(Charge &&other) noexcept;
+
+        /**
+         * @brief Оператор перемещения. Ранее учтённый объём освобождается.
+         *
+         * @param other Перемещаемый объём
+         *
+         * @return Объём
+         */
+        Charge &operator=(Charge &&other) noexcept;
+
+        Charge(const Charge &) = delete;
+        Charge &operator=(const Charge &) = delete;
+
+    private:
+        /**
+         * @brief Учтённый объём в байтах.
+         */
+        size_t bytes_{0};
+
+        /**
+         * @brief Признак учёта объёма.
+         */
+        bool granted_{true};
+    };
+
+    /**
+     * @brief Установка параметров бюджета.
+     *
+     * Вызывается при отсутствии потоков обработки событий.
+     *
+     * @param settings Параметры
+     */
+    static void Configure(const Settings &settings) noexcept;
+
+    /**
+     * @brief Запрос размера бюджета.
+     *
+     * @return Размер в байтах, 0 - без ограничения
+     */
+    [[nodiscard]] static size_t Limit() noexcept;
+
+    /**
+     * @brief Запрос учтённого объёма памяти.
+     *
+     * @return Объём в байтах
+     */
+    [[nodiscard]] static size_t Used() noexcept;
+
+    /**
+     * @brief Запрос количества запросов, отклонённых после чтения данных.
+     *
+     * @return Количество запросов
+     */
+    [[nodiscard]] static uint64_t Rejected() noexcept;
+
+    /**
+     * @brief Запрос максимального размера данных нового запроса.
+     *
+     * @param max_body_size Максимальный размер из параметров сервиса
+     *
+     * @return Меньшее из max_body_size и остатка бюджета
+     */
+    [[nodiscard]] static size_t BodyLimit(size_t max_body_size) noexcept;
+
+    /**
+     * @brief Перенос данных тела ответа в буфер отправки с учётом в бюджете
+     * до их отправки клиенту. Данные не копируются: буфер отправки ссылается
+     * на них, и объём освобождается при удалении последней ссылки.
+     *
+     * @param source Тело ответа, после вызова пусто
+     * @param output Буфер отправки
+     */
+    static void Track(evbuffer *source, evbuffer *output) noexcept;
+};
+
+}  // namespace tasp::http
+
+#endif  // TASP_HTTP_MEMORY_BUDGET_HPP_
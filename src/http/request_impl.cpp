@@ -2,12 +2,16 @@
 
 #include <tasp/logging.hpp>
 
+#include "binary_format.hpp"
 #include "header_impl.hpp"
+#include "json_writer.hpp"
+#include "trace.hpp"
 #include "uri_impl.hpp"
 
 using std::make_shared;
 using std::shared_ptr;
 using std::string;
+using std::string_view;
 
 namespace tasp::http
 {
@@ -21,18 +25,27 @@ RequestImpl::RequestImpl(evhttp_request *req) noexcept
 , method_(static_cast<Request::Method>(req_->type))
 , headers_(make_shared<HeaderImpl>(req_))
 , data_(make_shared<http::Data>())
+, deadline_(make_shared<Deadline>(req_))
+, charge_(evbuffer_get_length(evhttp_request_get_input_buffer(req_)))
 {
     const string &url = uri_->Url();
     const string &client = headers_->Get("client");
     const string &method = MethodToString(method_);
 
-    Logging::Info("HTTP-запрос {} {} от клиента {}", method, url, client);
-
-    ReadInputBuffer();
+    const auto *trace{Trace::Current()};
+    Logging::Info("HTTP-запрос {} {} от клиента {}, трассировка {}",
+                  method,
+                  url,
+                  client,
+                  trace != nullptr ? trace->TraceId() : string_view{});
 }
 
 //------------------------------------------------------------------------------
-RequestImpl::~RequestImpl() noexcept = default;
+RequestImpl::~RequestImpl() noexcept
+{
+    // признак отмены может пережить запрос, а подключение - нет
+    deadline_->Detach();
+}
 
 //------------------------------------------------------------------------------
 shared_ptr<Uri> RequestImpl::Uri() const noexcept
@@ -59,20 +72,67 @@ shared_ptr<Data> RequestImpl::Data() const noexcept
 }
 
 //------------------------------------------------------------------------------
-void RequestImpl::ReadInputBuffer() noexcept
+const shared_ptr<Deadline> &RequestImpl::GetDeadline() const noexcept
+{
+    return deadline_;
+}
+
+//------------------------------------------------------------------------------
+evhttp_request *RequestImpl::Native() const noexcept
+{
+    return req_;
+}
+
+//------------------------------------------------------------------------------
+bool RequestImpl::WithinBudget() const noexcept
+{
+    return charge_.Granted();
+}
+
+//------------------------------------------------------------------------------
+JsonReader::Result RequestImpl::ReadInputBuffer(bool lazy) noexcept
 {
     struct evbuffer *buf = evhttp_request_get_input_buffer(req_);
 
     auto length = evbuffer_get_length(buf);
-    if (length > 0)
+    if (length == 0)
     {
-        Logging::Debug("Размер данных: {}", length);
+        return JsonReader::Result::Ok;
+    }
+
+    Logging::Debug("Размер данных: {}", length);
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const string_view str{reinterpret_cast<char *>(evbuffer_pullup(buf, -1)),
+                          length};
+
+    const string &type{headers_->Get("Content-Type")};
+
+    // двоичные данные не имеют текстового представления и разбираются сразу
+    const auto format{BinaryFormat::FromContentType(type)};
+    const bool binary{format != BinaryFormat::Format::Json};
 
-        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-        const string str{reinterpret_cast<char *>(evbuffer_pullup(buf, -1)),
-                         length};
-        data_->Set(str);
+    if (!binary &&
+        (lazy ||
+         type.compare(0, JsonWriter::type.size(), JsonWriter::type) != 0))
+    {
+        data_->Set(string{str});
+        return JsonReader::Result::Ok;
+    }
+
+    Json::Value value;
+    string errors;
+
+    const auto result{binary ? BinaryFormat::Read(format, str, value, errors)
+                             : JsonReader::Read(str, value, errors)};
+    if (result != JsonReader::Result::Ok)
+    {
+        Logging::Warning("Ошибка разбора данных запроса: {}", errors);
+        return result;
     }
+
+    data_->Set(value);
+    return result;
 }
 
 }  // namespace tasp::http
@@ -8,10 +8,16 @@
 #include <evhttp.h>
 #include <jsoncpp/json/json.h>
 
+#include <memory>
+
 #include <tasp/http/header.hpp>
 #include <tasp/http/request.hpp>
 #include <tasp/http/uri.hpp>
 
+#include "deadline.hpp"
+#include "json_reader.hpp"
+#include "memory_budget.hpp"
+
 namespace tasp::http
 {
 
@@ -65,8 +71,38 @@ public:
     /**
      * @brief Чтение данные запроса из буфера библиотеки libevent во внутренний
      * буфер.
+     *
+     * Данные с типом application/json разбираются сразу, непосредственно из
+     * буфера libevent. Остальные данные, а также данные при отложенном разборе,
+     * передаются в текстовом виде и разбираются при обращении к ним.
+     *
+     * @param lazy Признак отложенного разбора данных
+     *
+     * @return Результат разбора
+     */
+    [[nodiscard]] JsonReader::Result ReadInputBuffer(bool lazy) noexcept;
+
+    /**
+     * @brief Запрос срока обработки запроса.
+     *
+     * @return Срок обработки
      */
-    void ReadInputBuffer() noexcept;
+    [[nodiscard]] const std::shared_ptr<Deadline> &GetDeadline()
+        const noexcept;
+
+    /**
+     * @brief Запрос указателя на запрос в библиотеке libevent.
+     *
+     * @return Указатель на запрос
+     */
+    [[nodiscard]] evhttp_request *Native() const noexcept;
+
+    /**
+     * @brief Запрос признака учёта данных запроса в бюджете памяти.
+     *
+     * @return false, если данные не поместились в бюджет
+     */
+    [[nodiscard]] bool WithinBudget() const noexcept;
 
     RequestImpl(const RequestImpl &) = delete;
     RequestImpl(RequestImpl &&) = delete;
@@ -98,6 +134,16 @@ private:
      * @brief Данные запроса.
      */
     std::shared_ptr<http::Data> data_;
+
+    /**
+     * @brief Срок обработки запроса.
+     */
+    std::shared_ptr<Deadline> deadline_;
+
+    /**
+     * @brief Объём данных запроса в бюджете памяти.
+     */
+    MemoryBudget::Charge charge_;
 };
 
 }  // namespace tasp::http
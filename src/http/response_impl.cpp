@@ -2,18 +2,33 @@
 
 #include <tasp/logging.hpp>
 
+#include "../hash.hpp"
+#include "binary_format.hpp"
+#include "compression.hpp"
+#include "exchange.hpp"
+#include "json_writer.hpp"
+#include "memory_budget.hpp"
+#include "trace.hpp"
+
 using std::make_shared;
+using std::pair;
 using std::shared_ptr;
 using std::string;
 using std::string_view;
+using std::vector;
 
 namespace tasp::http
 {
 
+namespace
+{
 /**
- * @brief Умный указатель буфера данных библиотеки libevent.
+ * @brief Минимальный размер тела ответа, учитываемого в бюджете памяти до
+ * отправки клиенту.
  */
-using EvBuffer = std::unique_ptr<evbuffer, decltype(&evbuffer_free)>;
+constexpr size_t tracked_size{64 * 1024};
+
+}  // namespace
 
 /*------------------------------------------------------------------------------
     ResponseImpl
@@ -47,6 +62,21 @@ shared_ptr<Header> ResponseImpl::Header() const noexcept
     return headers_;
 }
 
+//------------------------------------------------------------------------------
+vector<pair<string, string>> ResponseImpl::Headers() const noexcept
+{
+    vector<pair<string, string>> headers;
+
+    auto *ev_headers{evhttp_request_get_output_headers(req_)};
+    for (evkeyval *header = ev_headers->tqh_first; header != nullptr;
+         header = header->next.tqe_next)
+    {
+        headers.emplace_back(header->key, header->value);
+    }
+
+    return headers;
+}
+
 //------------------------------------------------------------------------------
 shared_ptr<Data> ResponseImpl::Data() const noexcept
 {
@@ -58,26 +88,321 @@ void ResponseImpl::SetError(Code code, string_view message) noexcept
 {
     SetCode(code);
 
+    // сообщение об ошибке заменяет тело, уже записанное обработчиком
+    evbuffer_drain(body_.get(), evbuffer_get_length(body_.get()));
+    serialized_ = false;
+
     Json::Value root;
     root["message"] = message.data();
     Data()->Set(root);
 }
 
+//------------------------------------------------------------------------------
+void ResponseImpl::SetBody(string_view type,
+                           string_view body,
+                           string_view etag) noexcept
+{
+    evbuffer_add(BodyBuffer(type), body.data(), body.length());
+    etag_ = etag;
+}
+
+//------------------------------------------------------------------------------
+evbuffer *ResponseImpl::BodyBuffer(string_view type) noexcept
+{
+    evbuffer_drain(body_.get(), evbuffer_get_length(body_.get()));
+
+    type_ = type;
+    etag_.clear();
+    serialized_ = true;
+
+    return body_.get();
+}
+
+//------------------------------------------------------------------------------
+string_view ResponseImpl::Body() noexcept
+{
+    Serialize();
+
+    const auto length{evbuffer_get_length(body_.get())};
+    if (length == 0)
+    {
+        return {};
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return {reinterpret_cast<char *>(evbuffer_pullup(body_.get(), -1)), length};
+}
+
+//------------------------------------------------------------------------------
+const string &ResponseImpl::Type() noexcept
+{
+    Serialize();
+    return type_;
+}
+
+//------------------------------------------------------------------------------
+void ResponseImpl::EnableETag() noexcept
+{
+    etag_enabled_ = true;
+}
+
+//------------------------------------------------------------------------------
+const string &ResponseImpl::ETag() noexcept
+{
+    if (etag_.empty())
+    {
+        static constexpr string_view digits{"0123456789abcdef"};
+
+        uint64_t hash{Hash64(Body())};
+
+        // строгий ETag: 16 шестнадцатеричных цифр хеша в кавычках
+        string etag(16 + 2, '"');
+        for (size_t i = 16; i > 0; i--)
+        {
+            etag[i] = digits[hash & 0xFU];
+            hash >>= 4U;
+        }
+        etag_ = std::move(etag);
+    }
+
+    return etag_;
+}
+
+//------------------------------------------------------------------------------
+bool ResponseImpl::NotModified(string_view etag) const noexcept
+{
+    const char *header{evhttp_find_header(
+        evhttp_request_get_input_headers(req_), "If-None-Match")};
+    if (header == nullptr)
+    {
+        return false;
+    }
+
+    string_view tags{header};
+    while (!tags.empty())
+    {
+        const auto comma{tags.find(',')};
+        string_view tag{tags.substr(0, comma)};
+        tags.remove_prefix(comma == string_view::npos ? tags.size()
+                                                      : comma + 1);
+
+        const auto first{tag.find_first_not_of(" \t")};
+        if (first == string_view::npos)
+        {
+            continue;
+        }
+        tag = tag.substr(first, tag.find_last_not_of(" \t") - first + 1);
+
+        // If-None-Match использует слабое сравнение
+        if (tag.substr(0, 2) == "W/")
+        {
+            tag.remove_prefix(2);
+        }
+
+        if (tag == "*" || tag == etag)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void ResponseImpl::Serialize() noexcept
+{
+    if (serialized_)
+    {
+        return;
+    }
+
+    const Trace::Scope trace(Trace::Phase::Serialize);
+
+    serialized_ = true;
+
+    const auto format{ResolveType()};
+    if (negotiated_)
+    {
+        // те же данные передаются в двоичном формате без формирования текста
+        if (format != BinaryFormat::Format::Json)
+        {
+            BinaryFormat::Write(format, data_->Get<Json::Value>(), body_.get());
+            return;
+        }
+
+        JsonWriter::Write(data_->Get<Json::Value>(), body_.get());
+        return;
+    }
+
+    const auto data{data_->Get<string>()};
+    evbuffer_add(body_.get(), data.data(), data.length());
+}
+
+//------------------------------------------------------------------------------
+BinaryFormat::Format ResponseImpl::ResolveType() noexcept
+{
+    type_ = data_->GetType();
+
+    if (type_ != JsonWriter::type)
+    {
+        return BinaryFormat::Format::Json;
+    }
+
+    negotiated_ = true;
+
+    const char *accept{
+        evhttp_find_header(evhttp_request_get_input_headers(req_), "Accept")};
+    const auto format{BinaryFormat::Negotiate(accept == nullptr ? "" : accept)};
+
+    if (format != BinaryFormat::Format::Json)
+    {
+        type_ = BinaryFormat::Type(format);
+    }
+
+    return format;
+}
+
 //------------------------------------------------------------------------------
 void ResponseImpl::Send() noexcept
 {
-    Logging::Info("HTTP-ответ {} клиенту {}",
+    // тело ответа на HEAD не передаётся и формируется, только если от него
+    // зависят ETag и выбор сжатия, совпадающие с ответом на GET
+    const bool head{evhttp_request_get_command(req_) == EVHTTP_REQ_HEAD};
+
+    if (!head || etag_enabled_ || Compression::Enabled())
+    {
+        Serialize();
+    }
+    else if (!serialized_)
+    {
+        ResolveType();
+    }
+
+    const Trace::Scope trace(Trace::Phase::Send);
+
+    const char *accept_encoding{evhttp_find_header(
+        evhttp_request_get_input_headers(req_), "Accept-Encoding")};
+
+    const auto encoding{Compression::Negotiate(
+        accept_encoding == nullptr ? "" : accept_encoding,
+        evbuffer_get_length(body_.get()))};
+
+    const bool binary{BinaryFormat::FromContentType(type_) !=
+                      BinaryFormat::Format::Json};
+
+    if (negotiated_ || binary)
+    {
+        headers_->Set("Vary",
+                      Compression::Enabled() ? "Accept, Accept-Encoding"
+                                             : "Accept");
+    }
+    else if (Compression::Enabled())
+    {
+        headers_->Set("Vary", "Accept-Encoding");
+    }
+
+    if (etag_enabled_ && code_ == Response::Code::Ok)
+    {
+        // сжатое представление должно иметь собственный строгий ETag
+        string etag{ETag()};
+        if (encoding != Compression::Encoding::Identity)
+        {
+            string suffix{"-"};
+            suffix.append(Compression::Name(encoding));
+            etag.insert(etag.length() - 1, suffix);
+        }
+
+        headers_->Set("ETag", etag);
+
+        if (NotModified(etag))
+        {
+            code_ = static_cast<Response::Code>(HTTP_NOTMODIFIED);
+        }
+    }
+
+    const auto *current{Trace::Current()};
+    Logging::Info("HTTP-ответ {} клиенту {}, трассировка {}",
                   static_cast<int>(code_),
-                  headers_->Get("client"));
+                  headers_->Get("client"),
+                  current != nullptr ? current->TraceId() : string_view{});
 
-    headers_->Set("Content-Type", data_->GetType() + "; charset=UTF-8");
+    if (static_cast<int>(code_) == HTTP_NOTMODIFIED)
+    {
+        Reply(HTTP_NOTMODIFIED, nullptr);
+        return;
+    }
 
-    const EvBuffer buffer{evbuffer_new(), evbuffer_free};
+    headers_->Set("Content-Type", binary ? type_ : type_ + "; charset=UTF-8");
+
+    // ответ на HEAD описывает представление, которое получит GET, но тело
+    // не сжимается: libevent его не передаёт
+    if (head && encoding != Compression::Encoding::Identity)
+    {
+        headers_->Set("Content-Encoding", Compression::Name(encoding));
+    }
+
+    if (head || encoding == Compression::Encoding::Identity)
+    {
+        // тело передаётся цепочками буфера без приведения к непрерывному виду
+        Reply(static_cast<int>(code_), body_.get());
+        return;
+    }
+
+    const EvBuffer compressed{evbuffer_new(), evbuffer_free};
+
+    if (Compression::Compress(encoding, Body(), compressed.get()))
+    {
+        headers_->Set("Content-Encoding", Compression::Name(encoding));
+        Reply(static_cast<int>(code_), compressed.get());
+        return;
+    }
+
+    Reply(static_cast<int>(code_), body_.get());
+}
+
+//------------------------------------------------------------------------------
+void ResponseImpl::SetReplySink(ReplySink sink) noexcept
+{
+    sink_ = sink;
+}
+
+//------------------------------------------------------------------------------
+void ResponseImpl::SetExchange(Exchange *exchange) noexcept
+{
+    exchange_ = exchange;
+}
+
+//------------------------------------------------------------------------------
+Exchange *ResponseImpl::GetExchange() const noexcept
+{
+    return exchange_;
+}
+
+//------------------------------------------------------------------------------
+bool ResponseImpl::Deferred() const noexcept
+{
+    return exchange_ != nullptr && exchange_->Deferred();
+}
+
+//------------------------------------------------------------------------------
+void ResponseImpl::Reply(int code, evbuffer *body) noexcept
+{
+    if (sink_)
+    {
+        sink_(req_, code, body);
+        return;
+    }
 
-    auto data = data_->Get<string>();
-    evbuffer_add(buffer.get(), data.data(), data.length());
+    // крупное тело учитывается в бюджете памяти до отправки клиенту
+    if (body != nullptr && evbuffer_get_length(body) >= tracked_size)
+    {
+        const EvBuffer tracked{evbuffer_new(), evbuffer_free};
+        MemoryBudget::Track(body, tracked.get());
+        evhttp_send_reply(req_, code, nullptr, tracked.get());
+        return;
+    }
 
-    evhttp_send_reply(req_, static_cast<int>(code_), nullptr, buffer.get());
+    evhttp_send_reply(req_, code, nullptr, body);
 }
 
 }  // namespace tasp::http
@@ -7,13 +7,34 @@
 
 #include <evhttp.h>
 
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tasp/function_ref.hpp>
 #include <tasp/http/response.hpp>
 
+#include "binary_format.hpp"
 #include "header_impl.hpp"
 
 namespace tasp::http
 {
 
+/**
+ * @brief Умный указатель буфера данных библиотеки libevent.
+ */
+using EvBuffer = std::unique_ptr<evbuffer, decltype(&evbuffer_free)>;
+
+/**
+ * @brief Функция передачи ответа для запросов, которые не принадлежат
+ * подключению HTTP-сервера libevent. Принимает запрос с заголовками ответа,
+ * код ответа и тело ответа (пустой указатель - без тела).
+ */
+using ReplySink = FunctionRef<void(evhttp_request *, int, evbuffer *)>;
+
+class Exchange;
+
 /**
  * @brief Реализация интерфейса для работы с ответом HTTP.
  */
@@ -54,6 +75,15 @@ public:
     [[nodiscard]] std::shared_ptr<http::Header> Header()
         const noexcept override;
 
+    /**
+     * @brief Запрос заголовков ответа, установленных к текущему моменту, в
+     * порядке добавления.
+     *
+     * @return Пары название - значение
+     */
+    [[nodiscard]] std::vector<std::pair<std::string, std::string>> Headers()
+        const noexcept;
+
     /**
      * @brief Запрос данных запроса в текстовом представлении.
      *
@@ -69,17 +99,131 @@ public:
      */
     void SetError(Code code, std::string_view message) noexcept override;
 
+    /**
+     * @brief Установка заранее сформированного тела ответа.
+     *
+     * @param type Тип данных
+     * @param body Тело ответа
+     * @param etag Значение заголовка ETag. Если не задано, вычисляется при
+     * необходимости.
+     */
+    void SetBody(std::string_view type,
+                 std::string_view body,
+                 std::string_view etag = {}) noexcept;
+
+    /**
+     * @brief Запрос буфера для записи тела ответа в обход данных ответа.
+     *
+     * После вызова данные ответа не сериализуются.
+     *
+     * @param type Тип данных
+     *
+     * @return Буфер тела ответа
+     */
+    [[nodiscard]] evbuffer *BodyBuffer(std::string_view type) noexcept;
+
+    /**
+     * @brief Запрос тела ответа в непрерывном виде. При первом вызове
+     * выполняется сериализация данных ответа.
+     *
+     * @return Тело ответа. Действительно до изменения или отправки ответа.
+     */
+    [[nodiscard]] std::string_view Body() noexcept;
+
+    /**
+     * @brief Запрос типа данных тела ответа.
+     *
+     * @return Тип данных
+     */
+    [[nodiscard]] const std::string &Type() noexcept;
+
+    /**
+     * @brief Включение формирования заголовка ETag и обработки условного
+     * запроса с заголовком If-None-Match.
+     */
+    void EnableETag() noexcept;
+
+    /**
+     * @brief Запрос значения заголовка ETag. При первом вызове вычисляется
+     * хеш тела ответа.
+     *
+     * @return Значение заголовка ETag
+     */
+    [[nodiscard]] const std::string &ETag() noexcept;
+
     /**
      * @brief Отправка ответа клиенту.
      */
     void Send() noexcept;
 
+    /**
+     * @brief Установка функции передачи ответа вместо evhttp_send_reply.
+     *
+     * @param sink Функция передачи ответа
+     */
+    void SetReplySink(ReplySink sink) noexcept;
+
+    /**
+     * @brief Установка обмена, которому принадлежит ответ. Только ответы,
+     * принадлежащие обмену, могут быть отложены.
+     *
+     * @param exchange Обмен
+     */
+    void SetExchange(Exchange *exchange) noexcept;
+
+    /**
+     * @brief Запрос обмена, которому принадлежит ответ.
+     *
+     * @return Обмен или пустой указатель
+     */
+    [[nodiscard]] Exchange *GetExchange() const noexcept;
+
+    /**
+     * @brief Запрос признака отложенного ответа. Отложенный ответ
+     * отправляется при завершении асинхронной обработки (AsyncReply).
+     *
+     * @return Признак отложенного ответа
+     */
+    [[nodiscard]] bool Deferred() const noexcept;
+
     ResponseImpl(const ResponseImpl &) = delete;
     ResponseImpl(ResponseImpl &&) = delete;
     ResponseImpl &operator=(const ResponseImpl &) = delete;
     ResponseImpl &operator=(ResponseImpl &&) = delete;
 
 private:
+    /**
+     * @brief Сериализация данных ответа, если тело ответа ещё не
+     * сформировано.
+     */
+    void Serialize() noexcept;
+
+    /**
+     * @brief Определение типа данных тела ответа без сериализации данных, в
+     * том числе выбор формата по заголовку Accept.
+     *
+     * @return Формат данных JSON
+     */
+    BinaryFormat::Format ResolveType() noexcept;
+
+    /**
+     * @brief Проверка совпадения ETag ответа со значением заголовка
+     * If-None-Match запроса.
+     *
+     * @param etag Значение заголовка ETag отправляемого представления
+     *
+     * @return Результат проверки
+     */
+    [[nodiscard]] bool NotModified(std::string_view etag) const noexcept;
+
+    /**
+     * @brief Передача ответа через libevent или функцию передачи ответа.
+     *
+     * @param code Код ответа
+     * @param body Тело ответа
+     */
+    void Reply(int code, evbuffer *body) noexcept;
+
     /**
      * @brief Указатель на ответ в библиотеке libevent.
      */
@@ -99,6 +243,47 @@ private:
      * @brief Данные запроса.
      */
     std::shared_ptr<http::Data> data_;
+
+    /**
+     * @brief Сформированное тело ответа.
+     */
+    EvBuffer body_{evbuffer_new(), evbuffer_free};
+
+    /**
+     * @brief Признак того, что тело ответа сформировано.
+     */
+    bool serialized_{false};
+
+    /**
+     * @brief Тип данных тела ответа.
+     */
+    std::string type_;
+
+    /**
+     * @brief Значение заголовка ETag.
+     */
+    std::string etag_;
+
+    /**
+     * @brief Признак выбора формата тела ответа по заголовку Accept.
+     */
+    bool negotiated_{false};
+
+    /**
+     * @brief Признак формирования заголовка ETag.
+     */
+    bool etag_enabled_{false};
+
+    /**
+     * @brief Функция передачи ответа. Пустая ссылка - ответ передаётся
+     * через подключение libevent.
+     */
+    ReplySink sink_;
+
+    /**
+     * @brief Обмен, которому принадлежит ответ.
+     */
+    Exchange *exchange_{nullptr};
 };
 
 }  // namespace tasp::http
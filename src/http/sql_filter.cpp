@@ -0,0 +1,339 @@
+#include "sql_filter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <tuple>
+#include <unordered_map>
+
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+using std::string_view;
+
+namespace tasp::http
+{
+
+namespace
+{
+/**
+ * @brief Операция условия.
+ */
+struct Operation
+{
+    /**
+     * @brief Название операции в параметре filter.
+     */
+    string_view name;
+
+    /**
+     * @brief Оператор SQL.
+     */
+    string_view sql;
+};
+
+/**
+ * @brief Поддерживаемые операции.
+ */
+constexpr std::array<Operation, 9> operations{{{"eq", "="},
+                                               {"ne", "<>"},
+                                               {"gt", ">"},
+                                               {"ge", ">="},
+                                               {"lt", "<"},
+                                               {"le", "<="},
+                                               {"like", "LIKE"},
+                                               {"ilike", "ILIKE"},
+                                               {"in", "IN"}}};
+
+/**
+ * @brief Разобранный параметр filter.
+ */
+struct Term
+{
+    string_view field;
+    const Operation *operation;
+    string_view value;
+    size_t count;
+};
+
+//------------------------------------------------------------------------------
+bool IsName(string_view name) noexcept
+{
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+    {
+        return false;
+    }
+
+    return std::all_of(name.begin(),
+                       name.end(),
+                       [](char ch)
+                       {
+                           return std::isalnum(static_cast<unsigned char>(
+                                      ch)) != 0 ||
+                                  ch == '_';
+                       });
+}
+
+//------------------------------------------------------------------------------
+bool IsIdentifier(string_view field) noexcept
+{
+    // имя столбца, возможно уточнённое именем таблицы: table.column
+    const auto dot{field.find('.')};
+    if (dot == string_view::npos)
+    {
+        return IsName(field);
+    }
+
+    return IsName(field.substr(0, dot)) && IsName(field.substr(dot + 1));
+}
+
+//------------------------------------------------------------------------------
+const Operation *FindOperation(string_view name) noexcept
+{
+    for (const auto &operation : operations)
+    {
+        if (operation.name == name)
+        {
+            return &operation;
+        }
+    }
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+bool IsIn(const Term &term) noexcept
+{
+    return term.operation->name == "in";
+}
+
+//------------------------------------------------------------------------------
+void AppendPlaceholder(string &text,
+                       SqlCondition::Placeholder placeholder,
+                       size_t &number) noexcept
+{
+    number++;
+    if (placeholder == SqlCondition::Placeholder::Question)
+    {
+        text += '?';
+        return;
+    }
+
+    text += '$';
+    text += std::to_string(number);
+}
+
+//------------------------------------------------------------------------------
+shared_ptr<const string> BuildText(const std::vector<Term> &terms,
+                                   SqlCondition::Placeholder placeholder)
+{
+    string text;
+    size_t number{0};
+
+    for (const auto &term : terms)
+    {
+        if (!text.empty())
+        {
+            text += " AND ";
+        }
+
+        text.append(term.field).append(" ").append(term.operation->sql);
+        text += " ";
+
+        if (!IsIn(term))
+        {
+            AppendPlaceholder(text, placeholder, number);
+            continue;
+        }
+
+        text += "(";
+        for (size_t i = 0; i < term.count; i++)
+        {
+            if (i != 0)
+            {
+                text += ", ";
+            }
+            AppendPlaceholder(text, placeholder, number);
+        }
+        text += ")";
+    }
+
+    return make_shared<const string>(std::move(text));
+}
+
+//------------------------------------------------------------------------------
+template <typename Func>
+void ForEachValue(string_view values, Func func) noexcept
+{
+    while (true)
+    {
+        const auto comma{values.find(',')};
+        func(values.substr(0, comma));
+        if (comma == string_view::npos)
+        {
+            return;
+        }
+        values.remove_prefix(comma + 1);
+    }
+}
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    SqlFilter
+------------------------------------------------------------------------------*/
+SqlFilter::Compiled SqlFilter::Compile(
+    const std::vector<string> &filters,
+    SqlCondition::Placeholder placeholder,
+    const std::vector<string> &fields) noexcept
+{
+    Compiled compiled;
+    if (filters.empty())
+    {
+        return compiled;
+    }
+
+    std::vector<Term> terms;
+    terms.reserve(filters.size());
+
+    size_t count{0};
+
+    for (const string_view filter : filters)
+    {
+        const auto first{filter.find(':')};
+        const auto second{first == string_view::npos
+                              ? string_view::npos
+                              : filter.find(':', first + 1)};
+
+        Term term{};
+        if (second != string_view::npos)
+        {
+            term.field = filter.substr(0, first);
+            term.operation =
+                FindOperation(filter.substr(first + 1, second - first - 1));
+            term.value = filter.substr(second + 1);
+        }
+
+        const bool allowed{
+            fields.empty() ||
+            std::find(fields.begin(), fields.end(), term.field) !=
+                fields.end()};
+
+        if (term.operation == nullptr || !IsIdentifier(term.field) ||
+            !allowed)
+        {
+            compiled.error = "Некорректный параметр filter: ";
+            compiled.error += filter;
+            return compiled;
+        }
+
+        term.count = 1;
+        if (IsIn(term))
+        {
+            term.count = static_cast<size_t>(
+                std::count(term.value.begin(), term.value.end(), ',') + 1);
+        }
+
+        count += term.count;
+        terms.push_back(term);
+    }
+
+    // одинаковые наборы условий в разном порядке дают один текст
+    std::stable_sort(terms.begin(),
+                     terms.end(),
+                     [](const Term &lhs, const Term &rhs)
+                     {
+                         return std::tie(lhs.field, lhs.operation->name) <
+                                std::tie(rhs.field, rhs.operation->name);
+                     });
+
+    // ключ кэша - вид условия без значений
+    string shape{placeholder == SqlCondition::Placeholder::Dollar ? "$" : "?"};
+    for (const auto &term : terms)
+    {
+        shape.append(term.field).append(":").append(term.operation->name);
+        shape.append(":").append(std::to_string(term.count)).append(";");
+    }
+
+    thread_local std::unordered_map<string, shared_ptr<const string>> cache;
+
+    auto it{cache.find(shape)};
+    if (it == cache.end())
+    {
+        if (cache.size() >= cache_size)
+        {
+            cache.clear();
+        }
+        it = cache.emplace(std::move(shape), BuildText(terms, placeholder))
+                 .first;
+    }
+    compiled.text = it->second;
+
+    compiled.params.reserve(count);
+    for (const auto &term : terms)
+    {
+        // шаблон сравнения всегда строка, даже если состоит из цифр
+        if (term.operation->name == "like" || term.operation->name == "ilike")
+        {
+            compiled.params.emplace_back(string{term.value});
+        }
+        else if (!IsIn(term))
+        {
+            compiled.params.push_back(ParseParam(term.value));
+        }
+        else
+        {
+            ForEachValue(term.value,
+                         [&compiled](string_view value)
+                         { compiled.params.push_back(ParseParam(value)); });
+        }
+    }
+
+    return compiled;
+}
+
+//------------------------------------------------------------------------------
+SqlCondition::Param SqlFilter::ParseParam(string_view value) noexcept
+{
+    if (value == "true" || value == "false")
+    {
+        return value == "true";
+    }
+
+    const char *begin{value.data()};
+    const char *end{value.data() + value.size()};
+
+    // ведущие нули (коды, номера) сохраняются в строке
+    const bool leading_zero{value.size() > 1 && value[0] == '0' &&
+                            std::isdigit(static_cast<unsigned char>(
+                                value[1])) != 0};
+
+    int64_t integer{0};
+    const auto [ptr, ec]{std::from_chars(begin, end, integer)};
+    if (ec == std::errc{} && ptr == end && !leading_zero)
+    {
+        return integer;
+    }
+
+    const bool numeric{
+        !value.empty() &&
+        value.find_first_not_of("0123456789+-.eE") == string_view::npos &&
+        std::isdigit(static_cast<unsigned char>(value.back())) != 0};
+    if (numeric && !leading_zero)
+    {
+        const string str{value};
+        char *parsed{nullptr};
+        const double real{std::strtod(str.c_str(), &parsed)};
+        if (parsed == str.c_str() + str.size() && std::isfinite(real))
+        {
+            return real;
+        }
+    }
+
+    return string{value};
+}
+
+}  // namespace tasp::http
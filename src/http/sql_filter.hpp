@@ -0,0 +1,84 @@
+/**
+ * @file
+ * @brief Компиляция параметров filter в параметризованное SQL-условие.
+ */
+#ifndef TASP_HTTP_SQL_FILTER_HPP_
+#define TASP_HTTP_SQL_FILTER_HPP_
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <tasp/sql_condition.hpp>
+
+namespace tasp::http
+{
+
+/**
+ * @brief Компиляция параметров filter в параметризованное SQL-условие.
+ *
+ * Текст условия зависит только от вида условия: полей, операций, количества
+ * значений операции in и вида обозначения параметров. Тексты хранятся в кэше
+ * каждого потока, поэтому для повторяющихся видов строка не формируется.
+ */
+class SqlFilter final
+{
+public:
+    /**
+     * @brief Максимальное количество видов условий в кэше потока. При
+     * переполнении кэш очищается.
+     */
+    static constexpr size_t cache_size{256};
+
+    /**
+     * @brief Результат компиляции.
+     */
+    struct Compiled
+    {
+        /**
+         * @brief Текст условия, пустой указатель при ошибке или отсутствии
+         * параметров.
+         */
+        std::shared_ptr<const std::string> text;
+
+        /**
+         * @brief Значения параметров.
+         */
+        std::vector<SqlCondition::Param> params;
+
+        /**
+         * @brief Описание ошибки.
+         */
+        std::string error;
+    };
+
+    /**
+     * @brief Компиляция параметров filter.
+     *
+     * @param filters Значения параметров filter вида поле:операция:значение
+     * @param placeholder Вид обозначения параметров
+     * @param fields Допустимые поля. Пустой список - допускается любое поле
+     * вида столбец или таблица.столбец
+     *
+     * @return Результат компиляции
+     */
+    [[nodiscard]] static Compiled Compile(
+        const std::vector<std::string> &filters,
+        SqlCondition::Placeholder placeholder,
+        const std::vector<std::string> &fields = {}) noexcept;
+
+    /**
+     * @brief Определение типа значения параметра.
+     *
+     * @param value Значение в текстовом виде
+     *
+     * @return Значение параметра
+     */
+    [[nodiscard]] static SqlCondition::Param ParseParam(
+        std::string_view value) noexcept;
+};
+
+}  // namespace tasp::http
+
+#endif  // TASP_HTTP_SQL_FILTER_HPP_
@@ -0,0 +1,27 @@
+#include "synthetic_request.hpp"
+
+#include <event2/http_struct.h>
+
+#include <cstring>
+
+namespace tasp::http
+{
+
+//------------------------------------------------------------------------------
+bool InitRequest(evhttp_request *req,
+                 evhttp_cmd_type type,
+                 std::string_view uri,
+                 char major,
+                 char minor) noexcept
+{
+    req->type = type;
+    req->major = major;
+    req->minor = minor;
+    req->uri = strndup(uri.data(), uri.size());
+    req->uri_elems =
+        evhttp_uri_parse_with_flags(req->uri, EVHTTP_URI_NONCONFORMANT);
+
+    return req->uri_elems != nullptr;
+}
+
+}  // namespace tasp::http
@@ -0,0 +1,41 @@
+/**
+ * @file
+ * @brief Заполнение запросов libevent, сформированных без HTTP-сервера.
+ */
+#ifndef TASP_HTTP_SYNTHETIC_REQUEST_HPP_
+#define TASP_HTTP_SYNTHETIC_REQUEST_HPP_
+
+#include <evhttp.h>
+
+#include <string_view>
+
+namespace tasp::http
+{
+
+/**
+ * @brief Заполнение запроса libevent, созданного evhttp_request_new без
+ * подключения: метода, версии протокола и URI.
+ *
+ * Используется запросами пакета, HTTP-серверами io_uring и HTTP/2 и тестами
+ * производительности. Открытый интерфейс libevent не позволяет задать эти
+ * поля, поэтому они записываются в структуру evhttp_request
+ * (event2/http_struct.h); зависимость от её расположения сосредоточена в
+ * этой функции.
+ *
+ * @param req Запрос без метода и URI
+ * @param type Метод
+ * @param uri URI запроса (путь и параметры)
+ * @param major Старшая цифра версии протокола
+ * @param minor Младшая цифра версии протокола
+ *
+ * @return Признак успешного разбора URI
+ */
+[[nodiscard]] bool InitRequest(evhttp_request *req,
+                               evhttp_cmd_type type,
+                               std::string_view uri,
+                               char major,
+                               char minor) noexcept;
+
+}  // namespace tasp::http
+
+#endif  // TASP_HTTP_SYNTHETIC_REQUEST_HPP_
@@ -0,0 +1,279 @@
+#include "tls.hpp"
+
+#include <event2/bufferevent_ssl.h>
+#include <openssl/err.h>
+
+#include <array>
+
+#include <tasp/logging.hpp>
+
+using std::string;
+
+namespace tasp::http
+{
+
+namespace
+{
+/**
+ * @brief Контекст идентификаторов сессий сервера.
+ */
+constexpr std::string_view session_context{"tasp-microservice"};
+
+/**
+ * @brief Протоколы ALPN сервера с HTTP/2 в порядке предпочтения.
+ */
+constexpr std::array<unsigned char, 12> alpn_http2{
+    {2, 'h', '2', 8, 'h', 't', 't', 'p', '/', '1', '.', '1'}};
+
+/**
+ * @brief Протоколы ALPN сервера без HTTP/2.
+ */
+constexpr std::array<unsigned char, 9> alpn_http1{
+    {8, 'h', 't', 't', 'p', '/', '1', '.', '1'}};
+
+//------------------------------------------------------------------------------
+void OnFree(void *parent,
+            void *ptr,
+            CRYPTO_EX_DATA *,
+            int,
+            long,
+            void *) noexcept
+{
+    // подключения HTTP закрываются без уведомления close_notify, и
+    // OpenSSL удаляет сессию такого подключения из кэша; признак
+    // завершённого обмена уведомлениями сохраняет сессию
+    if (ptr != nullptr)
+    {
+        SSL_set_shutdown(static_cast<SSL *>(parent),
+                         SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    }
+}
+
+//------------------------------------------------------------------------------
+int ServerIndex() noexcept
+{
+    static const int index{
+        SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &OnFree)};
+    return index;
+}
+
+//------------------------------------------------------------------------------
+string LastError() noexcept
+{
+    std::array<char, 256> text{};
+    ERR_error_string_n(ERR_get_error(), text.data(), text.size());
+    ERR_clear_error();
+    return text.data();
+}
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    Tls
+------------------------------------------------------------------------------*/
+Tls::Tls() noexcept
+: context_(SSL_CTX_new(TLS_server_method()), SSL_CTX_free)
+{
+    auto *context{context_.get()};
+    if (context == nullptr)
+    {
+        Logging::Error("Ошибка создания контекста TLS: {}", LastError());
+        return;
+    }
+
+    SSL_CTX_set_min_proto_version(context, TLS1_2_VERSION);
+    SSL_CTX_set_options(context,
+                        SSL_OP_NO_RENEGOTIATION |
+                            SSL_OP_CIPHER_SERVER_PREFERENCE);
+
+    // кэш сессий и ключи билетов принадлежат контексту и общие для всех
+    // циклов обработки событий
+    SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_set_session_id_context(
+        context,
+        reinterpret_cast<const uint8_t *>(  // NOLINT
+            session_context.data()),
+        static_cast<unsigned int>(session_context.size()));
+
+    SSL_CTX_set_app_data(context, this);
+    SSL_CTX_set_info_callback(context, &Tls::OnInfo);
+    SSL_CTX_set_alpn_select_cb(context, &Tls::OnAlpn, this);
+}
+
+//------------------------------------------------------------------------------
+Tls::~Tls() noexcept = default;
+
+//------------------------------------------------------------------------------
+bool Tls::Load(const Settings &settings) noexcept
+{
+    auto *context{context_.get()};
+    if (context == nullptr)
+    {
+        return false;
+    }
+
+    SSL_CTX_sess_set_cache_size(context,
+                                static_cast<long>(settings.session_cache));
+    SSL_CTX_set_timeout(context,
+                        static_cast<long>(settings.session_timeout.count()));
+
+    if (settings.tickets)
+    {
+        SSL_CTX_clear_options(context, SSL_OP_NO_TICKET);
+    }
+    else
+    {
+        SSL_CTX_set_options(context, SSL_OP_NO_TICKET);
+    }
+
+    http2_ = settings.http2;
+
+#ifdef SSL_OP_ENABLE_KTLS
+    if (settings.ktls)
+    {
+        SSL_CTX_set_options(context, SSL_OP_ENABLE_KTLS);
+    }
+    else
+    {
+        SSL_CTX_clear_options(context, SSL_OP_ENABLE_KTLS);
+    }
+#else
+    if (settings.ktls)
+    {
+        Logging::Debug("Библиотека OpenSSL не поддерживает kTLS");
+    }
+#endif
+
+    // сертификат проверяется в отдельном контексте, чтобы ошибка не
+    // затронула действующий сертификат
+    const SslContext check{SSL_CTX_new(TLS_server_method()), SSL_CTX_free};
+    if (check == nullptr || !UseCertificate(check.get(), settings))
+    {
+        return false;
+    }
+
+    if (!UseCertificate(context, settings))
+    {
+        return false;
+    }
+
+    Logging::Info("Загружен сертификат TLS {}", settings.certificate);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+Tls::Stats Tls::GetStats() const noexcept
+{
+    Stats stats;
+    stats.handshakes = handshakes_.load(std::memory_order_relaxed);
+    stats.resumed = resumed_.load(std::memory_order_relaxed);
+    stats.ktls = ktls_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+//------------------------------------------------------------------------------
+bufferevent *Tls::CreateBuffer(event_base *base, void *arg) noexcept
+{
+    auto *tls{static_cast<Tls *>(arg)};
+
+    SSL *ssl{SSL_new(tls->context_.get())};
+    if (ssl == nullptr)
+    {
+        Logging::Error("Ошибка создания подключения TLS: {}", LastError());
+        return nullptr;
+    }
+
+    SSL_set_ex_data(ssl, ServerIndex(), tls);
+
+    // сокет назначается буферу после его создания
+    auto *bev{bufferevent_openssl_socket_new(
+        base, -1, ssl, BUFFEREVENT_SSL_ACCEPTING, BEV_OPT_CLOSE_ON_FREE)};
+    if (bev == nullptr)
+    {
+        SSL_free(ssl);
+        return nullptr;
+    }
+
+    // клиенты HTTP закрывают подключение без уведомления close_notify
+    bufferevent_openssl_set_allow_dirty_shutdown(bev, 1);
+
+    return bev;
+}
+
+//------------------------------------------------------------------------------
+bool Tls::UseCertificate(SSL_CTX *context, const Settings &settings) noexcept
+{
+    if (SSL_CTX_use_certificate_chain_file(context,
+                                           settings.certificate.c_str()) != 1)
+    {
+        Logging::Error("Ошибка загрузки сертификата TLS {}: {}",
+                       settings.certificate,
+                       LastError());
+        return false;
+    }
+
+    if (SSL_CTX_use_PrivateKey_file(
+            context, settings.key.c_str(), SSL_FILETYPE_PEM) != 1 ||
+        SSL_CTX_check_private_key(context) != 1)
+    {
+        Logging::Error("Ошибка загрузки ключа TLS {}: {}",
+                       settings.key,
+                       LastError());
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void Tls::OnInfo(const SSL *ssl, int where, int) noexcept
+{
+    if ((where & SSL_CB_HANDSHAKE_DONE) == 0)
+    {
+        return;
+    }
+
+    auto *tls{static_cast<Tls *>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)))};
+
+    tls->handshakes_.fetch_add(1, std::memory_order_relaxed);
+
+    if (SSL_session_reused(ssl) == 1)
+    {
+        tls->resumed_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (BIO_get_ktls_send(SSL_get_wbio(ssl)) != 0)
+    {
+        tls->ktls_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+int Tls::OnAlpn(SSL *,
+                const unsigned char **out,
+                unsigned char *outlen,
+                const unsigned char *in,
+                unsigned int inlen,
+                void *arg) noexcept
+{
+    const auto *tls{static_cast<const Tls *>(arg)};
+
+    const unsigned char *protocols{tls->http2_ ? alpn_http2.data()
+                                               : alpn_http1.data()};
+    const auto size{static_cast<unsigned int>(
+        tls->http2_ ? alpn_http2.size() : alpn_http1.size())};
+
+    // протоколы выбираются в порядке предпочтения сервера
+    unsigned char *selected{nullptr};
+    if (SSL_select_next_proto(
+            &selected, outlen, protocols, size, in, inlen) !=
+        OPENSSL_NPN_NEGOTIATED)
+    {
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+
+    *out = selected;
+    return SSL_TLSEXT_ERR_OK;
+}
+
+}  // namespace tasp::http
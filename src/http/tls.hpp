@@ -0,0 +1,222 @@
+/**
+ * @file
+ * @brief Шифрование подключений HTTP-сервера (TLS).
+ */
+#ifndef TASP_HTTP_TLS_HPP_
+#define TASP_HTTP_TLS_HPP_
+
+#include <event2/bufferevent.h>
+#include <openssl/ssl.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace tasp::http
+{
+
+/**
+ * @brief Контекст TLS подключений HTTP-сервера libevent.
+ *
+ * Буферы подключений создаются функцией CreateBuffer (evhttp_set_bevcb) как
+ * буферы OpenSSL библиотеки libevent. Один контекст OpenSSL используется
+ * всеми циклами обработки событий, поэтому кэш сессий и ключи билетов
+ * сессий (session tickets) общие: клиент возобновляет сессию в любом цикле.
+ *
+ * Контекст сохраняется при обновлении конфигурации: Load заменяет
+ * сертификат и ключ, не сбрасывая кэш сессий и ключи билетов. Load
+ * вызывается, когда циклы обработки событий остановлены.
+ *
+ * Передача зашифрованных данных ядром (kTLS) включается, если библиотека
+ * OpenSSL и ядро её поддерживают, иначе данные шифруются библиотекой.
+ *
+ * Протокол прикладного уровня выбирается по ALPN: h2, если включён HTTP/2,
+ * иначе http/1.1.
+ */
+class Tls final
+{
+public:
+    /**
+     * @brief Параметры TLS.
+     */
+    struct Settings
+    {
+        /**
+         * @brief Признак включения TLS.
+         */
+        bool enabled{false};
+
+        /**
+         * @brief Путь к файлу цепочки сертификатов в формате PEM.
+         */
+        std::string certificate;
+
+        /**
+         * @brief Путь к файлу закрытого ключа в формате PEM.
+         */
+        std::string key;
+
+        /**
+         * @brief Максимальное количество сессий в кэше.
+         */
+        size_t session_cache{20480};
+
+        /**
+         * @brief Время жизни сессии.
+         */
+        std::chrono::seconds session_timeout{3600};
+
+        /**
+         * @brief Признак выдачи билетов сессий.
+         */
+        bool tickets{true};
+
+        /**
+         * @brief Признак передачи зашифрованных данных ядром (kTLS).
+         */
+        bool ktls{true};
+
+        /**
+         * @brief Признак выбора протокола HTTP/2 по ALPN.
+         */
+        bool http2{false};
+    };
+
+    /**
+     * @brief Показатели TLS.
+     */
+    struct Stats
+    {
+        /**
+         * @brief Количество завершённых рукопожатий.
+         */
+        uint64_t handshakes{0};
+
+        /**
+         * @brief Количество рукопожатий с возобновлением сессии.
+         */
+        uint64_t resumed{0};
+
+        /**
+         * @brief Количество подключений с передачей данных ядром (kTLS).
+         */
+        uint64_t ktls{0};
+    };
+
+    /**
+     * @brief Конструктор.
+     */
+    Tls() noexcept;
+
+    /**
+     * @brief Деструктор. Вызывается после освобождения HTTP-серверов.
+     */
+    ~Tls() noexcept;
+
+    /**
+     * @brief Загрузка сертификата, ключа и параметров сессий. При ошибке
+     * загрузки сохраняется прежний сертификат.
+     *
+     * @param settings Параметры TLS
+     *
+     * @return Результат загрузки
+     */
+    bool Load(const Settings &settings) noexcept;
+
+    /**
+     * @brief Запрос показателей TLS.
+     *
+     * @return Показатели
+     */
+    [[nodiscard]] Stats GetStats() const noexcept;
+
+    /**
+     * @brief Функция создания буфера подключения (evhttp_set_bevcb).
+     *
+     * @param base Цикл обработки событий
+     * @param arg Указатель на контекст TLS
+     *
+     * @return Буфер подключения
+     */
+    static bufferevent *CreateBuffer(event_base *base, void *arg) noexcept;
+
+    Tls(const Tls &) = delete;
+    Tls(Tls &&) = delete;
+    Tls &operator=(const Tls &) = delete;
+    Tls &operator=(Tls &&) = delete;
+
+private:
+    /**
+     * @brief Умный указатель контекста OpenSSL.
+     */
+    using SslContext = std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)>;
+
+    /**
+     * @brief Загрузка сертификата и ключа в контекст.
+     *
+     * @param context Контекст OpenSSL
+     * @param settings Параметры TLS
+     *
+     * @return Результат загрузки
+     */
+    static bool UseCertificate(SSL_CTX *context,
+                               const Settings &settings) noexcept;
+
+    /**
+     * @brief Функция обратного вызова состояния подключения OpenSSL: учёт
+     * завершённых рукопожатий.
+     *
+     * @param ssl Подключение OpenSSL
+     * @param where Событие
+     */
+    static void OnInfo(const SSL *ssl, int where, int) noexcept;
+
+    /**
+     * @brief Функция обратного вызова выбора протокола прикладного уровня
+     * (ALPN).
+     *
+     * @param out Выбранный протокол
+     * @param outlen Длина выбранного протокола
+     * @param in Протоколы клиента
+     * @param inlen Длина списка протоколов клиента
+     * @param arg Указатель на контекст TLS
+     *
+     * @return Результат выбора
+     */
+    static int OnAlpn(SSL *,
+                      const unsigned char **out,
+                      unsigned char *outlen,
+                      const unsigned char *in,
+                      unsigned int inlen,
+                      void *arg) noexcept;
+
+    /**
+     * @brief Контекст OpenSSL.
+     */
+    SslContext context_;
+
+    /**
+     * @brief Признак выбора протокола HTTP/2 по ALPN.
+     */
+    bool http2_{false};
+
+    /**
+     * @brief Количество завершённых рукопожатий.
+     */
+    std::atomic<uint64_t> handshakes_{0};
+
+    /**
+     * @brief Количество рукопожатий с возобновлением сессии.
+     */
+    std::atomic<uint64_t> resumed_{0};
+
+    /**
+     * @brief Количество подключений с передачей данных ядром.
+     */
+    std::atomic<uint64_t> ktls_{0};
+};
+
+}  // namespace tasp::http
+
+#endif  // TASP_HTTP_TLS_HPP_
@@ -0,0 +1,558 @@
+#include "trace.hpp"
+
+#include <jsoncpp/json/json.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <tasp/logging.hpp>
+
+#include "../hash.hpp"
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+
+namespace tasp::http
+{
+
+namespace
+{
+/**
+ * @brief Шестнадцатеричные цифры.
+ */
+constexpr string_view digits{"0123456789abcdef"};
+
+/**
+ * @brief Названия этапов обработки запроса.
+ */
+constexpr std::array<string_view, static_cast<size_t>(Trace::Phase::Count)>
+    phase_names{{"parse", "route", "handler", "serialize", "send"}};
+
+/**
+ * @brief Смещения полей в заголовке traceparent.
+ */
+constexpr size_t trace_id_offset{3};
+constexpr size_t trace_id_length{32};
+constexpr size_t span_id_offset{36};
+constexpr size_t span_id_length{16};
+constexpr size_t flags_offset{53};
+
+/**
+ * @brief Признак выгрузки в поле флагов traceparent.
+ */
+constexpr uint8_t sampled_flag{0x01};
+
+/**
+ * @brief Трассировка текущего потока.
+ */
+thread_local Trace *current{nullptr};
+
+//------------------------------------------------------------------------------
+bool IsHex(string_view str) noexcept
+{
+    return std::all_of(str.begin(),
+                       str.end(),
+                       [](char ch)
+                       {
+                           return digits.find(ch) != string_view::npos;
+                       });
+}
+
+//------------------------------------------------------------------------------
+bool IsZero(string_view str) noexcept
+{
+    return str.find_first_not_of('0') == string_view::npos;
+}
+
+//------------------------------------------------------------------------------
+void WriteHex(uint64_t value, char *out) noexcept
+{
+    for (size_t i = 16; i > 0; i--)
+    {
+        out[i - 1] = digits[value & 0xFU];  // NOLINT
+        value >>= 4U;
+    }
+}
+
+//------------------------------------------------------------------------------
+uint64_t Random() noexcept
+{
+    thread_local std::mt19937_64 generator{std::random_device{}()};
+
+    uint64_t value{0};
+    while (value == 0)
+    {
+        value = generator();
+    }
+    return value;
+}
+
+/**
+ * @brief Пакетная выгрузка этапов обработки запросов в файл.
+ */
+class Exporter final
+{
+public:
+    /**
+     * @brief Конструктор. Открывает файл и запускает поток выгрузки.
+     *
+     * @param settings Параметры трассировки
+     */
+    explicit Exporter(const Trace::Settings &settings) noexcept
+    : settings_(settings)
+    , file_(settings.file, std::ios::app)
+    {
+        if (!file_)
+        {
+            Logging::Error("Ошибка открытия файла трассировки {}",
+                           settings.file);
+        }
+
+        thread_ = std::thread(&Exporter::Run, this);
+    }
+
+    /**
+     * @brief Деструктор. Выгружает оставшиеся запросы и останавливает поток.
+     */
+    ~Exporter() noexcept
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+
+        thread_.join();
+    }
+
+    Exporter(const Exporter &) = delete;
+    Exporter(Exporter &&) = delete;
+    Exporter &operator=(const Exporter &) = delete;
+    Exporter &operator=(Exporter &&) = delete;
+
+    /**
+     * @brief Постановка запроса в очередь на выгрузку.
+     *
+     * @param record Сведения о запросе
+     */
+    void Push(Trace::Record &&record) noexcept
+    {
+        bool notify{false};
+        {
+            const std::lock_guard lock(mutex_);
+            if (queue_.size() >= settings_.max_queue)
+            {
+                dropped_++;
+                return;
+            }
+
+            queue_.push_back(std::move(record));
+            notify = queue_.size() == settings_.batch_size;
+        }
+
+        if (notify)
+        {
+            cv_.notify_one();
+        }
+    }
+
+private:
+    /**
+     * @brief Функция потока выгрузки.
+     */
+    void Run() noexcept
+    {
+        vector<Trace::Record> batch;
+        string line;
+
+        std::unique_lock lock(mutex_);
+        while (!stop_ || !queue_.empty())
+        {
+            cv_.wait_for(lock,
+                         settings_.flush_interval,
+                         [this]
+                         {
+                             return stop_ ||
+                                    queue_.size() >= settings_.batch_size;
+                         });
+
+            batch.swap(queue_);
+            const size_t dropped{std::exchange(dropped_, 0)};
+            lock.unlock();
+
+            if (dropped > 0)
+            {
+                Logging::Warning("Отброшено {} запросов трассировки", dropped);
+            }
+
+            for (const auto &record : batch)
+            {
+                Write(record, line);
+            }
+            file_.flush();
+            batch.clear();
+
+            lock.lock();
+        }
+    }
+
+    /**
+     * @brief Запись операций запроса в файл.
+     *
+     * @param record Сведения о запросе
+     * @param line Буфер строки
+     */
+    void Write(const Trace::Record &record, string &line) noexcept
+    {
+        const auto start{static_cast<uint64_t>(
+            duration_cast<nanoseconds>(record.start.time_since_epoch())
+                .count())};
+
+        const string_view traceparent{record.traceparent.data(),
+                                      record.traceparent.size()};
+        const string_view trace_id{
+            traceparent.substr(trace_id_offset, trace_id_length)};
+        const string_view span_id{
+            traceparent.substr(span_id_offset, span_id_length)};
+        const string_view parent{
+            record.parent[0] == 0
+                ? string_view{}
+                : string_view{record.parent.data(), record.parent.size()}};
+
+        string name{record.method};
+        name.append(" ").append(record.url);
+
+        WriteSpan(line,
+                  trace_id,
+                  span_id,
+                  parent,
+                  name,
+                  start,
+                  start + static_cast<uint64_t>(
+                              duration_cast<nanoseconds>(record.duration)
+                                  .count()));
+
+        line.append(",\"attributes\":{\"http.method\":")
+            .append(Json::valueToQuotedString(record.method.c_str()))
+            .append(",\"http.url\":")
+            .append(Json::valueToQuotedString(record.url.c_str()))
+            .append(",\"http.status_code\":")
+            .append(std::to_string(record.code))
+            .append("}}\n");
+        file_ << line;
+
+        std::array<char, span_id_length> child{};
+        for (size_t i = 0; i < record.spans.size(); i++)
+        {
+            const auto &span{record.spans.at(i)};
+            if (!span.used)
+            {
+                continue;
+            }
+
+            WriteHex(Hash64(span_id, i + 1), child.data());
+
+            const auto begin{
+                start + static_cast<uint64_t>(
+                            duration_cast<nanoseconds>(span.offset).count())};
+            WriteSpan(line,
+                      trace_id,
+                      {child.data(), child.size()},
+                      span_id,
+                      phase_names.at(i),
+                      begin,
+                      begin + static_cast<uint64_t>(
+                                  duration_cast<nanoseconds>(span.duration)
+                                      .count()));
+            line.append("}\n");
+            file_ << line;
+        }
+    }
+
+    /**
+     * @brief Формирование общих полей операции в буфере строки.
+     */
+    static void WriteSpan(string &line,
+                          string_view trace_id,
+                          string_view span_id,
+                          string_view parent,
+                          string_view name,
+                          uint64_t start,
+                          uint64_t end) noexcept
+    {
+        line.assign("{\"traceId\":\"")
+            .append(trace_id)
+            .append("\",\"spanId\":\"")
+            .append(span_id)
+            .append("\",\"parentSpanId\":\"")
+            .append(parent)
+            .append("\",\"name\":")
+            .append(Json::valueToQuotedString(string{name}.c_str()))
+            .append(",\"startTimeUnixNano\":")
+            .append(std::to_string(start))
+            .append(",\"endTimeUnixNano\":")
+            .append(std::to_string(end));
+    }
+
+    /**
+     * @brief Параметры трассировки.
+     */
+    Trace::Settings settings_;
+
+    /**
+     * @brief Файл для выгрузки.
+     */
+    std::ofstream file_;
+
+    /**
+     * @brief Очередь запросов на выгрузку.
+     */
+    vector<Trace::Record> queue_;
+
+    /**
+     * @brief Количество отброшенных запросов.
+     */
+    size_t dropped_{0};
+
+    /**
+     * @brief Синхронизация доступа к очереди.
+     */
+    std::mutex mutex_;
+
+    /**
+     * @brief Уведомление о заполнении очереди и остановке.
+     */
+    std::condition_variable cv_;
+
+    /**
+     * @brief Признак остановки потока.
+     */
+    bool stop_{false};
+
+    /**
+     * @brief Поток выгрузки.
+     */
+    std::thread thread_;
+};
+
+/**
+ * @brief Поток выгрузки. Пустой указатель - трассировка отключена.
+ */
+std::unique_ptr<Exporter> exporter;  // NOLINT(cert-err58-cpp)
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    Trace::Scope
+------------------------------------------------------------------------------*/
+Trace::Scope::Scope(Phase phase) noexcept
+: trace_(current)
+, phase_(phase)
+{
+    if (trace_ != nullptr)
+    {
+        trace_->Begin(phase_);
+    }
+}
+
+//------------------------------------------------------------------------------
+Trace::Scope::~Scope() noexcept
+{
+    if (trace_ != nullptr)
+    {
+        trace_->End(phase_);
+    }
+}
+
+/*------------------------------------------------------------------------------
+    Trace
+------------------------------------------------------------------------------*/
+Trace::Trace(evhttp_request *req) noexcept
+: start_(Clock::now())
+, previous_(current)
+{
+    current = this;
+
+    auto &traceparent{record_.traceparent};
+    string_view incoming;
+
+    const char *header{evhttp_find_header(evhttp_request_get_input_headers(req),
+                                          "traceparent")};
+    if (header != nullptr)
+    {
+        incoming = header;
+    }
+
+    // версия 00 имеет фиксированную длину, более поздние версии могут
+    // содержать дополнительные поля после флагов
+    const bool valid{
+        incoming.size() >= traceparent.size() &&
+        (incoming.size() == traceparent.size() ||
+         incoming[traceparent.size()] == '-') &&
+        IsHex(incoming.substr(0, 2)) && incoming.substr(0, 2) != "ff" &&
+        (incoming.substr(0, 2) != "00" ||
+         incoming.size() == traceparent.size()) &&
+        incoming[2] == '-' && incoming[span_id_offset - 1] == '-' &&
+        incoming[flags_offset - 1] == '-' &&
+        IsHex(incoming.substr(trace_id_offset, trace_id_length)) &&
+        !IsZero(incoming.substr(trace_id_offset, trace_id_length)) &&
+        IsHex(incoming.substr(span_id_offset, span_id_length)) &&
+        !IsZero(incoming.substr(span_id_offset, span_id_length)) &&
+        IsHex(incoming.substr(flags_offset, 2))};
+
+    std::copy_n("00-", 3, traceparent.data());
+    traceparent[span_id_offset - 1] = '-';
+    traceparent[flags_offset - 1] = '-';
+
+    if (valid)
+    {
+        std::copy_n(incoming.data() + trace_id_offset,
+                    trace_id_length,
+                    traceparent.data() + trace_id_offset);
+        std::copy_n(incoming.data() + span_id_offset,
+                    span_id_length,
+                    record_.parent.data());
+
+        const string flags_hex{incoming.substr(flags_offset, 2)};
+        const auto flags{
+            static_cast<uint8_t>(std::strtoul(flags_hex.c_str(), nullptr, 16))};
+        sampled_ = exporter && (flags & sampled_flag) != 0;
+    }
+    else
+    {
+        WriteHex(Random(), traceparent.data() + trace_id_offset);
+        WriteHex(Random(), traceparent.data() + trace_id_offset + 16);
+        sampled_ = static_cast<bool>(exporter);
+    }
+
+    WriteHex(Random(), traceparent.data() + span_id_offset);
+    traceparent[flags_offset] = '0';
+    traceparent[flags_offset + 1] = sampled_ ? '1' : '0';
+
+    evhttp_add_header(evhttp_request_get_output_headers(req),
+                      "traceparent",
+                      string{traceparent.data(), traceparent.size()}.c_str());
+
+    if (sampled_)
+    {
+        record_.start = std::chrono::system_clock::now();
+    }
+}
+
+//------------------------------------------------------------------------------
+Trace::~Trace() noexcept
+{
+    if (active_)
+    {
+        current = previous_;
+    }
+
+    if (sampled_ && exporter)
+    {
+        record_.duration = Clock::now() - start_;
+        exporter->Push(std::move(record_));
+    }
+}
+
+//------------------------------------------------------------------------------
+void Trace::Suspend() noexcept
+{
+    if (active_)
+    {
+        current = previous_;
+        active_ = false;
+    }
+}
+
+//------------------------------------------------------------------------------
+void Trace::Resume() noexcept
+{
+    if (!active_)
+    {
+        previous_ = current;
+        current = this;
+        active_ = true;
+    }
+}
+
+//------------------------------------------------------------------------------
+Trace *Trace::Current() noexcept
+{
+    return current;
+}
+
+//------------------------------------------------------------------------------
+void Trace::Configure(const Settings &settings) noexcept
+{
+    exporter.reset();
+
+    if (settings.enabled)
+    {
+        exporter = std::make_unique<Exporter>(settings);
+    }
+}
+
+//------------------------------------------------------------------------------
+void Trace::Begin(Phase phase) noexcept
+{
+    if (!sampled_)
+    {
+        return;
+    }
+
+    auto &span{record_.spans.at(static_cast<size_t>(phase))};
+    span.start = Clock::now();
+
+    if (!span.used)
+    {
+        span.used = true;
+        span.offset = span.start - start_;
+    }
+}
+
+//------------------------------------------------------------------------------
+void Trace::End(Phase phase) noexcept
+{
+    if (!sampled_)
+    {
+        return;
+    }
+
+    auto &span{record_.spans.at(static_cast<size_t>(phase))};
+    span.duration += Clock::now() - span.start;
+}
+
+//------------------------------------------------------------------------------
+void Trace::SetRequest(string_view method, string_view url) noexcept
+{
+    if (sampled_)
+    {
+        record_.method = method;
+        record_.url = url;
+    }
+}
+
+//------------------------------------------------------------------------------
+void Trace::SetCode(int code) noexcept
+{
+    record_.code = code;
+}
+
+//------------------------------------------------------------------------------
+string_view Trace::TraceId() const noexcept
+{
+    return {record_.traceparent.data() + trace_id_offset, trace_id_length};
+}
+
+}  // namespace tasp::http
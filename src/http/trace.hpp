@@ -0,0 +1,302 @@
+/**
+ * @file
+ * @brief Трассировка обработки запросов HTTP.
+ */
+#ifndef TASP_HTTP_TRACE_HPP_
+#define TASP_HTTP_TRACE_HPP_
+
+#include <evhttp.h>
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+namespace tasp::http
+{
+
+/**
+ * @brief Контекст трассировки запроса.
+ *
+ * Идентификаторы трассировки принимаются из заголовка traceparent (W3C Trace
+ * Context) или формируются заново. Заголовок traceparent с идентификатором
+ * трассировки и идентификатором операции сервиса добавляется в ответ.
+ *
+ * Длительность этапов обработки запроса накапливается в объекте без выделения
+ * памяти. При включённой трассировке после завершения запроса этапы
+ * передаются в поток выгрузки, который пакетами записывает их в файл в
+ * формате JSON, по одной операции (span) в строке.
+ */
+class Trace final
+{
+public:
+    /**
+     * @brief Этапы обработки запроса.
+     */
+    enum class Phase
+    {
+        Parse,
+        Route,
+        Handler,
+        Serialize,
+        Send,
+        Count
+    };
+
+    /**
+     * @brief Параметры трассировки.
+     */
+    struct Settings
+    {
+        /**
+         * @brief Признак выгрузки этапов обработки запросов.
+         */
+        bool enabled{false};
+
+        /**
+         * @brief Файл для выгрузки.
+         */
+        std::string file{"traces.json"};
+
+        /**
+         * @brief Количество запросов, при накоплении которого выполняется
+         * выгрузка.
+         */
+        size_t batch_size{512};
+
+        /**
+         * @brief Максимальный интервал между выгрузками.
+         */
+        std::chrono::milliseconds flush_interval{1000};
+
+        /**
+         * @brief Максимальное количество запросов в очереди на выгрузку.
+         * Запросы сверх этого количества отбрасываются.
+         */
+        size_t max_queue{65536};
+    };
+
+    /**
+     * @brief Отметка этапа обработки запроса текущего потока на время
+     * существования объекта.
+     */
+    class Scope final
+    {
+    public:
+        /**
+         * @brief Конструктор.
+         *
+         * @param phase Этап
+         */
+        explicit Scope(Phase phase) noexcept;
+
+        /**
+         * @brief Деструктор.
+         */
+        ~Scope() noexcept;
+
+        Scope(const Scope &) = delete;
+        Scope(Scope &&) = delete;
+        Scope &operator=(const Scope &) = delete;
+        Scope &operator=(Scope &&) = delete;
+
+    private:
+        /**
+         * @brief Трассировка текущего потока.
+         */
+        Trace *trace_;
+
+        /**
+         * @brief Этап.
+         */
+        Phase phase_;
+    };
+
+    /**
+     * @brief Конструктор. Становится текущей трассировкой потока.
+     *
+     * @param req Указатель на запрос в библиотеке libevent
+     */
+    explicit Trace(evhttp_request *req) noexcept;
+
+    /**
+     * @brief Деструктор. Передаёт этапы на выгрузку.
+     */
+    ~Trace() noexcept;
+
+    /**
+     * @brief Приостановка трассировки отложенного ответа: трассировка
+     * перестаёт быть текущей в потоке до вызова Resume.
+     */
+    void Suspend() noexcept;
+
+    /**
+     * @brief Возобновление приостановленной трассировки: трассировка снова
+     * становится текущей в потоке.
+     */
+    void Resume() noexcept;
+
+    /**
+     * @brief Запрос текущей трассировки потока.
+     *
+     * @return Трассировка или пустой указатель
+     */
+    [[nodiscard]] static Trace *Current() noexcept;
+
+    /**
+     * @brief Установка параметров трассировки. Перезапускает поток выгрузки.
+     *
+     * Вызывается при отсутствии потоков обработки событий.
+     *
+     * @param settings Параметры
+     */
+    static void Configure(const Settings &settings) noexcept;
+
+    /**
+     * @brief Начало этапа обработки.
+     *
+     * @param phase Этап
+     */
+    void Begin(Phase phase) noexcept;
+
+    /**
+     * @brief Завершение этапа обработки.
+     *
+     * @param phase Этап
+     */
+    void End(Phase phase) noexcept;
+
+    /**
+     * @brief Установка сведений о запросе.
+     *
+     * @param method Метод
+     * @param url URL запроса
+     */
+    void SetRequest(std::string_view method, std::string_view url) noexcept;
+
+    /**
+     * @brief Установка кода ответа.
+     *
+     * @param code Код
+     */
+    void SetCode(int code) noexcept;
+
+    /**
+     * @brief Запрос идентификатора трассировки.
+     *
+     * @return 32 шестнадцатеричные цифры
+     */
+    [[nodiscard]] std::string_view TraceId() const noexcept;
+
+    Trace(const Trace &) = delete;
+    Trace(Trace &&) = delete;
+    Trace &operator=(const Trace &) = delete;
+    Trace &operator=(Trace &&) = delete;
+
+    /**
+     * @brief Часы для измерения длительности этапов.
+     */
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Длительность этапа обработки.
+     */
+    struct Span
+    {
+        /**
+         * @brief Смещение начала этапа от начала запроса.
+         */
+        Clock::duration offset{};
+
+        /**
+         * @brief Суммарная длительность этапа.
+         */
+        Clock::duration duration{};
+
+        /**
+         * @brief Время начала текущего выполнения этапа.
+         */
+        Clock::time_point start{};
+
+        /**
+         * @brief Признак выполнения этапа.
+         */
+        bool used{false};
+    };
+
+    /**
+     * @brief Сведения о запросе для выгрузки.
+     */
+    struct Record
+    {
+        /**
+         * @brief Заголовок traceparent ответа.
+         */
+        std::array<char, 55> traceparent{};
+
+        /**
+         * @brief Идентификатор родительской операции или пустая строка.
+         */
+        std::array<char, 16> parent{};
+
+        /**
+         * @brief Время начала запроса.
+         */
+        std::chrono::system_clock::time_point start{};
+
+        /**
+         * @brief Длительность обработки запроса.
+         */
+        Clock::duration duration{};
+
+        /**
+         * @brief Этапы обработки.
+         */
+        std::array<Span, static_cast<size_t>(Phase::Count)> spans{};
+
+        /**
+         * @brief Метод запроса.
+         */
+        std::string method;
+
+        /**
+         * @brief URL запроса.
+         */
+        std::string url;
+
+        /**
+         * @brief Код ответа.
+         */
+        int code{0};
+    };
+
+private:
+    /**
+     * @brief Сведения о запросе.
+     */
+    Record record_;
+
+    /**
+     * @brief Время начала запроса.
+     */
+    Clock::time_point start_;
+
+    /**
+     * @brief Признак выгрузки этапов запроса.
+     */
+    bool sampled_{false};
+
+    /**
+     * @brief Предыдущая трассировка потока.
+     */
+    Trace *previous_;
+
+    /**
+     * @brief Признак текущей трассировки потока.
+     */
+    bool active_{true};
+};
+
+}  // namespace tasp::http
+
+#endif  // TASP_HTTP_TRACE_HPP_
@@ -35,6 +35,11 @@ UriImpl::UriImpl(const evhttp_request *req) noexcept
     for (evkeyval *param = params.tqh_first; param != nullptr;
          param = param->next.tqe_next)
     {
+        if (string_view{param->key} == "filter")
+        {
+            filters_.emplace_back(param->value);
+        }
+
         query_params_.insert(
             {param->key,
              std::make_shared<tasp::http::url::ParamValue>(param->value)});
@@ -109,6 +114,12 @@ const string &UriImpl::SubMatch(size_t number) const noexcept
     return matches_.at(number);
 }
 
+//------------------------------------------------------------------------------
+const std::vector<string> &UriImpl::Filters() const noexcept
+{
+    return filters_;
+}
+
 //------------------------------------------------------------------------------
 std::string UriImpl::ToSQLCondition() const noexcept
 {
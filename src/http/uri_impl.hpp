@@ -93,6 +93,14 @@ public:
      */
     [[nodiscard]] std::string ToSQLCondition() const noexcept override;
 
+    /**
+     * @brief Запрос значений параметров filter в порядке их следования в
+     * запросе.
+     *
+     * @return Значения параметров filter
+     */
+    [[nodiscard]] const std::vector<std::string> &Filters() const noexcept;
+
     UriImpl(const UriImpl &) = delete;
     UriImpl(UriImpl &&) = delete;
     UriImpl &operator=(const UriImpl &) = delete;
@@ -106,6 +114,11 @@ private:
                             std::shared_ptr<tasp::http::url::ParamValue>>
         query_params_;
 
+    /**
+     * @brief Значения параметров filter.
+     */
+    std::vector<std::string> filters_;
+
     /**
      * @brief Полный идентификатор ресурса.
      */
@@ -0,0 +1,1115 @@
+#include "server.hpp"
+
+#include <nghttp2/nghttp2.h>
+#include <strings.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <tasp/logging.hpp>
+
+#include "../http/client_limits.hpp"
+#include "../http/request_impl.hpp"
+#include "../http/response_impl.hpp"
+#include "../http/synthetic_request.hpp"
+#include "../http/trace.hpp"
+
+using std::make_unique;
+using std::string;
+using std::string_view;
+using std::unique_ptr;
+
+using tasp::http::ClientLimits;
+using tasp::http::InitRequest;
+using tasp::http::RequestImpl;
+using tasp::http::ResponseImpl;
+using tasp::http::Trace;
+
+namespace tasp::http2
+{
+
+namespace
+{
+/**
+ * @brief Преамбула подключения HTTP/2.
+ */
+constexpr string_view preface{"PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"};
+
+/**
+ * @brief Длина начала преамбулы, достаточная для передачи подключения
+ * сессии HTTP/2. Строка запроса HTTP/1.1 не может начинаться с метода PRI,
+ * а libevent отклоняет строку преамбулы, если успевает её прочитать.
+ */
+constexpr size_t preface_prefix{4};
+
+/**
+ * @brief Объём неотправленных данных подключения, при превышении которого
+ * передача ответов приостанавливается, если верхняя граница записи буфера
+ * не задана.
+ */
+constexpr size_t default_high_watermark{64 * 1024};
+
+/**
+ * @brief Методы HTTP.
+ */
+constexpr std::array<std::pair<string_view, evhttp_cmd_type>, 9> methods{{
+    {"GET", EVHTTP_REQ_GET},
+    {"POST", EVHTTP_REQ_POST},
+    {"HEAD", EVHTTP_REQ_HEAD},
+    {"PUT", EVHTTP_REQ_PUT},
+    {"DELETE", EVHTTP_REQ_DELETE},
+    {"OPTIONS", EVHTTP_REQ_OPTIONS},
+    {"TRACE", EVHTTP_REQ_TRACE},
+    {"CONNECT", EVHTTP_REQ_CONNECT},
+    {"PATCH", EVHTTP_REQ_PATCH},
+}};
+
+/**
+ * @brief Приём подключений HTTP/2 текущего потока.
+ */
+thread_local Server *current{nullptr};
+
+//------------------------------------------------------------------------------
+bool EqualsNoCase(string_view lhs, string_view rhs) noexcept
+{
+    return lhs.size() == rhs.size() &&
+           strncasecmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+//------------------------------------------------------------------------------
+bool HopByHop(string_view key) noexcept
+{
+    // заголовки подключения HTTP/1.1 запрещены в HTTP/2, длина данных
+    // передаётся сессией
+    return EqualsNoCase(key, "Connection") ||
+           EqualsNoCase(key, "Keep-Alive") ||
+           EqualsNoCase(key, "Proxy-Connection") ||
+           EqualsNoCase(key, "Transfer-Encoding") ||
+           EqualsNoCase(key, "Upgrade") || EqualsNoCase(key, "Content-Length");
+}
+
+//------------------------------------------------------------------------------
+nghttp2_nv Field(const string &name, const string &value) noexcept
+{
+    return nghttp2_nv{
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        reinterpret_cast<uint8_t *>(const_cast<char *>(name.data())),
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        reinterpret_cast<uint8_t *>(const_cast<char *>(value.data())),
+        name.size(),
+        value.size(),
+        NGHTTP2_NV_FLAG_NONE};
+}
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    Server::Session
+------------------------------------------------------------------------------*/
+/**
+ * @brief Сессия HTTP/2 подключения.
+ *
+ * Сессия владеет состоянием nghttp2 и потоками, буфер принадлежит
+ * подключению libevent. Сессия удаляется функцией обратного вызова
+ * закрытия подключения, поэтому после Free обращение к сессии недопустимо.
+ */
+class Server::Session final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param server Приём подключений HTTP/2
+     * @param connection Подключение
+     * @param bev Буфер подключения
+     */
+    Session(Server &server,
+            evhttp_connection *connection,
+            bufferevent *bev) noexcept
+    : server_(server)
+    , connection_(connection)
+    , bev_(bev)
+    {
+        char *address{nullptr};
+        uint16_t port{0};
+        evhttp_connection_get_peer(connection, &address, &port);
+        if (address != nullptr)
+        {
+            address_ = address;
+        }
+    }
+
+    /**
+     * @brief Деструктор.
+     */
+    ~Session() noexcept
+    {
+        // потоки удаляются nghttp2 без вызова функций обратного вызова
+        if (session_ != nullptr)
+        {
+            nghttp2_session_del(session_);
+        }
+    }
+
+    /**
+     * @brief Создание сессии nghttp2 и замена функций обратного вызова
+     * буфера подключения. Принятые данные обрабатываются функцией обратного
+     * вызова чтения буфера.
+     *
+     * @return Результат запуска
+     */
+    bool Start() noexcept
+    {
+        nghttp2_session_callbacks *callbacks{nullptr};
+        if (nghttp2_session_callbacks_new(&callbacks) != 0)
+        {
+            return false;
+        }
+
+        nghttp2_session_callbacks_set_on_begin_headers_callback(
+            callbacks, &Session::OnBeginHeaders);
+        nghttp2_session_callbacks_set_on_header_callback(callbacks,
+                                                         &Session::OnHeader);
+        nghttp2_session_callbacks_set_on_data_chunk_recv_callback(
+            callbacks, &Session::OnDataChunk);
+        nghttp2_session_callbacks_set_on_frame_recv_callback(
+            callbacks, &Session::OnFrame);
+        nghttp2_session_callbacks_set_on_frame_send_callback(
+            callbacks, &Session::OnFrameSend);
+        nghttp2_session_callbacks_set_on_stream_close_callback(
+            callbacks, &Session::OnStreamClose);
+        nghttp2_session_callbacks_set_send_data_callback(callbacks,
+                                                         &Session::OnSendData);
+
+        const int result{
+            nghttp2_session_server_new(&session_, callbacks, this)};
+        nghttp2_session_callbacks_del(callbacks);
+        if (result != 0)
+        {
+            session_ = nullptr;
+            return false;
+        }
+
+        const auto &settings{server_.settings_};
+        const std::array<nghttp2_settings_entry, 2> entries{{
+            {NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, settings.max_streams},
+            {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, settings.stream_window},
+        }};
+        nghttp2_submit_settings(
+            session_, NGHTTP2_FLAG_NONE, entries.data(), entries.size());
+        nghttp2_session_set_local_window_size(
+            session_,
+            NGHTTP2_FLAG_NONE,
+            0,
+            static_cast<int32_t>(settings.connection_window));
+
+        size_t high{0};
+        bufferevent_getwatermark(bev_, EV_WRITE, nullptr, &high);
+        high_watermark_ = high > 0 ? high : default_high_watermark;
+
+        const timeval idle{settings.idle_timeout.count(), 0};
+        bufferevent_set_timeouts(bev_, &idle, nullptr);
+        bufferevent_setcb(bev_,
+                          &Session::OnRead,
+                          &Session::OnWrite,
+                          &Session::OnEvent,
+                          this);
+        bufferevent_enable(bev_, EV_READ | EV_WRITE);
+
+        return true;
+    }
+
+    Session(const Session &) = delete;
+    Session(Session &&) = delete;
+    Session &operator=(const Session &) = delete;
+    Session &operator=(Session &&) = delete;
+
+private:
+    /**
+     * @brief Поток HTTP/2: запрос и данные ответа.
+     */
+    struct Stream
+    {
+        /**
+         * @brief Конструктор.
+         *
+         * @param stream_id Идентификатор потока
+         */
+        explicit Stream(int32_t stream_id) noexcept
+        : id(stream_id)
+        , req(evhttp_request_new(nullptr, nullptr))
+        , body(evbuffer_new())
+        {
+        }
+
+        /**
+         * @brief Деструктор.
+         */
+        ~Stream() noexcept
+        {
+            evhttp_request_free(req);
+            evbuffer_free(body);
+        }
+
+        Stream(const Stream &) = delete;
+        Stream(Stream &&) = delete;
+        Stream &operator=(const Stream &) = delete;
+        Stream &operator=(Stream &&) = delete;
+
+        /**
+         * @brief Идентификатор потока.
+         */
+        int32_t id;
+
+        /**
+         * @brief Запрос libevent без подключения.
+         */
+        evhttp_request *req;
+
+        /**
+         * @brief Неотправленные данные ответа.
+         */
+        evbuffer *body;
+
+        /**
+         * @brief URL-путь запроса (:path).
+         */
+        string path;
+
+        /**
+         * @brief Метод запроса (:method).
+         */
+        evhttp_cmd_type type{EVHTTP_REQ_GET};
+
+        /**
+         * @brief Признак известного метода запроса.
+         */
+        bool method{false};
+
+        /**
+         * @brief Код ответа на некорректный запрос, 0 - запрос корректен.
+         */
+        int error{0};
+
+        /**
+         * @brief Признак отправки ответа.
+         */
+        bool replied{false};
+    };
+
+    /**
+     * @brief Функция обратного вызова чтения буфера подключения.
+     *
+     * @param arg Указатель на сессию
+     */
+    static void OnRead(bufferevent *, void *arg) noexcept
+    {
+        auto *session{static_cast<Session *>(arg)};
+
+        const bool received{session->Receive()};
+        if (!session->Flush() || !received)
+        {
+            session->Close();
+            return;
+        }
+
+        session->Check();
+    }
+
+    /**
+     * @brief Функция обратного вызова отправки данных буфера подключения.
+     *
+     * @param arg Указатель на сессию
+     */
+    static void OnWrite(bufferevent *, void *arg) noexcept
+    {
+        auto *session{static_cast<Session *>(arg)};
+
+        if (session->closing_)
+        {
+            session->Free();
+            return;
+        }
+
+        if (!session->Flush())
+        {
+            session->Close();
+            return;
+        }
+
+        session->Check();
+    }
+
+    /**
+     * @brief Функция обратного вызова событий буфера подключения.
+     *
+     * @param events События
+     * @param arg Указатель на сессию
+     */
+    static void OnEvent(bufferevent *, int16_t events, void *arg) noexcept
+    {
+        auto *session{static_cast<Session *>(arg)};
+
+        // простой подключения завершается уведомлением GOAWAY
+        if ((events & BEV_EVENT_TIMEOUT) != 0 &&
+            (events & BEV_EVENT_READING) != 0 && !session->closing_)
+        {
+            nghttp2_session_terminate_session(session->session_,
+                                              NGHTTP2_NO_ERROR);
+            session->Flush();
+            session->Close();
+            return;
+        }
+
+        session->Free();
+    }
+
+    /**
+     * @brief Функция обратного вызова начала заголовков кадра: создание
+     * потока запроса.
+     *
+     * @param frame Кадр
+     * @param user_data Указатель на сессию
+     *
+     * @return Результат обработки
+     */
+    static int OnBeginHeaders(nghttp2_session *,
+                              const nghttp2_frame *frame,
+                              void *user_data) noexcept
+    {
+        auto *session{static_cast<Session *>(user_data)};
+
+        if (frame->hd.type != NGHTTP2_HEADERS ||
+            frame->headers.cat != NGHTTP2_HCAT_REQUEST)
+        {
+            return 0;
+        }
+
+        const int32_t id{frame->hd.stream_id};
+        auto stream{make_unique<Stream>(id)};
+        nghttp2_session_set_stream_user_data(
+            session->session_, id, stream.get());
+        session->streams_.insert_or_assign(id, std::move(stream));
+
+        return 0;
+    }
+
+    /**
+     * @brief Функция обратного вызова заголовка запроса. Строки заголовка
+     * завершаются нулевым символом.
+     *
+     * @param frame Кадр
+     * @param name Имя заголовка
+     * @param namelen Длина имени
+     * @param value Значение заголовка
+     * @param valuelen Длина значения
+     * @param user_data Указатель на сессию
+     *
+     * @return Результат обработки
+     */
+    static int OnHeader(nghttp2_session *,
+                        const nghttp2_frame *frame,
+                        const uint8_t *name,
+                        size_t namelen,
+                        const uint8_t *value,
+                        size_t valuelen,
+                        uint8_t,
+                        void *user_data) noexcept
+    {
+        auto *session{static_cast<Session *>(user_data)};
+
+        auto *stream{session->Find(frame->hd.stream_id)};
+        if (stream == nullptr || frame->hd.type != NGHTTP2_HEADERS)
+        {
+            return 0;
+        }
+
+        // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+        const string_view key{reinterpret_cast<const char *>(name), namelen};
+        const string_view data{reinterpret_cast<const char *>(value),
+                               valuelen};
+        // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+
+        auto *headers{evhttp_request_get_input_headers(stream->req)};
+
+        if (key == ":method")
+        {
+            const auto *known{std::find_if(methods.begin(),
+                                           methods.end(),
+                                           [data](const auto &item)
+                                           { return item.first == data; })};
+            stream->method = known != methods.end();
+            if (stream->method)
+            {
+                stream->type = known->second;
+            }
+            else
+            {
+                stream->error = HTTP_NOTIMPLEMENTED;
+            }
+        }
+        else if (key == ":path")
+        {
+            stream->path = data;
+        }
+        else if (key == ":authority")
+        {
+            evhttp_add_header(headers, "Host", data.data());
+        }
+        else if (!key.empty() && key.front() != ':')
+        {
+            evhttp_add_header(headers, key.data(), data.data());
+        }
+
+        return 0;
+    }
+
+    /**
+     * @brief Функция обратного вызова части данных запроса.
+     *
+     * @param stream_id Идентификатор потока
+     * @param data Данные
+     * @param len Размер данных
+     * @param user_data Указатель на сессию
+     *
+     * @return Результат обработки
+     */
+    static int OnDataChunk(nghttp2_session *,
+                           uint8_t,
+                           int32_t stream_id,
+                           const uint8_t *data,
+                           size_t len,
+                           void *user_data) noexcept
+    {
+        auto *session{static_cast<Session *>(user_data)};
+
+        auto *stream{session->Find(stream_id)};
+        if (stream == nullptr || stream->error != 0)
+        {
+            return 0;
+        }
+
+        auto *input{evhttp_request_get_input_buffer(stream->req)};
+        if (evbuffer_get_length(input) + len > session->server_.max_body_size_)
+        {
+            // ответ передаётся, не дожидаясь конца данных запроса, после его
+            // отправки поток закрывается (OnFrameSend)
+            stream->error = HTTP_ENTITYTOOLARGE;
+            evbuffer_drain(input, evbuffer_get_length(input));
+            session->Reply(*stream, stream->error, nullptr);
+            return 0;
+        }
+
+        evbuffer_add(input, data, len);
+        return 0;
+    }
+
+    /**
+     * @brief Функция обратного вызова приёма кадра: передача запроса
+     * обработчику по завершении потока клиентом.
+     *
+     * @param frame Кадр
+     * @param user_data Указатель на сессию
+     *
+     * @return Результат обработки
+     */
+    static int OnFrame(nghttp2_session *,
+                       const nghttp2_frame *frame,
+                       void *user_data) noexcept
+    {
+        auto *session{static_cast<Session *>(user_data)};
+
+        if ((frame->hd.type != NGHTTP2_HEADERS &&
+             frame->hd.type != NGHTTP2_DATA) ||
+            (frame->hd.flags & NGHTTP2_FLAG_END_STREAM) == 0)
+        {
+            return 0;
+        }
+
+        auto *stream{session->Find(frame->hd.stream_id)};
+        if (stream != nullptr && !stream->replied)
+        {
+            session->Dispatch(*stream);
+        }
+
+        return 0;
+    }
+
+    /**
+     * @brief Функция обратного вызова отправки кадра: закрытие потока после
+     * ответа с кодом 413, если клиент продолжает передачу данных запроса.
+     *
+     * @param frame Кадр
+     * @param user_data Указатель на сессию
+     *
+     * @return Результат обработки
+     */
+    static int OnFrameSend(nghttp2_session *,
+                           const nghttp2_frame *frame,
+                           void *user_data) noexcept
+    {
+        auto *session{static_cast<Session *>(user_data)};
+
+        const int32_t id{frame->hd.stream_id};
+        if (frame->hd.type != NGHTTP2_HEADERS ||
+            (frame->hd.flags & NGHTTP2_FLAG_END_STREAM) == 0 ||
+            nghttp2_session_get_stream_remote_close(session->session_, id) != 0)
+        {
+            return 0;
+        }
+
+        // RST_STREAM с кодом NO_ERROR после полного ответа (RFC 9113, 8.1)
+        // прекращает передачу данных клиентом и обновление окна потока;
+        // отправленный до ответа кадр отменил бы ответ
+        const auto *stream{session->Find(id)};
+        if (stream != nullptr && stream->error == HTTP_ENTITYTOOLARGE)
+        {
+            nghttp2_submit_rst_stream(
+                session->session_, NGHTTP2_FLAG_NONE, id, NGHTTP2_NO_ERROR);
+        }
+
+        return 0;
+    }
+
+    /**
+     * @brief Функция обратного вызова закрытия потока.
+     *
+     * @param stream_id Идентификатор потока
+     * @param user_data Указатель на сессию
+     *
+     * @return Результат обработки
+     */
+    static int OnStreamClose(nghttp2_session *,
+                             int32_t stream_id,
+                             uint32_t,
+                             void *user_data) noexcept
+    {
+        auto *session{static_cast<Session *>(user_data)};
+        session->streams_.erase(stream_id);
+        return 0;
+    }
+
+    /**
+     * @brief Функция чтения данных ответа потока: данные передаются в буфер
+     * подключения без копирования функцией OnSendData.
+     *
+     * @param length Максимальный размер данных кадра
+     * @param data_flags Признаки данных
+     * @param source Источник данных - поток
+     *
+     * @return Размер данных кадра
+     */
+    static ssize_t ReadBody(nghttp2_session *,
+                            int32_t,
+                            uint8_t *,
+                            size_t length,
+                            uint32_t *data_flags,
+                            nghttp2_data_source *source,
+                            void *) noexcept
+    {
+        const auto *stream{static_cast<const Stream *>(source->ptr)};
+
+        const size_t rest{evbuffer_get_length(stream->body)};
+        const size_t size{std::min(length, rest)};
+
+        *data_flags |= NGHTTP2_DATA_FLAG_NO_COPY;
+        if (size == rest)
+        {
+            *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+        }
+
+        return static_cast<ssize_t>(size);
+    }
+
+    /**
+     * @brief Функция отправки кадра данных ответа: заголовок кадра и данные
+     * переносятся в буфер подключения.
+     *
+     * @param frame Кадр
+     * @param framehd Заголовок кадра
+     * @param length Размер данных кадра
+     * @param source Источник данных - поток
+     * @param user_data Указатель на сессию
+     *
+     * @return Результат отправки
+     */
+    static int OnSendData(nghttp2_session *,
+                          nghttp2_frame *frame,
+                          const uint8_t *framehd,
+                          size_t length,
+                          nghttp2_data_source *source,
+                          void *user_data) noexcept
+    {
+        auto *session{static_cast<Session *>(user_data)};
+        auto *stream{static_cast<Stream *>(source->ptr)};
+        auto *output{bufferevent_get_output(session->bev_)};
+
+        const size_t header_size{9};
+        evbuffer_add(output, framehd, header_size);
+
+        // сессия не выравнивает кадры, но длина выравнивания передаётся,
+        // если она задана
+        const size_t padding{frame->data.padlen};
+        if (padding > 0)
+        {
+            const auto pad_length{static_cast<uint8_t>(padding - 1)};
+            evbuffer_add(output, &pad_length, 1);
+        }
+
+        evbuffer_remove_buffer(stream->body, output, length);
+
+        if (padding > 1)
+        {
+            const std::vector<uint8_t> zeros(padding - 1, 0);
+            evbuffer_add(output, zeros.data(), zeros.size());
+        }
+
+        return 0;
+    }
+
+    /**
+     * @brief Поиск потока запроса.
+     *
+     * @param stream_id Идентификатор потока
+     *
+     * @return Поток или пустой указатель
+     */
+    [[nodiscard]] Stream *Find(int32_t stream_id) const noexcept
+    {
+        return static_cast<Stream *>(
+            nghttp2_session_get_stream_user_data(session_, stream_id));
+    }
+
+    /**
+     * @brief Передача принятых данных сессии nghttp2.
+     *
+     * @return Признак корректности данных
+     */
+    bool Receive() noexcept
+    {
+        auto *input{bufferevent_get_input(bev_)};
+
+        while (evbuffer_get_length(input) > 0)
+        {
+            evbuffer_iovec vec{};
+            if (evbuffer_peek(input, -1, nullptr, &vec, 1) < 1)
+            {
+                break;
+            }
+
+            const auto read{nghttp2_session_mem_recv(
+                session_, static_cast<const uint8_t *>(vec.iov_base),
+                vec.iov_len)};
+            if (read < 0)
+            {
+                Logging::Debug("Ошибка протокола HTTP/2: {}",
+                               nghttp2_strerror(static_cast<int>(read)));
+                return false;
+            }
+
+            evbuffer_drain(input, static_cast<size_t>(read));
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Передача кадров сессии в буфер подключения до верхней границы
+     * записи. Остальные кадры передаются после отправки данных буфера.
+     *
+     * @return Результат передачи
+     */
+    bool Flush() noexcept
+    {
+        auto *output{bufferevent_get_output(bev_)};
+
+        while (evbuffer_get_length(output) < high_watermark_)
+        {
+            const size_t before{evbuffer_get_length(output)};
+
+            const uint8_t *data{nullptr};
+            const auto size{nghttp2_session_mem_send(session_, &data)};
+            if (size < 0)
+            {
+                Logging::Debug("Ошибка передачи HTTP/2: {}",
+                               nghttp2_strerror(static_cast<int>(size)));
+                return false;
+            }
+
+            if (size > 0)
+            {
+                evbuffer_add(output, data, static_cast<size_t>(size));
+            }
+            // данные ответов без копирования переносятся в буфер функцией
+            // OnSendData
+            else if (evbuffer_get_length(output) == before)
+            {
+                break;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Закрытие подключения, если сессия завершена обеими сторонами.
+     */
+    void Check() noexcept
+    {
+        if (nghttp2_session_want_read(session_) == 0 &&
+            nghttp2_session_want_write(session_) == 0)
+        {
+            Close();
+        }
+    }
+
+    /**
+     * @brief Закрытие подключения после отправки данных буфера.
+     */
+    void Close() noexcept
+    {
+        if (evbuffer_get_length(bufferevent_get_output(bev_)) == 0)
+        {
+            Free();
+            return;
+        }
+
+        // клиент, не принимающий данные, не задерживает закрытие дольше
+        // времени простоя
+        closing_ = true;
+        const timeval idle{server_.settings_.idle_timeout.count(), 0};
+        bufferevent_disable(bev_, EV_READ);
+        bufferevent_set_timeouts(bev_, nullptr, &idle);
+    }
+
+    /**
+     * @brief Освобождение подключения libevent, при котором удаляется
+     * сессия.
+     */
+    void Free() noexcept
+    {
+        evhttp_connection_free(connection_);
+    }
+
+    /**
+     * @brief Передача запроса потока обработчику.
+     *
+     * @param stream Поток
+     */
+    void Dispatch(Stream &stream) noexcept
+    {
+        auto *req{stream.req};
+
+        if (stream.error == 0 && (!stream.method || stream.path.empty()))
+        {
+            stream.error = HTTP_BADREQUEST;
+        }
+
+        if (stream.error == 0)
+        {
+            if (!InitRequest(req, stream.type, stream.path, 2, 0))
+            {
+                stream.error = HTTP_BADREQUEST;
+            }
+        }
+
+        if (stream.error != 0)
+        {
+            Reply(stream, stream.error, nullptr);
+            return;
+        }
+
+        // адрес клиента передаётся так же, как его формирует HeaderImpl для
+        // подключений HTTP-сервера libevent
+        auto *headers{evhttp_request_get_input_headers(req)};
+        evhttp_remove_header(headers, "client");
+        evhttp_add_header(headers, "client", address_.c_str());
+
+        current_ = &stream;
+
+        {
+            Trace trace(req);
+
+            trace.Begin(Trace::Phase::Parse);
+            RequestImpl request(req);
+            ResponseImpl response(req);
+            trace.End(Trace::Phase::Parse);
+
+            trace.SetRequest(http::MethodToString(request.GetMethod()),
+                             request.Uri()->Url());
+
+            response.SetReplySink(
+                http::ReplySink::Bind<&Session::OnReply>(this));
+
+            server_.func_(request, response);
+
+            response.Send();
+
+            trace.SetCode(static_cast<int>(response.GetCode()));
+        }
+
+        current_ = nullptr;
+
+        server_.streams_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Приёмник ответа обработчика.
+     *
+     * @param req Запрос
+     * @param code Код ответа
+     * @param body Данные ответа
+     */
+    void OnReply(evhttp_request *req, int code, evbuffer *body) noexcept
+    {
+        if (current_ == nullptr || current_->req != req)
+        {
+            return;
+        }
+
+        Reply(*current_, code, body);
+    }
+
+    /**
+     * @brief Отправка ответа потока.
+     *
+     * @param stream Поток
+     * @param code Код ответа
+     * @param body Данные ответа, пустой указатель - ответ без данных
+     */
+    void Reply(Stream &stream, int code, evbuffer *body) noexcept
+    {
+        if (stream.replied)
+        {
+            return;
+        }
+        stream.replied = true;
+
+        const bool no_body{
+            code == HTTP_NOCONTENT || code == HTTP_NOTMODIFIED ||
+            code < HTTP_OK ||
+            evhttp_request_get_command(stream.req) == EVHTTP_REQ_HEAD};
+
+        if (body != nullptr && !no_body)
+        {
+            evbuffer_add_buffer(stream.body, body);
+        }
+
+        // имена заголовков HTTP/2 передаются в нижнем регистре
+        std::vector<std::pair<string, string>> fields;
+        fields.emplace_back(":status", std::to_string(code));
+
+        auto *headers{evhttp_request_get_output_headers(stream.req)};
+        for (evkeyval *header = headers->tqh_first; header != nullptr;
+             header = header->next.tqe_next)
+        {
+            if (HopByHop(header->key))
+            {
+                continue;
+            }
+
+            string name{header->key};
+            std::transform(name.begin(),
+                           name.end(),
+                           name.begin(),
+                           [](unsigned char c)
+                           { return static_cast<char>(std::tolower(c)); });
+            fields.emplace_back(std::move(name), header->value);
+        }
+
+        if (!no_body)
+        {
+            fields.emplace_back(
+                "content-length",
+                std::to_string(evbuffer_get_length(stream.body)));
+        }
+
+        std::vector<nghttp2_nv> nva;
+        nva.reserve(fields.size());
+        for (const auto &[name, value] : fields)
+        {
+            nva.push_back(Field(name, value));
+        }
+
+        nghttp2_data_provider provider{};
+        provider.source.ptr = &stream;
+        provider.read_callback = &Session::ReadBody;
+
+        const bool has_data{evbuffer_get_length(stream.body) > 0};
+        nghttp2_submit_response(session_,
+                                stream.id,
+                                nva.data(),
+                                nva.size(),
+                                has_data ? &provider : nullptr);
+    }
+
+    /**
+     * @brief Приём подключений HTTP/2.
+     */
+    Server &server_;
+
+    /**
+     * @brief Подключение libevent - владелец буфера.
+     */
+    evhttp_connection *connection_;
+
+    /**
+     * @brief Буфер подключения.
+     */
+    bufferevent *bev_;
+
+    /**
+     * @brief Сессия nghttp2.
+     */
+    nghttp2_session *session_{nullptr};
+
+    /**
+     * @brief Потоки запросов по идентификаторам.
+     */
+    std::unordered_map<int32_t, unique_ptr<Stream>> streams_;
+
+    /**
+     * @brief Поток, запрос которого выполняется обработчиком.
+     */
+    Stream *current_{nullptr};
+
+    /**
+     * @brief Адрес клиента.
+     */
+    string address_;
+
+    /**
+     * @brief Объём неотправленных данных, при превышении которого передача
+     * кадров приостанавливается.
+     */
+    size_t high_watermark_{default_high_watermark};
+
+    /**
+     * @brief Признак закрытия подключения после отправки данных буфера.
+     */
+    bool closing_{false};
+};
+
+/*------------------------------------------------------------------------------
+    Server
+------------------------------------------------------------------------------*/
+Server::Server(const Settings &settings,
+               size_t max_body_size,
+               Dispatcher func) noexcept
+: settings_(settings)
+, max_body_size_(max_body_size)
+, func_(func)
+{
+}
+
+//------------------------------------------------------------------------------
+Server::~Server() noexcept = default;
+
+//------------------------------------------------------------------------------
+void Server::SetFactory(BufferFactory factory, void *arg) noexcept
+{
+    factory_ = factory;
+    factory_arg_ = arg;
+}
+
+//------------------------------------------------------------------------------
+void Server::Bind() noexcept
+{
+    current = this;
+}
+
+//------------------------------------------------------------------------------
+uint64_t Server::Streams() const noexcept
+{
+    return streams_.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+bufferevent *Server::CreateBuffer(event_base *base, void *arg) noexcept
+{
+    auto *server{static_cast<Server *>(arg)};
+
+    auto *bev{server->factory_ != nullptr
+                  ? server->factory_(base, server->factory_arg_)
+                  : bufferevent_socket_new(base, -1, BEV_OPT_CLOSE_ON_FREE)};
+    if (bev == nullptr)
+    {
+        return nullptr;
+    }
+
+    // функция удаляется после первых данных подключения
+    evbuffer_add_cb(bufferevent_get_input(bev), &Server::OnInput, bev);
+
+    return bev;
+}
+
+//------------------------------------------------------------------------------
+void Server::OnInput(evbuffer *buffer,
+                     const evbuffer_cb_info *info,
+                     void *arg) noexcept
+{
+    if (info->n_added == 0)
+    {
+        return;
+    }
+
+    std::array<char, preface.size()> head{};
+    const auto length{
+        evbuffer_copyout(buffer, head.data(), std::min(
+            evbuffer_get_length(buffer), head.size()))};
+    const auto size{static_cast<size_t>(std::max(length, ev_ssize_t{0}))};
+
+    const bool h2{string_view{head.data(), size} == preface.substr(0, size)};
+    if (h2 && size < preface_prefix)
+    {
+        return;
+    }
+
+    // функция обратного вызова может удалять себя во время вызова
+    evbuffer_remove_cb(buffer, &Server::OnInput, arg);
+
+    if (h2 && current != nullptr)
+    {
+        current->Accept(static_cast<bufferevent *>(arg));
+    }
+}
+
+//------------------------------------------------------------------------------
+void Server::Accept(bufferevent *bev) noexcept
+{
+    // аргумент функций обратного вызова буфера - подключение libevent
+    void *arg{nullptr};
+    bufferevent_getcb(bev, nullptr, nullptr, nullptr, &arg);
+    auto *connection{static_cast<evhttp_connection *>(arg)};
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    auto session{make_unique<Session>(*this, connection, bev)};
+    if (!session->Start())
+    {
+        Logging::Error("Ошибка создания сессии HTTP/2");
+        return;
+    }
+
+    ClientLimits::Release(connection);
+    ClientLimits::SetCloseCallback(connection, &Server::OnClose, this);
+
+    sessions_.insert_or_assign(connection, std::move(session));
+}
+
+//------------------------------------------------------------------------------
+void Server::OnClose(evhttp_connection *connection, void *arg) noexcept
+{
+    auto *server{static_cast<Server *>(arg)};
+    server->sessions_.erase(connection);
+}
+
+}  // namespace tasp::http2
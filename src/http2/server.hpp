@@ -0,0 +1,218 @@
+/**
+ * @file
+ * @brief Приём подключений HTTP/2 HTTP-сервером libevent.
+ */
+#ifndef TASP_HTTP2_SERVER_HPP_
+#define TASP_HTTP2_SERVER_HPP_
+
+#include <event2/bufferevent.h>
+#include <evhttp.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+
+#include "tasp/function_ref.hpp"
+
+namespace tasp::http
+{
+class RequestImpl;
+class ResponseImpl;
+}  // namespace tasp::http
+
+namespace tasp::http2
+{
+
+/**
+ * @brief Приём подключений HTTP/2 (h2c без шифрования и h2 через TLS с
+ * выбором протокола по ALPN) на порту HTTP-сервера libevent.
+ *
+ * Буфер каждого подключения создаётся через evhttp_set_bevcb, первые данные
+ * подключения проверяются функцией обратного вызова буфера ввода. Если
+ * клиент начинает с преамбулы HTTP/2 (prior knowledge), функции обратного
+ * вызова буфера заменяются функциями сессии nghttp2, а подключение libevent
+ * остаётся владельцем буфера и закрывается сессией. Остальные подключения
+ * обслуживаются libevent по HTTP/1.1 без изменений. Переход с HTTP/1.1
+ * заголовком Upgrade: h2c не поддерживается.
+ *
+ * Запросы потоков передаются обработчикам в виде запросов libevent без
+ * подключения, как и запросы сервера io_uring, поэтому обработчики работают
+ * с теми же интерфейсами http::Request и http::Response. Отложенные ответы
+ * и потоки событий требуют подключения libevent и по HTTP/2 недоступны.
+ *
+ * Количество одновременных потоков подключения ограничивается параметром
+ * SETTINGS_MAX_CONCURRENT_STREAMS, приём данных - окнами управления потоком
+ * потока и подключения. Ответы передаются в буфер подключения, пока объём
+ * неотправленных данных не превысит верхнюю границу записи буфера.
+ */
+class Server final
+{
+public:
+    /**
+     * @brief Функция создания буфера подключения (evhttp_set_bevcb).
+     */
+    using BufferFactory = bufferevent *(*)(event_base *, void *);
+
+    /**
+     * @brief Ссылка на функцию, распределяющую запросы по обработчикам.
+     */
+    using Dispatcher =
+        FunctionRef<void(http::RequestImpl &, http::ResponseImpl &)>;
+
+    /**
+     * @brief Параметры HTTP/2.
+     */
+    struct Settings
+    {
+        /**
+         * @brief Признак включения HTTP/2.
+         */
+        bool enabled{false};
+
+        /**
+         * @brief Максимальное количество одновременных потоков подключения.
+         */
+        uint32_t max_streams{100};
+
+        /**
+         * @brief Начальное окно управления потоком для данных запроса
+         * потока в байтах.
+         */
+        uint32_t stream_window{1024 * 1024};
+
+        /**
+         * @brief Окно управления потоком для данных запросов подключения в
+         * байтах.
+         */
+        uint32_t connection_window{16 * 1024 * 1024};
+
+        /**
+         * @brief Время простоя подключения без приёма данных.
+         */
+        std::chrono::seconds idle_timeout{60};
+    };
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param settings Параметры HTTP/2
+     * @param max_body_size Максимальный размер данных запроса в байтах
+     * @param func Функция, распределяющая запросы по обработчикам
+     */
+    Server(const Settings &settings,
+           size_t max_body_size,
+           Dispatcher func) noexcept;
+
+    /**
+     * @brief Деструктор. Вызывается после освобождения HTTP-сервера.
+     */
+    ~Server() noexcept;
+
+    /**
+     * @brief Установка функции создания буферов подключений, на которые
+     * распространяется HTTP/2.
+     *
+     * @param factory Функция создания буферов, пустая - буферы сокетов
+     * @param arg Аргумент функции создания буферов
+     */
+    void SetFactory(BufferFactory factory, void *arg) noexcept;
+
+    /**
+     * @brief Привязка приёма подключений к потоку цикла обработки событий.
+     * Вызывается в потоке цикла.
+     */
+    void Bind() noexcept;
+
+    /**
+     * @brief Запрос количества обработанных потоков HTTP/2.
+     *
+     * @return Количество потоков
+     */
+    [[nodiscard]] uint64_t Streams() const noexcept;
+
+    /**
+     * @brief Функция создания буфера подключения (evhttp_set_bevcb).
+     *
+     * @param base Цикл обработки событий
+     * @param arg Указатель на приём подключений HTTP/2
+     *
+     * @return Буфер подключения
+     */
+    static bufferevent *CreateBuffer(event_base *base, void *arg) noexcept;
+
+    Server(const Server &) = delete;
+    Server(Server &&) = delete;
+    Server &operator=(const Server &) = delete;
+    Server &operator=(Server &&) = delete;
+
+private:
+    class Session;
+
+    /**
+     * @brief Функция обратного вызова изменения буфера ввода: поиск
+     * преамбулы HTTP/2 в первых данных подключения.
+     *
+     * @param buffer Буфер ввода
+     * @param info Изменение буфера
+     * @param arg Буфер подключения
+     */
+    static void OnInput(evbuffer *buffer,
+                        const evbuffer_cb_info *info,
+                        void *arg) noexcept;
+
+    /**
+     * @brief Функция обратного вызова закрытия подключения HTTP/2.
+     *
+     * @param connection Подключение
+     * @param arg Указатель на приём подключений HTTP/2
+     */
+    static void OnClose(evhttp_connection *connection, void *arg) noexcept;
+
+    /**
+     * @brief Передача подключения сессии HTTP/2.
+     *
+     * @param bev Буфер подключения
+     */
+    void Accept(bufferevent *bev) noexcept;
+
+    /**
+     * @brief Параметры HTTP/2.
+     */
+    Settings settings_;
+
+    /**
+     * @brief Максимальный размер данных запроса в байтах.
+     */
+    size_t max_body_size_;
+
+    /**
+     * @brief Функция, распределяющая запросы по обработчикам.
+     */
+    Dispatcher func_;
+
+    /**
+     * @brief Функция создания буферов подключений.
+     */
+    BufferFactory factory_{nullptr};
+
+    /**
+     * @brief Аргумент функции создания буферов подключений.
+     */
+    void *factory_arg_{nullptr};
+
+    /**
+     * @brief Сессии HTTP/2 по подключениям.
+     */
+    std::unordered_map<evhttp_connection *, std::unique_ptr<Session>>
+        sessions_;
+
+    /**
+     * @brief Количество обработанных потоков HTTP/2.
+     */
+    std::atomic<uint64_t> streams_{0};
+};
+
+}  // namespace tasp::http2
+
+#endif  // TASP_HTTP2_SERVER_HPP_
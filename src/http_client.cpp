@@ -0,0 +1,43 @@
+#include "tasp/http_client.hpp"
+
+#include "http_client_impl.hpp"
+
+using std::make_unique;
+using std::string_view;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    HttpClient
+------------------------------------------------------------------------------*/
+HttpClient::HttpClient(string_view url) noexcept
+: HttpClient(url, Options{})
+{
+}
+
+//------------------------------------------------------------------------------
+HttpClient::HttpClient(string_view url, const Options &options) noexcept
+: impl_(make_unique<HttpClientImpl>(url, options))
+{
+}
+
+//------------------------------------------------------------------------------
+HttpClient::~HttpClient() noexcept = default;
+
+//------------------------------------------------------------------------------
+void HttpClient::Send(Call call, Callback callback) const noexcept
+{
+    impl_->Send(std::move(call), std::move(callback));
+}
+
+/*------------------------------------------------------------------------------
+    HttpClient::Result
+------------------------------------------------------------------------------*/
+bool HttpClient::Result::Ok() const noexcept
+{
+    const int success{200};
+    const int redirection{300};
+    return error.empty() && status >= success && status < redirection;
+}
+
+}  // namespace tasp
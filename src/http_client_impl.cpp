@@ -0,0 +1,656 @@
+#include "http_client_impl.hpp"
+
+#include <event2/dns.h>
+#include <event2/keyvalq_struct.h>
+#include <evhttp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <random>
+#include <unordered_map>
+
+#include <tasp/logging.hpp>
+
+#include "connection.hpp"
+
+using std::make_shared;
+using std::make_unique;
+using std::shared_ptr;
+using std::string;
+using std::string_view;
+using std::unique_ptr;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+namespace tasp
+{
+
+namespace
+{
+using Clock = HttpClient::Clock;
+
+/**
+ * @brief Умный указатель разобранного URI библиотеки libevent.
+ */
+using EvUri = unique_ptr<evhttp_uri, decltype(&evhttp_uri_free)>;
+
+/**
+ * @brief Коды ответа, при которых идемпотентный запрос повторяется.
+ */
+constexpr int bad_gateway{502};
+constexpr int service_unavailable{503};
+constexpr int gateway_timeout{504};
+
+/**
+ * @brief Счётчик идентификаторов клиентов.
+ */
+std::atomic<uint64_t> next_id{1};
+
+//------------------------------------------------------------------------------
+timeval ToTimeval(Clock::duration duration) noexcept
+{
+    const auto usec{
+        duration_cast<microseconds>(std::max(duration, Clock::duration::zero()))
+            .count()};
+    const int64_t usec_per_sec{1000000};
+    return timeval{usec / usec_per_sec, usec % usec_per_sec};
+}
+
+//------------------------------------------------------------------------------
+bool Idempotent(http::Request::Method method) noexcept
+{
+    switch (method)
+    {
+        case http::Request::Method::Get:
+        case http::Request::Method::Head:
+        case http::Request::Method::Put:
+        case http::Request::Method::Delete:
+        case http::Request::Method::Options:
+            return true;
+        default:
+            return false;
+    }
+}
+
+class Pool;
+
+/**
+ * @brief Состояние запроса в пуле подключений.
+ */
+struct Operation
+{
+    /**
+     * @brief Параметры запроса.
+     */
+    HttpClient::Call call;
+
+    /**
+     * @brief Функция обратного вызова с результатом.
+     */
+    HttpClient::Callback callback;
+
+    /**
+     * @brief Пул подключений.
+     */
+    Pool *pool{nullptr};
+
+    /**
+     * @brief Таймер времени ожидания ответа или задержки перед повтором.
+     */
+    ev::EvEvent timer{nullptr, nullptr};
+
+    /**
+     * @brief Выполняемый запрос libevent, пустой указатель - запрос
+     * ожидает отправки или повтора.
+     */
+    evhttp_request *req{nullptr};
+
+    /**
+     * @brief Номер подключения выполняемого запроса.
+     */
+    size_t link{0};
+
+    /**
+     * @brief Количество выполненных попыток.
+     */
+    size_t attempts{0};
+};
+
+/**
+ * @brief Пул подключений к сервису в цикле обработки событий.
+ */
+class Pool final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param base Цикл обработки событий
+     * @param upstream Параметры сервиса
+     */
+    Pool(event_base *base,
+         shared_ptr<const HttpClientImpl::Upstream> upstream) noexcept
+    : base_(base)
+    , upstream_(std::move(upstream))
+    , dns_(evdns_base_new(base, EVDNS_BASE_INITIALIZE_NAMESERVERS))
+    {
+    }
+
+    /**
+     * @brief Деструктор. Незавершённые запросы отменяются без вызова функций
+     * обратного вызова.
+     */
+    ~Pool() noexcept
+    {
+        // подключения освобождают свои запросы без вызова функций
+        // обратного вызова
+        for (auto *connection : links_)
+        {
+            evhttp_connection_free(connection);
+        }
+
+        operations_.clear();
+
+        if (dns_ != nullptr)
+        {
+            evdns_base_free(dns_, 0);
+        }
+    }
+
+    /**
+     * @brief Отправка запроса.
+     *
+     * @param call Параметры запроса
+     * @param callback Функция обратного вызова с результатом
+     */
+    void Send(HttpClient::Call &&call, HttpClient::Callback &&callback) noexcept
+    {
+        auto operation{make_unique<Operation>()};
+        operation->call = std::move(call);
+        operation->callback = std::move(callback);
+        operation->pool = this;
+        operation->timer = ev::EvEvent(
+            evtimer_new(base_, &Pool::OnTimer, operation.get()), event_free);
+
+        auto *ptr{operation.get()};
+        operations_.emplace(ptr, std::move(operation));
+
+        Dispatch(ptr);
+    }
+
+    Pool(const Pool &) = delete;
+    Pool(Pool &&) = delete;
+    Pool &operator=(const Pool &) = delete;
+    Pool &operator=(Pool &&) = delete;
+
+private:
+    /**
+     * @brief Отправка запроса через свободное подключение или постановка в
+     * очередь ожидания.
+     *
+     * @param operation Запрос
+     */
+    void Dispatch(Operation *operation) noexcept
+    {
+        if (Clock::now() >= operation->call.deadline)
+        {
+            Fail(operation, "Превышен срок выполнения запроса");
+            return;
+        }
+
+        const size_t link{FreeLink()};
+        if (link == links_.size())
+        {
+            if (pending_.size() >= upstream_->options.max_pending)
+            {
+                Fail(operation, "Превышен размер очереди запросов");
+                return;
+            }
+
+            pending_.push_back(operation);
+            return;
+        }
+
+        Start(operation, link);
+    }
+
+    /**
+     * @brief Выбор наименее загруженного подключения. Новое подключение
+     * создаётся, если все подключения заняты и лимит не достигнут.
+     *
+     * @return Номер подключения или links_.size(), если свободных нет
+     */
+    size_t FreeLink() noexcept
+    {
+        const auto &options{upstream_->options};
+
+        size_t best{links_.size()};
+        for (size_t i = 0; i < links_.size(); i++)
+        {
+            if (active_[i] < options.max_requests_per_connection &&
+                (best == links_.size() || active_[i] < active_[best]))
+            {
+                best = i;
+            }
+        }
+
+        if ((best == links_.size() || active_[best] > 0) &&
+            links_.size() < options.max_connections)
+        {
+            auto *connection{evhttp_connection_base_new(base_,
+                                                        dns_,
+                                                        upstream_->host.c_str(),
+                                                        upstream_->port)};
+            if (connection == nullptr)
+            {
+                Logging::Error("Ошибка создания подключения к {}:{}",
+                               upstream_->host,
+                               upstream_->port);
+                return best;
+            }
+
+            evhttp_connection_set_flags(connection,
+                                        EVHTTP_CON_REUSE_CONNECTED_ADDR);
+
+            links_.push_back(connection);
+            active_.push_back(0);
+            return links_.size() - 1;
+        }
+
+        return best;
+    }
+
+    /**
+     * @brief Отправка запроса через подключение.
+     *
+     * @param operation Запрос
+     * @param link Номер подключения
+     */
+    void Start(Operation *operation, size_t link) noexcept
+    {
+        const auto &call{operation->call};
+
+        auto *req{evhttp_request_new(&Pool::OnResponse, operation)};
+        auto *headers{evhttp_request_get_output_headers(req)};
+
+        evhttp_add_header(headers, "Host", upstream_->host_header.c_str());
+        for (const auto &[name, value] : call.headers)
+        {
+            evhttp_add_header(headers, name.c_str(), value.c_str());
+        }
+
+        if (!call.body.empty())
+        {
+            evhttp_add_header(
+                headers, "Content-Type", call.content_type.c_str());
+            evbuffer_add(evhttp_request_get_output_buffer(req),
+                         call.body.data(),
+                         call.body.size());
+        }
+
+        const milliseconds timeout{call.timeout.count() > 0
+                                       ? call.timeout
+                                       : upstream_->options.timeout};
+        const auto now{Clock::now()};
+        const auto limit{call.deadline - now < timeout ? call.deadline - now
+                                                       : Clock::duration{
+                                                             timeout}};
+
+        // сервис может прекратить обработку, ответ на которую не дождутся
+        const auto remaining{duration_cast<milliseconds>(limit).count()};
+        evhttp_add_header(
+            headers, "X-Request-Timeout", std::to_string(remaining).c_str());
+
+        operation->attempts++;
+        operation->req = req;
+        operation->link = link;
+        active_[link]++;
+
+        const timeval tv{ToTimeval(limit)};
+        evtimer_add(operation->timer.get(), &tv);
+
+        const string uri{upstream_->prefix + call.path};
+        if (evhttp_make_request(links_[link],
+                                req,
+                                static_cast<evhttp_cmd_type>(call.method),
+                                uri.c_str()) != 0)
+        {
+            Complete(operation, nullptr, "Ошибка отправки запроса");
+        }
+    }
+
+    /**
+     * @brief Завершение попытки: повтор, отправка результата и отправка
+     * ожидающих запросов.
+     *
+     * @param operation Запрос
+     * @param req Ответ libevent, пустой указатель - ответ не получен
+     * @param error Описание ошибки, если ответ не получен
+     */
+    void Complete(Operation *operation,
+                  evhttp_request *req,
+                  string_view error) noexcept
+    {
+        evtimer_del(operation->timer.get());
+        operation->req = nullptr;
+        active_[operation->link]--;
+
+        HttpClient::Result result;
+        if (req != nullptr && evhttp_request_get_response_code(req) > 0)
+        {
+            Read(req, result);
+        }
+        else
+        {
+            result.error = error;
+        }
+
+        if (!Retry(operation, result))
+        {
+            Finish(operation, std::move(result));
+        }
+
+        Pump();
+    }
+
+    /**
+     * @brief Чтение ответа.
+     *
+     * @param req Ответ libevent
+     * @param result Результат запроса
+     */
+    static void Read(evhttp_request *req, HttpClient::Result &result) noexcept
+    {
+        result.status = evhttp_request_get_response_code(req);
+
+        auto *body{evhttp_request_get_input_buffer(req)};
+        const size_t length{evbuffer_get_length(body)};
+        result.body.resize(length);
+        evbuffer_copyout(body, result.body.data(), length);
+
+        auto *headers{evhttp_request_get_input_headers(req)};
+        for (auto *header = headers->tqh_first; header != nullptr;
+             header = header->next.tqe_next)
+        {
+            result.headers.emplace_back(header->key, header->value);
+        }
+    }
+
+    /**
+     * @brief Повтор идемпотентного запроса после случайной задержки.
+     *
+     * @param operation Запрос
+     * @param result Результат попытки
+     *
+     * @return Признак запланированного повтора
+     */
+    bool Retry(Operation *operation,
+               const HttpClient::Result &result) const noexcept
+    {
+        const auto &options{upstream_->options};
+
+        const bool retryable{result.status == 0 ||
+                             result.status == bad_gateway ||
+                             result.status == service_unavailable ||
+                             result.status == gateway_timeout};
+        if (!retryable || operation->attempts > options.retries ||
+            !Idempotent(operation->call.method))
+        {
+            return false;
+        }
+
+        // экспоненциальная задержка со случайной составляющей, чтобы
+        // повторы разных запросов не приходили к сервису одновременно
+        const auto shift{std::min<size_t>(operation->attempts - 1, 16)};
+        const auto ceiling{std::min<milliseconds>(
+            options.max_backoff, options.backoff * (int64_t{1} << shift))};
+
+        thread_local std::minstd_rand random{std::random_device{}()};
+        std::uniform_int_distribution<int64_t> distribution(
+            ceiling.count() / 2, std::max<int64_t>(ceiling.count(), 0));
+        const milliseconds delay{distribution(random)};
+
+        if (Clock::now() + delay >= operation->call.deadline)
+        {
+            return false;
+        }
+
+        Logging::Debug("Повтор запроса {} к {} через {} мс: {}",
+                       operation->call.path,
+                       upstream_->host,
+                       delay.count(),
+                       result.error.empty() ? std::to_string(result.status)
+                                            : result.error);
+
+        const timeval tv{ToTimeval(delay)};
+        evtimer_add(operation->timer.get(), &tv);
+        return true;
+    }
+
+    /**
+     * @brief Отправка ожидающих запросов через освободившиеся подключения.
+     */
+    void Pump() noexcept
+    {
+        while (!pending_.empty())
+        {
+            const size_t link{FreeLink()};
+            if (link == links_.size())
+            {
+                return;
+            }
+
+            auto *operation{pending_.front()};
+            pending_.pop_front();
+
+            if (Clock::now() >= operation->call.deadline)
+            {
+                Fail(operation, "Превышен срок выполнения запроса");
+                continue;
+            }
+
+            Start(operation, link);
+        }
+    }
+
+    /**
+     * @brief Завершение запроса с ошибкой.
+     *
+     * @param operation Запрос
+     * @param error Описание ошибки
+     */
+    void Fail(Operation *operation, string_view error) noexcept
+    {
+        HttpClient::Result result;
+        result.error = error;
+        Finish(operation, std::move(result));
+    }
+
+    /**
+     * @brief Удаление запроса и вызов функции обратного вызова.
+     *
+     * @param operation Запрос
+     * @param result Результат
+     */
+    void Finish(Operation *operation, HttpClient::Result &&result) noexcept
+    {
+        result.attempts = operation->attempts;
+
+        auto callback{std::move(operation->callback)};
+        operations_.erase(operation);
+
+        // функция может отправить новые запросы в этот же пул
+        if (callback)
+        {
+            callback(std::move(result));
+        }
+    }
+
+    /**
+     * @brief Функция обратного вызова ответа libevent.
+     *
+     * @param req Ответ, пустой указатель при ошибке подключения
+     * @param arg Указатель на запрос
+     */
+    static void OnResponse(evhttp_request *req, void *arg) noexcept
+    {
+        auto *operation{static_cast<Operation *>(arg)};
+        operation->pool->Complete(operation, req, "Ошибка подключения");
+    }
+
+    /**
+     * @brief Функция обратного вызова таймера: истечение времени ожидания
+     * ответа или задержки перед повтором.
+     *
+     * @param fd Не используется
+     * @param events Не используется
+     * @param arg Указатель на запрос
+     */
+    static void OnTimer(evutil_socket_t /*fd*/,
+                        short /*events*/,
+                        void *arg) noexcept
+    {
+        auto *operation{static_cast<Operation *>(arg)};
+        auto *pool{operation->pool};
+
+        if (operation->req == nullptr)
+        {
+            pool->Dispatch(operation);
+            return;
+        }
+
+        // отменённый запрос освобождается библиотекой без вызова функции
+        // обратного вызова, подключение переустанавливается
+        evhttp_cancel_request(operation->req);
+        pool->Complete(operation, nullptr, "Превышено время ожидания ответа");
+    }
+
+    /**
+     * @brief Цикл обработки событий.
+     */
+    event_base *base_;
+
+    /**
+     * @brief Параметры сервиса.
+     */
+    shared_ptr<const HttpClientImpl::Upstream> upstream_;
+
+    /**
+     * @brief Асинхронное разрешение имён.
+     */
+    evdns_base *dns_;
+
+    /**
+     * @brief Подключения к сервису.
+     */
+    std::vector<evhttp_connection *> links_;
+
+    /**
+     * @brief Количество запросов, назначенных подключениям.
+     */
+    std::vector<size_t> active_;
+
+    /**
+     * @brief Запросы, ожидающие свободного подключения.
+     */
+    std::deque<Operation *> pending_;
+
+    /**
+     * @brief Незавершённые запросы.
+     */
+    std::unordered_map<Operation *, unique_ptr<Operation>> operations_;
+};
+
+/**
+ * @brief Пулы подключений циклов обработки событий потока по
+ * идентификаторам клиентов.
+ */
+thread_local std::map<uint64_t, unique_ptr<Pool>> pools;
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    HttpClientImpl
+------------------------------------------------------------------------------*/
+HttpClientImpl::HttpClientImpl(string_view url,
+                               const HttpClient::Options &options) noexcept
+{
+    const string str{url};
+    const EvUri uri{evhttp_uri_parse(str.c_str()), evhttp_uri_free};
+    if (!uri || evhttp_uri_get_host(uri.get()) == nullptr ||
+        evhttp_uri_get_scheme(uri.get()) == nullptr ||
+        string_view{evhttp_uri_get_scheme(uri.get())} != "http")
+    {
+        Logging::Error("Некорректный адрес сервиса {}", url);
+        return;
+    }
+
+    auto upstream{make_shared<Upstream>()};
+    upstream->id = next_id.fetch_add(1, std::memory_order_relaxed);
+    upstream->host = evhttp_uri_get_host(uri.get());
+    upstream->options = options;
+    upstream->host_header = upstream->host;
+
+    const int port{evhttp_uri_get_port(uri.get())};
+    if (port > 0)
+    {
+        upstream->port = static_cast<uint16_t>(port);
+        upstream->host_header += ":" + std::to_string(port);
+    }
+
+    const char *path{evhttp_uri_get_path(uri.get())};
+    if (path != nullptr)
+    {
+        upstream->prefix = path;
+        while (!upstream->prefix.empty() && upstream->prefix.back() == '/')
+        {
+            upstream->prefix.pop_back();
+        }
+    }
+
+    upstream_ = upstream;
+}
+
+//------------------------------------------------------------------------------
+HttpClientImpl::~HttpClientImpl() noexcept = default;
+
+//------------------------------------------------------------------------------
+void HttpClientImpl::Send(HttpClient::Call &&call,
+                          HttpClient::Callback &&callback) const noexcept
+{
+    HttpClient::Result result;
+
+    auto *base{ev::Connection::CurrentBase()};
+    if (!upstream_)
+    {
+        result.error = "Некорректный адрес сервиса";
+    }
+    else if (base == nullptr)
+    {
+        result.error = "Запрос вне цикла обработки событий HTTP-сервера";
+    }
+
+    if (!result.error.empty())
+    {
+        Logging::Error(
+            "Ошибка отправки запроса {}: {}", call.path, result.error);
+        if (callback)
+        {
+            callback(std::move(result));
+        }
+        return;
+    }
+
+    auto &pool{pools[upstream_->id]};
+    if (!pool)
+    {
+        pool = make_unique<Pool>(base, upstream_);
+    }
+
+    pool->Send(std::move(call), std::move(callback));
+}
+
+}  // namespace tasp
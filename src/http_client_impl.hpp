@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief Реализация асинхронного HTTP-клиента.
+ */
+#ifndef TASP_HTTP_CLIENT_IMPL_HPP_
+#define TASP_HTTP_CLIENT_IMPL_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <tasp/http_client.hpp>
+
+namespace tasp
+{
+
+/**
+ * @brief Реализация асинхронного HTTP-клиента.
+ *
+ * Пулы подключений хранятся в потоках циклов обработки событий и удаляются
+ * при завершении потоков, поэтому клиент может быть удалён раньше циклов.
+ */
+class HttpClientImpl final
+{
+public:
+    /**
+     * @brief Параметры сервиса, общие для клиента и его пулов подключений.
+     */
+    struct Upstream
+    {
+        /**
+         * @brief Идентификатор клиента.
+         */
+        uint64_t id{0};
+
+        /**
+         * @brief Имя узла.
+         */
+        std::string host;
+
+        /**
+         * @brief Порт.
+         */
+        uint16_t port{80};
+
+        /**
+         * @brief Значение заголовка Host.
+         */
+        std::string host_header;
+
+        /**
+         * @brief Префикс пути запросов.
+         */
+        std::string prefix;
+
+        /**
+         * @brief Параметры клиента.
+         */
+        HttpClient::Options options;
+    };
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param url Адрес сервиса
+     * @param options Параметры клиента
+     */
+    HttpClientImpl(std::string_view url,
+                   const HttpClient::Options &options) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~HttpClientImpl() noexcept;
+
+    /**
+     * @brief Отправка запроса через пул подключений цикла обработки событий
+     * текущего потока.
+     *
+     * @param call Параметры запроса
+     * @param callback Функция обратного вызова с результатом
+     */
+    void Send(HttpClient::Call &&call,
+              HttpClient::Callback &&callback) const noexcept;
+
+    HttpClientImpl(const HttpClientImpl &) = delete;
+    HttpClientImpl(HttpClientImpl &&) = delete;
+    HttpClientImpl &operator=(const HttpClientImpl &) = delete;
+    HttpClientImpl &operator=(HttpClientImpl &&) = delete;
+
+private:
+    /**
+     * @brief Параметры сервиса. Пустой указатель - адрес не разобран.
+     */
+    std::shared_ptr<const Upstream> upstream_;
+};
+
+}  // namespace tasp
+
+#endif  // TASP_HTTP_CLIENT_IMPL_HPP_
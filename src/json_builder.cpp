@@ -0,0 +1,260 @@
+#include "tasp/json_builder.hpp"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+#include <tasp/logging.hpp>
+
+#include "http/json_writer.hpp"
+#include "http/response_impl.hpp"
+
+using std::string_view;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    JsonBuilder
+------------------------------------------------------------------------------*/
+JsonBuilder::JsonBuilder(http::Response &response) noexcept
+{
+    auto *impl{dynamic_cast<http::ResponseImpl *>(&response)};
+    if (impl == nullptr)
+    {
+        Logging::Error("Формирование JSON недоступно для данного ответа");
+        return;
+    }
+
+    buffer_ = impl->BodyBuffer(http::JsonWriter::type);
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder::~JsonBuilder() noexcept = default;
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::BeginObject() noexcept
+{
+    Separate();
+    Append("{");
+    not_empty_.push_back(false);
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::EndObject() noexcept
+{
+    Append("}");
+    if (!not_empty_.empty())
+    {
+        not_empty_.pop_back();
+    }
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::BeginArray() noexcept
+{
+    Separate();
+    Append("[");
+    not_empty_.push_back(false);
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::EndArray() noexcept
+{
+    Append("]");
+    if (!not_empty_.empty())
+    {
+        not_empty_.pop_back();
+    }
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::Key(string_view key) noexcept
+{
+    Separate();
+    AppendString(key);
+    Append(":");
+    after_key_ = true;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::Value(string_view value) noexcept
+{
+    Separate();
+    AppendString(value);
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::Value(const char *value) noexcept
+{
+    if (value == nullptr)
+    {
+        return Null();
+    }
+
+    return Value(string_view{value});
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::Value(bool value) noexcept
+{
+    Separate();
+    Append(value ? "true" : "false");
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::Value(int64_t value) noexcept
+{
+    Separate();
+
+    std::array<char, 24> str{};
+    auto [end, error]{std::to_chars(str.begin(), str.end(), value)};
+    Append({str.data(), static_cast<size_t>(end - str.begin())});
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::Value(uint64_t value) noexcept
+{
+    Separate();
+
+    std::array<char, 24> str{};
+    auto [end, error]{std::to_chars(str.begin(), str.end(), value)};
+    Append({str.data(), static_cast<size_t>(end - str.begin())});
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::Value(int value) noexcept
+{
+    return Value(static_cast<int64_t>(value));
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::Value(double value) noexcept
+{
+    if (!std::isfinite(value))
+    {
+        return Null();
+    }
+
+    Separate();
+
+    std::array<char, 32> str{};
+    const int length{std::snprintf(str.data(), str.size(), "%.17g", value)};
+    Append({str.data(), static_cast<size_t>(length)});
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::Value(const Json::Value &value) noexcept
+{
+    Separate();
+    if (buffer_ != nullptr)
+    {
+        http::JsonWriter::Write(value, buffer_);
+    }
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::Raw(string_view json) noexcept
+{
+    Separate();
+    Append(json);
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+JsonBuilder &JsonBuilder::Null() noexcept
+{
+    Separate();
+    Append("null");
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+void JsonBuilder::Separate() noexcept
+{
+    if (after_key_)
+    {
+        after_key_ = false;
+        return;
+    }
+
+    if (not_empty_.empty())
+    {
+        return;
+    }
+
+    if (not_empty_.back())
+    {
+        Append(",");
+    }
+    not_empty_.back() = true;
+}
+
+//------------------------------------------------------------------------------
+void JsonBuilder::Append(string_view data) noexcept
+{
+    if (buffer_ != nullptr)
+    {
+        evbuffer_add(buffer_, data.data(), data.length());
+    }
+}
+
+//------------------------------------------------------------------------------
+void JsonBuilder::AppendString(string_view str) noexcept
+{
+    static constexpr string_view digits{"0123456789abcdef"};
+
+    Append("\"");
+
+    size_t begin{0};
+    for (size_t i = 0; i < str.length(); i++)
+    {
+        const auto ch{static_cast<unsigned char>(str[i])};
+        if (ch >= 0x20 && ch != '"' && ch != '\\')
+        {
+            continue;
+        }
+
+        Append(str.substr(begin, i - begin));
+        begin = i + 1;
+
+        switch (ch)
+        {
+            case '"':
+                Append("\\\"");
+                break;
+            case '\\':
+                Append("\\\\");
+                break;
+            case '\n':
+                Append("\\n");
+                break;
+            case '\r':
+                Append("\\r");
+                break;
+            case '\t':
+                Append("\\t");
+                break;
+            default:
+                const std::array<char, 6> escaped{
+                    {'\\', 'u', '0', '0', digits[ch >> 4U], digits[ch & 0xFU]}};
+                Append({escaped.data(), escaped.size()});
+        }
+    }
+
+    Append(str.substr(begin));
+    Append("\"");
+}
+
+}  // namespace tasp
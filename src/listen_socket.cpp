@@ -0,0 +1,136 @@
+#include "listen_socket.hpp"
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <tasp/logging.hpp>
+
+using std::string;
+using std::string_view;
+
+namespace tasp::ev
+{
+
+//------------------------------------------------------------------------------
+int ListenTcp(string_view address, uint16_t port) noexcept
+{
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    const string host{address};
+    const string service{std::to_string(port)};
+    const bool any{host.empty() || host == "*"};
+
+    addrinfo *info{nullptr};
+    const int res{getaddrinfo(
+        any ? nullptr : host.c_str(), service.c_str(), &hints, &info)};
+    if (res != 0)
+    {
+        Logging::Error(
+            "Ошибка разбора адреса {}: {}", address, gai_strerror(res));
+        return -1;
+    }
+
+    int fd{-1};
+    for (const addrinfo *addr = info; addr != nullptr; addr = addr->ai_next)
+    {
+        fd = socket(addr->ai_family,
+                    addr->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                    0);
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        const int on{1};
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+        if (bind(fd, addr->ai_addr, addr->ai_addrlen) == 0 &&
+            listen(fd, SOMAXCONN) == 0)
+        {
+            break;
+        }
+
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(info);
+
+    if (fd < 0)
+    {
+        Logging::Error("Ошибка привязки адреса {}:{}: {}",
+                       address,
+                       port,
+                       std::strerror(errno));
+    }
+    return fd;
+}
+
+//------------------------------------------------------------------------------
+int ListenUnix(string_view path, mode_t mode) noexcept
+{
+    sockaddr_un addr{};
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+    {
+        Logging::Error("Недопустимый путь к сокету Unix: {}", path);
+        return -1;
+    }
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(&addr.sun_path[0], path.data(), path.size());
+
+    const string file{path};
+
+    // файл, оставшийся от предыдущего запуска, не даст выполнить привязку
+    unlink(file.c_str());
+
+    const int fd{
+        socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (fd < 0 ||
+        bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        listen(fd, SOMAXCONN) != 0)
+    {
+        Logging::Error("Ошибка привязки сокета Unix {}: {}",
+                       path,
+                       std::strerror(errno));
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+
+    if (chmod(file.c_str(), mode) != 0)
+    {
+        Logging::Warning("Ошибка установки прав доступа к сокету Unix {}: {}",
+                         path,
+                         std::strerror(errno));
+    }
+
+    return fd;
+}
+
+//------------------------------------------------------------------------------
+int Listen(string_view address, uint16_t port, mode_t mode) noexcept
+{
+    if (address.substr(0, unix_prefix.size()) == unix_prefix)
+    {
+        return ListenUnix(address.substr(unix_prefix.size()), mode);
+    }
+
+    return ListenTcp(address, port);
+}
+
+}  // namespace tasp::ev
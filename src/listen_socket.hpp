@@ -0,0 +1,58 @@
+/**
+ * @file
+ * @brief Создание сокетов для приёма подключений.
+ */
+#ifndef TASP_LISTEN_SOCKET_HPP_
+#define TASP_LISTEN_SOCKET_HPP_
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <string_view>
+
+namespace tasp::ev
+{
+
+/**
+ * @brief Префикс адреса сокета Unix.
+ */
+constexpr std::string_view unix_prefix{"unix:"};
+
+/**
+ * @brief Создание неблокирующего сокета TCP для приёма подключений.
+ *
+ * @param address Адрес для прослушивания, "*" или пустая строка - все адреса
+ * @param port Порт
+ *
+ * @return Сокет или -1 при ошибке
+ */
+[[nodiscard]] int ListenTcp(std::string_view address, uint16_t port) noexcept;
+
+/**
+ * @brief Создание неблокирующего сокета Unix для приёма подключений. Файл,
+ * оставшийся от предыдущего запуска, удаляется.
+ *
+ * @param path Путь к файлу сокета
+ * @param mode Права доступа к файлу сокета
+ *
+ * @return Сокет или -1 при ошибке
+ */
+[[nodiscard]] int ListenUnix(std::string_view path, mode_t mode) noexcept;
+
+/**
+ * @brief Создание сокета для приёма подключений по адресу из конфигурации.
+ * Адрес вида unix:/путь задаёт сокет Unix.
+ *
+ * @param address Адрес для прослушивания
+ * @param port Порт
+ * @param mode Права доступа к файлу сокета Unix
+ *
+ * @return Сокет или -1 при ошибке
+ */
+[[nodiscard]] int Listen(std::string_view address,
+                         uint16_t port,
+                         mode_t mode) noexcept;
+
+}  // namespace tasp::ev
+
+#endif  // TASP_LISTEN_SOCKET_HPP_
@@ -0,0 +1,136 @@
+#include "loop_monitor.hpp"
+
+#include <algorithm>
+
+#include <tasp/logging.hpp>
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+
+namespace tasp::ev
+{
+
+namespace
+{
+/**
+ * @brief Порядок доступа к показателям из других потоков.
+ */
+constexpr auto relaxed{std::memory_order_relaxed};
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    LoopMonitor
+------------------------------------------------------------------------------*/
+LoopMonitor::LoopMonitor(size_t id,
+                         event_base *base,
+                         std::chrono::milliseconds probe_interval,
+                         std::chrono::seconds report_interval) noexcept
+: id_(id)
+, probe_interval_(std::max(probe_interval, std::chrono::milliseconds(1)))
+, report_interval_(report_interval)
+, expected_(Clock::now() + probe_interval_)
+, interval_start_(Clock::now())
+{
+    event_.reset(event_new(base, -1, EV_PERSIST, &LoopMonitor::Probe, this));
+
+    const auto usec{duration_cast<microseconds>(probe_interval_).count()};
+    const timeval interval{usec / 1000000, usec % 1000000};
+    event_add(event_.get(), &interval);
+}
+
+//------------------------------------------------------------------------------
+LoopMonitor::~LoopMonitor() noexcept = default;
+
+//------------------------------------------------------------------------------
+void LoopMonitor::AddRequest(Clock::duration busy) noexcept
+{
+    requests_.fetch_add(1, relaxed);
+    busy_.fetch_add(
+        static_cast<uint64_t>(duration_cast<nanoseconds>(busy).count()),
+        relaxed);
+}
+
+//------------------------------------------------------------------------------
+LoopMonitor::Snapshot LoopMonitor::GetSnapshot() const noexcept
+{
+    const double usec_in_msec{1000};
+    const double hundredths{10000};
+
+    Snapshot snapshot;
+    snapshot.id = id_;
+    snapshot.total_requests = requests_.load(relaxed);
+    snapshot.requests = last_requests_.load(relaxed);
+    snapshot.busy = nanoseconds(busy_.load(relaxed));
+    snapshot.utilization =
+        static_cast<double>(last_utilization_.load(relaxed)) / hundredths;
+    snapshot.lag_avg =
+        static_cast<double>(last_lag_avg_.load(relaxed)) / usec_in_msec;
+    snapshot.lag_max =
+        static_cast<double>(last_lag_max_.load(relaxed)) / usec_in_msec;
+    return snapshot;
+}
+
+//------------------------------------------------------------------------------
+void LoopMonitor::Probe(evutil_socket_t, int16_t, void *arg) noexcept
+{
+    auto *monitor{static_cast<LoopMonitor *>(arg)};
+
+    const auto now{Clock::now()};
+
+    const auto lag{std::max(now - monitor->expected_, Clock::duration{0})};
+    const auto lag_usec{
+        static_cast<uint64_t>(duration_cast<microseconds>(lag).count())};
+
+    monitor->lag_sum_ += lag_usec;
+    monitor->lag_max_ = std::max(monitor->lag_max_, lag_usec);
+    monitor->probes_++;
+
+    monitor->expected_ = now + monitor->probe_interval_;
+
+    if (now - monitor->interval_start_ >= monitor->report_interval_)
+    {
+        monitor->Report(now);
+    }
+}
+
+//------------------------------------------------------------------------------
+void LoopMonitor::Report(Clock::time_point now) noexcept
+{
+    const auto busy{busy_.load(relaxed)};
+    const auto requests{requests_.load(relaxed)};
+
+    const auto wall{static_cast<uint64_t>(
+        duration_cast<nanoseconds>(now - interval_start_).count())};
+
+    const uint64_t hundredths{10000};
+    const auto utilization{
+        wall == 0 ? 0 : std::min((busy - interval_busy_) * hundredths / wall,
+                                 hundredths)};
+    const auto lag_avg{probes_ == 0 ? 0 : lag_sum_ / probes_};
+
+    last_requests_.store(requests - interval_requests_, relaxed);
+    last_utilization_.store(utilization, relaxed);
+    last_lag_avg_.store(lag_avg, relaxed);
+    last_lag_max_.store(lag_max_, relaxed);
+
+    const auto snapshot{GetSnapshot()};
+    Logging::Info(
+        "Цикл обработки событий {}: запросов {}, загрузка {:.1f}%, задержка "
+        "планирования средняя {:.3f} мс, максимальная {:.3f} мс",
+        snapshot.id,
+        snapshot.requests,
+        snapshot.utilization * 100,
+        snapshot.lag_avg,
+        snapshot.lag_max);
+
+    interval_start_ = now;
+    interval_busy_ = busy;
+    interval_requests_ = requests;
+    lag_sum_ = 0;
+    lag_max_ = 0;
+    probes_ = 0;
+}
+
+}  // namespace tasp::ev
@@ -0,0 +1,220 @@
+/**
+ * @file
+ * @brief Контроль загрузки цикла обработки событий.
+ */
+#ifndef TASP_LOOP_MONITOR_HPP_
+#define TASP_LOOP_MONITOR_HPP_
+
+#include <event2/event.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace tasp::ev
+{
+
+/**
+ * @brief Контроль загрузки цикла обработки событий.
+ *
+ * Периодический таймер сравнивает ожидаемое и фактическое время срабатывания,
+ * что даёт задержку планирования цикла. Время обработки запросов
+ * накапливается при каждом запросе, остальное время цикл считается
+ * простаивающим. Итоги каждого интервала отчёта выводятся в журнал и доступны
+ * через GetSnapshot.
+ */
+class LoopMonitor final
+{
+public:
+    /**
+     * @brief Тип часов для измерения времени.
+     */
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Показатели цикла за последний интервал отчёта.
+     */
+    struct Snapshot
+    {
+        /**
+         * @brief Номер цикла.
+         */
+        size_t id{0};
+
+        /**
+         * @brief Общее количество обработанных запросов.
+         */
+        uint64_t total_requests{0};
+
+        /**
+         * @brief Количество запросов за интервал.
+         */
+        uint64_t requests{0};
+
+        /**
+         * @brief Общее время обработки запросов.
+         */
+        std::chrono::nanoseconds busy{0};
+
+        /**
+         * @brief Доля времени, проведённого в обработчиках, от 0 до 1.
+         */
+        double utilization{0};
+
+        /**
+         * @brief Средняя задержка планирования в миллисекундах.
+         */
+        double lag_avg{0};
+
+        /**
+         * @brief Максимальная задержка планирования в миллисекундах.
+         */
+        double lag_max{0};
+
+        /**
+         * @brief Количество зависаний обработчиков.
+         */
+        uint64_t stalls{0};
+    };
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param id Номер цикла
+     * @param base Цикл обработки событий
+     * @param probe_interval Период проверки задержки планирования
+     * @param report_interval Интервал отчёта
+     */
+    LoopMonitor(size_t id,
+                event_base *base,
+                std::chrono::milliseconds probe_interval,
+                std::chrono::seconds report_interval) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~LoopMonitor() noexcept;
+
+    /**
+     * @brief Учёт обработанного запроса. Вызывается из потока цикла.
+     *
+     * @param busy Время обработки запроса
+     */
+    void AddRequest(Clock::duration busy) noexcept;
+
+    /**
+     * @brief Запрос показателей цикла. Может вызываться из любого потока.
+     *
+     * @return Показатели
+     */
+    [[nodiscard]] Snapshot GetSnapshot() const noexcept;
+
+    LoopMonitor(const LoopMonitor &) = delete;
+    LoopMonitor(LoopMonitor &&) = delete;
+    LoopMonitor &operator=(const LoopMonitor &) = delete;
+    LoopMonitor &operator=(LoopMonitor &&) = delete;
+
+private:
+    /**
+     * @brief Обработчик срабатывания таймера.
+     *
+     * @param arg Указатель на объект контроля
+     */
+    static void Probe(evutil_socket_t, int16_t, void *arg) noexcept;
+
+    /**
+     * @brief Подведение итогов интервала отчёта.
+     *
+     * @param now Текущее время
+     */
+    void Report(Clock::time_point now) noexcept;
+
+    /**
+     * @brief Номер цикла.
+     */
+    size_t id_;
+
+    /**
+     * @brief Период проверки задержки планирования.
+     */
+    Clock::duration probe_interval_;
+
+    /**
+     * @brief Интервал отчёта.
+     */
+    Clock::duration report_interval_;
+
+    /**
+     * @brief Событие таймера.
+     */
+    std::unique_ptr<event, decltype(&event_free)> event_{nullptr, event_free};
+
+    /**
+     * @brief Ожидаемое время следующего срабатывания таймера.
+     */
+    Clock::time_point expected_;
+
+    /**
+     * @brief Начало текущего интервала отчёта.
+     */
+    Clock::time_point interval_start_;
+
+    /**
+     * @brief Значение busy_ на начало интервала отчёта.
+     */
+    uint64_t interval_busy_{0};
+
+    /**
+     * @brief Значение requests_ на начало интервала отчёта.
+     */
+    uint64_t interval_requests_{0};
+
+    /**
+     * @brief Суммарная задержка планирования за интервал в микросекундах.
+     */
+    uint64_t lag_sum_{0};
+
+    /**
+     * @brief Максимальная задержка планирования за интервал в микросекундах.
+     */
+    uint64_t lag_max_{0};
+
+    /**
+     * @brief Количество проверок за интервал.
+     */
+    uint64_t probes_{0};
+
+    /**
+     * @brief Общее количество запросов.
+     */
+    std::atomic<uint64_t> requests_{0};
+
+    /**
+     * @brief Общее время обработки запросов в наносекундах.
+     */
+    std::atomic<uint64_t> busy_{0};
+
+    /**
+     * @brief Количество запросов за последний интервал.
+     */
+    std::atomic<uint64_t> last_requests_{0};
+
+    /**
+     * @brief Загрузка за последний интервал в сотых долях процента.
+     */
+    std::atomic<uint64_t> last_utilization_{0};
+
+    /**
+     * @brief Средняя задержка за последний интервал в микросекундах.
+     */
+    std::atomic<uint64_t> last_lag_avg_{0};
+
+    /**
+     * @brief Максимальная задержка за последний интервал в микросекундах.
+     */
+    std::atomic<uint64_t> last_lag_max_{0};
+};
+
+}  // namespace tasp::ev
+
+#endif  // TASP_LOOP_MONITOR_HPP_
@@ -32,6 +32,32 @@ void MicroService::AddHandler(http::Request::Method method,
     impl_->AddHandler(method, path, func);
 }
 
+//------------------------------------------------------------------------------
+void MicroService::AddHandler(http::Request::Method method,
+                              string_view path,
+                              const Handler &func,
+                              const HandlerOptions &options) const noexcept
+{
+    impl_->AddHandler(method, path, func, options);
+}
+
+//------------------------------------------------------------------------------
+void MicroService::AddHandler(http::Request::Method method,
+                              string_view path,
+                              HandlerRef func,
+                              const HandlerOptions &options) const noexcept
+{
+    impl_->AddHandler(method, path, func, options);
+}
+
+//------------------------------------------------------------------------------
+EventStream MicroService::AddEventStream(
+    string_view path,
+    const EventStreamOptions &options) const noexcept
+{
+    return impl_->AddEventStream(path, options);
+}
+
 //------------------------------------------------------------------------------
 void MicroService::AddCheckFunctions(
     const std::vector<CheckFunction> &check_functions) noexcept
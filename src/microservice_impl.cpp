@@ -1,7 +1,10 @@
 #include "microservice_impl.hpp"
 
+#include <signal.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <experimental/filesystem>
 #include <iterator>
@@ -9,12 +12,38 @@
 #include <tasp/arguments.hpp>
 #include <tasp/logging.hpp>
 
+#include "event_stream_impl.hpp"
+#include "http/compression.hpp"
+#include "http/json_reader.hpp"
+#include "http/memory_budget.hpp"
+#include "http/request_impl.hpp"
+#include "http/response_impl.hpp"
+#include "http/trace.hpp"
+#include "listen_socket.hpp"
+#include "resources.hpp"
+
 using std::string;
 using std::string_view;
 using std::vector;
 
 using namespace std::string_literals;
 
+namespace
+{
+/**
+ * @brief Метод HEAD.
+ */
+constexpr auto head_method{static_cast<tasp::http::Request::Method>(
+    EVHTTP_REQ_HEAD)};
+
+/**
+ * @brief Метод OPTIONS.
+ */
+constexpr auto options_method{static_cast<tasp::http::Request::Method>(
+    EVHTTP_REQ_OPTIONS)};
+
+}  // namespace
+
 namespace tasp
 {
 /*------------------------------------------------------------------------------
@@ -27,7 +56,31 @@ MicroServiceImpl::MicroServiceImpl(int argc, const char **argv) noexcept
 }
 
 //------------------------------------------------------------------------------
-MicroServiceImpl::~MicroServiceImpl() noexcept = default;
+MicroServiceImpl::~MicroServiceImpl() noexcept
+{
+    workers_.reset();
+    CloseListenSocket();
+}
+
+//------------------------------------------------------------------------------
+int MicroServiceImpl::Exec() noexcept
+{
+    running_ = true;
+    if (workers_ != nullptr)
+    {
+        workers_->Start();
+    }
+
+    const int res{Daemon::Exec()};
+
+    running_ = false;
+    if (workers_ != nullptr)
+    {
+        workers_->Stop();
+    }
+
+    return res;
+}
 
 //------------------------------------------------------------------------------
 void MicroServiceImpl::Reload() noexcept
@@ -39,27 +92,274 @@ void MicroServiceImpl::Reload() noexcept
     const string address = config.Get("service.address", "*"s);
     auto port = config.Get<uint16_t>("service.port", 5555);
     auto pool_size = config.Get<size_t>("service.pool_size", 10);
+    auto workers = config.Get<size_t>("service.workers", 0);
+
+    // auto или 0 - по количеству доступных процессоров
+    if (pool_size == 0 || config.Get("service.pool_size", ""s) == "auto")
+    {
+        pool_size = ev::AvailableCpus();
+    }
+
+    ev::PoolScaler::Settings scaler;
+    scaler.enabled = config.Get("service.pool.adaptive", scaler.enabled);
+    scaler.min_size = config.Get("service.pool.min_size", scaler.min_size);
+    scaler.max_size = config.Get<size_t>("service.pool.max_size", 0);
+    if (scaler.max_size == 0)
+    {
+        scaler.max_size = ev::AvailableCpus();
+    }
+    scaler.max_size = std::max(scaler.max_size, scaler.min_size);
+    scaler.interval = std::chrono::seconds(
+        config.Get("service.pool.interval", scaler.interval.count()));
+    scaler.scale_up = config.Get("service.pool.scale_up", scaler.scale_up);
+    scaler.scale_down =
+        config.Get("service.pool.scale_down", scaler.scale_down);
 
-    Logging::Info("Параметры HTTP-сервера {}:{}", address, port);
+    if (scaler.enabled)
+    {
+        pool_size = std::clamp(pool_size, scaler.min_size, scaler.max_size);
+    }
+
+    Logging::Info("Параметры HTTP-сервера {}:{}, циклов обработки событий {}",
+                  address,
+                  port,
+                  pool_size);
+
+    scaler_.reset();
+
+    // все циклы завершаются одновременно, а не по очереди в деструкторах
+    for (const auto &connection : pool_)
+    {
+        connection->Stop();
+    }
+    for (const auto &server : uring_pool_)
+    {
+        server->Stop();
+    }
 
     pool_.clear();
+
+    workers_.reset();
+    CloseListenSocket();
+
+    // дополнительные серверы удаляются до главного, владеющего сокетом
+    while (!uring_pool_.empty())
+    {
+        uring_pool_.pop_back();
+    }
     handlers_.clear();
+    routes_.clear();
+
+    // в режиме рабочих процессов потоки создаются только в рабочих
+    // процессах, так как fork переносит в дочерний процесс один поток
+    watchdog_threshold_ = std::chrono::milliseconds(
+        config.Get<int64_t>("service.watchdog.threshold", 1000));
 
-    auto func = [this](auto &&request, auto &&response)
+    watchdog_.reset();
+    if (watchdog_threshold_.count() > 0 && workers == 0)
     {
-        Request(std::forward<decltype(request)>(request),
-                std::forward<decltype(response)>(response));
-    };
+        watchdog_ = std::make_unique<ev::Watchdog>(watchdog_threshold_);
+    }
+
+    tracing_ = http::Trace::Settings{};
+    tracing_.enabled =
+        config.Get("service.tracing.enabled", tracing_.enabled);
+    tracing_.file = config.Get("service.tracing.file", tracing_.file);
+    tracing_.batch_size =
+        config.Get("service.tracing.batch_size", tracing_.batch_size);
+    tracing_.flush_interval = std::chrono::milliseconds(
+        config.Get("service.tracing.flush_interval",
+                   tracing_.flush_interval.count()));
+    http::Trace::Configure(workers == 0 ? tracing_ : http::Trace::Settings{});
+
+    http::Compression::Settings compression;
+    compression.enabled =
+        config.Get("service.compression.enabled", compression.enabled);
+    compression.min_size =
+        config.Get("service.compression.min_size", compression.min_size);
+    compression.level =
+        config.Get("service.compression.level", compression.level);
+    http::Compression::Configure(compression);
+
+    http::JsonReader::Settings reader;
+    reader.max_size =
+        config.Get("service.request.max_body_size", reader.max_size);
+    reader.max_depth =
+        config.Get("service.request.max_depth", reader.max_depth);
+    http::JsonReader::Configure(reader);
+
+    // в режиме рабочих процессов бюджет делится между процессами
+    http::MemoryBudget::Settings memory;
+    memory.enabled = config.Get("service.memory.enabled", memory.enabled);
+    memory.limit = config.Get<size_t>("service.memory.limit", 0);
+    if (memory.limit == 0)
+    {
+        memory.limit = static_cast<size_t>(
+            static_cast<double>(ev::AvailableMemory()) *
+            config.Get("service.memory.fraction", 0.5));
+    }
+    memory.limit /= std::max(workers, static_cast<size_t>(1));
+    http::MemoryBudget::Configure(memory);
+
+    if (memory.enabled)
+    {
+        Logging::Info("Бюджет памяти данных запросов и ответов: {} байт",
+                      memory.limit);
+    }
+
+    ev::ConnectionOptions &options{options_};
+    options = ev::ConnectionOptions{};
+    options.max_body_size = reader.max_size;
+    options.probe_interval = std::chrono::milliseconds(config.Get(
+        "service.loop.probe_interval", options.probe_interval.count()));
+    options.report_interval = std::chrono::seconds(config.Get(
+        "service.loop.report_interval", options.report_interval.count()));
+    options.watchdog = watchdog_.get();
+    options.unix_mode = static_cast<mode_t>(std::strtoul(
+        config.Get("service.socket_mode", "0660"s).c_str(), nullptr, 8));
+
+    auto &client{options.client_limits};
+    client.enabled = config.Get("service.client.enabled", client.enabled);
+    client.idle_timeout = std::chrono::seconds(config.Get(
+        "service.client.idle_timeout", client.idle_timeout.count()));
+    client.header_timeout = std::chrono::seconds(config.Get(
+        "service.client.header_timeout", client.header_timeout.count()));
+    client.body_timeout = std::chrono::seconds(config.Get(
+        "service.client.body_timeout", client.body_timeout.count()));
+    client.min_rate = config.Get("service.client.min_rate", client.min_rate);
+    client.rate_interval = std::chrono::seconds(config.Get(
+        "service.client.rate_interval", client.rate_interval.count()));
+    client.output_high_watermark =
+        config.Get("service.client.output_high_watermark",
+                   client.output_high_watermark);
+
+    auto &http2{options.http2};
+    http2.enabled = config.Get("service.http2.enabled", http2.enabled);
+    http2.max_streams =
+        config.Get("service.http2.max_streams", http2.max_streams);
+    http2.stream_window =
+        config.Get("service.http2.stream_window", http2.stream_window);
+    http2.connection_window =
+        config.Get("service.http2.connection_window", http2.connection_window);
+    http2.idle_timeout = std::chrono::seconds(config.Get(
+        "service.http2.idle_timeout", http2.idle_timeout.count()));
+
+    // контекст TLS сохраняется, чтобы клиенты возобновляли сессии после
+    // обновления конфигурации
+    http::Tls::Settings tls;
+    tls.enabled = config.Get("service.tls.enabled", tls.enabled);
+    tls.certificate = config.Get("service.tls.certificate", tls.certificate);
+    tls.key = config.Get("service.tls.key", tls.key);
+    tls.session_cache =
+        config.Get("service.tls.session_cache", tls.session_cache);
+    tls.session_timeout = std::chrono::seconds(config.Get(
+        "service.tls.session_timeout", tls.session_timeout.count()));
+    tls.tickets = config.Get("service.tls.tickets", tls.tickets);
+    tls.ktls = config.Get("service.tls.ktls", tls.ktls);
+    tls.http2 = http2.enabled;
+
+    // адрес, настроенный на TLS, без сертификата не прослушивается, чтобы
+    // не принимать подключения без шифрования
+    bool listen{true};
+    if (!tls.enabled)
+    {
+        tls_.reset();
+    }
+    else
+    {
+        // при обновлении конфигурации контекст уже содержит сертификат,
+        // загруженный ранее
+        const bool loaded{tls_ != nullptr};
+        if (!loaded)
+        {
+            tls_ = std::make_unique<http::Tls>();
+        }
+
+        if (tls_->Load(tls) || loaded)
+        {
+            options.tls = tls_.get();
+        }
+        else
+        {
+            Logging::Error("Сертификат TLS не загружен, HTTP-сервер {}:{} не "
+                           "запущен",
+                           address,
+                           port);
+            tls_.reset();
+            listen = false;
+        }
+    }
 
-    pool_.reserve(pool_size);
+    cors_max_age_ = config.Get("service.cors.max_age", cors_max_age_);
 
-    auto &primary{pool_.emplace_back(address, port, func)};
+    ev::Batch::Settings batch;
+    batch.enabled = config.Get("service.batch.enabled", batch.enabled);
+    batch.max_requests =
+        config.Get("service.batch.max_requests", batch.max_requests);
+    batch.parallel = config.Get("service.batch.parallel", batch.parallel);
 
-    evutil_socket_t socket{primary.GetSocket()};
+    const auto func{ev::Dispatcher::Bind<&MicroServiceImpl::Request>(this)};
 
-    for (size_t i = 0; i < pool_size - 1; i++)
+    if (!listen)
+    {
+        // сервер запускается при обновлении конфигурации с сертификатом
+    }
+    else if (workers > 0)
+    {
+        Logging::Info("Количество рабочих процессов: {}", workers);
+
+        listen_address_ = address;
+        listen_socket_ = ev::Listen(address, port, options.unix_mode);
+        workers_ = std::make_unique<ev::WorkerPool>(
+            workers,
+            ev::WorkerPool::Runner::Bind<&MicroServiceImpl::RunWorker>(this));
+    }
+    else if (UseUring(config.Get("service.backend", "libevent"s),
+                      address,
+                      options.tls != nullptr,
+                      http2.enabled))
+    {
+        auto &primary{uring_pool_.emplace_back(
+            std::make_unique<uring::Server>(address, port, options, func))};
+
+        const int socket{primary->GetSocket()};
+
+        for (size_t i = 0; i < pool_size - 1; i++)
+        {
+            uring_pool_.push_back(
+                std::make_unique<uring::Server>(socket, options, func));
+        }
+    }
+    else
     {
-        pool_.emplace_back(socket, func);
+        pool_.reserve(pool_size);
+
+        auto &primary{pool_.emplace_back(std::make_unique<ev::Connection>(
+            address, port, options, func))};
+
+        evutil_socket_t socket{primary->GetSocket()};
+
+        for (size_t i = 0; i < pool_size - 1; i++)
+        {
+            options.id = pool_.size();
+            pool_.push_back(
+                std::make_unique<ev::Connection>(socket, options, func));
+        }
+
+        if (scaler.enabled && scaler.min_size < scaler.max_size)
+        {
+            Logging::Info("Количество циклов обработки событий изменяется "
+                          "по загрузке от {} до {}",
+                          scaler.min_size,
+                          scaler.max_size);
+
+            scaler_ = std::make_unique<ev::PoolScaler>(
+                scaler,
+                pool_size,
+                ev::PoolScaler::Busy::Bind<&MicroServiceImpl::PoolBusy>(this),
+                ev::PoolScaler::Resize::Bind<&MicroServiceImpl::ResizePool>(
+                    this));
+        }
     }
 
     handlers_.reserve(10);
@@ -67,12 +367,300 @@ void MicroServiceImpl::Reload() noexcept
     check_functions_.clear();
     AddDefaultCheckFunctions();
     AddHealthHandler();
+    AddLoopsHandler();
+    AddMemoryHandler();
+    AddTlsHandler();
+    AddBatchHandler(batch);
+
+    // при обновлении конфигурации во время работы процессы порождаются
+    // заново после регистрации обработчиков
+    if (workers_ != nullptr && running_)
+    {
+        workers_->Start();
+    }
+}
+
+//------------------------------------------------------------------------------
+void MicroServiceImpl::RunWorker(size_t index) noexcept
+{
+    // сигналы завершения принимаются sigwait, потоки наследуют маску
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    if (watchdog_threshold_.count() > 0)
+    {
+        watchdog_ = std::make_unique<ev::Watchdog>(watchdog_threshold_);
+    }
+
+    StartBatch();
+
+    // каждый процесс выгружает трассировку в собственный файл
+    http::Trace::Settings tracing{tracing_};
+    tracing.file += "." + std::to_string(index);
+    http::Trace::Configure(tracing);
+
+    options_.watchdog = watchdog_.get();
+    options_.id = index;
+
+    pool_.reserve(1);
+    pool_.push_back(std::make_unique<ev::Connection>(
+        listen_socket_,
+        options_,
+        ev::Dispatcher::Bind<&MicroServiceImpl::WorkerRequest>(this)));
+
+    // SIGHUP обрабатывается родительским процессом
+    int signal{0};
+    do
+    {
+        sigwait(&signals, &signal);
+    } while (signal == SIGHUP);
+
+    pool_.front()->Stop();
+    pool_.clear();
+    batch_.reset();
+    watchdog_.reset();
+    http::Trace::Configure(http::Trace::Settings{});
+}
+
+//------------------------------------------------------------------------------
+std::chrono::nanoseconds MicroServiceImpl::PoolBusy() noexcept
+{
+    const std::lock_guard lock(pool_mutex_);
+
+    // приостановленные циклы обслуживают принятые подключения, но не
+    // участвуют в распределении новых
+    std::chrono::nanoseconds busy{0};
+    for (const auto &connection : pool_)
+    {
+        if (connection->Accepting())
+        {
+            busy += connection->GetLoopSnapshot().busy;
+        }
+    }
+    return busy;
+}
+
+//------------------------------------------------------------------------------
+void MicroServiceImpl::ResizePool(size_t active) noexcept
+{
+    const std::lock_guard lock(pool_mutex_);
+
+    // приостановленные циклы продолжают обслуживать принятые подключения
+    for (size_t i = 0; i < pool_.size(); i++)
+    {
+        pool_[i]->SetAccepting(i < active);
+    }
+
+    // лишние циклы удаляются с конца пула после обслуживания принятых
+    // подключений
+    while (pool_.size() > std::max(active, static_cast<size_t>(1)) &&
+           !pool_.back()->Accepting() && pool_.back()->Drained())
+    {
+        Logging::Info("Цикл обработки событий {} завершён после обслуживания "
+                      "принятых подключений",
+                      pool_.size() - 1);
+        pool_.pop_back();
+    }
+
+    if (pool_.empty())
+    {
+        return;
+    }
+
+    const evutil_socket_t socket{pool_.front()->GetSocket()};
+    const auto func{ev::Dispatcher::Bind<&MicroServiceImpl::Request>(this)};
+
+    ev::ConnectionOptions options{options_};
+    while (pool_.size() < active)
+    {
+        options.id = pool_.size();
+        pool_.push_back(
+            std::make_unique<ev::Connection>(socket, options, func));
+    }
+}
+
+//------------------------------------------------------------------------------
+void MicroServiceImpl::WorkerRequest(http::RequestImpl &request,
+                                     http::ResponseImpl &response) noexcept
+{
+    Request(request, response);
+
+    auto *stats{ev::WorkerPool::Current()};
+    stats->total_requests.fetch_add(1, std::memory_order_relaxed);
+    if (static_cast<int>(response.GetCode()) >= HTTP_INTERNAL)
+    {
+        stats->errors.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const auto snapshot{pool_.front()->GetLoopSnapshot()};
+    stats->requests.store(snapshot.requests, std::memory_order_relaxed);
+    stats->utilization.store(snapshot.utilization, std::memory_order_relaxed);
+    stats->lag_avg.store(snapshot.lag_avg, std::memory_order_relaxed);
+    stats->lag_max.store(snapshot.lag_max, std::memory_order_relaxed);
+    stats->stalls.store(snapshot.stalls, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+HealthReport MicroServiceImpl::WorkersCheck() const noexcept
+{
+    size_t alive{0};
+    uint64_t restarts{0};
+    for (size_t i = 0; i < workers_->Size(); i++)
+    {
+        const auto &stats{workers_->Get(i)};
+        if (stats.pid.load() > 0)
+        {
+            alive++;
+        }
+        restarts += stats.restarts.load();
+    }
+
+    // процесс, завершившийся с ошибкой, перезапускается процессом надзора
+    const auto status{alive == workers_->Size()
+                          ? HealthReport::Status::Ok
+                          : HealthReport::Status::Warning};
+
+    return HealthReport{"Рабочие процессы",
+                        status,
+                        "Запущено " + std::to_string(alive) + " из " +
+                            std::to_string(workers_->Size()) +
+                            ", перезапусков: " + std::to_string(restarts)};
+}
+
+//------------------------------------------------------------------------------
+HealthReport MicroServiceImpl::MemoryCheck() noexcept
+{
+    const double warning_ratio{0.9};
+
+    const size_t used{http::MemoryBudget::Used()};
+    const size_t limit{http::MemoryBudget::Limit()};
+
+    const auto status{static_cast<double>(used) >=
+                              static_cast<double>(limit) * warning_ratio
+                          ? HealthReport::Status::Warning
+                          : HealthReport::Status::Ok};
+
+    return HealthReport{
+        "Бюджет памяти",
+        status,
+        "Занято " + std::to_string(used) + " из " + std::to_string(limit) +
+            " байт, отклонено запросов: " +
+            std::to_string(http::MemoryBudget::Rejected())};
+}
+
+//------------------------------------------------------------------------------
+void MicroServiceImpl::CloseListenSocket() noexcept
+{
+    if (listen_socket_ < 0)
+    {
+        return;
+    }
+
+    close(listen_socket_);
+    listen_socket_ = -1;
+
+    const string_view address{listen_address_};
+    if (address.substr(0, ev::unix_prefix.size()) == ev::unix_prefix)
+    {
+        unlink(string{address.substr(ev::unix_prefix.size())}.c_str());
+    }
+}
+
+//------------------------------------------------------------------------------
+bool MicroServiceImpl::UseUring(string_view backend,
+                                string_view address,
+                                bool tls,
+                                bool http2) noexcept
+{
+    if (backend != "io_uring")
+    {
+        if (backend != "libevent")
+        {
+            Logging::Warning("Неизвестный тип HTTP-сервера {}, используется "
+                             "libevent",
+                             backend);
+        }
+        return false;
+    }
+
+    if (address.substr(0, 5) == "unix:")
+    {
+        Logging::Warning("HTTP-сервер io_uring не поддерживает сокеты Unix, "
+                         "используется libevent");
+        return false;
+    }
+
+    if (tls)
+    {
+        Logging::Warning("HTTP-сервер io_uring не поддерживает TLS, "
+                         "используется libevent");
+        return false;
+    }
+
+    if (http2)
+    {
+        Logging::Warning("HTTP-сервер io_uring не поддерживает HTTP/2, "
+                         "используется libevent");
+        return false;
+    }
+
+    if (!uring::Server::Supported())
+    {
+        Logging::Warning("io_uring не поддерживается ядром, используется "
+                         "libevent");
+        return false;
+    }
+
+    Logging::Info("Используется HTTP-сервер io_uring");
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void MicroServiceImpl::AddHandler(http::Request::Method method,
+                                  string_view path,
+                                  const Handler &func,
+                                  const HandlerOptions &options) noexcept
+{
+    AddRoute({method, HandlerPath(path), func, options});
 }
 
 //------------------------------------------------------------------------------
 void MicroServiceImpl::AddHandler(http::Request::Method method,
                                   string_view path,
-                                  const Handler &func) noexcept
+                                  HandlerRef func,
+                                  const HandlerOptions &options) noexcept
+{
+    AddRoute({method, HandlerPath(path), func, options});
+}
+
+//------------------------------------------------------------------------------
+EventStream MicroServiceImpl::AddEventStream(
+    string_view path,
+    const EventStreamOptions &options) noexcept
+{
+    auto impl{std::make_shared<EventStreamImpl>(options)};
+
+    AddHandler(http::Request::Method::Get,
+               path,
+               [impl](const http::Request &request, http::Response &response)
+               { impl->Subscribe(request, response); });
+
+    return EventStream(impl);
+}
+
+//------------------------------------------------------------------------------
+void MicroServiceImpl::AddRoute(ev::HandlerImpl &&handler) noexcept
+{
+    routes_[handler.Method()].push_back(handlers_.size());
+    handlers_.push_back(std::move(handler));
+}
+
+//------------------------------------------------------------------------------
+string MicroServiceImpl::HandlerPath(string_view path) const noexcept
 {
     string regex_path{path.data()};
     if (regex_path.back() == '/')
@@ -81,19 +669,163 @@ void MicroServiceImpl::AddHandler(http::Request::Method method,
     };
     regex_path.append("/?");
 
-    handlers_.emplace_back(method, prefix_ + regex_path, func);
+    return prefix_ + regex_path;
 }
 
 //------------------------------------------------------------------------------
 void MicroServiceImpl::AddHealthHandler() noexcept
 {
-    handlers_.emplace_back(
-        http::Request::Method::Get,
-        prefix_ + "/health",
-        [this]([[maybe_unused]] auto &&request, auto &&response)
-        {
-            response.Data()->Set(HealthCheck());
-        });
+    AddRoute({http::Request::Method::Get,
+              prefix_ + "/health",
+              [this]([[maybe_unused]] auto &&request, auto &&response)
+              {
+                  response.Data()->Set(HealthCheck());
+              }});
+}
+
+//------------------------------------------------------------------------------
+void MicroServiceImpl::AddLoopsHandler() noexcept
+{
+    AddRoute(
+        {http::Request::Method::Get,
+         prefix_ + "/metrics/loops",
+         [this]([[maybe_unused]] auto &&request, auto &&response)
+         {
+             Json::Value loops{Json::arrayValue};
+
+             // в режиме рабочих процессов показатели всех процессов
+             // берутся из общей памяти
+             const size_t workers{workers_ != nullptr ? workers_->Size() : 0};
+             for (size_t i = 0; i < workers; i++)
+             {
+                 const auto &stats{workers_->Get(i)};
+
+                 Json::Value loop;
+                 loop["id"] = static_cast<Json::UInt64>(i);
+                 loop["pid"] = stats.pid.load();
+                 loop["restarts"] =
+                     static_cast<Json::UInt64>(stats.restarts.load());
+                 loop["total_requests"] =
+                     static_cast<Json::UInt64>(stats.total_requests.load());
+                 loop["errors"] =
+                     static_cast<Json::UInt64>(stats.errors.load());
+                 loop["requests"] =
+                     static_cast<Json::UInt64>(stats.requests.load());
+                 loop["utilization"] = stats.utilization.load();
+                 loop["lag_avg_ms"] = stats.lag_avg.load();
+                 loop["lag_max_ms"] = stats.lag_max.load();
+                 loop["stalls"] =
+                     static_cast<Json::UInt64>(stats.stalls.load());
+                 loops.append(loop);
+             }
+
+             const std::lock_guard lock(pool_mutex_);
+             for (size_t i = 0; workers == 0 && i < pool_.size(); i++)
+             {
+                 const auto snapshot{pool_[i]->GetLoopSnapshot()};
+
+                 Json::Value loop;
+                 loop["id"] = static_cast<Json::UInt64>(snapshot.id);
+                 loop["total_requests"] =
+                     static_cast<Json::UInt64>(snapshot.total_requests);
+                 loop["requests"] =
+                     static_cast<Json::UInt64>(snapshot.requests);
+                 loop["utilization"] = snapshot.utilization;
+                 loop["lag_avg_ms"] = snapshot.lag_avg;
+                 loop["lag_max_ms"] = snapshot.lag_max;
+                 loop["stalls"] = static_cast<Json::UInt64>(snapshot.stalls);
+                 loop["accepting"] = pool_[i]->Accepting();
+                 loop["slow_clients"] =
+                     static_cast<Json::UInt64>(pool_[i]->SlowClients());
+                 loop["http2_streams"] =
+                     static_cast<Json::UInt64>(pool_[i]->Http2Streams());
+                 loops.append(loop);
+             }
+             response.Data()->Set(loops);
+         }});
+}
+
+//------------------------------------------------------------------------------
+void MicroServiceImpl::AddMemoryHandler() noexcept
+{
+    AddRoute({http::Request::Method::Get,
+              prefix_ + "/metrics/memory",
+              []([[maybe_unused]] auto &&request, auto &&response)
+              {
+                  Json::Value memory;
+                  memory["limit"] =
+                      static_cast<Json::UInt64>(http::MemoryBudget::Limit());
+                  memory["used"] =
+                      static_cast<Json::UInt64>(http::MemoryBudget::Used());
+                  memory["rejected"] = static_cast<Json::UInt64>(
+                      http::MemoryBudget::Rejected());
+                  response.Data()->Set(memory);
+              }});
+}
+
+//------------------------------------------------------------------------------
+void MicroServiceImpl::AddTlsHandler() noexcept
+{
+    if (tls_ == nullptr)
+    {
+        return;
+    }
+
+    AddRoute({http::Request::Method::Get,
+              prefix_ + "/metrics/tls",
+              [this]([[maybe_unused]] auto &&request, auto &&response)
+              {
+                  const auto stats{tls_->GetStats()};
+
+                  Json::Value tls;
+                  tls["handshakes"] =
+                      static_cast<Json::UInt64>(stats.handshakes);
+                  tls["resumed"] = static_cast<Json::UInt64>(stats.resumed);
+                  tls["ktls"] = static_cast<Json::UInt64>(stats.ktls);
+                  response.Data()->Set(tls);
+              }});
+}
+
+//------------------------------------------------------------------------------
+void MicroServiceImpl::AddBatchHandler(
+    const ev::Batch::Settings &settings) noexcept
+{
+    batch_settings_ = settings;
+    batch_.reset();
+    if (!settings.enabled)
+    {
+        return;
+    }
+
+    Logging::Info("Пакетная обработка запросов: до {} запросов, потоков {}",
+                  settings.max_requests,
+                  settings.parallel);
+
+    // в режиме рабочих процессов потоки пакетной обработки создаются в
+    // рабочем процессе после его порождения
+    if (workers_ == nullptr)
+    {
+        StartBatch();
+    }
+
+    AddRoute({http::Request::Method::Post,
+              prefix_ + "/batch",
+              [this](auto &&request, auto &&response)
+              { batch_->Exec(request, response); }});
+}
+
+//------------------------------------------------------------------------------
+void MicroServiceImpl::StartBatch() noexcept
+{
+    if (!batch_settings_.enabled)
+    {
+        return;
+    }
+
+    batch_ = std::make_unique<ev::Batch>(
+        batch_settings_,
+        prefix_ + "/batch",
+        ev::Dispatcher::Bind<&MicroServiceImpl::Request>(this));
 }
 
 //------------------------------------------------------------------------------
@@ -111,7 +843,17 @@ Json::Value MicroServiceImpl::HealthCheck() const noexcept
     HealthReport::Status status{HealthReport::Status::Ok};
     Json::Value checks_json;
 
-    for (auto &&check_function : check_functions_)
+    auto checks{check_functions_};
+    if (workers_ != nullptr)
+    {
+        checks.emplace_back([this] { return WorkersCheck(); });
+    }
+    if (http::MemoryBudget::Limit() > 0)
+    {
+        checks.emplace_back([] { return MemoryCheck(); });
+    }
+
+    for (auto &&check_function : checks)
     {
         const HealthReport check_report = check_function();
         checks_json.append(check_report.ToJSON());
@@ -256,20 +998,126 @@ HealthReport MicroServiceImpl::DirectoriesCheck(
 }
 
 //------------------------------------------------------------------------------
-void MicroServiceImpl::Request(const http::Request &request,
-                               http::Response &response) noexcept
+void MicroServiceImpl::Request(http::RequestImpl &request,
+                               http::ResponseImpl &response) noexcept
 {
-    for (auto &handler : handlers_)
+    const auto method{request.GetMethod()};
+
+    ev::HandlerImpl *found{nullptr};
     {
-        if (handler.Method() == request.GetMethod() &&
-            request.Uri()->Match(handler.Path()))
+        const http::Trace::Scope route(http::Trace::Phase::Route);
+
+        found = FindHandler(method, request);
+
+        // запрос HEAD без собственного обработчика обрабатывается
+        // обработчиком GET, тело ответа не передаётся
+        if (found == nullptr && method == head_method)
         {
-            handler.Exec(request, response);
-            return;
+            found = FindHandler(http::Request::Method::Get, request);
         }
     }
 
-    response.SetCode(http::Response::Code::NotFound);
+    if (found != nullptr)
+    {
+        found->Exec(request, response);
+        return;
+    }
+
+    const string allow{AllowedMethods(request)};
+    if (allow.empty())
+    {
+        response.SetCode(http::Response::Code::NotFound);
+        return;
+    }
+
+    response.Header()->Set("Allow", allow);
+
+    if (method == options_method)
+    {
+        // предварительный запрос CORS обрабатывается без вызова обработчиков
+        const auto &headers{response.Header()};
+        headers->Set("Access-Control-Allow-Methods", allow);
+
+        const string &request_headers{
+            request.Header()->Get("Access-Control-Request-Headers")};
+        if (!request_headers.empty())
+        {
+            headers->Set("Access-Control-Allow-Headers", request_headers);
+        }
+
+        headers->Set("Access-Control-Max-Age", std::to_string(cors_max_age_));
+
+        response.SetCode(static_cast<http::Response::Code>(HTTP_NOCONTENT));
+        return;
+    }
+
+    response.SetError(static_cast<http::Response::Code>(HTTP_BADMETHOD),
+                      "Метод запроса не поддерживается для данного пути");
+}
+
+//------------------------------------------------------------------------------
+ev::HandlerImpl *MicroServiceImpl::FindHandler(
+    http::Request::Method method,
+    const http::RequestImpl &request) noexcept
+{
+    const auto route{routes_.find(method)};
+    if (route == routes_.end())
+    {
+        return nullptr;
+    }
+
+    for (const auto index : route->second)
+    {
+        auto &handler{handlers_[index]};
+        if (request.Uri()->Match(handler.Path()))
+        {
+            return &handler;
+        }
+    }
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+string MicroServiceImpl::AllowedMethods(
+    const http::RequestImpl &request) noexcept
+{
+    string allow;
+    bool get{false};
+    bool head{false};
+    bool options{false};
+
+    for (const auto &[method, indexes] : routes_)
+    {
+        if (FindHandler(method, request) == nullptr)
+        {
+            continue;
+        }
+
+        get = get || method == http::Request::Method::Get;
+        head = head || method == head_method;
+        options = options || method == options_method;
+
+        allow.append(allow.empty() ? "" : ", ")
+            .append(http::MethodToString(method));
+    }
+
+    if (allow.empty())
+    {
+        return allow;
+    }
+
+    if (get && !head)
+    {
+        allow.append(", ").append(http::MethodToString(head_method));
+    }
+
+    if (!options)
+    {
+        allow.append(", ").append(http::MethodToString(options_method));
+    }
+
+    return allow;
 }
 
 }  // namespace tasp
@@ -5,6 +5,8 @@
 #ifndef TASP_MICROSERVICE_IMPL_HPP_
 #define TASP_MICROSERVICE_IMPL_HPP_
 
+#include <map>
+#include <mutex>
 #include <string_view>
 #include <vector>
 
@@ -13,7 +15,12 @@
 #include <tasp/health.hpp>
 #include <tasp/microservice.hpp>
 
+#include "batch.hpp"
 #include "connection.hpp"
+#include "http/trace.hpp"
+#include "pool_scaler.hpp"
+#include "uring/server.hpp"
+#include "worker_pool.hpp"
 
 namespace tasp
 {
@@ -43,16 +50,52 @@ public:
      */
     void Reload() noexcept override;
 
+    /**
+     * @brief Запуск микросервиса. При заданном service.workers перед
+     * ожиданием сигналов порождаются рабочие процессы, после получения
+     * сигнала завершения они завершаются.
+     *
+     * @return Код завершения
+     */
+    int Exec() noexcept;
+
     /**
      * @brief Установка обработчика запроса.
      *
      * @param method Метод
      * @param path Путь запроса
      * @param func Обработчик
+     * @param options Параметры обработчика
+     */
+    void AddHandler(http::Request::Method method,
+                    std::string_view path,
+                    const Handler &func,
+                    const HandlerOptions &options = {}) noexcept;
+
+    /**
+     * @brief Установка обработчика запроса в виде невладеющей ссылки.
+     *
+     * @param method Метод
+     * @param path Путь запроса
+     * @param func Обработчик
+     * @param options Параметры обработчика
      */
     void AddHandler(http::Request::Method method,
                     std::string_view path,
-                    const Handler &func) noexcept;
+                    HandlerRef func,
+                    const HandlerOptions &options = {}) noexcept;
+
+    /**
+     * @brief Создание потока событий Server-Sent Events.
+     *
+     * @param path Путь запроса подписки
+     * @param options Параметры потока событий
+     *
+     * @return Поток событий
+     */
+    [[nodiscard]] EventStream AddEventStream(
+        std::string_view path,
+        const EventStreamOptions &options) noexcept;
 
     /**
      * @brief Установка проверок состояния компонентов микросервиса.
@@ -75,8 +118,122 @@ private:
      * @param request Запрос
      * @param response Ответ
      */
-    void Request(const http::Request &request,
-                 http::Response &response) noexcept;
+    void Request(http::RequestImpl &request,
+                 http::ResponseImpl &response) noexcept;
+
+    /**
+     * @brief Обработка запроса в рабочем процессе с записью показателей в
+     * общую память.
+     *
+     * @param request Запрос
+     * @param response Ответ
+     */
+    void WorkerRequest(http::RequestImpl &request,
+                       http::ResponseImpl &response) noexcept;
+
+    /**
+     * @brief Функция рабочего процесса. Обрабатывает запросы в одном цикле
+     * обработки событий до получения сигнала SIGTERM или SIGINT.
+     *
+     * @param index Номер рабочего процесса
+     */
+    void RunWorker(size_t index) noexcept;
+
+    /**
+     * @brief Проверка количества запущенных рабочих процессов.
+     *
+     * @return Отчёт о рабочих процессах
+     */
+    [[nodiscard]] HealthReport WorkersCheck() const noexcept;
+
+    /**
+     * @brief Проверка использования бюджета памяти. Состояние Warning при
+     * занятости бюджета на 90% и более.
+     *
+     * @return Отчёт о бюджете памяти
+     */
+    [[nodiscard]] static HealthReport MemoryCheck() noexcept;
+
+    /**
+     * @brief Запрос суммарного времени обработки запросов циклов обработки
+     * событий, принимающих подключения.
+     *
+     * @return Время обработки запросов
+     */
+    [[nodiscard]] std::chrono::nanoseconds PoolBusy() noexcept;
+
+    /**
+     * @brief Изменение количества циклов, принимающих подключения. Циклы
+     * сверх количества приостанавливают приём подключений и удаляются
+     * после обслуживания принятых, недостающие возобновляют приём или
+     * создаются.
+     *
+     * @param active Количество активных циклов
+     */
+    void ResizePool(size_t active) noexcept;
+
+    /**
+     * @brief Закрытие сокета рабочих процессов.
+     */
+    void CloseListenSocket() noexcept;
+
+    /**
+     * @brief Выбор HTTP-сервера io_uring. При недоступности io_uring
+     * используется HTTP-сервер libevent.
+     *
+     * @param backend Тип HTTP-сервера из конфигурации
+     * @param address Адрес для прослушивания
+     * @param tls Признак использования TLS
+     * @param http2 Признак использования HTTP/2
+     *
+     * @return Признак использования HTTP-сервера io_uring
+     */
+    [[nodiscard]] static bool UseUring(std::string_view backend,
+                                       std::string_view address,
+                                       bool tls,
+                                       bool http2) noexcept;
+
+    /**
+     * @brief Формирование регулярного выражения пути обработчика.
+     *
+     * @param path Путь запроса
+     *
+     * @return Регулярное выражение с префиксом и необязательным завершающим
+     * символом '/'
+     */
+    [[nodiscard]] std::string HandlerPath(std::string_view path) const noexcept;
+
+    /**
+     * @brief Добавление обработчика в список и индекс по методам.
+     *
+     * @param handler Обработчик
+     */
+    void AddRoute(ev::HandlerImpl &&handler) noexcept;
+
+    /**
+     * @brief Поиск обработчика запроса среди обработчиков метода.
+     *
+     * @param method Метод
+     * @param request Запрос
+     *
+     * @return Обработчик или пустой указатель
+     */
+    [[nodiscard]] ev::HandlerImpl *FindHandler(
+        http::Request::Method method,
+        const http::RequestImpl &request) noexcept;
+
+    /**
+     * @brief Формирование списка методов, для которых есть обработчики пути
+     * запроса, для заголовка Allow. HEAD добавляется при наличии GET, OPTIONS
+     * обрабатывается автоматически.
+     *
+     * @param request Запрос
+     *
+     * @return Список методов через запятую. Пустая строка, если путь не
+     * найден.
+     */
+    [[nodiscard]] std::string AllowedMethods(
+        const http::RequestImpl &request) noexcept;
 
     /**
      * @brief Установка обработчика запроса состояния работоспособности
@@ -84,6 +241,38 @@ private:
      */
     void AddHealthHandler() noexcept;
 
+    /**
+     * @brief Установка обработчика запроса показателей циклов обработки
+     * событий (GET /metrics/loops).
+     */
+    void AddLoopsHandler() noexcept;
+
+    /**
+     * @brief Установка обработчика запроса показателей бюджета памяти
+     * (GET /metrics/memory).
+     */
+    void AddMemoryHandler() noexcept;
+
+    /**
+     * @brief Установка обработчика запроса показателей TLS
+     * (GET /metrics/tls), если TLS включён.
+     */
+    void AddTlsHandler() noexcept;
+
+    /**
+     * @brief Установка обработчика пакета запросов (POST /batch), если
+     * пакетная обработка включена.
+     *
+     * @param settings Параметры пакетной обработки
+     */
+    void AddBatchHandler(const ev::Batch::Settings &settings) noexcept;
+
+    /**
+     * @brief Создание пакетной обработки запросов с потоками обработки, если
+     * она включена. Вызывается в процессе, обрабатывающем запросы.
+     */
+    void StartBatch() noexcept;
+
     /**
      * @brief Функция проверки работоспособности
      * микросервиса.
@@ -129,14 +318,102 @@ private:
     std::string prefix_{"/api/v1"};
 
     /**
-     * @brief Список подключений к серверу.
+     * @brief Контроль зависших обработчиков. Объявлен перед списком
+     * подключений, так как должен удаляться после них.
+     */
+    std::unique_ptr<ev::Watchdog> watchdog_;
+
+    /**
+     * @brief Пакетная обработка запросов. Объявлена перед списком
+     * подключений, так как должна удаляться после них.
+     */
+    std::unique_ptr<ev::Batch> batch_;
+
+    /**
+     * @brief Контекст TLS. Объявлен перед списком подключений, так как
+     * должен удаляться после них.
      */
-    std::vector<ev::Connection> pool_;
+    std::unique_ptr<http::Tls> tls_;
+
+    /**
+     * @brief Список подключений к серверу. Подключения хранятся в
+     * динамической памяти, так как цикл обработки событий ссылается на
+     * подключение.
+     */
+    std::vector<std::unique_ptr<ev::Connection>> pool_;
+
+    /**
+     * @brief Синхронизация доступа к списку подключений при изменении
+     * количества циклов.
+     */
+    std::mutex pool_mutex_;
+
+    /**
+     * @brief Изменение количества циклов по загрузке. Объявлено после
+     * списка подключений, так как должно удаляться до них.
+     */
+    std::unique_ptr<ev::PoolScaler> scaler_;
+
+    /**
+     * @brief Список серверов io_uring (service.backend = io_uring).
+     */
+    std::vector<std::unique_ptr<uring::Server>> uring_pool_;
 
     /**
      * @brief Список обработчиков.
      */
     std::vector<ev::HandlerImpl> handlers_;
+
+    /**
+     * @brief Индексы обработчиков в списке, сгруппированные по методам.
+     */
+    std::map<http::Request::Method, std::vector<size_t>> routes_;
+
+    /**
+     * @brief Время кэширования результата предварительного запроса CORS
+     * браузером в секундах (заголовок Access-Control-Max-Age).
+     */
+    int64_t cors_max_age_{86400};
+
+    /**
+     * @brief Параметры подключений.
+     */
+    ev::ConnectionOptions options_;
+
+    /**
+     * @brief Параметры выгрузки этапов обработки запросов.
+     */
+    http::Trace::Settings tracing_;
+
+    /**
+     * @brief Порог контроля зависших обработчиков, 0 - контроль отключён.
+     */
+    std::chrono::milliseconds watchdog_threshold_{0};
+
+    /**
+     * @brief Параметры пакетной обработки запросов (service.batch).
+     */
+    ev::Batch::Settings batch_settings_;
+
+    /**
+     * @brief Рабочие процессы (service.workers).
+     */
+    std::unique_ptr<ev::WorkerPool> workers_;
+
+    /**
+     * @brief Сокет, на котором подключения принимают рабочие процессы.
+     */
+    int listen_socket_{-1};
+
+    /**
+     * @brief Адрес сокета рабочих процессов.
+     */
+    std::string listen_address_;
+
+    /**
+     * @brief Признак выполнения Exec.
+     */
+    bool running_{false};
 };
 
 }  // namespace tasp
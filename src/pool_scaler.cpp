@@ -0,0 +1,129 @@
+#include "pool_scaler.hpp"
+
+#include <signal.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <tasp/logging.hpp>
+
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+
+namespace tasp::ev
+{
+
+/*------------------------------------------------------------------------------
+    PoolScaler
+------------------------------------------------------------------------------*/
+PoolScaler::PoolScaler(const Settings &settings,
+                       size_t active,
+                       Busy busy,
+                       Resize resize) noexcept
+: settings_(settings)
+, active_(active)
+, busy_(busy)
+, resize_(resize)
+{
+    thread_ = std::thread(&PoolScaler::Run, this);
+}
+
+//------------------------------------------------------------------------------
+PoolScaler::~PoolScaler() noexcept
+{
+    {
+        const std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+
+    thread_.join();
+}
+
+//------------------------------------------------------------------------------
+size_t PoolScaler::Decide(const Settings &settings,
+                          size_t active,
+                          double utilization) noexcept
+{
+    const size_t min_size{std::max(settings.min_size, static_cast<size_t>(1))};
+    const size_t max_size{std::max(settings.max_size, min_size)};
+
+    if (utilization > settings.scale_up && active < max_size)
+    {
+        // количество, при котором загрузка опустится до порога увеличения
+        const auto wanted{static_cast<size_t>(std::ceil(
+            static_cast<double>(active) * utilization / settings.scale_up))};
+        return std::min(std::max(wanted, active + 1), max_size);
+    }
+
+    if (utilization < settings.scale_down && active > min_size)
+    {
+        // нагрузка распределяется по оставшимся циклам
+        const double remaining{static_cast<double>(active) * utilization /
+                               static_cast<double>(active - 1)};
+        if (remaining < settings.scale_up)
+        {
+            return active - 1;
+        }
+    }
+
+    return std::clamp(active, min_size, max_size);
+}
+
+//------------------------------------------------------------------------------
+void PoolScaler::Run() noexcept
+{
+    // сигналы процесса обрабатываются основным потоком
+    sigset_t signals;
+    sigfillset(&signals);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    auto last{std::chrono::steady_clock::now()};
+    auto busy{busy_()};
+
+    std::unique_lock lock(mutex_);
+    while (!stop_cv_.wait_for(lock,
+                              settings_.interval,
+                              [this]
+                              {
+                                  return stop_;
+                              }))
+    {
+        const auto now{std::chrono::steady_clock::now()};
+        const auto current{busy_()};
+
+        const auto wall{duration_cast<nanoseconds>(now - last).count()};
+        const double utilization{
+            wall == 0 || active_ == 0 || current < busy
+                ? 0
+                : static_cast<double>((current - busy).count()) /
+                      static_cast<double>(wall) /
+                      static_cast<double>(active_)};
+
+        last = now;
+        busy = current;
+
+        const size_t active{Decide(settings_, active_, utilization)};
+        if (active == active_)
+        {
+            // удаление лишних циклов, завершивших обслуживание подключений
+            resize_(active_);
+            continue;
+        }
+
+        Logging::Info("Загрузка циклов обработки событий {:.1f}%, количество "
+                      "активных циклов изменено с {} на {}",
+                      utilization * 100,
+                      active_,
+                      active);
+
+        active_ = active;
+        resize_(active);
+
+        // время обработки учитывается по новому составу активных циклов
+        last = std::chrono::steady_clock::now();
+        busy = busy_();
+    }
+}
+
+}  // namespace tasp::ev
@@ -0,0 +1,167 @@
+/**
+ * @file
+ * @brief Изменение количества циклов обработки событий по загрузке.
+ */
+#ifndef TASP_POOL_SCALER_HPP_
+#define TASP_POOL_SCALER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <tasp/function_ref.hpp>
+
+namespace tasp::ev
+{
+
+/**
+ * @brief Изменение количества активных циклов обработки событий по загрузке.
+ *
+ * Отдельный поток с заданным интервалом определяет среднюю загрузку активных
+ * циклов: приращение суммарного времени обработки запросов активных
+ * циклов, делённое на интервал и количество активных циклов. После
+ * изменения количества циклов отсчёт приращения начинается заново. При
+ * загрузке выше порога увеличения количество циклов увеличивается
+ * пропорционально загрузке (не менее чем на один), при загрузке ниже порога
+ * уменьшения - уменьшается на один, если после этого загрузка останется ниже
+ * порога увеличения.
+ */
+class PoolScaler final
+{
+public:
+    /**
+     * @brief Параметры изменения количества циклов.
+     */
+    struct Settings
+    {
+        /**
+         * @brief Признак включения.
+         */
+        bool enabled{false};
+
+        /**
+         * @brief Минимальное количество активных циклов.
+         */
+        size_t min_size{1};
+
+        /**
+         * @brief Максимальное количество активных циклов.
+         */
+        size_t max_size{1};
+
+        /**
+         * @brief Интервал оценки загрузки.
+         */
+        std::chrono::seconds interval{10};
+
+        /**
+         * @brief Порог загрузки для увеличения количества циклов, от 0 до 1.
+         */
+        double scale_up{0.75};
+
+        /**
+         * @brief Порог загрузки для уменьшения количества циклов, от 0 до 1.
+         */
+        double scale_down{0.25};
+    };
+
+    /**
+     * @brief Функция запроса суммарного времени обработки запросов активных
+     * циклов.
+     */
+    using Busy = FunctionRef<std::chrono::nanoseconds()>;
+
+    /**
+     * @brief Функция изменения количества активных циклов. Вызывается с
+     * каждым интервалом, в том числе без изменения количества, для удаления
+     * лишних циклов.
+     */
+    using Resize = FunctionRef<void(size_t)>;
+
+    /**
+     * @brief Конструктор. Запускает поток оценки загрузки.
+     *
+     * @param settings Параметры
+     * @param active Начальное количество активных циклов
+     * @param busy Функция запроса времени обработки запросов
+     * @param resize Функция изменения количества циклов
+     */
+    PoolScaler(const Settings &settings,
+               size_t active,
+               Busy busy,
+               Resize resize) noexcept;
+
+    /**
+     * @brief Деструктор. Останавливает поток оценки загрузки.
+     */
+    ~PoolScaler() noexcept;
+
+    /**
+     * @brief Выбор количества активных циклов.
+     *
+     * @param settings Параметры
+     * @param active Текущее количество активных циклов
+     * @param utilization Средняя загрузка активных циклов
+     *
+     * @return Количество активных циклов
+     */
+    [[nodiscard]] static size_t Decide(const Settings &settings,
+                                       size_t active,
+                                       double utilization) noexcept;
+
+    PoolScaler(const PoolScaler &) = delete;
+    PoolScaler(PoolScaler &&) = delete;
+    PoolScaler &operator=(const PoolScaler &) = delete;
+    PoolScaler &operator=(PoolScaler &&) = delete;
+
+private:
+    /**
+     * @brief Функция потока оценки загрузки.
+     */
+    void Run() noexcept;
+
+    /**
+     * @brief Параметры.
+     */
+    Settings settings_;
+
+    /**
+     * @brief Текущее количество активных циклов.
+     */
+    size_t active_;
+
+    /**
+     * @brief Функция запроса времени обработки запросов.
+     */
+    Busy busy_;
+
+    /**
+     * @brief Функция изменения количества циклов.
+     */
+    Resize resize_;
+
+    /**
+     * @brief Синхронизация остановки потока.
+     */
+    std::mutex mutex_;
+
+    /**
+     * @brief Уведомление об остановке потока.
+     */
+    std::condition_variable stop_cv_;
+
+    /**
+     * @brief Признак остановки потока.
+     */
+    bool stop_{false};
+
+    /**
+     * @brief Поток оценки загрузки.
+     */
+    std::thread thread_;
+};
+
+}  // namespace tasp::ev
+
+#endif  // TASP_POOL_SCALER_HPP_
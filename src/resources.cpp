@@ -0,0 +1,240 @@
+#include "resources.hpp"
+
+#include <sched.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace tasp::ev
+{
+
+namespace
+{
+/**
+ * @brief Точка монтирования контрольных групп.
+ */
+constexpr string_view cgroup_root{"/sys/fs/cgroup"};
+
+//------------------------------------------------------------------------------
+string ReadLine(const string &path) noexcept
+{
+    std::ifstream file(path);
+    string line;
+    std::getline(file, line);
+    return line;
+}
+
+//------------------------------------------------------------------------------
+bool HasController(string_view controllers, string_view controller) noexcept
+{
+    while (!controllers.empty())
+    {
+        const auto pos{controllers.find(',')};
+        if (controllers.substr(0, pos) == controller)
+        {
+            return true;
+        }
+        if (pos == string_view::npos)
+        {
+            break;
+        }
+        controllers.remove_prefix(pos + 1);
+    }
+    return false;
+}
+
+/**
+ * @brief Каталоги контрольной группы процесса от собственного до корневого.
+ * Ограничение действует на всех уровнях иерархии, а внутри контейнера
+ * собственный каталог может быть недоступен под путём из /proc/self/cgroup,
+ * поэтому просматриваются все уровни.
+ *
+ * @param controller Контроллер cgroup v1, пустая строка - cgroup v2
+ *
+ * @return Каталоги
+ */
+vector<string> CgroupDirs(string_view controller) noexcept
+{
+    vector<string> dirs;
+
+    std::ifstream file("/proc/self/cgroup");
+    string line;
+    while (std::getline(file, line))
+    {
+        // строка вида номер:контроллеры:путь
+        const auto first{line.find(':')};
+        const auto second{line.find(':', first + 1)};
+        if (first == string::npos || second == string::npos)
+        {
+            continue;
+        }
+
+        const string_view controllers{line.data() + first + 1,
+                                      second - first - 1};
+
+        const bool unified{controller.empty() && controllers.empty()};
+        const bool legacy{!controller.empty() &&
+                          HasController(controllers, controller)};
+        if (!unified && !legacy)
+        {
+            continue;
+        }
+
+        // в cgroup v1 каждый набор контроллеров смонтирован отдельно
+        string mount{cgroup_root};
+        if (legacy)
+        {
+            mount.append("/").append(controllers);
+        }
+
+        string path{line.substr(second + 1)};
+        while (!path.empty())
+        {
+            dirs.push_back(mount + path);
+
+            const auto pos{path.rfind('/')};
+            if (path == "/" || pos == string::npos)
+            {
+                break;
+            }
+            path.resize(pos == 0 ? 1 : pos);
+        }
+        break;
+    }
+
+    return dirs;
+}
+
+/**
+ * @brief Определение квоты процессорного времени контрольной группы.
+ *
+ * @return Квота в процессорах или 0, если квота не задана
+ */
+double CpuQuota() noexcept
+{
+    double quota{0};
+    const auto apply{[&quota](double value)
+                     {
+                         if (value > 0 && (quota <= 0 || value < quota))
+                         {
+                             quota = value;
+                         }
+                     }};
+
+    // cpu.max: "max 100000" или "200000 100000"
+    for (const auto &dir : CgroupDirs({}))
+    {
+        std::istringstream max{ReadLine(dir + "/cpu.max")};
+        string limit;
+        double period{0};
+        if (max >> limit >> period && limit != "max" && period > 0)
+        {
+            apply(std::strtod(limit.c_str(), nullptr) / period);
+        }
+    }
+
+    for (const auto &dir : CgroupDirs("cpu"))
+    {
+        const double limit{
+            std::strtod(ReadLine(dir + "/cpu.cfs_quota_us").c_str(), nullptr)};
+        const double period{std::strtod(
+            ReadLine(dir + "/cpu.cfs_period_us").c_str(), nullptr)};
+        if (limit > 0 && period > 0)
+        {
+            apply(limit / period);
+        }
+    }
+
+    return quota;
+}
+
+/**
+ * @brief Определение ограничения памяти контрольной группы.
+ *
+ * @return Ограничение в байтах или 0, если ограничение не задано
+ */
+size_t MemoryLimit() noexcept
+{
+    size_t limit{0};
+    const auto apply{[&limit](const string &value)
+                     {
+                         // "max" и значения cgroup v1 без ограничения
+                         // (близкие к 2^63) не учитываются
+                         const auto bytes{std::strtoull(value.c_str(),
+                                                        nullptr,
+                                                        10)};
+                         if (bytes > 0 && bytes < (1ULL << 62U) &&
+                             (limit == 0 || bytes < limit))
+                         {
+                             limit = static_cast<size_t>(bytes);
+                         }
+                     }};
+
+    for (const auto &dir : CgroupDirs({}))
+    {
+        apply(ReadLine(dir + "/memory.max"));
+    }
+
+    for (const auto &dir : CgroupDirs("memory"))
+    {
+        apply(ReadLine(dir + "/memory.limit_in_bytes"));
+    }
+
+    return limit;
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+size_t AvailableCpus() noexcept
+{
+    size_t cpus{static_cast<size_t>(
+        std::max(sysconf(_SC_NPROCESSORS_ONLN), static_cast<long>(1)))};
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        cpus = static_cast<size_t>(CPU_COUNT(&set));
+    }
+
+    const double quota{CpuQuota()};
+    if (quota > 0)
+    {
+        cpus = std::min(cpus, static_cast<size_t>(std::ceil(quota)));
+    }
+
+    return std::max(cpus, static_cast<size_t>(1));
+}
+
+//------------------------------------------------------------------------------
+size_t AvailableMemory() noexcept
+{
+    const auto pages{sysconf(_SC_PHYS_PAGES)};
+    const auto page_size{sysconf(_SC_PAGE_SIZE)};
+    size_t memory{pages > 0 && page_size > 0
+                      ? static_cast<size_t>(pages) *
+                            static_cast<size_t>(page_size)
+                      : 0};
+
+    const size_t limit{MemoryLimit()};
+    if (limit > 0 && (memory == 0 || limit < memory))
+    {
+        memory = limit;
+    }
+
+    return memory;
+}
+
+}  // namespace tasp::ev
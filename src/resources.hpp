@@ -0,0 +1,34 @@
+/**
+ * @file
+ * @brief Определение ресурсов, доступных процессу.
+ */
+#ifndef TASP_RESOURCES_HPP_
+#define TASP_RESOURCES_HPP_
+
+#include <cstddef>
+
+namespace tasp::ev
+{
+
+/**
+ * @brief Определение количества процессоров, доступных процессу: меньшее из
+ * количества процессоров маски привязки (sched_getaffinity) и квоты
+ * процессорного времени контрольной группы (cpu.max для cgroup v2,
+ * cpu.cfs_quota_us для cgroup v1), округлённой вверх.
+ *
+ * @return Количество процессоров, не менее 1
+ */
+[[nodiscard]] size_t AvailableCpus() noexcept;
+
+/**
+ * @brief Определение объёма памяти, доступного процессу: меньшее из объёма
+ * физической памяти и ограничения контрольной группы (memory.max для
+ * cgroup v2, memory.limit_in_bytes для cgroup v1).
+ *
+ * @return Объём памяти в байтах
+ */
+[[nodiscard]] size_t AvailableMemory() noexcept;
+
+}  // namespace tasp::ev
+
+#endif  // TASP_RESOURCES_HPP_
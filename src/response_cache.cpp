@@ -0,0 +1,603 @@
+#include "response_cache.hpp"
+
+#include <event2/event.h>
+#include <strings.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "connection.hpp"
+#include "http/binary_format.hpp"
+#include "http/exchange.hpp"
+
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::pair;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+namespace tasp::ev
+{
+/*------------------------------------------------------------------------------
+    ResponseCache::Parking
+------------------------------------------------------------------------------*/
+/**
+ * @brief Запросы цикла обработки событий, ожидающие формирования записей.
+ *
+ * Запрос, сформировавший запись, передаёт её ожидающим запросам через
+ * очередь и пробуждает их цикл через eventfd. Событие пробуждения добавлено
+ * в цикл только пока есть ожидающие запросы, чтобы не удерживать его
+ * завершение.
+ */
+class ResponseCache::Parking final
+{
+public:
+    /**
+     * @brief Конструктор. Вызывается в потоке цикла обработки событий.
+     *
+     * @param base Цикл обработки событий
+     */
+    explicit Parking(event_base *base) noexcept
+    : base_(base)
+    , wake_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    {
+        wake_ = EvEvent(event_new(base,
+                                  wake_fd_,
+                                  EV_READ | EV_PERSIST,
+                                  &Parking::OnWake,
+                                  this),
+                        event_free);
+    }
+
+    /**
+     * @brief Деструктор.
+     */
+    ~Parking() noexcept
+    {
+        Close();
+    }
+
+    /**
+     * @brief Запрос ожидания цикла обработки событий текущего потока.
+     *
+     * @return Ожидание или пустой указатель вне цикла обработки событий
+     */
+    [[nodiscard]] static shared_ptr<Parking> Current() noexcept;
+
+    /**
+     * @brief Запрос цикла обработки событий.
+     *
+     * @return Цикл обработки событий
+     */
+    [[nodiscard]] event_base *Base() const noexcept
+    {
+        return base_;
+    }
+
+    /**
+     * @brief Добавление ожидающего запроса. Вызывается в потоке цикла.
+     *
+     * @param follower Ожидающий запрос
+     */
+    void Add(const shared_ptr<Follower> &follower) noexcept
+    {
+        if (parked_.empty())
+        {
+            event_add(wake_.get(), nullptr);
+        }
+        parked_.push_back(follower);
+    }
+
+    /**
+     * @brief Удаление ожидающего запроса. Вызывается в потоке цикла.
+     *
+     * @param follower Ожидающий запрос
+     */
+    void Remove(const Follower *follower) noexcept
+    {
+        const auto found{std::find_if(parked_.begin(),
+                                      parked_.end(),
+                                      [follower](const auto &item)
+                                      { return item.get() == follower; })};
+        if (found == parked_.end())
+        {
+            return;
+        }
+
+        parked_.erase(found);
+        if (parked_.empty())
+        {
+            event_del(wake_.get());
+        }
+    }
+
+    /**
+     * @brief Передача записи ожидающему запросу. Вызывается из любого
+     * потока.
+     *
+     * @param follower Ожидающий запрос
+     * @param entry Запись, пустой указатель - запись не сформирована
+     */
+    void Push(shared_ptr<Follower> follower,
+              shared_ptr<const Entry> entry) noexcept
+    {
+        const lock_guard lock(mutex_);
+        if (closed_)
+        {
+            return;
+        }
+
+        inbox_.emplace_back(std::move(follower), std::move(entry));
+
+        // цикл пробуждается один раз на пачку записей
+        if (inbox_.size() == 1)
+        {
+            const uint64_t one{1};
+            static_cast<void>(write(wake_fd_, &one, sizeof(one)));
+        }
+    }
+
+    /**
+     * @brief Закрытие при завершении цикла обработки событий: ожидание
+     * запросов прекращается без ответа.
+     */
+    void Close() noexcept;
+
+    Parking(const Parking &) = delete;
+    Parking(Parking &&) = delete;
+    Parking &operator=(const Parking &) = delete;
+    Parking &operator=(Parking &&) = delete;
+
+private:
+    /**
+     * @brief Функция обратного вызова пробуждения цикла.
+     *
+     * @param fd Дескриптор eventfd
+     * @param events Не используется
+     * @param arg Указатель на ожидание
+     */
+    static void OnWake(evutil_socket_t fd,
+                       short /*events*/,
+                       void *arg) noexcept;
+
+    /**
+     * @brief Цикл обработки событий.
+     */
+    event_base *base_;
+
+    /**
+     * @brief Дескриптор пробуждения цикла.
+     */
+    int wake_fd_;
+
+    /**
+     * @brief Событие пробуждения цикла.
+     */
+    EvEvent wake_{nullptr, nullptr};
+
+    /**
+     * @brief Синхронизация доступа к очереди записей.
+     */
+    mutex mutex_;
+
+    /**
+     * @brief Записи для ожидающих запросов.
+     */
+    vector<pair<shared_ptr<Follower>, shared_ptr<const Entry>>> inbox_;
+
+    /**
+     * @brief Признак закрытия.
+     */
+    bool closed_{false};
+
+    /**
+     * @brief Ожидающие запросы. Используется только в потоке цикла.
+     */
+    vector<shared_ptr<Follower>> parked_;
+};
+
+/*------------------------------------------------------------------------------
+    ResponseCache::Follower
+------------------------------------------------------------------------------*/
+/**
+ * @brief Запрос, ожидающий запись, которую формирует другой запрос. Все
+ * методы, кроме Notify, вызываются в потоке цикла обработки событий
+ * запроса.
+ */
+class ResponseCache::Follower final
+: public std::enable_shared_from_this<Follower>
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param parking Ожидание цикла обработки событий запроса
+     * @param exchange Обмен запроса с отложенным ответом
+     * @param invoke Вызов обработчика запроса
+     */
+    Follower(shared_ptr<Parking> parking,
+             shared_ptr<http::Exchange> exchange,
+             Invoke invoke) noexcept
+    : parking_(std::move(parking))
+    , exchange_(std::move(exchange))
+    , invoke_(invoke)
+    {
+    }
+
+    /**
+     * @brief Начало ожидания не дольше wait.
+     *
+     * @param wait Время ожидания
+     */
+    void Park(milliseconds wait) noexcept
+    {
+        timer_ = EvEvent(
+            evtimer_new(parking_->Base(), &Follower::OnTimeout, this),
+            event_free);
+
+        const auto usec{duration_cast<microseconds>(wait).count()};
+        const timeval timeout{usec / 1000000, usec % 1000000};
+        evtimer_add(timer_.get(), &timeout);
+
+        parking_->Add(shared_from_this());
+    }
+
+    /**
+     * @brief Передача записи в поток цикла запроса. Вызывается из любого
+     * потока.
+     *
+     * @param entry Запись, пустой указатель - запись не сформирована
+     */
+    void Notify(shared_ptr<const Entry> entry) noexcept
+    {
+        parking_->Push(shared_from_this(), std::move(entry));
+    }
+
+    /**
+     * @brief Завершение ожидания: отправка ответа из записи или, если
+     * запись не сформирована, вызов обработчика.
+     *
+     * @param entry Запись
+     */
+    void Finish(const shared_ptr<const Entry> &entry) noexcept
+    {
+        const auto self{shared_from_this()};
+        const auto exchange{std::move(exchange_)};
+        if (!exchange)
+        {
+            return;
+        }
+
+        Cancel();
+
+        if (entry)
+        {
+            auto fill{[&entry](http::Response &response)
+                      {
+                          Fill(*entry,
+                               static_cast<http::ResponseImpl &>(response));
+                      }};
+            exchange->Complete(
+                FunctionRef<void(http::Response &)>::Bind(fill));
+            return;
+        }
+
+        if (exchange->Resume())
+        {
+            invoke_(exchange->Request(), exchange->Response());
+            exchange->Dispatched();
+        }
+    }
+
+    /**
+     * @brief Прекращение ожидания без ответа.
+     */
+    void Cancel() noexcept
+    {
+        const auto self{shared_from_this()};
+        timer_.reset(nullptr);
+        exchange_.reset();
+        parking_->Remove(this);
+    }
+
+    Follower(const Follower &) = delete;
+    Follower(Follower &&) = delete;
+    Follower &operator=(const Follower &) = delete;
+    Follower &operator=(Follower &&) = delete;
+
+private:
+    /**
+     * @brief Функция обратного вызова таймера ожидания: обработчик
+     * вызывается без ожидания записи.
+     *
+     * @param fd Не используется
+     * @param events Не используется
+     * @param arg Указатель на ожидающий запрос
+     */
+    static void OnTimeout(evutil_socket_t /*fd*/,
+                          short /*events*/,
+                          void *arg) noexcept
+    {
+        static_cast<Follower *>(arg)->Finish(nullptr);
+    }
+
+    /**
+     * @brief Ожидание цикла обработки событий запроса.
+     */
+    shared_ptr<Parking> parking_;
+
+    /**
+     * @brief Обмен запроса. Пустой указатель - ожидание завершено.
+     */
+    shared_ptr<http::Exchange> exchange_;
+
+    /**
+     * @brief Вызов обработчика запроса.
+     */
+    Invoke invoke_;
+
+    /**
+     * @brief Таймер ожидания.
+     */
+    EvEvent timer_{nullptr, nullptr};
+};
+
+namespace
+{
+/**
+ * @brief Ожидание цикла обработки событий потока. Закрывается после
+ * завершения цикла (ResponseCache::Unbind) или при завершении потока.
+ */
+struct Registry
+{
+    Registry() noexcept = default;
+
+    ~Registry() noexcept
+    {
+        if (parking)
+        {
+            parking->Close();
+        }
+    }
+
+    Registry(const Registry &) = delete;
+    Registry(Registry &&) = delete;
+    Registry &operator=(const Registry &) = delete;
+    Registry &operator=(Registry &&) = delete;
+
+    shared_ptr<ResponseCache::Parking> parking;
+};
+
+thread_local Registry registry;  // NOLINT(cert-err58-cpp)
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+shared_ptr<ResponseCache::Parking> ResponseCache::Parking::Current() noexcept
+{
+    auto *base{Connection::CurrentBase()};
+    if (base == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto &parking{registry.parking};
+    if (!parking || parking->Base() != base)
+    {
+        if (parking)
+        {
+            parking->Close();
+        }
+        parking = make_shared<Parking>(base);
+    }
+
+    return parking;
+}
+
+//------------------------------------------------------------------------------
+void ResponseCache::Parking::Close() noexcept
+{
+    {
+        const lock_guard lock(mutex_);
+        if (closed_)
+        {
+            return;
+        }
+        closed_ = true;
+        inbox_.clear();
+    }
+
+    for (const auto &follower : std::exchange(parked_, {}))
+    {
+        follower->Cancel();
+    }
+
+    wake_.reset(nullptr);
+    close(wake_fd_);
+}
+
+//------------------------------------------------------------------------------
+void ResponseCache::Parking::OnWake(evutil_socket_t fd,
+                                    short /*events*/,
+                                    void *arg) noexcept
+{
+    auto *parking{static_cast<Parking *>(arg)};
+
+    uint64_t value{0};
+    static_cast<void>(read(fd, &value, sizeof(value)));
+
+    decltype(parking->inbox_) ready;
+    {
+        const lock_guard lock(parking->mutex_);
+        std::swap(ready, parking->inbox_);
+    }
+
+    for (const auto &[follower, entry] : ready)
+    {
+        follower->Finish(entry);
+    }
+}
+
+/*------------------------------------------------------------------------------
+    ResponseCache
+------------------------------------------------------------------------------*/
+ResponseCache::ResponseCache(HandlerOptions::Cache options) noexcept
+: options_(std::move(options))
+{
+}
+
+//------------------------------------------------------------------------------
+ResponseCache::~ResponseCache() noexcept = default;
+
+//------------------------------------------------------------------------------
+string ResponseCache::Key(const http::Request &request) const noexcept
+{
+    string key{std::to_string(static_cast<int>(request.GetMethod()))};
+    key.append(" ").append(request.Uri()->Url());
+
+    const auto headers{request.Header()};
+    for (const auto &name : options_.vary)
+    {
+        key.append("\n").append(name).append(":").append(headers->Get(name));
+    }
+
+    // данные ответа кэшируются в выбранном по заголовку Accept формате
+    const auto format{http::BinaryFormat::Negotiate(headers->Get("Accept"))};
+    if (format != http::BinaryFormat::Format::Json)
+    {
+        key.append("\n").append(http::BinaryFormat::Type(format));
+    }
+
+    return key;
+}
+
+//------------------------------------------------------------------------------
+ResponseCache::Lookup ResponseCache::Acquire(const string &key,
+                                             http::Exchange *exchange,
+                                             Invoke invoke) noexcept
+{
+    const lock_guard<mutex> lock(mutex_);
+
+    auto found{index_.find(key)};
+    if (found != index_.end())
+    {
+        auto item{found->second};
+        if (item->expires > Clock::now())
+        {
+            items_.splice(items_.begin(), items_, item);
+            return {item->entry, false, false};
+        }
+
+        Erase(item);
+    }
+
+    auto flight{flights_.find(key)};
+    if (flight == flights_.end())
+    {
+        flights_.emplace(key, vector<shared_ptr<Follower>>{});
+        return {nullptr, true, false};
+    }
+
+    // ответ, который нельзя отложить, формируется обработчиком сразу
+    auto parking{exchange != nullptr ? Parking::Current() : nullptr};
+    if (!parking)
+    {
+        return {nullptr, false, false};
+    }
+
+    auto follower{
+        make_shared<Follower>(std::move(parking), exchange->Defer(), invoke)};
+    follower->Park(options_.wait);
+    flight->second.push_back(std::move(follower));
+
+    return {nullptr, false, true};
+}
+
+//------------------------------------------------------------------------------
+void ResponseCache::Release(const string &key,
+                            shared_ptr<const Entry> entry) noexcept
+{
+    const lock_guard<mutex> lock(mutex_);
+
+    auto flight{flights_.find(key)};
+    if (flight != flights_.end())
+    {
+        for (const auto &follower : flight->second)
+        {
+            follower->Notify(entry);
+        }
+        flights_.erase(flight);
+    }
+
+    if (!entry || entry->body.size() > options_.max_size)
+    {
+        return;
+    }
+
+    auto found{index_.find(key)};
+    if (found != index_.end())
+    {
+        Erase(found->second);
+    }
+
+    http::MemoryBudget::Charge charge(entry->body.size());
+    if (!charge.Granted())
+    {
+        return;
+    }
+
+    size_ += entry->body.size();
+    items_.push_front({key,
+                       std::move(entry),
+                       Clock::now() + options_.ttl,
+                       std::move(charge)});
+    index_.emplace(key, items_.begin());
+
+    while (!items_.empty() &&
+           (items_.size() > options_.max_entries || size_ > options_.max_size))
+    {
+        Erase(std::prev(items_.end()));
+    }
+}
+
+//------------------------------------------------------------------------------
+void ResponseCache::Fill(const Entry &entry,
+                         http::ResponseImpl &response) noexcept
+{
+    // ответ из кэша должен совпадать с ответом обработчика
+    for (const auto &[name, value] : entry.headers)
+    {
+        if (strcasecmp(name.c_str(), "traceparent") != 0)
+        {
+            response.Header()->Set(name, value);
+        }
+    }
+
+    response.SetBody(entry.type, entry.body, entry.etag);
+}
+
+//------------------------------------------------------------------------------
+void ResponseCache::Unbind() noexcept
+{
+    if (registry.parking)
+    {
+        registry.parking->Close();
+        registry.parking.reset();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ResponseCache::Erase(std::list<Item>::iterator item) noexcept
+{
+    size_ -= item->entry->body.size();
+    index_.erase(item->key);
+    items_.erase(item);
+}
+
+}  // namespace tasp::ev
@@ -0,0 +1,256 @@
+/**
+ * @file
+ * @brief Кэш ответов обработчиков запросов.
+ */
+#ifndef TASP_RESPONSE_CACHE_HPP_
+#define TASP_RESPONSE_CACHE_HPP_
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "http/memory_budget.hpp"
+#include "tasp/function_ref.hpp"
+#include "tasp/microservice.hpp"
+
+namespace tasp::http
+{
+class Exchange;
+class RequestImpl;
+class ResponseImpl;
+}  // namespace tasp::http
+
+namespace tasp::ev
+{
+
+/**
+ * @brief Кэш ответов обработчика запроса.
+ *
+ * Хранит уже сформированные тела ответов, поэтому при попадании в кэш
+ * сериализация данных не выполняется. Записи вытесняются по времени жизни и
+ * по принципу LRU при превышении ограничений на количество и размер.
+ *
+ * Одновременные промахи по одному ключу объединяются: обработчик вызывается
+ * только первым запросом, ответы остальных откладываются до его завершения,
+ * не блокируя циклы обработки событий. Ожидающие запросы отправляют ответ
+ * из сформированной записи в потоках своих циклов; если запись не
+ * сформирована или ожидание превысило время ожидания из параметров
+ * кэширования, они вызывают обработчик сами.
+ *
+ * Записи учитываются в бюджете памяти; запись, не поместившаяся в бюджет, не
+ * сохраняется.
+ */
+class ResponseCache final
+{
+public:
+    class Follower;
+    class Parking;
+
+    /**
+     * @brief Запись кэша.
+     */
+    struct Entry
+    {
+        /**
+         * @brief Тип данных ответа.
+         */
+        std::string type;
+
+        /**
+         * @brief Тело ответа.
+         */
+        std::string body;
+
+        /**
+         * @brief Значение заголовка ETag. Пустое, если не формируется.
+         */
+        std::string etag;
+
+        /**
+         * @brief Заголовки, установленные обработчиком, например
+         * Cache-Control. Повторяются в ответах из кэша.
+         */
+        std::vector<std::pair<std::string, std::string>> headers;
+    };
+
+    /**
+     * @brief Вызов обработчика запроса, ответ которого не получен из кэша.
+     */
+    using Invoke = FunctionRef<void(http::RequestImpl &, http::ResponseImpl &)>;
+
+    /**
+     * @brief Результат поиска в кэше.
+     */
+    struct Lookup
+    {
+        /**
+         * @brief Найденная запись. Пустой указатель при промахе.
+         */
+        std::shared_ptr<const Entry> entry;
+
+        /**
+         * @brief Признак того, что запрос должен сформировать запись и
+         * передать её в Release.
+         */
+        bool leader{false};
+
+        /**
+         * @brief Признак того, что ответ отложен до формирования записи
+         * другим запросом.
+         */
+        bool parked{false};
+    };
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param options Параметры кэширования
+     */
+    explicit ResponseCache(HandlerOptions::Cache options) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~ResponseCache() noexcept;
+
+    /**
+     * @brief Формирование ключа кэша для запроса.
+     *
+     * @param request Запрос
+     *
+     * @return Ключ
+     */
+    [[nodiscard]] std::string Key(const http::Request &request) const noexcept;
+
+    /**
+     * @brief Поиск записи в кэше.
+     *
+     * Если ответ по ключу уже формируется другим запросом, ответ обмена
+     * откладывается и отправляется в потоке цикла обработки событий после
+     * формирования записи, а если запись не сформирована или время ожидания
+     * истекло - после вызова invoke. Запрос без обмена или вне цикла
+     * обработки событий не ожидает: возвращается промах без признака
+     * формирования записи.
+     *
+     * @param key Ключ
+     * @param exchange Обмен запроса, пустой указатель - ответ нельзя отложить
+     * @param invoke Вызов обработчика запроса
+     *
+     * @return Результат поиска
+     */
+    [[nodiscard]] Lookup Acquire(const std::string &key,
+                                 http::Exchange *exchange,
+                                 Invoke invoke) noexcept;
+
+    /**
+     * @brief Завершение формирования записи и передача её ожидающим
+     * запросам.
+     *
+     * @param key Ключ
+     * @param entry Запись. Пустой указатель, если ответ не подлежит
+     * кэшированию.
+     */
+    void Release(const std::string &key,
+                 std::shared_ptr<const Entry> entry) noexcept;
+
+    /**
+     * @brief Формирование ответа из записи. Заголовок traceparent ответа
+     * принадлежит текущему запросу и не заменяется.
+     *
+     * @param entry Запись
+     * @param response Ответ
+     */
+    static void Fill(const Entry &entry, http::ResponseImpl &response) noexcept;
+
+    /**
+     * @brief Прекращение ожидания записей запросами цикла обработки событий
+     * текущего потока. Вызывается в потоке цикла после его завершения, пока
+     * цикл и данные потока ещё существуют.
+     */
+    static void Unbind() noexcept;
+
+    ResponseCache(const ResponseCache &) = delete;
+    ResponseCache(ResponseCache &&) = delete;
+    ResponseCache &operator=(const ResponseCache &) = delete;
+    ResponseCache &operator=(ResponseCache &&) = delete;
+
+private:
+
+    /**
+     * @brief Тип часов для отсчёта времени жизни записей.
+     */
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Элемент списка LRU.
+     */
+    struct Item
+    {
+        /**
+         * @brief Ключ.
+         */
+        std::string key;
+
+        /**
+         * @brief Запись.
+         */
+        std::shared_ptr<const Entry> entry;
+
+        /**
+         * @brief Время устаревания записи.
+         */
+        Clock::time_point expires;
+
+        /**
+         * @brief Объём записи в бюджете памяти.
+         */
+        http::MemoryBudget::Charge charge;
+    };
+
+    /**
+     * @brief Удаление элемента из кэша.
+     *
+     * @param item Элемент
+     */
+    void Erase(std::list<Item>::iterator item) noexcept;
+
+    /**
+     * @brief Параметры кэширования.
+     */
+    HandlerOptions::Cache options_;
+
+    /**
+     * @brief Синхронизация доступа к кэшу.
+     */
+    std::mutex mutex_;
+
+    /**
+     * @brief Записи в порядке последнего использования.
+     */
+    std::list<Item> items_;
+
+    /**
+     * @brief Индекс записей по ключу.
+     */
+    std::unordered_map<std::string, std::list<Item>::iterator> index_;
+
+    /**
+     * @brief Запросы, ожидающие формируемые записи, по ключам записей.
+     */
+    std::unordered_map<std::string, std::vector<std::shared_ptr<Follower>>>
+        flights_;
+
+    /**
+     * @brief Суммарный размер тел ответов.
+     */
+    size_t size_{0};
+};
+
+}  // namespace tasp::ev
+
+#endif  // TASP_RESPONSE_CACHE_HPP_
@@ -0,0 +1,83 @@
+#include "tasp/sql_condition.hpp"
+
+#include <tasp/logging.hpp>
+
+#include "http/sql_filter.hpp"
+#include "http/uri_impl.hpp"
+
+using std::string;
+using std::vector;
+
+namespace tasp
+{
+/*------------------------------------------------------------------------------
+    SqlCondition
+------------------------------------------------------------------------------*/
+SqlCondition::SqlCondition(const http::Request &request,
+                           Placeholder placeholder) noexcept
+: SqlCondition(request, {}, placeholder)
+{
+}
+
+//------------------------------------------------------------------------------
+SqlCondition::SqlCondition(const http::Request &request,
+                           const vector<string> &fields,
+                           Placeholder placeholder) noexcept
+{
+    const auto uri{request.Uri()};
+    const auto *impl{dynamic_cast<const http::UriImpl *>(uri.get())};
+    if (impl == nullptr)
+    {
+        Logging::Error("SQL-условие недоступно для данного запроса");
+        error_ = "SQL-условие недоступно для данного запроса";
+        return;
+    }
+
+    auto compiled{
+        http::SqlFilter::Compile(impl->Filters(), placeholder, fields)};
+    text_ = std::move(compiled.text);
+    params_ = std::move(compiled.params);
+    error_ = std::move(compiled.error);
+}
+
+//------------------------------------------------------------------------------
+SqlCondition::~SqlCondition() noexcept = default;
+
+//------------------------------------------------------------------------------
+SqlCondition::SqlCondition(const SqlCondition &) noexcept = default;
+
+//------------------------------------------------------------------------------
+SqlCondition::SqlCondition(SqlCondition &&) noexcept = default;
+
+//------------------------------------------------------------------------------
+SqlCondition &SqlCondition::operator=(const SqlCondition &) noexcept = default;
+
+//------------------------------------------------------------------------------
+SqlCondition &SqlCondition::operator=(SqlCondition &&) noexcept = default;
+
+//------------------------------------------------------------------------------
+bool SqlCondition::Valid() const noexcept
+{
+    return error_.empty();
+}
+
+//------------------------------------------------------------------------------
+const string &SqlCondition::Error() const noexcept
+{
+    return error_;
+}
+
+//------------------------------------------------------------------------------
+const string &SqlCondition::Text() const noexcept
+{
+    static const string empty;
+    return text_ ? *text_ : empty;
+}
+
+//------------------------------------------------------------------------------
+const vector<SqlCondition::Param> &SqlCondition::Params() const noexcept
+{
+    return params_;
+}
+
+}  // namespace tasp
@@ -0,0 +1,255 @@
+#include "ring.hpp"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+namespace tasp::uring
+{
+
+namespace
+{
+//------------------------------------------------------------------------------
+int Setup(unsigned entries, io_uring_params *params) noexcept
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+//------------------------------------------------------------------------------
+int Enter(int fd, unsigned to_submit, unsigned wait, unsigned flags) noexcept
+{
+    return static_cast<int>(syscall(
+        __NR_io_uring_enter, fd, to_submit, wait, flags, nullptr, 0));
+}
+
+//------------------------------------------------------------------------------
+template<typename T>
+T *At(void *base, size_t offset) noexcept
+{
+    return reinterpret_cast<T *>(static_cast<char *>(base) +  // NOLINT
+                                 offset);
+}
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    Ring
+------------------------------------------------------------------------------*/
+Ring::Ring(unsigned entries) noexcept
+{
+    params_.flags = IORING_SETUP_CQSIZE;
+    params_.cq_entries = entries * 4;
+
+    fd_ = Setup(entries, &params_);
+    if (fd_ < 0)
+    {
+        return;
+    }
+
+    sq_ring_size_ =
+        params_.sq_off.array + params_.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params_.cq_off.cqes + params_.cq_entries * sizeof(io_uring_cqe);
+
+    const bool single_mmap{(params_.features & IORING_FEAT_SINGLE_MMAP) != 0};
+    if (single_mmap)
+    {
+        sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        cq_ring_size_ = sq_ring_size_;
+    }
+
+    sq_ring_ = mmap(nullptr,
+                    sq_ring_size_,
+                    PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE,
+                    fd_,
+                    IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED)
+    {
+        sq_ring_ = nullptr;
+        return;
+    }
+
+    if (single_mmap)
+    {
+        cq_ring_ = sq_ring_;
+    }
+    else
+    {
+        cq_ring_ = mmap(nullptr,
+                        cq_ring_size_,
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE,
+                        fd_,
+                        IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED)
+        {
+            cq_ring_ = nullptr;
+            return;
+        }
+    }
+
+    void *sqes{mmap(nullptr,
+                    params_.sq_entries * sizeof(io_uring_sqe),
+                    PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE,
+                    fd_,
+                    IORING_OFF_SQES)};
+    if (sqes == MAP_FAILED)
+    {
+        return;
+    }
+    sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+    sq_head_ = At<unsigned>(sq_ring_, params_.sq_off.head);
+    sq_tail_ = At<unsigned>(sq_ring_, params_.sq_off.tail);
+    sq_mask_ = *At<unsigned>(sq_ring_, params_.sq_off.ring_mask);
+    sq_array_ = At<unsigned>(sq_ring_, params_.sq_off.array);
+    sqe_tail_ = *sq_tail_;
+
+    cq_head_ = At<unsigned>(cq_ring_, params_.cq_off.head);
+    cq_tail_ = At<unsigned>(cq_ring_, params_.cq_off.tail);
+    cq_mask_ = *At<unsigned>(cq_ring_, params_.cq_off.ring_mask);
+    cqes_ = At<io_uring_cqe>(cq_ring_, params_.cq_off.cqes);
+}
+
+//------------------------------------------------------------------------------
+Ring::~Ring() noexcept
+{
+    if (sqes_ != nullptr)
+    {
+        munmap(sqes_, params_.sq_entries * sizeof(io_uring_sqe));
+    }
+
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+    {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+
+    if (sq_ring_ != nullptr)
+    {
+        munmap(sq_ring_, sq_ring_size_);
+    }
+
+    if (fd_ >= 0)
+    {
+        close(fd_);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool Ring::Valid() const noexcept
+{
+    return sqes_ != nullptr;
+}
+
+//------------------------------------------------------------------------------
+bool Ring::Supported() noexcept
+{
+    io_uring_params params{};
+    const int fd{Setup(1, &params)};
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    const size_t ops{IORING_OP_LAST};
+    std::vector<char> buffer(sizeof(io_uring_probe) +
+                             ops * sizeof(io_uring_probe_op));
+    auto *probe{reinterpret_cast<io_uring_probe *>(buffer.data())};  // NOLINT
+
+    const bool probed{syscall(__NR_io_uring_register,
+                              fd,
+                              IORING_REGISTER_PROBE,
+                              probe,
+                              ops) == 0};
+    close(fd);
+
+    if (!probed)
+    {
+        return false;
+    }
+
+    // многократный приём подключений появился в ядре вместе с операцией
+    // IORING_OP_SOCKET (5.19), поддержка флага проверяется по ней
+    constexpr std::array<unsigned, 5> required{{IORING_OP_ACCEPT,
+                                                IORING_OP_RECV,
+                                                IORING_OP_SEND,
+                                                IORING_OP_PROVIDE_BUFFERS,
+                                                IORING_OP_SOCKET}};
+    for (const auto op : required)
+    {
+        if (op > probe->last_op ||
+            (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0)  // NOLINT
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+io_uring_sqe *Ring::Sqe() noexcept
+{
+    if (sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >=
+        params_.sq_entries)
+    {
+        Submit(0);
+    }
+
+    const unsigned index{sqe_tail_ & sq_mask_};
+    io_uring_sqe *sqe{&sqes_[index]};  // NOLINT
+    std::memset(sqe, 0, sizeof(*sqe));
+
+    sq_array_[index] = index;  // NOLINT
+    sqe_tail_++;
+
+    return sqe;
+}
+
+//------------------------------------------------------------------------------
+int Ring::Submit(unsigned wait) noexcept
+{
+    __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+
+    const unsigned to_submit{sqe_tail_ -
+                             __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE)};
+
+    int res{0};
+    do
+    {
+        res = Enter(fd_,
+                    to_submit,
+                    wait,
+                    wait > 0 ? IORING_ENTER_GETEVENTS : 0U);
+    } while (res < 0 && errno == EINTR);
+
+    return res < 0 ? -errno : res;
+}
+
+//------------------------------------------------------------------------------
+io_uring_cqe *Ring::Peek() noexcept
+{
+    const unsigned head{*cq_head_};
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE))
+    {
+        return nullptr;
+    }
+
+    return &cqes_[head & cq_mask_];  // NOLINT
+}
+
+//------------------------------------------------------------------------------
+void Ring::Seen() noexcept
+{
+    __atomic_store_n(cq_head_, *cq_head_ + 1, __ATOMIC_RELEASE);
+}
+
+}  // namespace tasp::uring
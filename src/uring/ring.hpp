@@ -0,0 +1,174 @@
+/**
+ * @file
+ * @brief Очередь ввода-вывода io_uring.
+ */
+#ifndef TASP_URING_RING_HPP_
+#define TASP_URING_RING_HPP_
+
+#include <linux/io_uring.h>
+
+#include <cstddef>
+
+namespace tasp::uring
+{
+
+/**
+ * @brief Очередь ввода-вывода io_uring на системных вызовах, без библиотеки
+ * liburing.
+ *
+ * Очереди отправки и завершения отображаются в память процесса. Заявки
+ * накапливаются в очереди отправки и передаются ядру одним вызовом
+ * io_uring_enter вместе с ожиданием завершений.
+ */
+class Ring final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param entries Размер очереди отправки. Очередь завершения в четыре раза
+     * больше.
+     */
+    explicit Ring(unsigned entries) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~Ring() noexcept;
+
+    /**
+     * @brief Проверка успешного создания очереди.
+     *
+     * @return Признак успешного создания
+     */
+    [[nodiscard]] bool Valid() const noexcept;
+
+    /**
+     * @brief Проверка поддержки ядром операций, необходимых серверу:
+     * многократного приёма подключений, выбора буферов ядром и отправки.
+     *
+     * @return Признак поддержки
+     */
+    [[nodiscard]] static bool Supported() noexcept;
+
+    /**
+     * @brief Получение свободной заявки. При заполнении очереди накопленные
+     * заявки передаются ядру.
+     *
+     * @return Обнулённая заявка
+     */
+    [[nodiscard]] io_uring_sqe *Sqe() noexcept;
+
+    /**
+     * @brief Передача накопленных заявок ядру и ожидание завершений.
+     *
+     * @param wait Минимальное количество ожидаемых завершений
+     *
+     * @return Количество переданных заявок или отрицательный код ошибки
+     */
+    int Submit(unsigned wait) noexcept;
+
+    /**
+     * @brief Запрос очередного завершения.
+     *
+     * @return Завершение или пустой указатель, если очередь пуста
+     */
+    [[nodiscard]] io_uring_cqe *Peek() noexcept;
+
+    /**
+     * @brief Освобождение завершения, полученного Peek.
+     */
+    void Seen() noexcept;
+
+    Ring(const Ring &) = delete;
+    Ring(Ring &&) = delete;
+    Ring &operator=(const Ring &) = delete;
+    Ring &operator=(Ring &&) = delete;
+
+private:
+    /**
+     * @brief Файловый дескриптор очереди.
+     */
+    int fd_{-1};
+
+    /**
+     * @brief Параметры очереди, возвращённые ядром.
+     */
+    io_uring_params params_{};
+
+    /**
+     * @brief Отображение очереди отправки.
+     */
+    void *sq_ring_{nullptr};
+
+    /**
+     * @brief Размер отображения очереди отправки.
+     */
+    size_t sq_ring_size_{0};
+
+    /**
+     * @brief Отображение очереди завершения. Совпадает с sq_ring_ при
+     * IORING_FEAT_SINGLE_MMAP.
+     */
+    void *cq_ring_{nullptr};
+
+    /**
+     * @brief Размер отображения очереди завершения.
+     */
+    size_t cq_ring_size_{0};
+
+    /**
+     * @brief Массив заявок.
+     */
+    io_uring_sqe *sqes_{nullptr};
+
+    /**
+     * @brief Голова очереди отправки, изменяется ядром.
+     */
+    unsigned *sq_head_{nullptr};
+
+    /**
+     * @brief Хвост очереди отправки.
+     */
+    unsigned *sq_tail_{nullptr};
+
+    /**
+     * @brief Маска индекса очереди отправки.
+     */
+    unsigned sq_mask_{0};
+
+    /**
+     * @brief Массив индексов заявок очереди отправки.
+     */
+    unsigned *sq_array_{nullptr};
+
+    /**
+     * @brief Локальный хвост очереди отправки, включая ещё не переданные
+     * заявки.
+     */
+    unsigned sqe_tail_{0};
+
+    /**
+     * @brief Голова очереди завершения.
+     */
+    unsigned *cq_head_{nullptr};
+
+    /**
+     * @brief Хвост очереди завершения, изменяется ядром.
+     */
+    unsigned *cq_tail_{nullptr};
+
+    /**
+     * @brief Маска индекса очереди завершения.
+     */
+    unsigned cq_mask_{0};
+
+    /**
+     * @brief Массив завершений.
+     */
+    io_uring_cqe *cqes_{nullptr};
+};
+
+}  // namespace tasp::uring
+
+#endif  // TASP_URING_RING_HPP_
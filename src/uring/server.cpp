@@ -0,0 +1,852 @@
+#include "server.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <strings.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+
+#include <tasp/logging.hpp>
+
+#include "../http/request_impl.hpp"
+#include "../http/response_impl.hpp"
+#include "../http/synthetic_request.hpp"
+#include "../http/trace.hpp"
+#include "../listen_socket.hpp"
+
+using std::string;
+using std::string_view;
+using std::thread;
+
+using tasp::http::InitRequest;
+using tasp::http::RequestImpl;
+using tasp::http::ResponseImpl;
+using tasp::http::Trace;
+
+namespace tasp::uring
+{
+
+namespace
+{
+/**
+ * @brief Размер очереди заявок.
+ */
+constexpr unsigned ring_entries{1024};
+
+/**
+ * @brief Количество буферов для чтения.
+ */
+constexpr uint16_t buffer_count{256};
+
+/**
+ * @brief Размер буфера для чтения.
+ */
+constexpr size_t buffer_size{16 * 1024};
+
+/**
+ * @brief Группа буферов для чтения.
+ */
+constexpr uint16_t buffer_group{1};
+
+/**
+ * @brief Максимальный размер строки запроса и заголовков.
+ */
+constexpr size_t max_header_size{64 * 1024};
+
+/**
+ * @brief Сдвиг типа операции в user_data.
+ */
+constexpr unsigned op_shift{56};
+
+/**
+ * @brief Маска идентификатора подключения в user_data.
+ */
+constexpr uint64_t id_mask{(uint64_t{1} << op_shift) - 1};
+
+/**
+ * @brief Методы HTTP.
+ */
+constexpr std::array<std::pair<string_view, evhttp_cmd_type>, 9> methods{{
+    {"GET", EVHTTP_REQ_GET},
+    {"POST", EVHTTP_REQ_POST},
+    {"HEAD", EVHTTP_REQ_HEAD},
+    {"PUT", EVHTTP_REQ_PUT},
+    {"DELETE", EVHTTP_REQ_DELETE},
+    {"OPTIONS", EVHTTP_REQ_OPTIONS},
+    {"TRACE", EVHTTP_REQ_TRACE},
+    {"CONNECT", EVHTTP_REQ_CONNECT},
+    {"PATCH", EVHTTP_REQ_PATCH},
+}};
+
+//------------------------------------------------------------------------------
+string_view Reason(int code) noexcept
+{
+    switch (code)
+    {
+        case HTTP_OK:
+            return "OK";
+        case HTTP_NOCONTENT:
+            return "No Content";
+        case HTTP_MOVEPERM:
+            return "Moved Permanently";
+        case HTTP_MOVETEMP:
+            return "Found";
+        case HTTP_NOTMODIFIED:
+            return "Not Modified";
+        case HTTP_BADREQUEST:
+            return "Bad Request";
+        case HTTP_NOTFOUND:
+            return "Not Found";
+        case HTTP_BADMETHOD:
+            return "Method Not Allowed";
+        case HTTP_ENTITYTOOLARGE:
+            return "Payload Too Large";
+        case HTTP_INTERNAL:
+            return "Internal Server Error";
+        case HTTP_NOTIMPLEMENTED:
+            return "Not Implemented";
+        case HTTP_SERVUNAVAIL:
+            return "Service Unavailable";
+        default:
+            return code < 400 ? "OK" : "Error";
+    }
+}
+
+//------------------------------------------------------------------------------
+bool EqualsNoCase(string_view lhs, string_view rhs) noexcept
+{
+    return lhs.size() == rhs.size() &&
+           strncasecmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+//------------------------------------------------------------------------------
+string_view Trim(string_view str) noexcept
+{
+    const auto first{str.find_first_not_of(" \t")};
+    if (first == string_view::npos)
+    {
+        return {};
+    }
+
+    return str.substr(first, str.find_last_not_of(" \t") - first + 1);
+}
+
+//------------------------------------------------------------------------------
+uint64_t UserData(uint8_t op, uint64_t id) noexcept
+{
+    return (uint64_t{op} << op_shift) | (id & id_mask);
+}
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    Server
+------------------------------------------------------------------------------*/
+Server::Server(string_view address,
+               uint16_t port,
+               const ev::ConnectionOptions &options,
+               ev::Dispatcher func) noexcept
+: Server(options, func)
+{
+    socket_ = ev::ListenTcp(address, port);
+    if (socket_ < 0)
+    {
+        return;
+    }
+
+    owner_ = true;
+    Start();
+}
+
+//------------------------------------------------------------------------------
+Server::Server(int socket,
+               const ev::ConnectionOptions &options,
+               ev::Dispatcher func) noexcept
+: Server(options, func)
+{
+    socket_ = socket;
+    if (socket_ < 0)
+    {
+        Logging::Error("Ошибка привязки HTTP-сервера с сокетом");
+        return;
+    }
+
+    Start();
+}
+
+//------------------------------------------------------------------------------
+Server::Server(const ev::ConnectionOptions &options,
+               ev::Dispatcher func) noexcept
+: buffers_(size_t{buffer_count} * buffer_size)
+, ring_(ring_entries)
+, wakeup_(eventfd(0, EFD_CLOEXEC))
+, max_body_size_(options.max_body_size)
+, func_(func)
+, watchdog_(options.watchdog)
+{
+    if (watchdog_ != nullptr)
+    {
+        slot_ = watchdog_->Register();
+    }
+}
+
+//------------------------------------------------------------------------------
+Server::~Server() noexcept
+{
+    Stop();
+
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+
+    for (const auto &[id, client] : clients_)
+    {
+        close(client.fd);
+    }
+
+    if (watchdog_ != nullptr)
+    {
+        watchdog_->Unregister(slot_);
+    }
+
+    if (owner_)
+    {
+        close(socket_);
+    }
+
+    if (wakeup_ >= 0)
+    {
+        close(wakeup_);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool Server::Supported() noexcept
+{
+    return Ring::Supported();
+}
+
+//------------------------------------------------------------------------------
+int Server::GetSocket() const noexcept
+{
+    return socket_;
+}
+
+//------------------------------------------------------------------------------
+void Server::Stop() const noexcept
+{
+    if (wakeup_ >= 0)
+    {
+        eventfd_write(wakeup_, 1);
+    }
+}
+
+//------------------------------------------------------------------------------
+void Server::Start() noexcept
+{
+    if (!ring_.Valid() || wakeup_ < 0)
+    {
+        Logging::Error("Ошибка создания очереди io_uring: {}",
+                       std::strerror(errno));
+        return;
+    }
+
+    thread_ = thread(&Server::Run, this);
+}
+
+//------------------------------------------------------------------------------
+void Server::Run() noexcept
+{
+    ev::Watchdog::Bind(slot_);
+
+    ArmWakeup();
+    Provide(0, buffer_count);
+    ArmAccept();
+
+    bool running{true};
+    while (running)
+    {
+        const int res{ring_.Submit(1)};
+        if (res < 0 && res != -EBUSY && res != -EAGAIN)
+        {
+            Logging::Error("Ошибка io_uring_enter: {}", std::strerror(-res));
+            break;
+        }
+
+        // завершения обрабатываются пачкой, ответы отправляются после неё
+        for (auto *cqe = ring_.Peek(); cqe != nullptr; cqe = ring_.Peek())
+        {
+            const uint64_t user_data{cqe->user_data};
+            const int cqe_res{cqe->res};
+            const uint32_t flags{cqe->flags};
+            ring_.Seen();
+
+            running = Complete(user_data, cqe_res, flags) && running;
+        }
+
+        Flush();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool Server::Complete(uint64_t user_data, int res, uint32_t flags) noexcept
+{
+    const auto op{static_cast<Op>(user_data >> op_shift)};
+    const uint64_t id{user_data & id_mask};
+
+    switch (op)
+    {
+        case Op::Wakeup:
+            return false;
+
+        case Op::Provide:
+            if (res < 0)
+            {
+                Logging::Error("Ошибка передачи буферов io_uring: {}",
+                               std::strerror(-res));
+            }
+            return true;
+
+        case Op::Accept:
+            if (res >= 0)
+            {
+                Accepted(res);
+            }
+            else if (res != -ECANCELED)
+            {
+                Logging::Debug("Ошибка приёма подключения: {}",
+                               std::strerror(-res));
+            }
+
+            if ((flags & IORING_CQE_F_MORE) == 0U && res != -EBADF)
+            {
+                ArmAccept();
+            }
+            return true;
+
+        default:
+            break;
+    }
+
+    const auto it{clients_.find(id)};
+    if (it == clients_.end())
+    {
+        return true;
+    }
+    auto &client{it->second};
+
+    if (op == Op::Send)
+    {
+        client.send_pending = false;
+        if (res <= 0)
+        {
+            client.closing = true;
+            client.output.clear();
+        }
+        else
+        {
+            client.sent += static_cast<size_t>(res);
+            if (client.sent < client.sending.size())
+            {
+                ArmSend(id, client);
+                return true;
+            }
+            client.sending.clear();
+            client.sent = 0;
+            dirty_.push_back(id);
+        }
+
+        Check(id, client);
+        return true;
+    }
+
+    // Op::Recv
+    client.recv_pending = false;
+
+    if (res == -ENOBUFS)
+    {
+        // все буферы заняты в текущей пачке, они будут возвращены ядру
+        ArmRecv(id, client);
+        return true;
+    }
+
+    if (res <= 0)
+    {
+        client.closing = true;
+        Check(id, client);
+        return true;
+    }
+
+    if ((flags & IORING_CQE_F_BUFFER) != 0U)
+    {
+        const auto bid{static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT)};
+        client.input.append(&buffers_[bid * buffer_size],
+                            static_cast<size_t>(res));
+        Provide(bid, 1);
+    }
+
+    Process(client);
+
+    if (!client.closing)
+    {
+        ArmRecv(id, client);
+    }
+
+    if (!client.output.empty())
+    {
+        dirty_.push_back(id);
+    }
+
+    Check(id, client);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void Server::ArmAccept() noexcept
+{
+    auto *sqe{ring_.Sqe()};
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = socket_;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = UserData(static_cast<uint8_t>(Op::Accept), 0);
+}
+
+//------------------------------------------------------------------------------
+void Server::ArmRecv(uint64_t id, Client &client) noexcept
+{
+    auto *sqe{ring_.Sqe()};
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = client.fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = buffer_group;
+    sqe->len = buffer_size;
+    sqe->user_data = UserData(static_cast<uint8_t>(Op::Recv), id);
+
+    client.recv_pending = true;
+}
+
+//------------------------------------------------------------------------------
+void Server::ArmSend(uint64_t id, Client &client) noexcept
+{
+    auto *sqe{ring_.Sqe()};
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = client.fd;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    sqe->addr = reinterpret_cast<uint64_t>(client.sending.data() + client.sent);
+    sqe->len = static_cast<uint32_t>(client.sending.size() - client.sent);
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = UserData(static_cast<uint8_t>(Op::Send), id);
+
+    client.send_pending = true;
+}
+
+//------------------------------------------------------------------------------
+void Server::ArmWakeup() noexcept
+{
+    auto *sqe{ring_.Sqe()};
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wakeup_;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    sqe->addr = reinterpret_cast<uint64_t>(&wakeup_value_);
+    sqe->len = sizeof(wakeup_value_);
+    sqe->user_data = UserData(static_cast<uint8_t>(Op::Wakeup), 0);
+}
+
+//------------------------------------------------------------------------------
+void Server::Provide(uint16_t bid, uint16_t count) noexcept
+{
+    auto *sqe{ring_.Sqe()};
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = count;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    sqe->addr = reinterpret_cast<uint64_t>(&buffers_[bid * buffer_size]);
+    sqe->len = buffer_size;
+    sqe->off = bid;
+    sqe->buf_group = buffer_group;
+    sqe->user_data = UserData(static_cast<uint8_t>(Op::Provide), 0);
+}
+
+//------------------------------------------------------------------------------
+void Server::Accepted(int fd) noexcept
+{
+    const uint64_t id{next_id_++};
+    auto &client{clients_[id]};
+    client.fd = fd;
+
+    sockaddr_storage addr{};
+    socklen_t length{sizeof(addr)};
+    std::array<char, INET6_ADDRSTRLEN> ip{};
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (getpeername(fd, reinterpret_cast<sockaddr *>(&addr), &length) == 0)
+    {
+        if (addr.ss_family == AF_INET)
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            const auto *in{reinterpret_cast<sockaddr_in *>(&addr)};
+            inet_ntop(AF_INET, &in->sin_addr, ip.data(), ip.size());
+        }
+        else if (addr.ss_family == AF_INET6)
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            const auto *in6{reinterpret_cast<sockaddr_in6 *>(&addr)};
+            inet_ntop(AF_INET6, &in6->sin6_addr, ip.data(), ip.size());
+        }
+    }
+    client.address = ip.data();
+
+    ArmRecv(id, client);
+}
+
+//------------------------------------------------------------------------------
+void Server::Process(Client &client) noexcept
+{
+    size_t offset{0};
+
+    while (!client.closing)
+    {
+        const string_view input{string_view{client.input}.substr(offset)};
+
+        const auto header_end{input.find("\r\n\r\n")};
+        if (header_end == string_view::npos)
+        {
+            if (input.size() > max_header_size)
+            {
+                Reject(client, HTTP_BADREQUEST);
+            }
+            break;
+        }
+
+        string_view head{input.substr(0, header_end)};
+
+        const auto line_end{head.find("\r\n")};
+        const string_view line{head.substr(0, line_end)};
+        head.remove_prefix(line_end == string_view::npos ? head.size()
+                                                         : line_end + 2);
+
+        const auto method_end{line.find(' ')};
+        const auto target_end{line.rfind(' ')};
+        if (method_end == string_view::npos || target_end <= method_end)
+        {
+            Reject(client, HTTP_BADREQUEST);
+            break;
+        }
+
+        const string_view method{line.substr(0, method_end)};
+        const string_view target{
+            line.substr(method_end + 1, target_end - method_end - 1)};
+        const string_view version{line.substr(target_end + 1)};
+
+        const auto *known{std::find_if(methods.begin(),
+                                       methods.end(),
+                                       [method](const auto &item)
+                                       { return item.first == method; })};
+        if (known == methods.end())
+        {
+            Reject(client, HTTP_NOTIMPLEMENTED);
+            break;
+        }
+
+        if (version != "HTTP/1.1" && version != "HTTP/1.0")
+        {
+            Reject(client, HTTP_BADREQUEST);
+            break;
+        }
+
+        auto *req{evhttp_request_new(nullptr, nullptr)};
+        const bool http11{version == "HTTP/1.1"};
+
+        bool keep_alive{http11};
+        size_t content_length{0};
+        bool valid{InitRequest(req, known->second, target, 1, http11 ? 1 : 0)};
+        int error{HTTP_BADREQUEST};
+
+        auto *headers{evhttp_request_get_input_headers(req)};
+        while (valid && !head.empty())
+        {
+            const auto end{head.find("\r\n")};
+            const string_view header{head.substr(0, end)};
+            head.remove_prefix(end == string_view::npos ? head.size()
+                                                        : end + 2);
+
+            const auto colon{header.find(':')};
+            if (colon == string_view::npos || colon == 0)
+            {
+                valid = false;
+                break;
+            }
+
+            const string key{header.substr(0, colon)};
+            const string value{Trim(header.substr(colon + 1))};
+
+            if (EqualsNoCase(key, "Content-Length"))
+            {
+                const auto [ptr, ec]{
+                    std::from_chars(value.data(),
+                                    value.data() + value.size(),
+                                    content_length)};
+                valid = ec == std::errc{} && ptr == value.data() + value.size();
+            }
+            else if (EqualsNoCase(key, "Transfer-Encoding"))
+            {
+                valid = false;
+                error = HTTP_NOTIMPLEMENTED;
+            }
+            else if (EqualsNoCase(key, "Connection"))
+            {
+                if (EqualsNoCase(value, "close"))
+                {
+                    keep_alive = false;
+                }
+                else if (EqualsNoCase(value, "keep-alive"))
+                {
+                    keep_alive = true;
+                }
+            }
+
+            evhttp_add_header(headers, key.c_str(), value.c_str());
+        }
+
+        if (valid && content_length > max_body_size_)
+        {
+            valid = false;
+            error = HTTP_ENTITYTOOLARGE;
+        }
+
+        if (!valid)
+        {
+            evhttp_request_free(req);
+            Reject(client, error);
+            break;
+        }
+
+        const size_t body_begin{header_end + 4};
+        if (input.size() - body_begin < content_length)
+        {
+            // данные запроса приняты не полностью
+            evhttp_request_free(req);
+            break;
+        }
+
+        evbuffer_add(evhttp_request_get_input_buffer(req),
+                     input.data() + body_begin,
+                     content_length);
+
+        // адрес клиента передаётся так же, как его формирует HeaderImpl для
+        // подключений HTTP-сервера libevent
+        evhttp_remove_header(headers, "client");
+        evhttp_add_header(headers, "client", client.address.c_str());
+
+        offset += body_begin + content_length;
+
+        Dispatch(client, req, keep_alive);
+    }
+
+    client.input.erase(0, offset);
+}
+
+//------------------------------------------------------------------------------
+void Server::Dispatch(Client &client,
+                      evhttp_request *req,
+                      bool keep_alive) noexcept
+{
+    current_ = &client;
+    keep_alive_ = keep_alive;
+
+    {
+        Trace trace(req);
+
+        trace.Begin(Trace::Phase::Parse);
+        RequestImpl request(req);
+        ResponseImpl response(req);
+        trace.End(Trace::Phase::Parse);
+
+        trace.SetRequest(http::MethodToString(request.GetMethod()),
+                         request.Uri()->Url());
+
+        response.SetReplySink(http::ReplySink::Bind<&Server::Reply>(this));
+
+        func_(request, response);
+
+        response.Send();
+
+        trace.SetCode(static_cast<int>(response.GetCode()));
+    }
+
+    evhttp_request_free(req);
+
+    if (!keep_alive)
+    {
+        client.closing = true;
+    }
+
+    current_ = nullptr;
+}
+
+//------------------------------------------------------------------------------
+void Server::Reply(evhttp_request *req, int code, evbuffer *body) noexcept
+{
+    if (current_ == nullptr)
+    {
+        return;
+    }
+
+    string &out{current_->output};
+
+    std::array<char, 16> code_str{};
+    const auto [code_end, code_ec]{
+        std::to_chars(code_str.begin(), code_str.end(), code)};
+
+    out.append("HTTP/1.1 ")
+        .append(code_str.data(), code_end)
+        .append(" ")
+        .append(Reason(code))
+        .append("\r\n");
+
+    bool has_date{false};
+    auto *headers{evhttp_request_get_output_headers(req)};
+    for (evkeyval *header = headers->tqh_first; header != nullptr;
+         header = header->next.tqe_next)
+    {
+        const string_view key{header->key};
+        if (EqualsNoCase(key, "Content-Length") ||
+            EqualsNoCase(key, "Connection") ||
+            EqualsNoCase(key, "Transfer-Encoding"))
+        {
+            continue;
+        }
+
+        has_date = has_date || EqualsNoCase(key, "Date");
+        out.append(key).append(": ").append(header->value).append("\r\n");
+    }
+
+    if (!has_date)
+    {
+        out.append("Date: ").append(Date()).append("\r\n");
+    }
+
+    const bool no_body{code == HTTP_NOCONTENT || code == HTTP_NOTMODIFIED ||
+                       code < HTTP_OK};
+    const bool head{evhttp_request_get_command(req) == EVHTTP_REQ_HEAD};
+    const size_t length{body != nullptr ? evbuffer_get_length(body) : 0};
+
+    // тело ответа на HEAD может быть не сформировано, длина не передаётся,
+    // как и в HTTP-сервере libevent
+    if (!no_body && !head)
+    {
+        const auto [length_end, length_ec]{
+            std::to_chars(code_str.begin(), code_str.end(), length)};
+        out.append("Content-Length: ")
+            .append(code_str.data(), length_end)
+            .append("\r\n");
+    }
+
+    if (!keep_alive_)
+    {
+        out.append("Connection: close\r\n");
+    }
+
+    out.append("\r\n");
+
+    if (no_body || head || length == 0)
+    {
+        return;
+    }
+
+    const size_t size{out.size()};
+    out.resize(size + length);
+    evbuffer_copyout(body, &out[size], length);
+}
+
+//------------------------------------------------------------------------------
+void Server::Reject(Client &client, int code) noexcept
+{
+    client.output.append("HTTP/1.1 ")
+        .append(std::to_string(code))
+        .append(" ")
+        .append(Reason(code))
+        .append("\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    client.closing = true;
+}
+
+//------------------------------------------------------------------------------
+void Server::Flush() noexcept
+{
+    for (const uint64_t id : dirty_)
+    {
+        const auto it{clients_.find(id)};
+        if (it == clients_.end())
+        {
+            continue;
+        }
+        auto &client{it->second};
+
+        if (client.send_pending || client.output.empty())
+        {
+            continue;
+        }
+
+        // ответы на все запросы, принятые в пачке, отправляются вместе
+        client.sending.swap(client.output);
+        client.output.clear();
+        client.sent = 0;
+        ArmSend(id, client);
+    }
+
+    dirty_.clear();
+}
+
+//------------------------------------------------------------------------------
+void Server::Check(uint64_t id, Client &client) noexcept
+{
+    if (!client.closing || client.send_pending || !client.output.empty())
+    {
+        return;
+    }
+
+    if (!client.shutdown)
+    {
+        // ожидающее чтение завершится после shutdown
+        shutdown(client.fd, SHUT_RDWR);
+        client.shutdown = true;
+    }
+
+    if (client.recv_pending)
+    {
+        return;
+    }
+
+    close(client.fd);
+    clients_.erase(id);
+}
+
+//------------------------------------------------------------------------------
+const string &Server::Date() noexcept
+{
+    const time_t now{time(nullptr)};
+    if (now != date_time_)
+    {
+        std::tm tm{};
+        gmtime_r(&now, &tm);
+
+        std::array<char, 64> str{};
+        const size_t length{std::strftime(
+            str.data(), str.size(), "%a, %d %b %Y %H:%M:%S GMT", &tm)};
+
+        date_.assign(str.data(), length);
+        date_time_ = now;
+    }
+    return date_;
+}
+
+}  // namespace tasp::uring
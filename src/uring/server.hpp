@@ -0,0 +1,385 @@
+/**
+ * @file
+ * @brief HTTP-сервер на основе io_uring.
+ */
+#ifndef TASP_URING_SERVER_HPP_
+#define TASP_URING_SERVER_HPP_
+
+#include <evhttp.h>
+
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../connection.hpp"
+#include "ring.hpp"
+
+namespace tasp::uring
+{
+
+/**
+ * @brief HTTP-сервер на основе io_uring, альтернатива ev::Connection.
+ *
+ * Каждый сервер имеет собственный поток и очередь io_uring. Подключения
+ * принимаются многократной заявкой accept на общем сокете, данные читаются в
+ * буферы, предоставленные ядру заранее (ядро само выбирает буфер), ответы
+ * накапливаются и отправляются после обработки всех завершений одним
+ * вызовом io_uring_enter.
+ *
+ * Запросы HTTP/1.1 разбираются сервером и передаются обработчикам в виде
+ * запросов libevent без подключения, поэтому обработчики работают с теми же
+ * интерфейсами http::Request и http::Response. Поддерживаются постоянные
+ * подключения и конвейерная передача запросов. Данные запроса с
+ * Transfer-Encoding: chunked не поддерживаются (ответ 501).
+ */
+class Server final
+{
+public:
+    /**
+     * @brief Конструктор главного сервера.
+     *
+     * @param address Адрес для прослушивания
+     * @param port Порт сервера
+     * @param options Параметры подключения
+     * @param func Функция формирующая запрос
+     */
+    Server(std::string_view address,
+           uint16_t port,
+           const ev::ConnectionOptions &options,
+           ev::Dispatcher func) noexcept;
+
+    /**
+     * @brief Конструктор дополнительного сервера.
+     *
+     * @param socket Сокет главного сервера
+     * @param options Параметры подключения
+     * @param func Функция формирующая запрос
+     */
+    Server(int socket,
+           const ev::ConnectionOptions &options,
+           ev::Dispatcher func) noexcept;
+
+    /**
+     * @brief Деструктор.
+     */
+    ~Server() noexcept;
+
+    /**
+     * @brief Проверка поддержки io_uring ядром.
+     *
+     * @return Признак поддержки
+     */
+    [[nodiscard]] static bool Supported() noexcept;
+
+    /**
+     * @brief Запрос сокета сервера.
+     *
+     * @return Сокет
+     */
+    [[nodiscard]] int GetSocket() const noexcept;
+
+    /**
+     * @brief Запрос на завершение потока сервера.
+     */
+    void Stop() const noexcept;
+
+    Server(const Server &) = delete;
+    Server(Server &&) = delete;
+    Server &operator=(const Server &) = delete;
+    Server &operator=(Server &&) = delete;
+
+private:
+    /**
+     * @brief Тип операции заявки, хранится в старшем байте user_data.
+     */
+    enum class Op : uint8_t
+    {
+        Accept = 1,
+        Recv,
+        Send,
+        Provide,
+        Wakeup
+    };
+
+    /**
+     * @brief Подключение клиента.
+     */
+    struct Client
+    {
+        /**
+         * @brief Сокет.
+         */
+        int fd{-1};
+
+        /**
+         * @brief Адрес клиента.
+         */
+        std::string address;
+
+        /**
+         * @brief Принятые и ещё не обработанные данные.
+         */
+        std::string input;
+
+        /**
+         * @brief Сформированные и ещё не отправленные ответы.
+         */
+        std::string output;
+
+        /**
+         * @brief Отправляемые ответы.
+         */
+        std::string sending;
+
+        /**
+         * @brief Количество отправленных байт из sending.
+         */
+        size_t sent{0};
+
+        /**
+         * @brief Признак ожидания завершения чтения.
+         */
+        bool recv_pending{false};
+
+        /**
+         * @brief Признак ожидания завершения отправки.
+         */
+        bool send_pending{false};
+
+        /**
+         * @brief Признак закрытия подключения после отправки ответов.
+         */
+        bool closing{false};
+
+        /**
+         * @brief Признак вызова shutdown для сокета.
+         */
+        bool shutdown{false};
+    };
+
+    /**
+     * @brief Конструктор с общими действиями для главного и дополнительных
+     * серверов.
+     *
+     * @param options Параметры подключения
+     * @param func Функция формирующая запрос
+     */
+    Server(const ev::ConnectionOptions &options, ev::Dispatcher func) noexcept;
+
+    /**
+     * @brief Запуск потока сервера.
+     */
+    void Start() noexcept;
+
+    /**
+     * @brief Функция потока сервера.
+     */
+    void Run() noexcept;
+
+    /**
+     * @brief Обработка завершения заявки.
+     *
+     * @param user_data Данные заявки
+     * @param res Результат
+     * @param flags Флаги завершения
+     *
+     * @return Признак продолжения работы
+     */
+    bool Complete(uint64_t user_data, int res, uint32_t flags) noexcept;
+
+    /**
+     * @brief Постановка заявки многократного приёма подключений.
+     */
+    void ArmAccept() noexcept;
+
+    /**
+     * @brief Постановка заявки чтения с выбором буфера ядром.
+     *
+     * @param id Идентификатор подключения
+     * @param client Подключение
+     */
+    void ArmRecv(uint64_t id, Client &client) noexcept;
+
+    /**
+     * @brief Постановка заявки отправки.
+     *
+     * @param id Идентификатор подключения
+     * @param client Подключение
+     */
+    void ArmSend(uint64_t id, Client &client) noexcept;
+
+    /**
+     * @brief Постановка заявки ожидания сигнала завершения.
+     */
+    void ArmWakeup() noexcept;
+
+    /**
+     * @brief Передача ядру буферов для чтения.
+     *
+     * @param bid Номер первого буфера
+     * @param count Количество буферов
+     */
+    void Provide(uint16_t bid, uint16_t count) noexcept;
+
+    /**
+     * @brief Обработка принятого подключения.
+     *
+     * @param fd Сокет подключения
+     */
+    void Accepted(int fd) noexcept;
+
+    /**
+     * @brief Разбор принятых данных и вызов обработчиков для всех
+     * полностью принятых запросов.
+     *
+     * @param client Подключение
+     */
+    void Process(Client &client) noexcept;
+
+    /**
+     * @brief Вызов обработчика запроса.
+     *
+     * @param client Подключение
+     * @param req Запрос libevent без подключения
+     * @param keep_alive Признак постоянного подключения
+     */
+    void Dispatch(Client &client,
+                  evhttp_request *req,
+                  bool keep_alive) noexcept;
+
+    /**
+     * @brief Формирование ответа в выходном буфере текущего подключения.
+     * Функция передачи ответа для ResponseImpl.
+     *
+     * @param req Запрос с заголовками ответа
+     * @param code Код ответа
+     * @param body Тело ответа
+     */
+    void Reply(evhttp_request *req, int code, evbuffer *body) noexcept;
+
+    /**
+     * @brief Формирование ответа с ошибкой разбора запроса и закрытие
+     * подключения.
+     *
+     * @param client Подключение
+     * @param code Код ответа
+     */
+    static void Reject(Client &client, int code) noexcept;
+
+    /**
+     * @brief Отправка накопленных ответов подключений, изменённых при
+     * обработке завершений.
+     */
+    void Flush() noexcept;
+
+    /**
+     * @brief Закрытие подключения, если ответы отправлены.
+     *
+     * @param id Идентификатор подключения
+     * @param client Подключение
+     */
+    void Check(uint64_t id, Client &client) noexcept;
+
+    /**
+     * @brief Запрос значения заголовка Date для текущего времени.
+     *
+     * @return Значение заголовка
+     */
+    const std::string &Date() noexcept;
+
+    /**
+     * @brief Буферы для чтения, предоставленные ядру.
+     */
+    std::vector<char> buffers_;
+
+    /**
+     * @brief Очередь io_uring.
+     */
+    Ring ring_;
+
+    /**
+     * @brief Сокет для приёма подключений.
+     */
+    int socket_{-1};
+
+    /**
+     * @brief Признак владения сокетом (главный сервер).
+     */
+    bool owner_{false};
+
+    /**
+     * @brief Событие для сигнала завершения потока.
+     */
+    int wakeup_{-1};
+
+    /**
+     * @brief Значение, прочитанное из события завершения.
+     */
+    uint64_t wakeup_value_{0};
+
+    /**
+     * @brief Подключения клиентов.
+     */
+    std::unordered_map<uint64_t, Client> clients_;
+
+    /**
+     * @brief Идентификатор следующего подключения.
+     */
+    uint64_t next_id_{1};
+
+    /**
+     * @brief Подключения с ответами для отправки.
+     */
+    std::vector<uint64_t> dirty_;
+
+    /**
+     * @brief Подключение, для которого вызван обработчик.
+     */
+    Client *current_{nullptr};
+
+    /**
+     * @brief Признак постоянного подключения для текущего запроса.
+     */
+    bool keep_alive_{true};
+
+    /**
+     * @brief Секунда, для которой сформирован заголовок Date.
+     */
+    time_t date_time_{0};
+
+    /**
+     * @brief Значение заголовка Date.
+     */
+    std::string date_;
+
+    /**
+     * @brief Максимальный размер данных запроса в байтах.
+     */
+    size_t max_body_size_;
+
+    /**
+     * @brief Функция формирующая запрос.
+     */
+    ev::Dispatcher func_;
+
+    /**
+     * @brief Контроль зависших обработчиков.
+     */
+    ev::Watchdog *watchdog_;
+
+    /**
+     * @brief Ячейка контроля зависших обработчиков потока сервера.
+     */
+    ev::Watchdog::Slot *slot_{nullptr};
+
+    /**
+     * @brief Поток сервера.
+     */
+    std::thread thread_;
+};
+
+}  // namespace tasp::uring
+
+#endif  // TASP_URING_SERVER_HPP_
@@ -0,0 +1,249 @@
+#include "watchdog.hpp"
+
+#include <execinfo.h>
+#include <signal.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <tasp/logging.hpp>
+
+using std::string;
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+
+namespace tasp::ev
+{
+
+namespace
+{
+/**
+ * @brief Ячейка контроля текущего потока.
+ */
+thread_local Watchdog::Slot *current{nullptr};
+
+/**
+ * @brief Ячейка, для потока которой снимается стек вызовов.
+ */
+std::atomic<Watchdog::Slot *> target{nullptr};
+
+/**
+ * @brief Время ожидания снятия стека вызовов.
+ */
+constexpr milliseconds capture_timeout{100};
+
+//------------------------------------------------------------------------------
+int CaptureSignal() noexcept
+{
+    return SIGRTMIN + 1;
+}
+
+//------------------------------------------------------------------------------
+int64_t Now() noexcept
+{
+    return duration_cast<nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+//------------------------------------------------------------------------------
+void Capture(int) noexcept
+{
+    auto *slot{target.load(std::memory_order_acquire)};
+    if (slot == nullptr || pthread_equal(slot->thread, pthread_self()) == 0)
+    {
+        return;
+    }
+
+    slot->depth = backtrace(slot->frames.data(), Watchdog::max_frames);
+    slot->captured.store(true, std::memory_order_release);
+}
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    Watchdog::Scope
+------------------------------------------------------------------------------*/
+Watchdog::Scope::Scope(const string &route) noexcept
+: slot_(current)
+{
+    if (slot_ != nullptr)
+    {
+        outer_start_ = slot_->start.load(std::memory_order_relaxed);
+        outer_route_ = slot_->route.load(std::memory_order_relaxed);
+
+        slot_->route.store(&route, std::memory_order_relaxed);
+        slot_->start.store(Now(), std::memory_order_release);
+    }
+}
+
+//------------------------------------------------------------------------------
+Watchdog::Scope::~Scope() noexcept
+{
+    if (slot_ != nullptr)
+    {
+        slot_->route.store(outer_route_, std::memory_order_relaxed);
+        slot_->start.store(outer_start_, std::memory_order_release);
+    }
+}
+
+/*------------------------------------------------------------------------------
+    Watchdog
+------------------------------------------------------------------------------*/
+Watchdog::Watchdog(milliseconds threshold) noexcept
+: threshold_(threshold)
+{
+    // первый вызов backtrace загружает библиотеку раскрутки стека, что
+    // недопустимо в обработчике сигнала
+    std::array<void *, 1> frames{};
+    backtrace(frames.data(), static_cast<int>(frames.size()));
+
+    struct sigaction action
+    {
+    };
+    action.sa_handler = &Capture;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(CaptureSignal(), &action, nullptr);
+
+    thread_ = std::thread(&Watchdog::Run, this);
+}
+
+//------------------------------------------------------------------------------
+Watchdog::~Watchdog() noexcept
+{
+    {
+        const std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+
+    thread_.join();
+}
+
+//------------------------------------------------------------------------------
+Watchdog::Slot *Watchdog::Register() noexcept
+{
+    const std::lock_guard lock(mutex_);
+    return &slots_.emplace_back();
+}
+
+//------------------------------------------------------------------------------
+void Watchdog::Unregister(Slot *slot) noexcept
+{
+    std::unique_lock lock(mutex_);
+    stop_cv_.wait(lock,
+                  [this, slot]
+                  {
+                      return reporting_ != slot;
+                  });
+
+    slots_.remove_if(
+        [slot](const Slot &item)
+        {
+            return &item == slot;
+        });
+}
+
+//------------------------------------------------------------------------------
+void Watchdog::Bind(Slot *slot) noexcept
+{
+    current = slot;
+
+    if (slot != nullptr)
+    {
+        slot->thread = pthread_self();
+        slot->bound.store(true, std::memory_order_release);
+    }
+}
+
+//------------------------------------------------------------------------------
+void Watchdog::Run() noexcept
+{
+    const auto period{std::clamp(duration_cast<milliseconds>(threshold_ / 4),
+                                 milliseconds(10),
+                                 milliseconds(1000))};
+
+    std::unique_lock lock(mutex_);
+    while (!stop_cv_.wait_for(lock,
+                              period,
+                              [this]
+                              {
+                                  return stop_;
+                              }))
+    {
+        const auto now{Now()};
+
+        for (auto &slot : slots_)
+        {
+            const auto start{slot.start.load(std::memory_order_acquire)};
+            if (start == 0 || start == slot.reported ||
+                nanoseconds(now - start) < threshold_ ||
+                !slot.bound.load(std::memory_order_acquire))
+            {
+                continue;
+            }
+
+            slot.reported = start;
+            slot.stalls.fetch_add(1, std::memory_order_relaxed);
+
+            // снятие стека ожидает ответа потока, поэтому выполняется без
+            // блокировки регистрации ячеек
+            reporting_ = &slot;
+            lock.unlock();
+
+            Report(slot, nanoseconds(now - start));
+
+            lock.lock();
+            reporting_ = nullptr;
+            stop_cv_.notify_all();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void Watchdog::Report(Slot &slot, nanoseconds elapsed) noexcept
+{
+    const auto *route{slot.route.load(std::memory_order_relaxed)};
+    const string path{route != nullptr ? *route : string{}};
+
+    slot.captured.store(false, std::memory_order_relaxed);
+    target.store(&slot, std::memory_order_release);
+
+    string stack;
+    if (pthread_kill(slot.thread, CaptureSignal()) == 0)
+    {
+        const auto deadline{std::chrono::steady_clock::now() +
+                            capture_timeout};
+        while (!slot.captured.load(std::memory_order_acquire) &&
+               std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+    }
+
+    target.store(nullptr, std::memory_order_release);
+
+    if (slot.captured.load(std::memory_order_acquire))
+    {
+        char **symbols{backtrace_symbols(slot.frames.data(), slot.depth)};
+        for (int i = 0; symbols != nullptr && i < slot.depth; i++)
+        {
+            stack.append("\n  ").append(symbols[i]);  // NOLINT
+        }
+        free(symbols);  // NOLINT(cppcoreguidelines-no-malloc)
+    }
+    else
+    {
+        stack = " недоступен";
+    }
+
+    Logging::Warning(
+        "Обработчик {} выполняется {} мс, стек вызовов потока:{}",
+        path,
+        duration_cast<milliseconds>(elapsed).count(),
+        stack);
+}
+
+}  // namespace tasp::ev
@@ -0,0 +1,230 @@
+/**
+ * @file
+ * @brief Контроль зависших обработчиков запросов.
+ */
+#ifndef TASP_WATCHDOG_HPP_
+#define TASP_WATCHDOG_HPP_
+
+#include <pthread.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace tasp::ev
+{
+
+/**
+ * @brief Контроль времени выполнения обработчиков запросов.
+ *
+ * Каждый поток обработки событий получает ячейку, в которую при вызове
+ * обработчика записываются время начала и путь запроса. Отдельный поток
+ * периодически просматривает ячейки и при превышении порога выводит в журнал
+ * путь, время выполнения и стек вызовов зависшего потока. Стек снимается в
+ * обработчике сигнала, отправленного зависшему потоку.
+ */
+class Watchdog final
+{
+public:
+    /**
+     * @brief Максимальная глубина снимаемого стека вызовов.
+     */
+    static constexpr size_t max_frames{64};
+
+    /**
+     * @brief Ячейка контроля потока обработки событий.
+     */
+    struct Slot
+    {
+        /**
+         * @brief Время начала выполнения обработчика в наносекундах
+         * монотонных часов. 0 - обработчик не выполняется.
+         */
+        std::atomic<int64_t> start{0};
+
+        /**
+         * @brief Путь выполняемого обработчика.
+         */
+        std::atomic<const std::string *> route{nullptr};
+
+        /**
+         * @brief Количество зависаний обработчиков.
+         */
+        std::atomic<uint64_t> stalls{0};
+
+        /**
+         * @brief Поток обработки событий.
+         */
+        pthread_t thread{};
+
+        /**
+         * @brief Признак привязки к потоку.
+         */
+        std::atomic<bool> bound{false};
+
+        /**
+         * @brief Время начала последнего зависания, выведенного в журнал.
+         */
+        int64_t reported{0};
+
+        /**
+         * @brief Стек вызовов, снятый в обработчике сигнала.
+         */
+        std::array<void *, max_frames> frames{};
+
+        /**
+         * @brief Глубина снятого стека вызовов.
+         */
+        int depth{0};
+
+        /**
+         * @brief Признак завершения снятия стека вызовов.
+         */
+        std::atomic<bool> captured{false};
+    };
+
+    /**
+     * @brief Отметка выполнения обработчика в текущем потоке на время
+     * существования объекта.
+     *
+     * Отметки вкладываются: вложенный обработчик, например запрос пакета,
+     * контролируется под своим путём, а после его завершения возобновляется
+     * контроль внешнего обработчика с исходными временем начала и путём.
+     */
+    class Scope final
+    {
+    public:
+        /**
+         * @brief Конструктор.
+         *
+         * @param route Путь обработчика
+         */
+        explicit Scope(const std::string &route) noexcept;
+
+        /**
+         * @brief Деструктор.
+         */
+        ~Scope() noexcept;
+
+        Scope(const Scope &) = delete;
+        Scope(Scope &&) = delete;
+        Scope &operator=(const Scope &) = delete;
+        Scope &operator=(Scope &&) = delete;
+
+    private:
+        /**
+         * @brief Ячейка текущего потока.
+         */
+        Slot *slot_;
+
+        /**
+         * @brief Время начала внешнего обработчика.
+         */
+        int64_t outer_start_{0};
+
+        /**
+         * @brief Путь внешнего обработчика.
+         */
+        const std::string *outer_route_{nullptr};
+    };
+
+    /**
+     * @brief Конструктор. Запускает поток контроля.
+     *
+     * @param threshold Порог времени выполнения обработчика
+     */
+    explicit Watchdog(std::chrono::milliseconds threshold) noexcept;
+
+    /**
+     * @brief Деструктор. Останавливает поток контроля.
+     */
+    ~Watchdog() noexcept;
+
+    /**
+     * @brief Создание ячейки для потока обработки событий.
+     *
+     * @return Ячейка
+     */
+    [[nodiscard]] Slot *Register() noexcept;
+
+    /**
+     * @brief Удаление ячейки. Вызывается после завершения потока.
+     *
+     * @param slot Ячейка
+     */
+    void Unregister(Slot *slot) noexcept;
+
+    /**
+     * @brief Привязка ячейки к текущему потоку.
+     *
+     * @param slot Ячейка. Допускается пустой указатель.
+     */
+    static void Bind(Slot *slot) noexcept;
+
+    Watchdog(const Watchdog &) = delete;
+    Watchdog(Watchdog &&) = delete;
+    Watchdog &operator=(const Watchdog &) = delete;
+    Watchdog &operator=(Watchdog &&) = delete;
+
+private:
+    /**
+     * @brief Функция потока контроля.
+     */
+    void Run() noexcept;
+
+    /**
+     * @brief Вывод в журнал сведений о зависшем обработчике. Вызывается без
+     * блокировки: ячейка защищена от удаления признаком reporting_.
+     *
+     * @param slot Ячейка зависшего потока
+     * @param elapsed Время выполнения обработчика
+     */
+    static void Report(Slot &slot, std::chrono::nanoseconds elapsed) noexcept;
+
+    /**
+     * @brief Порог времени выполнения обработчика.
+     */
+    std::chrono::nanoseconds threshold_;
+
+    /**
+     * @brief Ячейки потоков обработки событий.
+     */
+    std::list<Slot> slots_;
+
+    /**
+     * @brief Синхронизация доступа к ячейкам и остановки потока.
+     */
+    std::mutex mutex_;
+
+    /**
+     * @brief Уведомление об остановке потока и о завершении вывода сведений
+     * о зависании.
+     */
+    std::condition_variable stop_cv_;
+
+    /**
+     * @brief Признак остановки потока.
+     */
+    bool stop_{false};
+
+    /**
+     * @brief Ячейка, сведения о зависании которой выводятся в журнал.
+     * Удаление такой ячейки ожидает завершения вывода.
+     */
+    Slot *reporting_{nullptr};
+
+    /**
+     * @brief Поток контроля.
+     */
+    std::thread thread_;
+};
+
+}  // namespace tasp::ev
+
+#endif  // TASP_WATCHDOG_HPP_
@@ -0,0 +1,346 @@
+#include "worker_pool.hpp"
+
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#include <tasp/logging.hpp>
+
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+using std::chrono::seconds;
+
+namespace tasp::ev
+{
+
+namespace
+{
+/**
+ * @brief Показатели текущего рабочего процесса.
+ */
+WorkerPool::Stats *current{nullptr};
+
+/**
+ * @brief Период проверки рабочих процессов.
+ */
+constexpr milliseconds check_interval{100};
+
+/**
+ * @brief Минимальный интервал между порождениями процесса. Процесс,
+ * завершившийся раньше, перезапускается с задержкой.
+ */
+constexpr seconds restart_delay{1};
+
+/**
+ * @brief Время ожидания завершения процессов по сигналу SIGTERM.
+ */
+constexpr seconds stop_timeout{5};
+
+}  // namespace
+
+/*------------------------------------------------------------------------------
+    WorkerPool
+------------------------------------------------------------------------------*/
+WorkerPool::WorkerPool(size_t count, Runner runner) noexcept
+: count_(count)
+, runner_(runner)
+, spawned_(count)
+{
+    void *memory{mmap(nullptr,
+                      sizeof(Stats) * count_,
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS,
+                      -1,
+                      0)};
+    if (memory == MAP_FAILED)
+    {
+        Logging::Error("Ошибка выделения общей памяти для рабочих процессов: "
+                       "{}",
+                       std::strerror(errno));
+        count_ = 0;
+        return;
+    }
+
+    stats_ = new (memory) Stats[count_];
+}
+
+//------------------------------------------------------------------------------
+WorkerPool::~WorkerPool() noexcept
+{
+    Stop();
+
+    if (stats_ != nullptr)
+    {
+        munmap(stats_, sizeof(Stats) * count_);
+    }
+}
+
+//------------------------------------------------------------------------------
+void WorkerPool::Start() noexcept
+{
+    if (supervisor_ > 0 || count_ == 0)
+    {
+        return;
+    }
+
+    const pid_t parent{getpid()};
+    const pid_t pid{fork()};
+    if (pid < 0)
+    {
+        Logging::Error("Ошибка порождения процесса надзора рабочих процессов: "
+                       "{}",
+                       std::strerror(errno));
+        return;
+    }
+
+    if (pid == 0)
+    {
+        // процесс надзора завершается вместе с сервисом
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        if (getppid() != parent)
+        {
+            _exit(0);
+        }
+
+        Supervise();
+    }
+
+    supervisor_ = pid;
+    Logging::Info("Запущен процесс надзора рабочих процессов (pid {})", pid);
+}
+
+//------------------------------------------------------------------------------
+void WorkerPool::Stop() noexcept
+{
+    if (supervisor_ <= 0)
+    {
+        return;
+    }
+
+    kill(supervisor_, SIGTERM);
+
+    // процесс надзора ожидает завершения рабочих процессов не дольше
+    // stop_timeout
+    const auto deadline{Clock::now() + stop_timeout + seconds(1)};
+    while (waitpid(supervisor_, nullptr, WNOHANG) == 0)
+    {
+        if (Clock::now() >= deadline)
+        {
+            Logging::Warning("Процесс надзора (pid {}) не завершился, "
+                             "отправлен сигнал SIGKILL",
+                             supervisor_);
+            kill(supervisor_, SIGKILL);
+            waitpid(supervisor_, nullptr, 0);
+
+            // рабочие процессы, оставшиеся без процесса надзора
+            for (size_t i = 0; i < count_; i++)
+            {
+                const pid_t pid{stats_[i].pid.load()};
+                if (pid > 0)
+                {
+                    kill(pid, SIGKILL);
+                }
+            }
+            break;
+        }
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+
+    for (size_t i = 0; i < count_; i++)
+    {
+        stats_[i].pid.store(0);
+    }
+
+    supervisor_ = 0;
+}
+
+//------------------------------------------------------------------------------
+size_t WorkerPool::Size() const noexcept
+{
+    return count_;
+}
+
+//------------------------------------------------------------------------------
+const WorkerPool::Stats &WorkerPool::Get(size_t index) const noexcept
+{
+    return stats_[index];
+}
+
+//------------------------------------------------------------------------------
+WorkerPool::Stats *WorkerPool::Current() noexcept
+{
+    return current;
+}
+
+//------------------------------------------------------------------------------
+void WorkerPool::Spawn(size_t index) noexcept
+{
+    auto &stats{stats_[index]};
+    spawned_[index] = Clock::now();
+
+    const pid_t parent{getpid()};
+    const pid_t pid{fork()};
+    if (pid < 0)
+    {
+        Logging::Error("Ошибка порождения рабочего процесса {}: {}",
+                       index,
+                       std::strerror(errno));
+        return;
+    }
+
+    if (pid == 0)
+    {
+        // рабочий процесс завершается вместе с родительским
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        if (getppid() != parent)
+        {
+            _exit(0);
+        }
+
+        // маска сигналов унаследована от процесса надзора, обработчики - от
+        // сервиса
+        sigset_t signals;
+        sigemptyset(&signals);
+        pthread_sigmask(SIG_SETMASK, &signals, nullptr);
+        std::signal(SIGTERM, SIG_DFL);
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGHUP, SIG_DFL);
+
+        current = &stats;
+        runner_(index);
+        _exit(0);
+    }
+
+    stats.pid.store(pid);
+    Logging::Info("Запущен рабочий процесс {} (pid {})", index, pid);
+}
+
+//------------------------------------------------------------------------------
+void WorkerPool::Supervise() noexcept
+{
+    // сигналы принимаются sigtimedwait, обработчики сервиса не вызываются;
+    // SIGHUP обновления конфигурации обрабатывается сервисом
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGHUP);
+    sigaddset(&signals, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+
+    // при игнорировании SIGCHLD завершившиеся процессы не ожидаются waitpid
+    std::signal(SIGCHLD, SIG_DFL);
+
+    for (size_t i = 0; i < count_; i++)
+    {
+        Spawn(i);
+    }
+
+    const auto interval{duration_cast<nanoseconds>(check_interval).count()};
+    const timespec timeout{interval / 1000000000, interval % 1000000000};
+
+    while (true)
+    {
+        const int signal{sigtimedwait(&signals, nullptr, &timeout)};
+        if (signal == SIGTERM || signal == SIGINT)
+        {
+            break;
+        }
+
+        int status{0};
+        pid_t pid{0};
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+        {
+            for (size_t i = 0; i < count_; i++)
+            {
+                if (stats_[i].pid.load() != pid)
+                {
+                    continue;
+                }
+
+                stats_[i].pid.store(0);
+
+                if (WIFSIGNALED(status))
+                {
+                    Logging::Error("Рабочий процесс {} (pid {}) завершён "
+                                   "сигналом {}",
+                                   i,
+                                   pid,
+                                   WTERMSIG(status));
+                }
+                else
+                {
+                    Logging::Warning("Рабочий процесс {} (pid {}) завершён с "
+                                     "кодом {}",
+                                     i,
+                                     pid,
+                                     WEXITSTATUS(status));
+                }
+            }
+        }
+
+        for (size_t i = 0; i < count_; i++)
+        {
+            if (stats_[i].pid.load() > 0 ||
+                Clock::now() - spawned_[i] < restart_delay)
+            {
+                continue;
+            }
+
+            stats_[i].restarts++;
+            Spawn(i);
+        }
+    }
+
+    StopWorkers();
+    _exit(0);
+}
+
+//------------------------------------------------------------------------------
+void WorkerPool::StopWorkers() noexcept
+{
+    for (size_t i = 0; i < count_; i++)
+    {
+        const pid_t pid{stats_[i].pid.load()};
+        if (pid > 0)
+        {
+            kill(pid, SIGTERM);
+        }
+    }
+
+    const auto deadline{Clock::now() + stop_timeout};
+    for (size_t i = 0; i < count_; i++)
+    {
+        const pid_t pid{stats_[i].pid.load()};
+        if (pid <= 0)
+        {
+            continue;
+        }
+
+        while (waitpid(pid, nullptr, WNOHANG) == 0)
+        {
+            if (Clock::now() >= deadline)
+            {
+                Logging::Warning("Рабочий процесс {} (pid {}) не завершился, "
+                                 "отправлен сигнал SIGKILL",
+                                 i,
+                                 pid);
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+                break;
+            }
+            std::this_thread::sleep_for(milliseconds(10));
+        }
+
+        stats_[i].pid.store(0);
+    }
+}
+
+}  // namespace tasp::ev
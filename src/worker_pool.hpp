@@ -0,0 +1,202 @@
+/**
+ * @file
+ * @brief Обработка запросов в нескольких процессах.
+ */
+#ifndef TASP_WORKER_POOL_HPP_
+#define TASP_WORKER_POOL_HPP_
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include <tasp/function_ref.hpp>
+
+namespace tasp::ev
+{
+
+/**
+ * @brief Набор рабочих процессов, принимающих подключения на общем сокете.
+ *
+ * После регистрации обработчиков основной поток сервиса порождает вызовом
+ * fork однопоточный процесс надзора. Процесс надзора порождает рабочие
+ * процессы, которые выполняют функцию запуска до получения сигнала SIGTERM,
+ * и перезапускает завершившиеся. Поскольку fork вызывается только основным
+ * потоком и однопоточным процессом надзора, рабочие процессы не наследуют
+ * блокировки, захваченные другими потоками сервиса.
+ *
+ * Показатели процессов хранятся в общей памяти, отображённой до порождения
+ * процессов, и доступны сервису и каждому из процессов.
+ */
+class WorkerPool final
+{
+public:
+    /**
+     * @brief Показатели рабочего процесса в общей памяти.
+     */
+    struct Stats
+    {
+        /**
+         * @brief Идентификатор процесса. 0 - процесс не запущен.
+         */
+        std::atomic<pid_t> pid{0};
+
+        /**
+         * @brief Количество перезапусков процесса.
+         */
+        std::atomic<uint64_t> restarts{0};
+
+        /**
+         * @brief Количество обработанных запросов.
+         */
+        std::atomic<uint64_t> total_requests{0};
+
+        /**
+         * @brief Количество ответов с кодом 5xx.
+         */
+        std::atomic<uint64_t> errors{0};
+
+        /**
+         * @brief Количество запросов за последний интервал контроля цикла.
+         */
+        std::atomic<uint64_t> requests{0};
+
+        /**
+         * @brief Доля времени выполнения обработчиков за последний интервал.
+         */
+        std::atomic<double> utilization{0};
+
+        /**
+         * @brief Средняя задержка планирования в миллисекундах.
+         */
+        std::atomic<double> lag_avg{0};
+
+        /**
+         * @brief Максимальная задержка планирования в миллисекундах.
+         */
+        std::atomic<double> lag_max{0};
+
+        /**
+         * @brief Количество зависаний обработчиков.
+         */
+        std::atomic<uint64_t> stalls{0};
+    };
+
+    static_assert(std::atomic<double>::is_always_lock_free &&
+                      std::atomic<uint64_t>::is_always_lock_free,
+                  "Показатели в общей памяти требуют атомарных операций "
+                  "без блокировок");
+
+    /**
+     * @brief Функция рабочего процесса, принимает номер процесса. После
+     * возврата из функции процесс завершается.
+     */
+    using Runner = FunctionRef<void(size_t)>;
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param count Количество рабочих процессов
+     * @param runner Функция рабочего процесса
+     */
+    WorkerPool(size_t count, Runner runner) noexcept;
+
+    /**
+     * @brief Деструктор. Завершает рабочие процессы.
+     */
+    ~WorkerPool() noexcept;
+
+    /**
+     * @brief Порождение процесса надзора, который порождает рабочие процессы.
+     * Вызывается основным потоком сервиса.
+     */
+    void Start() noexcept;
+
+    /**
+     * @brief Завершение процесса надзора и рабочих процессов.
+     */
+    void Stop() noexcept;
+
+    /**
+     * @brief Запрос количества рабочих процессов.
+     *
+     * @return Количество процессов
+     */
+    [[nodiscard]] size_t Size() const noexcept;
+
+    /**
+     * @brief Запрос показателей рабочего процесса.
+     *
+     * @param index Номер процесса
+     *
+     * @return Показатели
+     */
+    [[nodiscard]] const Stats &Get(size_t index) const noexcept;
+
+    /**
+     * @brief Запрос показателей текущего рабочего процесса.
+     *
+     * @return Показатели или nullptr вне рабочего процесса
+     */
+    [[nodiscard]] static Stats *Current() noexcept;
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool(WorkerPool &&) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+    WorkerPool &operator=(WorkerPool &&) = delete;
+
+private:
+    /**
+     * @brief Часы для отсчёта времени жизни процессов.
+     */
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Порождение рабочего процесса.
+     *
+     * @param index Номер процесса
+     */
+    void Spawn(size_t index) noexcept;
+
+    /**
+     * @brief Функция процесса надзора: порождение и перезапуск рабочих
+     * процессов до получения сигнала SIGTERM.
+     */
+    [[noreturn]] void Supervise() noexcept;
+
+    /**
+     * @brief Завершение рабочих процессов сигналом SIGTERM с ожиданием, по
+     * истечении времени ожидания - сигналом SIGKILL.
+     */
+    void StopWorkers() noexcept;
+
+    /**
+     * @brief Показатели процессов в общей памяти.
+     */
+    Stats *stats_{nullptr};
+
+    /**
+     * @brief Количество рабочих процессов.
+     */
+    size_t count_;
+
+    /**
+     * @brief Функция рабочего процесса.
+     */
+    Runner runner_;
+
+    /**
+     * @brief Время порождения процессов.
+     */
+    std::vector<Clock::time_point> spawned_;
+
+    /**
+     * @brief Идентификатор процесса надзора. 0 - процесс не запущен.
+     */
+    pid_t supervisor_{0};
+};
+
+}  // namespace tasp::ev
+
+#endif  // TASP_WORKER_POOL_HPP_
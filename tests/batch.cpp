@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include <jsoncpp/json/json.h>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "batch.hpp"
+#include "common.hpp"
+
+using std::string;
+using std::vector;
+
+using tasp::HandlerRef;
+using tasp::ev::Batch;
+using tasp::ev::Dispatcher;
+using tasp::ev::HandlerImpl;
+using tasp::http::Request;
+using tasp::http::RequestImpl;
+using tasp::http::Response;
+using tasp::http::ResponseImpl;
+using tasp::test::Fetch;
+using tasp::test::Reply;
+using tasp::test::Server;
+
+namespace
+{
+/**
+ * @brief Сервер с обработчиком пакетов запросов.
+ */
+class BatchTest : public testing::Test
+{
+protected:
+    /**
+     * @brief Запуск сервера.
+     */
+    void SetUp() override
+    {
+        Batch::Settings settings;
+        settings.enabled = true;
+        settings.max_requests = 3;
+
+        batch_ = std::make_unique<Batch>(
+            settings, "/api/batch", Dispatcher::Bind<&BatchTest::Item>(this));
+
+        vector<HandlerImpl> handlers;
+        handlers.emplace_back(Request::Method::Post,
+                              "/api/batch",
+                              HandlerRef::Bind<&Batch::Exec>(batch_.get()));
+        server_ = std::make_unique<Server>(std::move(handlers));
+    }
+
+    /**
+     * @brief Остановка сервера.
+     */
+    void TearDown() override
+    {
+        server_.reset();
+        batch_.reset();
+    }
+
+    /**
+     * @brief Передача пакета запросов.
+     *
+     * @param body Тело пакета
+     *
+     * @return Ответ
+     */
+    [[nodiscard]] Reply Send(const string &body) const
+    {
+        return Fetch(server_->Port(),
+                     "POST",
+                     "/api/batch",
+                     {{"Content-Type", "application/json"}},
+                     body);
+    }
+
+private:
+    /**
+     * @brief Обработка запроса пакета: ответ содержит путь запроса.
+     *
+     * @param request Запрос
+     * @param response Ответ
+     */
+    void Item(RequestImpl &request, ResponseImpl &response) noexcept
+    {
+        response.Data()->Set(string{evhttp_uri_get_path(
+            evhttp_request_get_evhttp_uri(request.Native()))});
+    }
+
+    /**
+     * @brief Пакетная обработка запросов.
+     */
+    std::unique_ptr<Batch> batch_;
+
+    /**
+     * @brief Сервер.
+     */
+    std::unique_ptr<Server> server_;
+};
+
+/**
+ * @brief Разбор ответа в формате JSON.
+ *
+ * @param reply Ответ
+ *
+ * @return Данные ответа
+ */
+Json::Value Parse(const Reply &reply)
+{
+    Json::Value value;
+    std::istringstream input{reply.body};
+    Json::parseFromStream(Json::CharReaderBuilder{}, input, &value, nullptr);
+    return value;
+}
+
+//------------------------------------------------------------------------------
+TEST_F(BatchTest, Items)
+{
+    const auto reply{Send(R"([{"path": "/api/a"}, {"path": "/api/b"}])")};
+    ASSERT_EQ(reply.status, 200);
+
+    const auto results{Parse(reply)};
+    ASSERT_TRUE(results.isArray());
+    ASSERT_EQ(results.size(), 2U);
+    EXPECT_EQ(results[0]["status"].asInt(), 200);
+    EXPECT_EQ(results[0]["body"].asString(), "/api/a");
+    EXPECT_EQ(results[1]["body"].asString(), "/api/b");
+}
+
+//------------------------------------------------------------------------------
+TEST_F(BatchTest, RejectsNonArray)
+{
+    EXPECT_EQ(Send(R"({"path": "/api/a"})").status, 400);
+    EXPECT_EQ(Send("not json").status, 400);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(BatchTest, RejectsTooManyItems)
+{
+    EXPECT_EQ(Send(R"([{"path": "/a"}, {"path": "/b"}, {"path": "/c"},
+                       {"path": "/d"}])")
+                  .status,
+              413);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(BatchTest, RejectsInvalidItems)
+{
+    const auto reply{Send(R"([1,
+                             {"method": {}, "path": "/api/a"},
+                             {"path": "/api/a", "headers": {"a": []}}])")};
+    ASSERT_EQ(reply.status, 200);
+
+    // некорректный запрос пакета не прерывает обработку остальных
+    const auto results{Parse(reply)};
+    ASSERT_EQ(results.size(), 3U);
+    for (const auto &result : results)
+    {
+        EXPECT_EQ(result["status"].asInt(), 400);
+        EXPECT_TRUE(result["body"].isObject());
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(BatchTest, RejectsUnknownMethod)
+{
+    const auto reply{
+        Send(R"([{"method": "BREW", "path": "/api/a"}, {"path": "/api/b"}])")};
+    ASSERT_EQ(reply.status, 200);
+
+    const auto results{Parse(reply)};
+    ASSERT_EQ(results.size(), 2U);
+    EXPECT_EQ(results[0]["status"].asInt(), 501);
+    EXPECT_EQ(results[1]["status"].asInt(), 200);
+}
+
+}  // namespace
@@ -0,0 +1,294 @@
+/**
+ * @file
+ * @brief Общие функции тестов.
+ */
+#ifndef TASP_TESTS_COMMON_HPP_
+#define TASP_TESTS_COMMON_HPP_
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "connection.hpp"
+#include "http/request_impl.hpp"
+#include "http/response_impl.hpp"
+
+namespace tasp::test
+{
+
+/**
+ * @brief Ответ HTTP, полученный тестовым клиентом.
+ */
+struct Reply
+{
+    /**
+     * @brief Код ответа, 0 - ответ не получен.
+     */
+    int status{0};
+
+    /**
+     * @brief Заголовки ответа.
+     */
+    std::vector<std::pair<std::string, std::string>> headers;
+
+    /**
+     * @brief Тело ответа.
+     */
+    std::string body;
+
+    /**
+     * @brief Поиск заголовка ответа без учёта регистра имени.
+     *
+     * @param name Имя заголовка
+     *
+     * @return Значение заголовка, пустая строка - заголовок отсутствует
+     */
+    [[nodiscard]] std::string Header(std::string_view name) const
+    {
+        for (const auto &[key, value] : headers)
+        {
+            if (key.size() == name.size() &&
+                strncasecmp(key.data(), name.data(), name.size()) == 0)
+            {
+                return value;
+            }
+        }
+        return {};
+    }
+};
+
+/**
+ * @brief Выполнение запроса HTTP/1.1 через отдельное подключение к адресу
+ * 127.0.0.1. Подключение закрывается сервером после ответа.
+ *
+ * @param port Порт сервера
+ * @param method Метод
+ * @param target Путь и параметры запроса
+ * @param headers Заголовки запроса
+ * @param body Тело запроса
+ *
+ * @return Ответ
+ */
+inline Reply Fetch(uint16_t port,
+                   std::string_view method,
+                   std::string_view target,
+                   const std::vector<std::pair<std::string, std::string>>
+                       &headers = {},
+                   std::string_view body = {})
+{
+    Reply reply;
+
+    const int fd{socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    // зависший сервер не должен останавливать выполнение тестов
+    const timeval timeout{5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) !=
+        0)
+    {
+        close(fd);
+        return reply;
+    }
+
+    std::string text{method};
+    text.append(" ").append(target).append(" HTTP/1.1\r\n");
+    text.append("Host: 127.0.0.1\r\nConnection: close\r\n");
+    for (const auto &[name, value] : headers)
+    {
+        text.append(name).append(": ").append(value).append("\r\n");
+    }
+    if (!body.empty())
+    {
+        text.append("Content-Length: ")
+            .append(std::to_string(body.size()))
+            .append("\r\n");
+    }
+    text.append("\r\n").append(body);
+
+    for (size_t sent = 0; sent < text.size();)
+    {
+        const auto res{send(fd, text.data() + sent, text.size() - sent, 0)};
+        if (res <= 0)
+        {
+            break;
+        }
+        sent += static_cast<size_t>(res);
+    }
+
+    std::string input;
+    std::array<char, 4096> buffer{};
+    while (true)
+    {
+        const auto res{recv(fd, buffer.data(), buffer.size(), 0)};
+        if (res <= 0)
+        {
+            break;
+        }
+        input.append(buffer.data(), static_cast<size_t>(res));
+    }
+    close(fd);
+
+    const auto head_end{input.find("\r\n\r\n")};
+    if (input.compare(0, 5, "HTTP/") != 0 || head_end == std::string::npos)
+    {
+        return reply;
+    }
+
+    std::string_view head{input.data(), head_end};
+    const auto line_end{head.find("\r\n")};
+    const auto status_begin{head.find(' ') + 1};
+    reply.status = std::atoi(std::string{head.substr(status_begin, 3)}.c_str());
+
+    head.remove_prefix(line_end == std::string_view::npos ? head.size()
+                                                          : line_end + 2);
+    while (!head.empty())
+    {
+        const auto end{head.find("\r\n")};
+        const auto line{head.substr(0, end)};
+        const auto colon{line.find(':')};
+        if (colon != std::string_view::npos)
+        {
+            auto value{line.substr(colon + 1)};
+            while (!value.empty() && value.front() == ' ')
+            {
+                value.remove_prefix(1);
+            }
+            reply.headers.emplace_back(line.substr(0, colon), value);
+        }
+        head.remove_prefix(end == std::string_view::npos ? head.size()
+                                                         : end + 2);
+    }
+
+    reply.body = input.substr(head_end + 4);
+    return reply;
+}
+
+/**
+ * @brief HTTP-сервер libevent с обработчиками для тестов. Циклы обработки
+ * событий используют общий сокет на адресе 127.0.0.1, порт выбирается
+ * системой. Запросы распределяются по методу и URL-пути без параметров.
+ */
+class Server final
+{
+public:
+    /**
+     * @brief Конструктор.
+     *
+     * @param handlers Обработчики запросов
+     * @param loops Количество циклов обработки событий
+     * @param options Параметры подключений
+     */
+    explicit Server(std::vector<ev::HandlerImpl> handlers,
+                    size_t loops = 1,
+                    ev::ConnectionOptions options = {})
+    : handlers_(std::move(handlers))
+    {
+        const auto func{ev::Dispatcher::Bind<&Server::Dispatch>(this)};
+
+        pool_.push_back(
+            std::make_unique<ev::Connection>("127.0.0.1", 0, options, func));
+        for (size_t i = 1; i < loops; i++)
+        {
+            options.id = i;
+            pool_.push_back(std::make_unique<ev::Connection>(
+                pool_.front()->GetSocket(), options, func));
+        }
+
+        sockaddr_in addr{};
+        socklen_t addr_len{sizeof(addr)};
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        getsockname(pool_.front()->GetSocket(),
+                    reinterpret_cast<sockaddr *>(&addr),
+                    &addr_len);
+        port_ = ntohs(addr.sin_port);
+    }
+
+    /**
+     * @brief Деструктор. Останавливает циклы обработки событий.
+     */
+    ~Server()
+    {
+        for (const auto &connection : pool_)
+        {
+            connection->Stop();
+        }
+        pool_.clear();
+    }
+
+    /**
+     * @brief Запрос порта сервера.
+     *
+     * @return Порт
+     */
+    [[nodiscard]] uint16_t Port() const
+    {
+        return port_;
+    }
+
+    Server(const Server &) = delete;
+    Server(Server &&) = delete;
+    Server &operator=(const Server &) = delete;
+    Server &operator=(Server &&) = delete;
+
+private:
+    /**
+     * @brief Распределение запроса по обработчикам.
+     *
+     * @param request Запрос
+     * @param response Ответ
+     */
+    void Dispatch(http::RequestImpl &request,
+                  http::ResponseImpl &response) noexcept
+    {
+        const char *path{evhttp_uri_get_path(
+            evhttp_request_get_evhttp_uri(request.Native()))};
+
+        for (auto &handler : handlers_)
+        {
+            if (handler.Method() == request.GetMethod() &&
+                handler.Path() == path)
+            {
+                handler.Exec(request, response);
+                return;
+            }
+        }
+
+        response.SetCode(http::Response::Code::NotFound);
+    }
+
+    /**
+     * @brief Обработчики запросов.
+     */
+    std::vector<ev::HandlerImpl> handlers_;
+
+    /**
+     * @brief Циклы обработки событий.
+     */
+    std::vector<std::unique_ptr<ev::Connection>> pool_;
+
+    /**
+     * @brief Порт сервера.
+     */
+    uint16_t port_{0};
+};
+
+}  // namespace tasp::test
+
+#endif  // TASP_TESTS_COMMON_HPP_
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+
+using std::string;
+using std::vector;
+
+using tasp::HandlerOptions;
+using tasp::ev::HandlerImpl;
+using tasp::http::Request;
+using tasp::http::Response;
+using tasp::test::Fetch;
+using tasp::test::Server;
+
+namespace
+{
+/**
+ * @brief Сервер с обработчиком, формирующим ETag.
+ *
+ * @param calls Счётчик вызовов обработчика
+ * @param options Параметры обработчика
+ *
+ * @return Обработчики
+ */
+vector<HandlerImpl> Handlers(std::atomic<int> &calls, HandlerOptions options)
+{
+    options.etag = true;
+
+    vector<HandlerImpl> handlers;
+    handlers.emplace_back(Request::Method::Get,
+                          "/api/item",
+                          [&calls](const Request &, Response &response)
+                          {
+                              calls++;
+                              response.Data()->Set(string{"item"});
+                          },
+                          options);
+    return handlers;
+}
+
+//------------------------------------------------------------------------------
+TEST(ETag, NotModified)
+{
+    std::atomic<int> calls{0};
+    const Server server(Handlers(calls, {}));
+
+    const auto full{Fetch(server.Port(), "GET", "/api/item")};
+    ASSERT_EQ(full.status, 200);
+    EXPECT_EQ(full.body, "item");
+
+    const string etag{full.Header("ETag")};
+    ASSERT_FALSE(etag.empty());
+    EXPECT_EQ(etag.front(), '"');
+
+    const auto same{
+        Fetch(server.Port(), "GET", "/api/item", {{"If-None-Match", etag}})};
+    EXPECT_EQ(same.status, 304);
+    EXPECT_TRUE(same.body.empty());
+    EXPECT_EQ(same.Header("ETag"), etag);
+
+    const auto list{Fetch(server.Port(),
+                          "GET",
+                          "/api/item",
+                          {{"If-None-Match", "\"other\", " + etag}})};
+    EXPECT_EQ(list.status, 304);
+
+    const auto other{Fetch(
+        server.Port(), "GET", "/api/item", {{"If-None-Match", "\"other\""}})};
+    EXPECT_EQ(other.status, 200);
+    EXPECT_EQ(other.body, "item");
+
+    EXPECT_EQ(calls, 4);
+}
+
+//------------------------------------------------------------------------------
+TEST(ETag, NotModifiedFromCache)
+{
+    std::atomic<int> calls{0};
+
+    HandlerOptions options;
+    options.cache.ttl = std::chrono::seconds(30);
+    const Server server(Handlers(calls, options));
+
+    const auto full{Fetch(server.Port(), "GET", "/api/item")};
+    ASSERT_EQ(full.status, 200);
+
+    const auto same{Fetch(server.Port(),
+                          "GET",
+                          "/api/item",
+                          {{"If-None-Match", full.Header("ETag")}})};
+    EXPECT_EQ(same.status, 304);
+    EXPECT_TRUE(same.body.empty());
+
+    EXPECT_EQ(calls, 1);
+}
+
+}  // namespace
@@ -0,0 +1,394 @@
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <nghttp2/nghttp2.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common.hpp"
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+using tasp::ev::ConnectionOptions;
+using tasp::ev::HandlerImpl;
+using tasp::http::Request;
+using tasp::http::Response;
+using tasp::test::Server;
+
+namespace
+{
+/**
+ * @brief Максимальный размер тела запроса сервера.
+ */
+constexpr size_t max_body_size{64 * 1024};
+
+/**
+ * @brief Клиент HTTP/2 без TLS (h2c с предварительным знанием), выполняющий
+ * один запрос через блокирующий сокет.
+ */
+class Client final
+{
+public:
+    /**
+     * @brief Результат запроса.
+     */
+    struct Result
+    {
+        /**
+         * @brief Код ответа, 0 - ответ не получен.
+         */
+        int status{0};
+
+        /**
+         * @brief Тело ответа.
+         */
+        string body;
+
+        /**
+         * @brief Признак закрытия потока запроса.
+         */
+        bool closed{false};
+    };
+
+    /**
+     * @brief Конструктор.
+     *
+     * @param port Порт сервера
+     */
+    explicit Client(uint16_t port)
+    : fd_(socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0))
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        connected_ = connect(fd_,
+                             reinterpret_cast<const sockaddr *>(&addr),
+                             sizeof(addr)) == 0;
+
+        // зависший сервер не должен останавливать выполнение тестов
+        const timeval timeout{5, 0};
+        setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        nghttp2_session_callbacks *callbacks{nullptr};
+        nghttp2_session_callbacks_new(&callbacks);
+        nghttp2_session_callbacks_set_send_callback(callbacks, OnSend);
+        nghttp2_session_callbacks_set_on_header_callback(callbacks, OnHeader);
+        nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks,
+                                                                  OnData);
+        nghttp2_session_callbacks_set_on_stream_close_callback(callbacks,
+                                                               OnClose);
+        nghttp2_session_client_new(&session_, callbacks, this);
+        nghttp2_session_callbacks_del(callbacks);
+
+        nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, nullptr, 0);
+    }
+
+    /**
+     * @brief Деструктор.
+     */
+    ~Client()
+    {
+        nghttp2_session_del(session_);
+        close(fd_);
+    }
+
+    /**
+     * @brief Выполнение запроса POST.
+     *
+     * @param path Путь запроса
+     * @param body Тело запроса
+     *
+     * @return Результат запроса
+     */
+    Result Post(string_view path, string body)
+    {
+        if (!connected_)
+        {
+            return result_;
+        }
+
+        body_ = std::move(body);
+        sent_ = 0;
+
+        const string length{std::to_string(body_.size())};
+        const std::array<nghttp2_nv, 5> headers{{
+            Header(":method", "POST"),
+            Header(":scheme", "http"),
+            Header(":authority", "127.0.0.1"),
+            Header(":path", path),
+            Header("content-length", length),
+        }};
+
+        nghttp2_data_provider provider{};
+        provider.read_callback = OnRead;
+
+        stream_id_ = nghttp2_submit_request(
+            session_, nullptr, headers.data(), headers.size(), &provider, this);
+
+        std::array<uint8_t, 16384> buffer{};
+        while (!result_.closed && nghttp2_session_send(session_) == 0)
+        {
+            const auto res{recv(fd_, buffer.data(), buffer.size(), 0)};
+            if (res <= 0 || nghttp2_session_mem_recv(
+                                session_,
+                                buffer.data(),
+                                static_cast<size_t>(res)) < 0)
+            {
+                break;
+            }
+        }
+
+        return result_;
+    }
+
+    Client(const Client &) = delete;
+    Client(Client &&) = delete;
+    Client &operator=(const Client &) = delete;
+    Client &operator=(Client &&) = delete;
+
+private:
+    /**
+     * @brief Формирование заголовка запроса.
+     *
+     * @param name Имя
+     * @param value Значение
+     *
+     * @return Заголовок
+     */
+    static nghttp2_nv Header(string_view name, string_view value)
+    {
+        // NOLINTBEGIN(cppcoreguidelines-pro-type-const-cast)
+        return {const_cast<uint8_t *>(
+                    reinterpret_cast<const uint8_t *>(name.data())),
+                const_cast<uint8_t *>(
+                    reinterpret_cast<const uint8_t *>(value.data())),
+                name.size(),
+                value.size(),
+                NGHTTP2_NV_FLAG_NONE};
+        // NOLINTEND(cppcoreguidelines-pro-type-const-cast)
+    }
+
+    /**
+     * @brief Функция обратного вызова передачи данных сессии.
+     */
+    static ssize_t OnSend(nghttp2_session *,
+                          const uint8_t *data,
+                          size_t length,
+                          int,
+                          void *user_data)
+    {
+        const auto *client{static_cast<Client *>(user_data)};
+        const auto res{send(client->fd_, data, length, MSG_NOSIGNAL)};
+        return res < 0 ? ssize_t{NGHTTP2_ERR_CALLBACK_FAILURE} : res;
+    }
+
+    /**
+     * @brief Функция чтения тела запроса.
+     */
+    static ssize_t OnRead(nghttp2_session *,
+                          int32_t,
+                          uint8_t *buf,
+                          size_t length,
+                          uint32_t *data_flags,
+                          nghttp2_data_source *,
+                          void *user_data)
+    {
+        auto *client{static_cast<Client *>(user_data)};
+
+        const size_t count{
+            std::min(length, client->body_.size() - client->sent_)};
+        client->body_.copy(reinterpret_cast<char *>(buf), count, client->sent_);
+        client->sent_ += count;
+
+        if (client->sent_ == client->body_.size())
+        {
+            *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+        }
+        return static_cast<ssize_t>(count);
+    }
+
+    /**
+     * @brief Функция обратного вызова приёма заголовка ответа.
+     */
+    static int OnHeader(nghttp2_session *,
+                        const nghttp2_frame *,
+                        const uint8_t *name,
+                        size_t namelen,
+                        const uint8_t *value,
+                        size_t valuelen,
+                        uint8_t,
+                        void *user_data)
+    {
+        auto *client{static_cast<Client *>(user_data)};
+
+        const string_view header{reinterpret_cast<const char *>(name),
+                                 namelen};
+        if (header == ":status")
+        {
+            client->result_.status = std::atoi(
+                string{reinterpret_cast<const char *>(value), valuelen}
+                    .c_str());
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Функция обратного вызова приёма данных ответа.
+     */
+    static int OnData(nghttp2_session *,
+                      uint8_t,
+                      int32_t stream_id,
+                      const uint8_t *data,
+                      size_t len,
+                      void *user_data)
+    {
+        auto *client{static_cast<Client *>(user_data)};
+        if (stream_id == client->stream_id_)
+        {
+            client->result_.body.append(reinterpret_cast<const char *>(data),
+                                        len);
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Функция обратного вызова закрытия потока.
+     */
+    static int OnClose(nghttp2_session *,
+                       int32_t stream_id,
+                       uint32_t,
+                       void *user_data)
+    {
+        auto *client{static_cast<Client *>(user_data)};
+        if (stream_id == client->stream_id_)
+        {
+            client->result_.closed = true;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Сокет подключения.
+     */
+    int fd_;
+
+    /**
+     * @brief Признак установки подключения.
+     */
+    bool connected_{false};
+
+    /**
+     * @brief Сессия HTTP/2.
+     */
+    nghttp2_session *session_{nullptr};
+
+    /**
+     * @brief Идентификатор потока запроса.
+     */
+    int32_t stream_id_{0};
+
+    /**
+     * @brief Тело запроса.
+     */
+    string body_;
+
+    /**
+     * @brief Количество переданных байт тела запроса.
+     */
+    size_t sent_{0};
+
+    /**
+     * @brief Результат запроса.
+     */
+    Result result_;
+};
+
+/**
+ * @brief Сервер HTTP/2 с обработчиком, возвращающим размер тела запроса.
+ */
+class Http2Test : public testing::Test
+{
+protected:
+    /**
+     * @brief Запуск сервера.
+     */
+    void SetUp() override
+    {
+        ConnectionOptions options;
+        options.max_body_size = max_body_size;
+        options.http2.enabled = true;
+
+        vector<HandlerImpl> handlers;
+        handlers.emplace_back(
+            Request::Method::Post,
+            "/api/upload",
+            [this](const Request &request, Response &response)
+            {
+                calls_++;
+                response.Data()->Set(std::to_string(
+                    request.Data()->Get<string>().size()));
+            },
+            tasp::HandlerOptions{});
+        server_ = std::make_unique<Server>(std::move(handlers), 1, options);
+    }
+
+    /**
+     * @brief Остановка сервера.
+     */
+    void TearDown() override
+    {
+        server_.reset();
+    }
+
+    /**
+     * @brief Количество вызовов обработчика.
+     */
+    std::atomic<int> calls_{0};
+
+    /**
+     * @brief Сервер.
+     */
+    std::unique_ptr<Server> server_;
+};
+
+//------------------------------------------------------------------------------
+TEST_F(Http2Test, Body)
+{
+    Client client(server_->Port());
+    const auto result{client.Post("/api/upload", string(1000, 'x'))};
+
+    EXPECT_TRUE(result.closed);
+    EXPECT_EQ(result.status, 200);
+    EXPECT_EQ(result.body, "1000");
+    EXPECT_EQ(calls_, 1);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Http2Test, PayloadTooLarge)
+{
+    // ответ передаётся до окончания передачи тела, после чего поток
+    // закрывается сервером
+    Client client(server_->Port());
+    const auto result{
+        client.Post("/api/upload", string(max_body_size * 4, 'x'))};
+
+    EXPECT_TRUE(result.closed);
+    EXPECT_EQ(result.status, 413);
+    EXPECT_EQ(calls_, 0);
+}
+
+}  // namespace
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common.hpp"
+
+using std::string;
+using std::vector;
+
+using tasp::HandlerOptions;
+using tasp::ev::HandlerImpl;
+using tasp::http::Request;
+using tasp::http::Response;
+using tasp::test::Fetch;
+using tasp::test::Reply;
+using tasp::test::Server;
+
+namespace
+{
+/**
+ * @brief Количество одновременных запросов.
+ */
+constexpr size_t clients{8};
+
+/**
+ * @brief Параметры кэширования: ожидание ответа первого запроса дольше
+ * времени работы обработчика.
+ *
+ * @return Параметры обработчика
+ */
+HandlerOptions CacheOptions()
+{
+    HandlerOptions options;
+    options.cache.ttl = std::chrono::seconds(30);
+    options.cache.wait = std::chrono::seconds(5);
+    return options;
+}
+
+/**
+ * @brief Одновременные запросы клиентов.
+ *
+ * @param port Порт сервера
+ * @param target Путь запроса
+ *
+ * @return Ответы
+ */
+vector<Reply> Burst(uint16_t port, const string &target)
+{
+    vector<Reply> replies(clients);
+    vector<std::thread> threads;
+    for (auto &reply : replies)
+    {
+        threads.emplace_back([&reply, port, &target]
+                             { reply = Fetch(port, "GET", target); });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    return replies;
+}
+
+//------------------------------------------------------------------------------
+TEST(ResponseCache, SingleFlight)
+{
+    std::atomic<int> calls{0};
+
+    vector<HandlerImpl> handlers;
+    handlers.emplace_back(
+        Request::Method::Get,
+        "/api/item",
+        [&calls](const Request &, Response &response)
+        {
+            calls++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            response.Header()->Set("Cache-Control", "max-age=5");
+            response.Data()->Set(string{"item"});
+        },
+        CacheOptions());
+
+    // запросы распределяются по нескольким циклам, ожидающие запросы
+    // получают ответ в своём цикле
+    const Server server(std::move(handlers), 4);
+
+    const auto replies{Burst(server.Port(), "/api/item")};
+
+    EXPECT_EQ(calls, 1);
+
+    std::set<string> traces;
+    for (const auto &reply : replies)
+    {
+        EXPECT_EQ(reply.status, 200);
+        EXPECT_EQ(reply.body, "item");
+        EXPECT_EQ(reply.Header("Cache-Control"), "max-age=5");
+        traces.insert(reply.Header("traceparent"));
+    }
+
+    // у ответа из кэша собственная трассировка
+    EXPECT_EQ(traces.size(), clients);
+
+    const auto cached{Fetch(server.Port(), "GET", "/api/item")};
+    EXPECT_EQ(cached.status, 200);
+    EXPECT_EQ(cached.body, "item");
+    EXPECT_EQ(calls, 1);
+}
+
+//------------------------------------------------------------------------------
+TEST(ResponseCache, FollowersRetryAfterError)
+{
+    std::atomic<int> calls{0};
+
+    vector<HandlerImpl> handlers;
+    handlers.emplace_back(
+        Request::Method::Get,
+        "/api/error",
+        [&calls](const Request &, Response &response)
+        {
+            calls++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            response.SetError(Response::Code::InternalServerError, "error");
+        },
+        CacheOptions());
+
+    const Server server(std::move(handlers), 4);
+
+    // ответ с ошибкой не кэшируется: ожидающие запросы вызывают обработчик
+    const auto replies{Burst(server.Port(), "/api/error")};
+
+    EXPECT_EQ(calls, static_cast<int>(clients));
+    for (const auto &reply : replies)
+    {
+        EXPECT_EQ(reply.status, 500);
+    }
+}
+
+}  // namespace
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tasp/config.hpp>
+#include <tasp/microservice.hpp>
+
+#include "common.hpp"
+
+using std::string;
+using std::vector;
+
+using tasp::http::Request;
+using tasp::http::Response;
+using tasp::test::Fetch;
+
+namespace
+{
+/**
+ * @brief Методы, допустимые для пути.
+ */
+const std::set<string> allowed{"GET", "POST", "HEAD", "OPTIONS"};
+
+/**
+ * @brief Разбор списка методов заголовка Allow.
+ *
+ * @param header Значение заголовка
+ *
+ * @return Методы
+ */
+std::set<string> Methods(const string &header)
+{
+    std::set<string> methods;
+    std::istringstream input{header};
+    for (string method; std::getline(input >> std::ws, method, ',');)
+    {
+        methods.insert(method);
+    }
+    return methods;
+}
+
+/**
+ * @brief Микросервис с обработчиками GET и POST одного пути, запущенный в
+ * отдельном потоке.
+ */
+class RoutingTest : public testing::Test
+{
+protected:
+    /**
+     * @brief Запуск микросервиса.
+     */
+    static void SetUpTestSuite()
+    {
+        // сигнал завершения принимается sigwait микросервиса, потоки
+        // наследуют маску
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+        vector<const char *> args{"tasp-microservice-tests"};
+        service = std::make_unique<tasp::MicroService>(
+            static_cast<int>(args.size()), args.data());
+
+        service->AddHandler(Request::Method::Get,
+                            "/items",
+                            [](const Request &, Response &response)
+                            { response.Data()->Set(string{"items"}); });
+        service->AddHandler(Request::Method::Post,
+                            "/items",
+                            [](const Request &, Response &response)
+                            { response.Data()->Set(string{"created"}); });
+
+        thread = std::thread(
+            []
+            {
+                [[maybe_unused]] const int res{service->Exec()};
+            });
+
+        const auto &config{tasp::ConfigGlobal::Instance()};
+        prefix = config.Get("service.prefix", string{"/api/v1"});
+        port = config.Get<uint16_t>("service.port", 5555);
+
+        // ожидание запуска потоков обработки событий
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    /**
+     * @brief Остановка микросервиса сигналом завершения.
+     */
+    static void TearDownTestSuite()
+    {
+        kill(getpid(), SIGTERM);
+        thread.join();
+        service.reset();
+    }
+
+    /**
+     * @brief Микросервис.
+     */
+    static inline std::unique_ptr<tasp::MicroService> service;
+
+    /**
+     * @brief Поток микросервиса.
+     */
+    static inline std::thread thread;
+
+    /**
+     * @brief Префикс путей обработчиков.
+     */
+    static inline string prefix;
+
+    /**
+     * @brief Порт микросервиса.
+     */
+    static inline uint16_t port{0};
+};
+
+//------------------------------------------------------------------------------
+TEST_F(RoutingTest, Get)
+{
+    const auto reply{Fetch(port, "GET", prefix + "/items")};
+    EXPECT_EQ(reply.status, 200);
+    EXPECT_EQ(reply.body, "items");
+}
+
+//------------------------------------------------------------------------------
+TEST_F(RoutingTest, MethodNotAllowed)
+{
+    const auto reply{Fetch(port, "DELETE", prefix + "/items")};
+    EXPECT_EQ(reply.status, 405);
+    EXPECT_EQ(Methods(reply.Header("Allow")), allowed);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(RoutingTest, HeadFallsBackToGet)
+{
+    const auto reply{Fetch(port, "HEAD", prefix + "/items")};
+    EXPECT_EQ(reply.status, 200);
+    EXPECT_TRUE(reply.body.empty());
+    EXPECT_FALSE(reply.Header("Content-Type").empty());
+}
+
+//------------------------------------------------------------------------------
+TEST_F(RoutingTest, Options)
+{
+    const auto reply{Fetch(port,
+                           "OPTIONS",
+                           prefix + "/items",
+                           {{"Origin", "http://localhost"},
+                            {"Access-Control-Request-Method", "POST"},
+                            {"Access-Control-Request-Headers", "X-Token"}})};
+    EXPECT_EQ(reply.status, 204);
+    EXPECT_EQ(Methods(reply.Header("Access-Control-Allow-Methods")), allowed);
+    EXPECT_EQ(reply.Header("Access-Control-Allow-Headers"), "X-Token");
+    EXPECT_FALSE(reply.Header("Access-Control-Max-Age").empty());
+}
+
+//------------------------------------------------------------------------------
+TEST_F(RoutingTest, NotFound)
+{
+    EXPECT_EQ(Fetch(port, "GET", prefix + "/missing").status, 404);
+    EXPECT_EQ(Fetch(port, "DELETE", prefix + "/missing").status, 404);
+}
+
+}  // namespace
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "http/sql_filter.hpp"
+
+using std::string;
+using std::vector;
+
+using tasp::SqlCondition;
+using tasp::http::SqlFilter;
+
+namespace
+{
+/**
+ * @brief Допустимые поля фильтра.
+ */
+const vector<string> fields{"id", "name"};
+
+//------------------------------------------------------------------------------
+TEST(SqlFilter, AllowedFields)
+{
+    const auto compiled{SqlFilter::Compile({"name:eq:item", "id:in:1,2"},
+                                           SqlCondition::Placeholder::Dollar,
+                                           fields)};
+
+    EXPECT_TRUE(compiled.error.empty());
+    ASSERT_NE(compiled.text, nullptr);
+    EXPECT_EQ(*compiled.text, "id IN ($1, $2) AND name = $3");
+    ASSERT_EQ(compiled.params.size(), 3U);
+    EXPECT_EQ(std::get<int64_t>(compiled.params[0]), 1);
+    EXPECT_EQ(std::get<string>(compiled.params[2]), "item");
+}
+
+//------------------------------------------------------------------------------
+TEST(SqlFilter, RejectsFieldOutsideWhitelist)
+{
+    const auto compiled{SqlFilter::Compile({"name:eq:item", "password:eq:1"},
+                                           SqlCondition::Placeholder::Dollar,
+                                           fields)};
+
+    EXPECT_FALSE(compiled.error.empty());
+    EXPECT_EQ(compiled.text, nullptr);
+    EXPECT_TRUE(compiled.params.empty());
+}
+
+//------------------------------------------------------------------------------
+TEST(SqlFilter, RejectsInvalidIdentifier)
+{
+    const auto compiled{SqlFilter::Compile(
+        {"id;drop table t:eq:1"}, SqlCondition::Placeholder::Question)};
+
+    EXPECT_FALSE(compiled.error.empty());
+    EXPECT_EQ(compiled.text, nullptr);
+}
+
+//------------------------------------------------------------------------------
+TEST(SqlFilter, RejectsUnknownOperation)
+{
+    const auto compiled{SqlFilter::Compile({"id:between:1"},
+                                           SqlCondition::Placeholder::Question,
+                                           fields)};
+
+    EXPECT_FALSE(compiled.error.empty());
+    EXPECT_EQ(compiled.text, nullptr);
+}
+
+}  // namespace